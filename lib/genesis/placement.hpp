@@ -34,6 +34,7 @@
  */
 
 #include "genesis/placement/formats/edge_color.hpp"
+#include "genesis/placement/formats/jplace_input_iterator.hpp"
 #include "genesis/placement/formats/jplace_reader.hpp"
 #include "genesis/placement/formats/jplace_writer.hpp"
 #include "genesis/placement/formats/newick_reader.hpp"
@@ -0,0 +1,428 @@
+#ifndef GENESIS_PLACEMENT_FORMATS_JPLACE_INPUT_ITERATOR_H_
+#define GENESIS_PLACEMENT_FORMATS_JPLACE_INPUT_ITERATOR_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/placement_tree.hpp"
+#include "genesis/placement/pquery.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/scanner.hpp"
+
+#include <cctype>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Jplace Input Iterator
+// =================================================================================================
+
+/**
+ * @brief Iterate an input source and parse it as a jplace document, yielding one Pquery
+ * at a time.
+ *
+ * This class allows to iterate over the `placements` of a jplace document, without having to keep
+ * all of them in memory. This is useful for processing files that are too large to be read into
+ * a Sample. The reference tree of the document, as well as its metadata, are available via
+ * tree() and sample(), where sample() does not contain any Pqueries. The PqueryPlacement%s of the
+ * yielded Pqueries point to the edges of this tree.
+ *
+ * Example:
+ *
+ *     auto masses = std::vector<double>();
+ *     auto it = JplaceInputIterator( from_file( "/path/to/large_file.jplace" ));
+ *     masses.resize( it.tree().edge_count(), 0.0 );
+ *     while( it ) {
+ *         filter_min_accumulated_weight( *it, 0.95 );
+ *         placement_mass_per_edges_with_multiplicities( *it, masses );
+ *         ++it;
+ *     }
+ *
+ * Use functions such as utils::from_file() and utils::from_string() to conveniently
+ * get an input source that can be used here. In order to change the reading behaviour, a
+ * JplaceReader object can be handed over from which the settings are copied.
+ *
+ * In order to interpret the placements, the `tree`, `fields` and `version` keys of the document
+ * are needed before the first Pquery can be yielded. However, many programs (including our
+ * JplaceWriter) write those after the `placements`. As the input source cannot be rewound,
+ * a second input source for the same document can be provided for such cases, for example:
+ *
+ *     auto it = JplaceInputIterator( from_file( infile ), from_file( infile ));
+ *
+ * This second source is only used if needed: It is read in a quick first pass that skips the
+ * `placements` and only collects the other keys. If no second source is given and the document
+ * does not provide the `tree` and the `fields` before the `placements`, an exception is thrown.
+ * If only the `version` comes after the `placements`, iterating works without the second source,
+ * as the version only changes how the tree is read for the old version 1, in which case an
+ * exception is thrown once the version is found at the end of the document.
+ *
+ * Thread safety: No thread safety. The common use case for this iterator is to loop over a file.
+ * Thus, guarding induces unnecessary overhead. If multiple threads read from this iterator, both
+ * dereferencing and incrementing need to be guarded.
+ */
+class JplaceInputIterator
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Member Types
+    // -------------------------------------------------------------------------
+
+    using self_type         = JplaceInputIterator;
+    using value_type        = Pquery;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Create a default instance, with no input.
+     */
+    JplaceInputIterator()
+        : input_stream_( nullptr )
+        , reader_()
+        , good_( false )
+    {}
+
+    /**
+     * @brief Create an instance that reads from an input source, using a default JplaceReader.
+     */
+    explicit JplaceInputIterator( std::shared_ptr<utils::BaseInputSource> source )
+        : JplaceInputIterator( source, nullptr, JplaceReader() )
+    {}
+
+    /**
+     * @brief Create an instance that reads from an input source,
+     * using the settings of a given JplaceReader.
+     */
+    JplaceInputIterator(
+        std::shared_ptr<utils::BaseInputSource> source,
+        JplaceReader const& settings
+    )
+        : JplaceInputIterator( source, nullptr, settings )
+    {}
+
+    /**
+     * @brief Create an instance that reads from an input source, and uses a second source
+     * of the same document to read the `tree` and `fields` if they appear after the `placements`.
+     *
+     * See the class description for details.
+     */
+    JplaceInputIterator(
+        std::shared_ptr<utils::BaseInputSource> source,
+        std::shared_ptr<utils::BaseInputSource> header_source,
+        JplaceReader const& settings = JplaceReader()
+    )
+        : input_stream_( std::make_shared<utils::InputStream>( source ))
+        , reader_( settings )
+    {
+        init_( header_source );
+        increment();
+    }
+
+    ~JplaceInputIterator() = default;
+
+    JplaceInputIterator( self_type const& ) = delete;
+    JplaceInputIterator( self_type&& )      = default;
+
+    self_type& operator= ( self_type const& ) = delete;
+    self_type& operator= ( self_type&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Comparators
+    // -------------------------------------------------------------------------
+
+    bool operator == ( self_type const& other ) const
+    {
+        return input_stream_ == other.input_stream_;
+    }
+
+    bool operator != ( self_type const& other ) const
+    {
+        return !( *this == other );
+    }
+
+    /**
+    * @brief Return true iff dereferencing is valid, i.e., iff there is a Pquery available.
+    */
+    explicit operator bool() const
+    {
+        return good_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the current Pquery.
+     *
+     * The Pquery can be modified, e.g., by filter functions, as it is replaced by the next one
+     * when incrementing the iterator anyway.
+     */
+    value_type& operator * ()
+    {
+        return pquery_;
+    }
+
+    value_type const& operator * () const
+    {
+        return pquery_;
+    }
+
+    value_type* operator -> ()
+    {
+        return &pquery_;
+    }
+
+    value_type const* operator -> () const
+    {
+        return &pquery_;
+    }
+
+    value_type const& dereference() const
+    {
+        return pquery_;
+    }
+
+    /**
+     * @brief Return the Sample that holds the reference tree and the metadata of the document.
+     *
+     * The Sample does not contain any Pqueries. Metadata that appears after the `placements`
+     * in the document is only available once the iteration is finished.
+     */
+    Sample const& sample() const
+    {
+        return sample_;
+    }
+
+    /**
+     * @brief Return the reference tree of the document.
+     */
+    PlacementTree const& tree() const
+    {
+        return sample_.tree();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Iteration
+    // -------------------------------------------------------------------------
+
+    self_type& operator ++ ()
+    {
+        increment();
+        return *this;
+    }
+
+    void increment()
+    {
+        if( ! good_ ) {
+            return;
+        }
+        auto& it = *input_stream_;
+
+        // After the first Pquery, we expect a comma or the end of the placements array.
+        utils::skip_while( it, ::isspace );
+        if( ! first_pquery_ && it && *it != ']' ) {
+            utils::read_char_or_throw( it, ',' );
+            utils::skip_while( it, ::isspace );
+        }
+        first_pquery_ = false;
+
+        // If we reached the end of the placements, read the rest of the document and stop.
+        if( !it || *it == ']' ) {
+            utils::read_char_or_throw( it, ']' );
+            finish_();
+            good_ = false;
+            return;
+        }
+
+        // Read the next Pquery.
+        pquery_ = Pquery();
+        reader_.parse_jplace_pquery_( it, pquery_, values_ );
+        reader_.process_jplace_placements_p_( values_, pquery_, header_.fields, edge_num_map_ );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Internal Helpers
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Read the document until the beginning of the `placements` array, and process
+     * its header, using the @p header_source if needed.
+     */
+    void init_( std::shared_ptr<utils::BaseInputSource> header_source )
+    {
+        auto& it = *input_stream_;
+
+        // Read keys until we find the placements.
+        std::string key;
+        bool first = true;
+        bool found_placements = false;
+        while( reader_.parse_jplace_key_( it, key, first )) {
+            first = false;
+            if( key == "placements" ) {
+                found_placements = true;
+                break;
+            }
+            reader_.parse_jplace_header_value_( it, key, header_, sample_ );
+        }
+        if( ! found_placements ) {
+            throw std::runtime_error(
+                "Jplace document does not contain pqueries at key 'placements'."
+            );
+        }
+
+        // If we do not know the header yet, make a first pass over the second source.
+        if( ! header_.complete() && header_source ) {
+            read_header_( header_source );
+        }
+        if( ! header_.found_tree || ! header_.found_fields ) {
+            throw std::runtime_error(
+                "Jplace document does not contain the 'tree' and 'fields' keys before "
+                "the 'placements', which are needed to iterate its pqueries. "
+                "Provide a second input source of the same document to read them first."
+            );
+        }
+        edge_num_map_ = reader_.process_jplace_header_( header_, sample_ );
+
+        // Move to the first Pquery.
+        if( !it || *it != '[' ) {
+            throw std::runtime_error(
+                "Jplace document does not contain pqueries at key 'placements'."
+            );
+        }
+        ++it;
+    }
+
+    /**
+     * @brief Read all keys except for the `placements` from a source, without keeping the
+     * placements in memory.
+     */
+    void read_header_( std::shared_ptr<utils::BaseInputSource> header_source )
+    {
+        // Start from scratch, so that we do not process keys twice.
+        header_ = JplaceReader::DocumentHeader();
+        sample_ = Sample();
+        header_from_source_ = true;
+
+        utils::InputStream header_stream( header_source );
+        std::string key;
+        bool first = true;
+        while( reader_.parse_jplace_key_( header_stream, key, first )) {
+            first = false;
+            if( key == "placements" ) {
+                reader_.skip_jplace_value_( header_stream );
+            } else {
+                reader_.parse_jplace_header_value_( header_stream, key, header_, sample_ );
+            }
+        }
+    }
+
+    /**
+     * @brief Read the remaining keys after the `placements` array.
+     */
+    void finish_()
+    {
+        auto& it = *input_stream_;
+
+        // We already know the header at this point. If we read it from the second source,
+        // all other keys were processed already. Otherwise, we only need the metadata here,
+        // and the version, in case that it was not given before the placements.
+        std::string key;
+        auto header = JplaceReader::DocumentHeader();
+        while( reader_.parse_jplace_key_( it, key, false )) {
+            if(
+                header_from_source_ || key == "tree" || key == "fields" ||
+                ( key == "version" && header_.found_version )
+            ) {
+                reader_.skip_jplace_value_( it );
+            } else {
+                reader_.parse_jplace_header_value_( it, key, header, sample_ );
+            }
+        }
+
+        // If the version came after the placements, we have processed the tree without it.
+        // That is only correct if the version does not change how the tree is read.
+        if( header.found_version ) {
+            if( header.version == 1 ) {
+                throw std::runtime_error(
+                    "Jplace document specifies version 1 at key 'version' after the 'placements', "
+                    "which changes how its tree is read. Provide a second input source of the "
+                    "same document to read the version first."
+                );
+            }
+            header_.version       = header.version;
+            header_.found_version = true;
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    std::shared_ptr<utils::InputStream> input_stream_;
+
+    JplaceReader reader_;
+    bool         good_ = true;
+    bool         first_pquery_ = true;
+    bool         header_from_source_ = false;
+
+    JplaceReader::DocumentHeader                   header_;
+    std::unordered_map<size_t, PlacementTreeEdge*> edge_num_map_;
+    JplaceReader::PqueryValues                     values_;
+
+    Sample sample_;
+    Pquery pquery_;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
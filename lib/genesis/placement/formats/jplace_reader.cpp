@@ -53,7 +53,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -74,8 +77,10 @@ namespace placement {
 Sample JplaceReader::read(
     std::shared_ptr<utils::BaseInputSource> source
 ) const {
-    auto doc = utils::JsonReader().read( source );
-    return read( doc );
+    Sample smp;
+    utils::InputStream is( source );
+    parse_jplace_document_( is, smp );
+    return smp;
 }
 
 Sample JplaceReader::read(
@@ -102,12 +107,29 @@ Sample JplaceReader::read(
     }
 
     // Basics.
-    process_jplace_version_( doc );
-    process_jplace_metadata_( doc, smp );
+    auto const version_it = doc.find( "version" );
+    auto const version = ( version_it == doc.end() ? -1 : get_jplace_version_( *version_it ));
+    process_jplace_version_( version );
+    auto const meta_it = doc.find( "metadata" );
+    if( meta_it != doc.end() ) {
+        process_jplace_metadata_( *meta_it, smp );
+    }
+
+    // Find and process the reference tree.
+    auto const tree_it = doc.find( "tree" );
+    if( tree_it == doc.end() || ! tree_it->is_string() ) {
+        throw std::runtime_error(
+            "Jplace document does not contain a valid Newick tree at key 'tree'."
+        );
+    }
+    process_jplace_tree_( tree_it->get_string(), version, smp );
 
     // Content.
-    process_jplace_tree_( doc, smp );
-    auto const fields = process_jplace_fields_( doc );
+    auto const fields_it = doc.find( "fields" );
+    if( fields_it == doc.end() ) {
+        throw std::runtime_error( "Jplace document does not contain field names at key 'fields'." );
+    }
+    auto const fields = process_jplace_fields_( *fields_it );
     process_jplace_placements_( doc, smp, fields );
 
     return smp;
@@ -131,10 +153,16 @@ void JplaceReader::read(
     // when reading with OpenMP.
     auto tmp = std::vector<Sample>( sources.size() );
 
+    // Trees that are identical between the documents are only parsed once.
+    // The cache is dropped at the end of this function.
+    TreeCache tree_cache;
+    auto const cache_ptr = ( reuse_trees_ ? &tree_cache : nullptr );
+
     // Parallel parsing.
     #pragma omp parallel for
     for( size_t i = 0; i < sources.size(); ++i ) {
-        tmp[ i ] = read( sources[i] );
+        utils::InputStream is( sources[i] );
+        parse_jplace_document_( is, tmp[ i ], cache_ptr );
     }
 
     // Move to target SampleSet.
@@ -150,6 +178,434 @@ void JplaceReader::read(
     }
 }
 
+// =================================================================================================
+//     Streaming
+// =================================================================================================
+
+// -------------------------------------------------------------------------
+//     Parse Document
+// -------------------------------------------------------------------------
+
+void JplaceReader::parse_jplace_document_(
+    utils::InputStream& input_stream,
+    Sample&             smp,
+    TreeCache*          tree_cache
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+
+    // Values of the top level keys that we need to keep until the whole header is known.
+    DocumentHeader header;
+    bool found_placements = false;
+
+    // Once the tree is processed, we can resolve the edge nums of the placements.
+    bool tree_processed = false;
+    std::unordered_map<size_t, PlacementTreeEdge*> edge_num_map;
+
+    // Placement values that cannot be processed yet, because the header was not complete when the
+    // placements were read. The indices correspond to the Pqueries in the Sample.
+    std::vector<PqueryValues> pending;
+
+    std::string key;
+    bool first = true;
+    while( parse_jplace_key_( it, key, first )) {
+        first = false;
+
+        if( key != "placements" ) {
+            parse_jplace_header_value_( it, key, header, smp );
+            continue;
+        }
+
+        if( found_placements ) {
+            throw std::runtime_error(
+                "Jplace document contains key 'placements' more than once."
+            );
+        }
+        found_placements = true;
+
+        // If we already know everything needed to interpret the placements, we can process
+        // the tree now, and then each pquery directly once it is read.
+        if( header.complete() ) {
+            edge_num_map = process_jplace_header_( header, smp, tree_cache );
+            tree_processed = true;
+        } else {
+            LOG_DBG << "Jplace document does not contain the 'version', 'tree' and 'fields' keys "
+                    << "before the 'placements'. Keeping the placement values until the end "
+                    << "of the document.";
+        }
+
+        if( !it || *it != '[' ) {
+            throw std::runtime_error(
+                "Jplace document does not contain pqueries at key 'placements'."
+            );
+        }
+        ++it;
+        skip_while( it, ::isspace );
+
+        // Buffer for the placement values, used if we can process the pqueries directly.
+        PqueryValues values;
+
+        while( it && *it != ']' ) {
+            auto& pquery = smp.add();
+            if( tree_processed ) {
+                parse_jplace_pquery_( it, pquery, values );
+                process_jplace_placements_p_( values, pquery, header.fields, edge_num_map );
+            } else {
+                pending.emplace_back();
+                parse_jplace_pquery_( it, pquery, pending.back() );
+            }
+
+            // Check for end of array, or continue with the next element.
+            skip_while( it, ::isspace );
+            if( !it || *it == ']' ) {
+                break;
+            }
+            read_char_or_throw( it, ',' );
+            skip_while( it, ::isspace );
+        }
+        read_char_or_throw( it, ']' );
+    }
+
+    // Check that we found the placements. The other keys are checked when processing the header.
+    if( ! found_placements ) {
+        throw std::runtime_error(
+            "Jplace document does not contain pqueries at key 'placements'."
+        );
+    }
+
+    // If the header was incomplete when reading the placements, we now have all we need
+    // to process the pending placement values.
+    if( ! tree_processed ) {
+        edge_num_map = process_jplace_header_( header, smp, tree_cache );
+
+        assert( pending.size() == smp.size() );
+        for( size_t i = 0; i < pending.size(); ++i ) {
+            process_jplace_placements_p_( pending[i], smp.at(i), header.fields, edge_num_map );
+            pending[i] = PqueryValues();
+        }
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Parse Key
+// -------------------------------------------------------------------------
+
+bool JplaceReader::parse_jplace_key_(
+    utils::InputStream& input_stream,
+    std::string&        key,
+    bool                first
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+
+    // At the beginning, check that this is a Json object at all.
+    // Otherwise, we expect either the end of the object, or a comma and the next key.
+    skip_while( it, ::isspace );
+    if( first ) {
+        if( !it || *it != '{' ) {
+            throw std::runtime_error( "Json value is not a Json document." );
+        }
+        ++it;
+        skip_while( it, ::isspace );
+    } else if( it && *it == ',' ) {
+        ++it;
+        skip_while( it, ::isspace );
+        affirm_char_or_throw( it, '"' );
+    } else if( !it || *it != '}' ) {
+        throw std::runtime_error( "Unexpected end of Json object at " + it.at() );
+    }
+
+    // We are at the end of the object. There should not be anything else in the input.
+    if( it && *it == '}' ) {
+        ++it;
+        skip_while( it, ::isspace );
+        if( it ) {
+            throw std::runtime_error(
+                "Expected end of input while reading Json at " + it.at()
+            );
+        }
+        return false;
+    }
+
+    // Get the key and move to the beginning of the value.
+    affirm_char_or_throw( it, '"' );
+    key = parse_quoted_string( it );
+    skip_while( it, ::isspace );
+    read_char_or_throw( it, ':' );
+    skip_while( it, ::isspace );
+    return true;
+}
+
+// -------------------------------------------------------------------------
+//     Parse Header Value
+// -------------------------------------------------------------------------
+
+void JplaceReader::parse_jplace_header_value_(
+    utils::InputStream& input_stream,
+    std::string const&  key,
+    DocumentHeader&     header,
+    Sample&             smp
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+    auto const json_reader = JsonReader();
+
+    if( key == "version" ) {
+        header.version = get_jplace_version_( json_reader.parse_value( it ));
+        header.found_version = true;
+
+    } else if( key == "metadata" ) {
+        process_jplace_metadata_( json_reader.parse_value( it ), smp );
+
+    } else if( key == "tree" ) {
+        if( !it || *it != '"' ) {
+            throw std::runtime_error(
+                "Jplace document does not contain a valid Newick tree at key 'tree'."
+            );
+        }
+        header.newick = parse_quoted_string( it );
+        header.found_tree = true;
+
+    } else if( key == "fields" ) {
+        header.fields = process_jplace_fields_( json_reader.parse_value( it ));
+        header.found_fields = true;
+
+    } else {
+        LOG_WARN << "Jplace document contains top-level key '" << key << "', which is not part "
+                 << "of the jplace standard and hence ignored. This might indicate an issue "
+                 << "with the data or the program which generated the document.";
+        skip_jplace_value_( it );
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Skip Value
+// -------------------------------------------------------------------------
+
+void JplaceReader::skip_jplace_value_(
+    utils::InputStream& input_stream
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+
+    // Helper to skip a string, which might contain brackets and escaped quotation marks.
+    auto skip_string = [&](){
+        assert( it && *it == '"' );
+        ++it;
+        while( it && *it != '"' ) {
+            if( *it == '\\' ) {
+                ++it;
+            }
+            ++it;
+        }
+        read_char_or_throw( it, '"' );
+    };
+
+    skip_while( it, ::isspace );
+    if( !it ) {
+        throw std::runtime_error(
+            "Unexpected end of " + it.source_name() + " at " + it.at() + "."
+        );
+    }
+
+    // Simple values end at the next delimiter.
+    if( *it == '"' ) {
+        skip_string();
+        return;
+    }
+    if( *it != '[' && *it != '{' ) {
+        while( it && *it != ',' && *it != ']' && *it != '}' && ! ::isspace( *it )) {
+            ++it;
+        }
+        return;
+    }
+
+    // Skip nested arrays and objects by counting their brackets.
+    // We do not validate the content here, as it is not used anyway.
+    size_t depth = 0;
+    do {
+        if( *it == '"' ) {
+            skip_string();
+            continue;
+        }
+        if( *it == '[' || *it == '{' ) {
+            ++depth;
+        } else if( *it == ']' || *it == '}' ) {
+            --depth;
+        }
+        ++it;
+    } while( it && depth > 0 );
+
+    if( depth > 0 ) {
+        throw std::runtime_error(
+            "Unexpected end of " + it.source_name() + " at " + it.at() + "."
+        );
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Parse Pquery
+// -------------------------------------------------------------------------
+
+void JplaceReader::parse_jplace_pquery_(
+    utils::InputStream& input_stream,
+    Pquery&             pquery,
+    PqueryValues&       values
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+    auto const json_reader = JsonReader();
+
+    // Check that this is an object.
+    skip_while( it, ::isspace );
+    if( !it || *it != '{' ) {
+        throw std::runtime_error(
+            "Jplace document contains a value at " + it.at() + " that is not an object "
+            "with a pquery at key 'placements'."
+        );
+    }
+    ++it;
+    skip_while( it, ::isspace );
+
+    // The names are small, so we simply keep their Json values for processing them.
+    bool found_p = false;
+    JsonDocument n_value;
+    JsonDocument m_value;
+    JsonDocument nm_value;
+    bool found_n = false;
+    bool found_m = false;
+    bool found_nm = false;
+
+    while( it && *it != '}' ) {
+        affirm_char_or_throw( it, '"' );
+        auto const key = parse_quoted_string( it );
+        skip_while( it, ::isspace );
+        read_char_or_throw( it, ':' );
+        skip_while( it, ::isspace );
+
+        if( key == "p" ) {
+            parse_jplace_pquery_p_( it, values );
+            found_p = true;
+        } else if( key == "n" ) {
+            n_value = json_reader.parse_value( it );
+            found_n = true;
+        } else if( key == "m" ) {
+            m_value = json_reader.parse_value( it );
+            found_m = true;
+        } else if( key == "nm" ) {
+            nm_value = json_reader.parse_value( it );
+            found_nm = true;
+        } else {
+            skip_jplace_value_( it );
+        }
+
+        skip_while( it, ::isspace );
+        if( !it || *it == '}' ) {
+            break;
+        }
+        read_char_or_throw( it, ',' );
+        skip_while( it, ::isspace );
+    }
+    read_char_or_throw( it, '}' );
+
+    if( ! found_p ) {
+        throw std::runtime_error(
+            "Jplace document contains a pquery at key 'placements' that does not contain an "
+            "array of placements at key 'p'."
+        );
+    }
+    process_jplace_placements_nm_(
+        found_n  ? &n_value  : nullptr,
+        found_m  ? &m_value  : nullptr,
+        found_nm ? &nm_value : nullptr,
+        pquery
+    );
+}
+
+// -------------------------------------------------------------------------
+//     Parse Pquery P
+// -------------------------------------------------------------------------
+
+void JplaceReader::parse_jplace_pquery_p_(
+    utils::InputStream& input_stream,
+    PqueryValues&       values
+) const {
+    using namespace utils;
+    auto& it = input_stream;
+    auto const json_reader = JsonReader();
+
+    values.values.clear();
+    values.field_count = 0;
+    values.placement_count = 0;
+
+    // Check basic validity.
+    if( !it || *it != '[' ) {
+        throw std::runtime_error(
+            "Jplace document contains a pquery at key 'placements' that does not contain an "
+            "array of placements at key 'p'."
+        );
+    }
+    ++it;
+    skip_while( it, ::isspace );
+    if( it && *it == ']' ) {
+        throw std::runtime_error(
+            "Jplace document contains a pquery at key 'placements' that does not contain any "
+            "placements at key 'p'."
+        );
+    }
+
+    // Read all placements, each of them an array of values.
+    while( it ) {
+        if( *it != '[' ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery with invalid placement at key 'p'."
+            );
+        }
+        ++it;
+        skip_while( it, ::isspace );
+
+        size_t field_count = 0;
+        while( it && *it != ']' ) {
+
+            // Numbers are read directly. Everything else is skipped, but marked as invalid,
+            // so that we can complain about it later if it is a field that we need.
+            if( char_is_digit( *it ) || char_is_sign( *it ) || *it == '.' ) {
+                values.values.push_back( json_reader.parse_number( it ).get_number<double>() );
+            } else {
+                skip_jplace_value_( it );
+                values.values.push_back( std::numeric_limits<double>::quiet_NaN() );
+            }
+            ++field_count;
+
+            skip_while( it, ::isspace );
+            if( !it || *it == ']' ) {
+                break;
+            }
+            read_char_or_throw( it, ',' );
+            skip_while( it, ::isspace );
+        }
+        read_char_or_throw( it, ']' );
+
+        // All placements need the same number of fields.
+        if( values.placement_count > 0 && field_count != values.field_count ) {
+            throw std::runtime_error(
+                "Jplace document contains a placement fields array with different size "
+                "than the fields name array."
+            );
+        }
+        values.field_count = field_count;
+        ++values.placement_count;
+
+        skip_while( it, ::isspace );
+        if( !it || *it == ']' ) {
+            break;
+        }
+        read_char_or_throw( it, ',' );
+        skip_while( it, ::isspace );
+    }
+    read_char_or_throw( it, ']' );
+}
+
 // =================================================================================================
 //     Processing
 // =================================================================================================
@@ -158,25 +614,18 @@ void JplaceReader::read(
 //     Get Version
 // -------------------------------------------------------------------------
 
-int JplaceReader::get_jplace_version_( utils::JsonDocument const& doc ) const
+int JplaceReader::get_jplace_version_( utils::JsonDocument const& version_value ) const
 {
-    // Check if there is a version key.
-    auto v_it = doc.find( "version" );
-    if( v_it == doc.end() ) {
-        return -1;
-    }
-
     // Try string and int, return -1 otherwise.
     int version = -1;
-    assert( v_it != doc.end() );
-    if( v_it->is_string() ) {
+    if( version_value.is_string() ) {
         try {
-            version = std::stoi( v_it->get_string() );
+            version = std::stoi( version_value.get_string() );
         } catch(...) {
             version = -1;
         }
-    } else if( v_it->is_number_unsigned() ) {
-        version = v_it->get_number_unsigned();
+    } else if( version_value.is_number_unsigned() ) {
+        version = version_value.get_number_unsigned();
     }
     return version;
 }
@@ -185,10 +634,8 @@ int JplaceReader::get_jplace_version_( utils::JsonDocument const& doc ) const
 //     Processing Version
 // -------------------------------------------------------------------------
 
-void JplaceReader::process_jplace_version_( utils::JsonDocument const& doc ) const
+void JplaceReader::process_jplace_version_( int version ) const
 {
-    auto const version = get_jplace_version_( doc );
-
     // Check if there is a valid version key.
     if( version == -1 ) {
         LOG_WARN << "Jplace document does not contain a valid version number at key 'version'. "
@@ -208,12 +655,12 @@ void JplaceReader::process_jplace_version_( utils::JsonDocument const& doc ) con
 //     Processing Metadata
 // -------------------------------------------------------------------------
 
-void JplaceReader::process_jplace_metadata_( utils::JsonDocument const& doc, Sample& smp ) const
-{
+void JplaceReader::process_jplace_metadata_(
+    utils::JsonDocument const& metadata_value, Sample& smp
+) const {
     // Check if there is metadata.
-    auto meta_it = doc.find( "metadata" );
-    if( meta_it != doc.end() && meta_it->is_object() ) {
-        for( auto it = meta_it->begin(); it != meta_it->end(); ++it ) {
+    if( metadata_value.is_object() ) {
+        for( auto it = metadata_value.begin(); it != metadata_value.end(); ++it ) {
 
             // Only use metadata that is a string. Everything else is ignored.
             if( it.value().is_string() ) {
@@ -230,44 +677,77 @@ void JplaceReader::process_jplace_metadata_( utils::JsonDocument const& doc, Sam
 //     Processing Tree
 // -------------------------------------------------------------------------
 
-void JplaceReader::process_jplace_tree_( utils::JsonDocument const& doc, Sample& smp ) const
-{
-    // Get the jplace version. Version 1 uses Newick comments in brackets [] for the edge_nums,
+void JplaceReader::process_jplace_tree_(
+    std::string const& newick,
+    int                version,
+    Sample&            smp,
+    TreeCache*         tree_cache
+) const {
+    // If we already parsed the same tree for another document, simply copy it.
+    // The copy is made outside of the critical section, as the cached trees are never modified,
+    // and our shared pointer keeps the tree alive in any case.
+    utils::SHA1::DigestType digest{};
+    if( tree_cache ) {
+        utils::SHA1 hasher;
+        hasher.update( newick );
+        digest = hasher.final_digest();
+
+        auto& trees = ( version == 1 ? tree_cache->trees_v1 : tree_cache->trees );
+        std::shared_ptr<PlacementTree const> cached;
+
+        #pragma omp critical( GENESIS_PLACEMENT_JPLACE_READER_TREE_CACHE )
+        {
+            auto const found = trees.find( digest );
+            if( found != trees.end() ) {
+                cached = found->second;
+            }
+        }
+        if( cached ) {
+            smp.tree() = *cached;
+            return;
+        }
+    }
+
+    // Version 1 uses Newick comments in brackets [] for the edge_nums,
     // while later versions store them in "tags" in curly braces {}.
     // Prepare the Newick reader accordingly.
-    auto const version = get_jplace_version_( doc );
     auto reader = PlacementTreeNewickReader();
     if( version == 1 ) {
         reader.get_edge_num_from_comments( true );
     }
-
-    // Find and process the reference tree.
-    auto tree_it = doc.find( "tree" );
-    if( tree_it == doc.end() || ! tree_it->is_string() ) {
-        throw std::runtime_error(
-            "Jplace document does not contain a valid Newick tree at key 'tree'."
-        );
-    }
-    smp.tree() = reader.read( utils::from_string( tree_it->get_string() ));
+    auto tree = reader.read( utils::from_string( newick ));
 
     // The tree reader already does all necessary checks of the tree. No need to repeat them here.
+
+    // Offer a copy of the tree to other documents. If another thread parsed the same tree
+    // in the meantime, this does nothing, and our copy is dropped again.
+    if( tree_cache ) {
+        auto& trees = ( version == 1 ? tree_cache->trees_v1 : tree_cache->trees );
+        auto entry = std::make_shared<PlacementTree const>( tree );
+
+        #pragma omp critical( GENESIS_PLACEMENT_JPLACE_READER_TREE_CACHE )
+        {
+            trees.emplace( digest, std::move( entry ));
+        }
+    }
+    smp.tree() = std::move( tree );
 }
 
 // -------------------------------------------------------------------------
 //     Processing Fields
 // -------------------------------------------------------------------------
 
-std::vector<std::string> JplaceReader::process_jplace_fields_( utils::JsonDocument const& doc ) const
-{
+std::vector<std::string> JplaceReader::process_jplace_fields_(
+    utils::JsonDocument const& fields_value
+) const {
     // Basics.
-    auto fields_it = doc.find( "fields" );
-    if( fields_it == doc.end() || ! fields_it->is_array() ) {
+    if( ! fields_value.is_array() ) {
         throw std::runtime_error( "Jplace document does not contain field names at key 'fields'." );
     }
 
     // Store the fields in a vecor in the order that they are specified.
     std::vector<std::string> fields;
-    for( auto const& fields_val : *fields_it ) {
+    for( auto const& fields_val : fields_value ) {
         if( ! fields_val.is_string() ) {
             throw std::runtime_error(
                 "Jplace document contains a value of type '" + fields_val.type_name()
@@ -338,13 +818,36 @@ std::vector<std::string> JplaceReader::process_jplace_fields_( utils::JsonDocume
 }
 
 // -------------------------------------------------------------------------
-//     Processing Placements
+//     Processing Header
 // -------------------------------------------------------------------------
 
-void JplaceReader::process_jplace_placements_(
-    utils::JsonDocument&            doc,
-    Sample&                         smp,
-    std::vector<std::string> const& fields
+std::unordered_map<size_t, PlacementTreeEdge*> JplaceReader::process_jplace_header_(
+    DocumentHeader& header,
+    Sample&         smp,
+    TreeCache*      tree_cache
+) const {
+    // Check that we found all necessary parts.
+    if( ! header.found_tree ) {
+        throw std::runtime_error(
+            "Jplace document does not contain a valid Newick tree at key 'tree'."
+        );
+    }
+    if( ! header.found_fields ) {
+        throw std::runtime_error( "Jplace document does not contain field names at key 'fields'." );
+    }
+
+    process_jplace_version_( header.version );
+    process_jplace_tree_( header.newick, header.version, smp, tree_cache );
+    header.newick = std::string();
+    return process_jplace_edge_nums_( smp );
+}
+
+// -------------------------------------------------------------------------
+//     Processing Edge Nums
+// -------------------------------------------------------------------------
+
+std::unordered_map<size_t, PlacementTreeEdge*> JplaceReader::process_jplace_edge_nums_(
+    Sample& smp
 ) const {
     // Create a map from edge nums to the actual edge pointers, for later use when processing
     // the pqueries. we do not use Sample::EdgeNumMap() here, because we need to do extra
@@ -362,6 +865,19 @@ void JplaceReader::process_jplace_placements_(
         }
         edge_num_map.emplace( edge_data.edge_num(), &edge );
     }
+    return edge_num_map;
+}
+
+// -------------------------------------------------------------------------
+//     Processing Placements
+// -------------------------------------------------------------------------
+
+void JplaceReader::process_jplace_placements_(
+    utils::JsonDocument&            doc,
+    Sample&                         smp,
+    std::vector<std::string> const& fields
+) const {
+    auto const edge_num_map = process_jplace_edge_nums_( smp );
 
     // Find and process the pqueries.
     auto place_it = doc.find( "placements" );
@@ -370,6 +886,7 @@ void JplaceReader::process_jplace_placements_(
             "Jplace document does not contain pqueries at key 'placements'."
         );
     }
+    PqueryValues values;
     for( auto& pqry_obj : *place_it ) {
         if( ! pqry_obj.is_object() ) {
             throw std::runtime_error(
@@ -378,13 +895,58 @@ void JplaceReader::process_jplace_placements_(
             );
         }
 
+        // Check basic validity of the placements.
+        auto const pqry_p_arr = pqry_obj.find( "p" );
+        if( pqry_p_arr == pqry_obj.end() || ! pqry_p_arr->is_array() ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery at key 'placements' that does not contain an "
+                "array of placements at key 'p'."
+            );
+        }
+        if( pqry_p_arr->size() == 0 ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery at key 'placements' that does not contain any "
+                "placements at key 'p'."
+            );
+        }
+
+        // Collect the placement values. Non-numbers are stored as NaN, see PqueryValues.
+        values.values.clear();
+        values.field_count = pqry_p_arr->at(0).is_array() ? pqry_p_arr->at(0).size() : 0;
+        values.placement_count = 0;
+        for( auto const& pqry_fields : *pqry_p_arr ) {
+            if( ! pqry_fields.is_array() ) {
+                throw std::runtime_error(
+                    "Jplace document contains a pquery with invalid placement at key 'p'."
+                );
+            }
+            if( pqry_fields.size() != values.field_count ) {
+                throw std::runtime_error(
+                    "Jplace document contains a placement fields array with different size "
+                    "than the fields name array."
+                );
+            }
+            for( auto const& field_val : pqry_fields ) {
+                values.values.push_back(
+                    field_val.is_number()
+                    ? field_val.get_number<double>()
+                    : std::numeric_limits<double>::quiet_NaN()
+                );
+            }
+            ++values.placement_count;
+        }
+
         // Create new pquery and fill it with the p, n, m, and nm values.
-        auto pquery = Pquery();
-        process_jplace_placements_p_( pqry_obj, pquery, fields, edge_num_map );
-        process_jplace_placements_nm_( pqry_obj, pquery );
+        auto& pquery = smp.add();
+        process_jplace_placements_p_( values, pquery, fields, edge_num_map );
+        process_jplace_placements_nm_(
+            pqry_obj.count( "n" )  > 0 ? &pqry_obj[ "n" ]  : nullptr,
+            pqry_obj.count( "m" )  > 0 ? &pqry_obj[ "m" ]  : nullptr,
+            pqry_obj.count( "nm" ) > 0 ? &pqry_obj[ "nm" ] : nullptr,
+            pquery
+        );
 
-        // Add the pquery to the smp object, and remove the values from the json doc to save memory.
-        smp.add( pquery );
+        // Remove the values from the json doc to save memory.
         pqry_obj.clear();
     }
 }
@@ -394,7 +956,7 @@ void JplaceReader::process_jplace_placements_(
 // -------------------------------------------------------------------------
 
 void JplaceReader::process_jplace_placements_p_(
-    utils::JsonDocument const&      pqry_obj,
+    PqueryValues const&             values,
     Pquery&                         pquery,
     std::vector<std::string> const& fields,
     std::unordered_map<size_t, PlacementTreeEdge*> const& edge_num_map
@@ -433,35 +995,23 @@ void JplaceReader::process_jplace_placements_p_(
     };
 
     // Check basic validity.
-    assert( pqry_obj.is_object() );
-    auto const pqry_p_arr = pqry_obj.find( "p" );
-    if( pqry_p_arr == pqry_obj.end() || ! pqry_p_arr->is_array() ) {
+    if( values.placement_count == 0 ) {
         throw std::runtime_error(
-            "Jplace document contains a pquery at key 'placements' that does not contain an "
-            "array of placements at key 'p'."
+            "Jplace document contains a pquery at key 'placements' that does not contain any "
+            "placements at key 'p'."
         );
     }
-    if( pqry_p_arr->size() == 0 ) {
+    if( values.field_count != fields.size() ) {
         throw std::runtime_error(
-            "Jplace document contains a pquery at key 'placements' that does not contain any "
-            "placements at key 'p'."
+            "Jplace document contains a placement fields array with different size "
+            "than the fields name array."
         );
     }
+    assert( values.values.size() == values.placement_count * values.field_count );
 
     // Process the placements and store them in the pquery.
-    for( auto const& pqry_fields : *pqry_p_arr ) {
-        if( ! pqry_fields.is_array() ) {
-            throw std::runtime_error(
-                "Jplace document contains a pquery with invalid placement at key 'p'."
-            );
-        }
-
-        if( pqry_fields.size() != fields.size() ) {
-            throw std::runtime_error(
-                "Jplace document contains a placement fields array with different size "
-                "than the fields name array."
-            );
-        }
+    for( size_t p = 0; p < values.placement_count; ++p ) {
+        auto const pqry_fields = values.values.data() + p * values.field_count;
 
         // Init a placement and set some distal/proximal lengths temps.
         auto pqry_place = PqueryPlacement();
@@ -469,7 +1019,7 @@ void JplaceReader::process_jplace_placements_p_(
         pqry_place.proximal_length = 0.0;
 
         // Process all fields of the placement.
-        for( size_t i = 0; i < pqry_fields.size(); ++i ) {
+        for( size_t i = 0; i < fields.size(); ++i ) {
 
             // Switch on the field name to set the correct value, and store the target value.
             // We currently only process number fields, as all values in a PqueryPlacement
@@ -478,7 +1028,13 @@ void JplaceReader::process_jplace_placements_p_(
             // field of the jplace standard, the following has to be refactored.
             double* target = nullptr;
             if( fields[i] == "edge_num" ) {
-                size_t val_int = pqry_fields.at(i).get_number<size_t>();
+                if( std::isnan( pqry_fields[i] ) || pqry_fields[i] < 0.0 ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery where field 'edge_num' "
+                        "is not a valid edge_num number."
+                    );
+                }
+                auto const val_int = static_cast<size_t>( pqry_fields[i] );
 
                 if( edge_num_map.count( val_int ) == 0 ) {
                     throw std::runtime_error(
@@ -505,14 +1061,13 @@ void JplaceReader::process_jplace_placements_p_(
             // Hence, check if it is numercial (again, we currently are only interested in these),
             // and set it accordingly.
             if( target ) {
-                if( !pqry_fields.at(i).is_number() ) {
+                if( std::isnan( pqry_fields[i] )) {
                     throw std::runtime_error(
                         "Jplace document contains a pquery where the field " + fields[i]
-                        + " is of type '" + pqry_fields.at(i).type_name()
-                        + "' instead of a number."
+                        + " is not a number."
                     );
                 }
-                *target = pqry_fields.at(i).get_number<double>();
+                *target = pqry_fields[i];
             }
         }
 
@@ -568,40 +1123,41 @@ void JplaceReader::process_jplace_placements_p_(
 // -------------------------------------------------------------------------
 
 void JplaceReader::process_jplace_placements_nm_(
-    utils::JsonDocument const&      pqry_obj,
+    utils::JsonDocument const*      n_value,
+    utils::JsonDocument const*      m_value,
+    utils::JsonDocument const*      nm_value,
     Pquery&                         pquery
 ) const {
 
     // Check name/named multiplicity validity.
-    assert( pqry_obj.is_object() );
-    if( pqry_obj.count("n") > 0 && pqry_obj.count("nm") > 0 ) {
+    if( n_value && nm_value ) {
         throw std::runtime_error(
             "Jplace document contains a pquery with both an 'n' and an 'nm' key."
         );
     }
-    if( pqry_obj.count("n") == 0 && pqry_obj.count("nm") == 0 ) {
+    if( ! n_value && ! nm_value ) {
         throw std::runtime_error(
             "Jplace document contains a pquery with neither an 'n' nor an 'nm' key."
         );
     }
-    if( pqry_obj.count("m") > 0 && pqry_obj.count("n") == 0 ) {
+    if( m_value && ! n_value ) {
         throw std::runtime_error(
             "Jplace document contains a pquery with key 'm' but without 'n' key."
         );
     }
 
     // Process names.
-    if( pqry_obj.count("n") > 0 ) {
-        assert( pqry_obj.count("nm") == 0 );
+    if( n_value ) {
+        assert( ! nm_value );
 
         // Get the multiplicity for the name. This is only relevant for the old case of
         // jplace version 2, which offered an 'm' key for this. If the key is not provided,
         // we simply use the default multiplicity of 1.
         double m = 1.0;
-        if( pqry_obj.count("m") > 0 ) {
+        if( m_value ) {
 
             // The 'm' key is expected to be a single float.
-            if( ! pqry_obj[ "m" ].is_number() ) {
+            if( ! (*m_value).is_number() ) {
                 throw std::runtime_error(
                     "Jplace document contains a pquery where key 'm' has a "
                     "value is not a valid number for the multiplicity."
@@ -611,7 +1167,7 @@ void JplaceReader::process_jplace_placements_nm_(
             // Furthermore, if 'm' is provided, 'n' can only contain a single element,
             // that is, either be a string, or an array with one string. Both is covered by
             // the Json Document size() property.
-            if( pqry_obj[ "n" ].size() != 1 ) {
+            if( (*n_value).size() != 1 ) {
                 throw std::runtime_error(
                     "Jplace document contains a pquery with key 'n' that is an array of size greater "
                     "than one, while also having key 'm' for the multiplicity. This is not allowed."
@@ -619,15 +1175,15 @@ void JplaceReader::process_jplace_placements_nm_(
             }
 
             // Finally, set the multiplicity to be used for the name.
-            m = pqry_obj[ "m" ].get_number<double>();
+            m = (*m_value).get_number<double>();
         }
 
         // The 'n' key can either be a string or an array containing one string.
         // Process accordingly.
-        if( pqry_obj[ "n" ].is_array() ) {
+        if( (*n_value).is_array() ) {
 
             // Validity check.
-            if( pqry_obj[ "n" ].size() == 0 ) {
+            if( (*n_value).size() == 0 ) {
                 throw std::runtime_error(
                     "Jplace document contains a pquery with key 'n' that does not contain any values."
                 );
@@ -635,10 +1191,10 @@ void JplaceReader::process_jplace_placements_nm_(
 
             // If we are here, and there is an 'm' key, the array can only have size 1.
             // We checked this before, so assert it here.
-            assert(!( pqry_obj[ "n" ].size() > 1 && pqry_obj.count("m") > 0 ));
+            assert(!( (*n_value).size() > 1 && m_value ));
 
             // Add all names.
-            for( auto const& pqry_n_val : pqry_obj[ "n" ] ) {
+            for( auto const& pqry_n_val : (*n_value) ) {
                 if( ! pqry_n_val.is_string() ) {
                     throw std::runtime_error(
                         "Jplace document contains a pquery where key 'n' has a non-string field."
@@ -649,8 +1205,8 @@ void JplaceReader::process_jplace_placements_nm_(
                 pquery.add_name( pqry_n_val.get_string(), m );
             }
 
-        } else if( pqry_obj[ "n" ].is_string() ) {
-            pquery.add_name( pqry_obj[ "n" ].get_string(), m );
+        } else if( (*n_value).is_string() ) {
+            pquery.add_name( (*n_value).get_string(), m );
 
         } else {
             throw std::runtime_error(
@@ -661,24 +1217,24 @@ void JplaceReader::process_jplace_placements_nm_(
     }
 
     // Process named multiplicities.
-    if( pqry_obj.count("nm") > 0 ) {
-        assert( pqry_obj.count("n") == 0 );
-        assert( pqry_obj.count("m") == 0 );
+    if( nm_value ) {
+        assert( ! n_value );
+        assert( ! m_value );
 
         // Validity check.
-        if ( ! pqry_obj[ "nm" ].is_array() ) {
+        if ( ! (*nm_value).is_array() ) {
             throw std::runtime_error(
                 "Jplace document contains a pquery with key 'nm' that is not array."
             );
         }
-        if( pqry_obj[ "nm" ].size() == 0 ) {
+        if( (*nm_value).size() == 0 ) {
             throw std::runtime_error(
                 "Jplace document contains a pquery with key 'nm' that does not contain any values."
             );
         }
 
         // Add all n/m value pairs to the pquery.
-        for( auto const& pqry_nm_val : pqry_obj[ "nm" ] ) {
+        for( auto const& pqry_nm_val : (*nm_value) ) {
 
             // Validity checks.
             if( ! pqry_nm_val.is_array() ) {
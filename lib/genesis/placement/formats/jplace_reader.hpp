@@ -32,6 +32,7 @@
  */
 
 #include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/tools/hash/sha1.hpp"
 
 #include <iosfwd>
 #include <memory>
@@ -46,16 +47,20 @@ namespace genesis {
 // =================================================================================================
 
 namespace utils {
+    class InputStream;
     class JsonDocument;
 }
 
 namespace tree {
+    class Tree;
     class TreeEdge;
 }
 
 namespace placement {
+    using PlacementTree = tree::Tree;
     using PlacementTreeEdge = tree::TreeEdge;
 
+    class JplaceInputIterator;
     class Pquery;
     class Sample;
     class SampleSet;
@@ -94,10 +99,23 @@ namespace placement {
  * See http://matsen.github.io/pplacer/generated_rst/pplacer.html#json-format-specification
  * for differences between the versions of the jplace standard.
  *
+ * Reading from an input source does not build an intermediate JsonDocument of the whole file.
+ * Instead, the document is scanned key by key, and the Pqueries are stored in the Sample while
+ * the `placements` array is read. The keys of the document can appear in any order, but only
+ * if the `version`, `tree` and `fields` appear before the `placements`, each Pquery is fully
+ * processed as soon as it is read, as is the case for documents written by our JplaceWriter.
+ * Otherwise, which is the case for many other programs, the numerical values of all placements
+ * are kept in a compact form until the rest of the document is known, and processed at the end.
+ * This takes additional memory of about the size of those values, and is logged with `LOG_DBG`. In both cases, the memory usage stays
+ * well below the size of the document, which is important for large files.
+ *
  * See Sample and SampleSet for the data structures used to store the Pqueries and the reference Tree.
  */
 class JplaceReader
 {
+    // The input iterator uses our internal streaming functions to read one Pquery at a time.
+    friend class JplaceInputIterator;
+
     // ---------------------------------------------------------------------
     //     Constructor and Rule of Five
     // ---------------------------------------------------------------------
@@ -124,6 +142,9 @@ public:
      *
      * Use functions such as utils::from_file() and utils::from_string() to conveniently
      * get an input source that can be used here.
+     *
+     * The input is parsed as a stream, without building an intermediate JsonDocument.
+     * See the class description for details.
      */
     Sample read(
         std::shared_ptr<utils::BaseInputSource> source
@@ -150,6 +171,12 @@ public:
      * SampleSet.
      *
      * The Sample%s are added to the SampleSet, so that existing Samples in the SampleSet are kept.
+     *
+     * The sources are parsed in parallel if OpenMP is available. Typically, all documents of a
+     * SampleSet use the same reference tree. Hence, by default, each distinct Newick string is
+     * only parsed once, and Samples with the same string get a copy of that tree.
+     * This saves parsing time, but not memory, as each Sample still owns its tree.
+     * See reuse_trees( bool ) to deactivate this.
      */
     void read(
         std::vector<std::shared_ptr<utils::BaseInputSource>> sources,
@@ -157,45 +184,207 @@ public:
     ) const;
 
     // ---------------------------------------------------------------------
-    //     Processing
+    //     Internal Helpers
     // ---------------------------------------------------------------------
 
 private:
 
     /**
-     * @brief Get the version of the jplace document.
+     * @brief Values of the placements of one Pquery, as found at its `p` key.
+     *
+     * The values are stored row by row, that is, one row of size `field_count` per placement.
+     * This is the form in which placements are kept while the reference tree or the `fields` key
+     * of the document are not yet known, e.g., because they appear after the `placements`
+     * in the file. Values that are not numbers are stored as `NaN`; using them for one of the
+     * fields that we interpret is an error.
+     */
+    struct PqueryValues
+    {
+        std::vector<double> values;
+        size_t              field_count     = 0;
+        size_t              placement_count = 0;
+    };
+
+    /**
+     * @brief Top-level values of a jplace document that are needed to interpret its placements.
+     */
+    struct DocumentHeader
+    {
+        bool                     found_version = false;
+        bool                     found_tree    = false;
+        bool                     found_fields  = false;
+
+        int                      version = -1;
+        std::string              newick;
+        std::vector<std::string> fields;
+
+        /**
+         * @brief Return whether all values needed for processing the placements are known.
+         */
+        bool complete() const
+        {
+            return found_version && found_tree && found_fields;
+        }
+    };
+
+    /**
+     * @brief Reference trees that were already parsed while reading multiple documents,
+     * indexed by the SHA1 digest of their Newick string.
+     *
+     * The cache owns its own copy of each distinct tree, which is never modified, so that it does
+     * not depend on the Samples that are being filled (and possibly moved) by other threads.
+     * Only the digests of the strings are kept. Version 1 documents store the edge nums in
+     * a different way, so that the same string yields a different tree there, which is why those
+     * are kept separately. The maps are shared between threads, and need to be accessed in an
+     * `omp critical` section.
+     */
+    struct TreeCache
+    {
+        using TreeMap = std::unordered_map<
+            utils::SHA1::DigestType, std::shared_ptr<PlacementTree const>
+        >;
+
+        TreeMap trees;
+        TreeMap trees_v1;
+    };
+
+    // ---------------------------------------------------------------------
+    //     Streaming
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Parse a jplace document directly from an InputStream into a Sample.
+     *
+     * The document is scanned key by key, without building an intermediate JsonDocument.
+     * If the `version`, `tree` and `fields` keys appear before the `placements`, each Pquery is
+     * fully processed as soon as it is read. Otherwise, the Pqueries are added to the Sample with
+     * their names only, and the compact PqueryValues are kept until the rest of the document is
+     * known. In both cases, memory usage stays close to the size of the resulting Sample.
+     */
+    void parse_jplace_document_(
+        utils::InputStream& input_stream,
+        Sample&             smp,
+        TreeCache*          tree_cache = nullptr
+    ) const;
+
+    /**
+     * @brief Read the next top-level key of the document, and move to the beginning of its value.
      *
-     * The function simply returns the value of the `version` field of the top level `json` object.
-     * If that field is not found, or does not contain an integer number, `-1` is returned.
+     * For the @p first key, the stream has to be at the opening brace of the document. For all
+     * subsequent keys, it has to be right after the value of the previous key. The function
+     * returns `false` once the closing brace of the document is reached instead, and checks
+     * that there is no more input after it.
+     */
+    bool parse_jplace_key_(
+        utils::InputStream& input_stream,
+        std::string&        key,
+        bool                first
+    ) const;
+
+    /**
+     * @brief Parse the value of a top-level key other than `placements`.
+     *
+     * The values needed for the placements are stored in the @p header, the `metadata` are stored
+     * in the Sample, and everything else is skipped.
+     */
+    void parse_jplace_header_value_(
+        utils::InputStream& input_stream,
+        std::string const&  key,
+        DocumentHeader&     header,
+        Sample&             smp
+    ) const;
+
+    /**
+     * @brief Skip a Json value of any type in the input, without storing it.
+     */
+    void skip_jplace_value_(
+        utils::InputStream& input_stream
+    ) const;
+
+    /**
+     * @brief Parse a single Pquery object of the `placements` array.
+     *
+     * The names of the Pquery are directly stored in the given @p pquery, while the values of the
+     * placements are stored in @p values, to be processed by process_jplace_placements_p_().
+     */
+    void parse_jplace_pquery_(
+        utils::InputStream& input_stream,
+        Pquery&             pquery,
+        PqueryValues&       values
+    ) const;
+
+    /**
+     * @brief Parse the `p` part of a Pquery object, that is, the array of placement value arrays.
+     */
+    void parse_jplace_pquery_p_(
+        utils::InputStream& input_stream,
+        PqueryValues&       values
+    ) const;
+
+    // ---------------------------------------------------------------------
+    //     Processing
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Get the version of the jplace document from the value of its `version` key.
+     *
+     * The function returns the value as an int, if it is an integer number or a string
+     * containing one. Otherwise, `-1` is returned.
      *
      * According to the standard, this is an integer number. If this ever changes to a different
      * format, this function has to be changed accordingly.
      */
-    int get_jplace_version_( utils::JsonDocument const& doc ) const;
+    int get_jplace_version_( utils::JsonDocument const& version_value ) const;
 
     /**
-     * @brief Internal helper function that checks whether the `version` key in a JsonDocument
-     * corresponds to a valid version number for the JplaceReader.
+     * @brief Internal helper function that checks whether the `version` of a document
+     * is a valid version number for the JplaceReader.
      */
-    void process_jplace_version_( utils::JsonDocument const& doc ) const;
+    void process_jplace_version_( int version ) const;
 
     /**
-     * @brief Internal helper function that processes the `metadata` key of a JsonDocument and stores
-     * its value in the Sample metadata member.
+     * @brief Internal helper function that processes the value of the `metadata` key of a
+     * document and stores its values in the Sample metadata member.
      */
-    void process_jplace_metadata_( utils::JsonDocument const& doc, Sample& smp ) const;
+    void process_jplace_metadata_( utils::JsonDocument const& metadata_value, Sample& smp ) const;
 
     /**
-     * @brief Internal helper function that processes the `tree` key of a JsonDocument and stores it as
-     * the Tree of a Sample.
+     * @brief Internal helper function that processes the Newick string of the `tree` key of a
+     * document and stores it as the Tree of a Sample.
+     *
+     * If a @p tree_cache is given, a tree that was already parsed from the same string is copied
+     * instead of parsing it again, and newly parsed trees are added to the cache.
      */
-    void process_jplace_tree_( utils::JsonDocument const& doc, Sample& smp ) const;
+    void process_jplace_tree_(
+        std::string const& newick,
+        int                version,
+        Sample&            smp,
+        TreeCache*         tree_cache = nullptr
+    ) const;
 
     /**
-     * @brief Internal helper function that processes the `fields` key of a JsonDocument and returns
-     * its values.
+     * @brief Internal helper function that processes the value of the `fields` key of a document
+     * and returns its values.
      */
-    std::vector<std::string> process_jplace_fields_( utils::JsonDocument const& doc ) const;
+    std::vector<std::string> process_jplace_fields_( utils::JsonDocument const& fields_value ) const;
+
+    /**
+     * @brief Internal helper function that processes the version and tree of a complete
+     * DocumentHeader into the Sample, and returns the map from edge nums to edges of its tree.
+     *
+     * As the Newick string of the tree is not needed any more afterwards, it is released.
+     */
+    std::unordered_map<size_t, PlacementTreeEdge*> process_jplace_header_(
+        DocumentHeader& header,
+        Sample&         smp,
+        TreeCache*      tree_cache = nullptr
+    ) const;
+
+    /**
+     * @brief Internal helper function that creates a map from edge nums to edges of the
+     * Tree of a Sample, checking that each edge num is unique.
+     */
+    std::unordered_map<size_t, PlacementTreeEdge*> process_jplace_edge_nums_( Sample& smp ) const;
 
     /**
      * @brief Internal helper function that processes the `placements` key of a JsonDocument and stores
@@ -208,10 +397,11 @@ private:
     ) const;
 
     /**
-     * @brief Internal helper function that processes the `p` part of a placement.
+     * @brief Internal helper function that processes the `p` part of a placement,
+     * given as its PqueryValues, and adds the placements to the Pquery.
      */
     void process_jplace_placements_p_(
-        utils::JsonDocument const&      pqry_obj,
+        PqueryValues const&             values,
         Pquery&                         pquery,
         std::vector<std::string> const& fields,
         std::unordered_map<size_t, PlacementTreeEdge*> const& edge_num_map
@@ -219,9 +409,14 @@ private:
 
     /**
      * @brief Internal helper function that processes the `n`, `m`, and `nm` part of a placement.
+     *
+     * The values of those keys are provided as pointers, which are `nullptr` if the respective key
+     * is not present in the pquery.
      */
     void process_jplace_placements_nm_(
-        utils::JsonDocument const&      pqry_obj,
+        utils::JsonDocument const*      n_value,
+        utils::JsonDocument const*      m_value,
+        utils::JsonDocument const*      nm_value,
         Pquery&                         pquery
     ) const;
 
@@ -307,6 +502,33 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Return whether reference trees are reused when reading multiple documents.
+     */
+    bool reuse_trees() const
+    {
+        return reuse_trees_;
+    }
+
+    /**
+     * @brief Set whether reference trees are reused when reading multiple documents.
+     *
+     * When reading multiple sources into a SampleSet, the reference trees of the documents are
+     * usually identical. If this setting is `true` (default), each distinct Newick string of the
+     * `tree` key is only parsed once, and all Samples with that string get a copy of the parsed
+     * tree. This saves the time for parsing the (potentially large) tree for every file.
+     * It does not save memory, as each Sample needs its own tree for its placements to point to.
+     * The cache only stores digests of the strings, and is dropped once the reading is done.
+     * The resulting trees are identical to the ones obtained by parsing each file on its own.
+     *
+     * The function returns the JplaceReader object to allow for a fluent interface.
+     */
+    JplaceReader& reuse_trees( bool val )
+    {
+        reuse_trees_ = val;
+        return *this;
+    }
+
     // ---------------------------------------------------------------------
     //     Members
     // ---------------------------------------------------------------------
@@ -314,6 +536,7 @@ public:
 private:
 
     InvalidNumberBehaviour invalid_number_behaviour_ = InvalidNumberBehaviour::kIgnore;
+    bool                   reuse_trees_ = true;
 
 };
 
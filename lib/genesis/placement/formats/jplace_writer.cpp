@@ -178,12 +178,15 @@ void JplaceWriter::to_stream( Sample const& sample, std::ostream& os ) const
  * already exists, an exception is thrown.
  * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
  * change this behaviour.
+ *
+ * If the file name ends in `.gz`, the output is gzip-compressed,
+ * see utils::make_file_output_stream().
  */
 void JplaceWriter::to_file( Sample const& sample, std::string const& filename ) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sample, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( sample, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 /**
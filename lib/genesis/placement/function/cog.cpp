@@ -36,6 +36,7 @@
 #include "genesis/placement/sample.hpp"
 
 #include "genesis/tree/common_tree/distances.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/iterator/node_links.hpp"
@@ -46,6 +47,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace genesis {
 namespace placement {
@@ -602,75 +607,88 @@ double center_of_gravity_variance (
 //     Center of Gravity Distance
 // =================================================================================================
 
-double center_of_gravity_distance (
-    Sample const& smp_a,
-    Sample const& smp_b,
-    bool const    with_pendant_length
+/**
+ * @brief Local helper function that calculates the distance between the two Centers of Gravity,
+ * for both the plain node distances and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double center_of_gravity_distance_(
+    Sample const&        smp_a,
+    Sample const&        smp_b,
+    NodeDistances const& node_distances,
+    bool const           with_pendant_length
 ) {
-    if (!compatible_trees(smp_a, smp_b)) {
-        throw std::invalid_argument("__FUNCTION__: Incompatible trees.");
+    auto const cog_a = center_of_gravity( smp_a, with_pendant_length );
+    auto const cog_b = center_of_gravity( smp_b, with_pendant_length );
+
+    auto const& edge_a = *cog_a.first;
+    auto const& edge_b = *cog_b.first;
+    double const prox_a = cog_a.second;
+    double const prox_b = cog_b.second;
+
+    if( edge_a.index() == edge_b.index() ) {
+        // same branch case
+        return std::abs( prox_a - prox_b );
     }
 
-    // Disable debug messages while code is not in review.
-    LOG_SCOPE_LEVEL(utils::Logging::kInfo)
+    // proximal-proximal case
+    double const pp = prox_a
+        + node_distances( edge_a.primary_node().index(), edge_b.primary_node().index() )
+        + prox_b;
 
-    auto cog_a = center_of_gravity(smp_a, with_pendant_length);
-    auto cog_b = center_of_gravity(smp_b, with_pendant_length);
+    // proximal-distal case
+    double const pd = prox_a
+        + node_distances( edge_a.primary_node().index(), edge_b.secondary_node().index() )
+        + edge_b.data<PlacementEdgeData>().branch_length - prox_b;
 
-    auto edge_a = cog_a.first;
-    auto edge_b = cog_b.first;
+    // distal-proximal case
+    double const dp = edge_a.data<PlacementEdgeData>().branch_length - prox_a
+        + node_distances( edge_a.secondary_node().index(), edge_b.primary_node().index() )
+        + prox_b;
 
-    double prox_a = cog_a.second;
-    double prox_b = cog_b.second;
+    // find min of the three cases
+    return std::min({ pp, pd, dp });
+}
 
-    // TODO this is for testing purposes only
-    if (prox_a < 0.0) {
-        LOG_INFO << "map a COG proximal_length < 0: " << prox_a;
+double center_of_gravity_distance (
+    Sample const& smp_a,
+    Sample const& smp_b,
+    bool const    with_pendant_length
+) {
+    if( ! compatible_trees( smp_a, smp_b )) {
+        throw std::invalid_argument( "center_of_gravity_distance: Incompatible trees." );
     }
 
-    LOG_DBG << "cog a edge " << edge_a->index() << " prox " << prox_a;
-    LOG_DBG << "cog b edge " << edge_b->index() << " prox " << prox_b;
+    // We only need the distances from the two nodes of the edge of the first Center of Gravity,
+    // so compute them from those nodes once they are first needed.
+    std::unordered_map<size_t, std::vector<double>> node_dists;
+    auto const node_distances = [&]( size_t from, size_t to ){
+        auto found = node_dists.find( from );
+        if( found == node_dists.end() ) {
+            found = node_dists.emplace( from, tree::node_branch_length_distance_vector(
+                smp_a.tree(), &smp_a.tree().node_at( from )
+            )).first;
+        }
+        return found->second[ to ];
+    };
 
-    // TODO turn the result of cog method into a class TreePoint or so, and write functions for this
-    // like distance to another point, which uses the code below. then replace the code by calling
-    // this function.
+    return center_of_gravity_distance_( smp_a, smp_b, node_distances, with_pendant_length );
+}
 
-    double dist = -1.0;
-    if (edge_a->index() == edge_b->index()) {
-        // same branch case
-        dist = std::abs(prox_a - prox_b);
-    } else {
-        // TODO instead of the whole vector, we need a distnace between nodes function in the future,
-        // which probably uses the path iterator.
-        auto node_dist_a_prox = node_branch_length_distance_vector(
-            smp_a.tree(), &edge_a->primary_node()
-        );
-        auto node_dist_a_dist = node_branch_length_distance_vector(
-            smp_a.tree(), &edge_a->secondary_node()
-        );
-
-        double pp, pd, dp;
-
-        // proximal-proximal case
-        pp = prox_a
-           + node_dist_a_prox[edge_b->primary_node().index()]
-           + prox_b;
-
-        // proximal-distal case
-        pd = prox_a
-           + node_dist_a_prox[edge_b->secondary_node().index()]
-           + edge_b->data<PlacementEdgeData>().branch_length - prox_b;
-
-        // distal-proximal case
-        dp = edge_a->data<PlacementEdgeData>().branch_length - prox_a
-           + node_dist_a_dist[edge_b->primary_node().index()]
-           + prox_b;
-
-        // find min of the three cases and
-        dist = std::min(pp, std::min(pd, dp));
+double center_of_gravity_distance (
+    Sample const&                   smp_a,
+    Sample const&                   smp_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool const                      with_pendant_length
+) {
+    if( ! compatible_trees( smp_a, smp_b )) {
+        throw std::invalid_argument( "center_of_gravity_distance: Incompatible trees." );
+    }
+    if( node_distances.node_count() != smp_a.tree().node_count() ) {
+        throw std::invalid_argument( "TreeDistanceOracle does not fit the tree of the Sample." );
     }
 
-    return dist;
+    return center_of_gravity_distance_( smp_a, smp_b, node_distances, with_pendant_length );
 }
 
 } // namespace placement
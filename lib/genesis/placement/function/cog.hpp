@@ -34,12 +34,19 @@
 #include "genesis/placement/placement_tree.hpp"
 
 namespace genesis {
-namespace placement {
 
 // =================================================================================================
 //     Forward Declarations
 // =================================================================================================
 
+namespace tree {
+
+    class TreeDistanceOracle;
+
+}
+
+namespace placement {
+
 class Sample;
 
 // =================================================================================================
@@ -101,6 +108,21 @@ double center_of_gravity_distance (
     bool const    with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the distance between the two Centers of Gravity of two Sample%s,
+ * using a tree::TreeDistanceOracle to look up the distances between nodes.
+ *
+ * Instead of computing the distances from the Center of Gravity of @p smp_a to all nodes of the
+ * tree, this only looks up the few node distances that are needed. The @p node_distances oracle has
+ * to be built from the tree of @p smp_a, and can be reused for many pairs of Sample%s.
+ */
+double center_of_gravity_distance (
+    Sample const&                   smp_a,
+    Sample const&                   smp_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool const                      with_pendant_length = false
+);
+
 } // namespace placement
 } // namespace genesis
 
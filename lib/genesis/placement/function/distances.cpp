@@ -33,6 +33,8 @@
 #include "genesis/placement/pquery.hpp"
 #include "genesis/placement/pquery/plain.hpp"
 
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
+
 #include <algorithm>
 #include <cassert>
 #include <cmath>
@@ -48,11 +50,16 @@ namespace placement {
 //     Pquery to Pquery Distances
 // =================================================================================================
 
-double pquery_distance(
-    PqueryPlain const&           pquery_a,
-    PqueryPlain const&           pquery_b,
-    utils::Matrix<double> const& node_distances,
-    bool                         with_pendant_length
+/**
+ * @brief Local helper function that calculates the distance between two plain pqueries,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double pquery_plain_distance_(
+    PqueryPlain const&   pquery_a,
+    PqueryPlain const&   pquery_b,
+    NodeDistances const& node_distances,
+    bool                 with_pendant_length
 ) {
     double sum = 0.0;
 
@@ -105,6 +112,24 @@ double pquery_distance(
     return sum;
 }
 
+double pquery_distance(
+    PqueryPlain const&           pquery_a,
+    PqueryPlain const&           pquery_b,
+    utils::Matrix<double> const& node_distances,
+    bool                         with_pendant_length
+) {
+    return pquery_plain_distance_( pquery_a, pquery_b, node_distances, with_pendant_length );
+}
+
+double pquery_distance(
+    PqueryPlain const&              pquery_a,
+    PqueryPlain const&              pquery_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length
+) {
+    return pquery_plain_distance_( pquery_a, pquery_b, node_distances, with_pendant_length );
+}
+
 /**
  * @brief Local helper function to avoid code duplication.
  */
@@ -154,10 +179,34 @@ double pquery_distance(
     );
 }
 
-double placement_distance(
+double pquery_distance(
+    Pquery const&                   pquery_a,
+    Pquery const&                   pquery_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length
+) {
+    return pquery_distance(
+        pquery_a,
+        pquery_b,
+        [&]( PqueryPlacement const& place_a, PqueryPlacement const& place_b ){
+            double dist = placement_distance( place_a, place_b, node_distances );
+            if( with_pendant_length ) {
+                dist += place_a.pendant_length + place_b.pendant_length;
+            }
+            return dist;
+        }
+    );
+}
+
+/**
+ * @brief Local helper function that calculates the distance between two placements,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double placement_distance_(
     PqueryPlacement const& place_a,
     PqueryPlacement const& place_b,
-    utils::Matrix<double> const& node_distances
+    NodeDistances const&   node_distances
 ) {
     double dist;
 
@@ -199,6 +248,22 @@ double placement_distance(
     return dist;
 }
 
+double placement_distance(
+    PqueryPlacement const&       place_a,
+    PqueryPlacement const&       place_b,
+    utils::Matrix<double> const& node_distances
+) {
+    return placement_distance_( place_a, place_b, node_distances );
+}
+
+double placement_distance(
+    PqueryPlacement const&          place_a,
+    PqueryPlacement const&          place_b,
+    tree::TreeDistanceOracle const& node_distances
+) {
+    return placement_distance_( place_a, place_b, node_distances );
+}
+
 double pquery_path_length_distance(
     Pquery const&                pquery_a,
     Pquery const&                pquery_b,
@@ -284,10 +349,28 @@ double pquery_distance(
     );
 }
 
-double placement_distance(
-    PqueryPlacement const&       placement,
-    tree::TreeNode const&        node,
-    utils::Matrix<double> const& node_distances
+double pquery_distance(
+    Pquery const&                   pquery,
+    tree::TreeNode const&           node,
+    tree::TreeDistanceOracle const& node_distances
+) {
+    return pquery_distance(
+        pquery,
+        [&]( PqueryPlacement const& placement ){
+            return placement_distance( placement, node, node_distances );
+        }
+    );
+}
+
+/**
+ * @brief Local helper function that calculates the distance between a placement and a node,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double placement_node_distance_(
+    PqueryPlacement const& placement,
+    tree::TreeNode const&  node,
+    NodeDistances const&   node_distances
 ) {
     // proximal
     double const pd = placement.proximal_length
@@ -303,6 +386,22 @@ double placement_distance(
     return std::min( pd, dd );
 }
 
+double placement_distance(
+    PqueryPlacement const&       placement,
+    tree::TreeNode const&        node,
+    utils::Matrix<double> const& node_distances
+) {
+    return placement_node_distance_( placement, node, node_distances );
+}
+
+double placement_distance(
+    PqueryPlacement const&          placement,
+    tree::TreeNode const&           node,
+    tree::TreeDistanceOracle const& node_distances
+) {
+    return placement_node_distance_( placement, node, node_distances );
+}
+
 // double pquery_path_length_distance(
 //     Pquery const&                pquery,
 //     tree::TreeNode const&        node,
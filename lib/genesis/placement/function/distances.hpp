@@ -53,6 +53,8 @@ namespace tree {
     class CommonEdgeData;
 
     using CommonTree = Tree;
+
+    class TreeDistanceOracle;
 }
 
 namespace placement {
@@ -132,6 +134,20 @@ double pquery_distance(
     bool                         with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the weighted distance between two plain pqueries, using a
+ * tree::TreeDistanceOracle to look up the distances between nodes.
+ *
+ * This is the same as the version that takes a node distance matrix, but only needs memory that is
+ * linear in the size of the tree. See there for details.
+ */
+double pquery_distance(
+    PqueryPlain const&              pquery_a,
+    PqueryPlain const&              pquery_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length = false
+);
+
 /**
  * @brief Calculate the weighted distance between two @link Pquery Pqueries@endlink,
  * in branch length units, as the pairwise distance between their PqueryPlacement%s, and using
@@ -146,6 +162,17 @@ double pquery_distance(
     bool                         with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the weighted distance between two @link Pquery Pqueries@endlink,
+ * using a tree::TreeDistanceOracle to look up the distances between nodes.
+ */
+double pquery_distance(
+    Pquery const&                   pquery_a,
+    Pquery const&                   pquery_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length = false
+);
+
 /**
  * @brief Calculate the distance between two PqueryPlacement%s, using their positin on the
  * tree::TreeEdge%s, measured in branch length units.
@@ -158,6 +185,16 @@ double placement_distance(
     utils::Matrix<double> const& node_distances
 );
 
+/**
+ * @brief Calculate the distance between two PqueryPlacement%s, using a tree::TreeDistanceOracle
+ * to look up the distances between nodes.
+ */
+double placement_distance(
+    PqueryPlacement const&          place_a,
+    PqueryPlacement const&          place_b,
+    tree::TreeDistanceOracle const& node_distances
+);
+
 /**
  * @brief Calculate the weighted discrete distance between two @link Pquery Pqueries@endlink,
  * measured as the pairwise distance in number of nodes between between their PqueryPlacement%s,
@@ -203,6 +240,16 @@ double pquery_distance(
     utils::Matrix<double> const& node_distances
 );
 
+/**
+ * @brief Calculate the weighted distance between the PqueryPlacement%s of a Pquery and a
+ * tree::TreeNode, using a tree::TreeDistanceOracle to look up the distances between nodes.
+ */
+double pquery_distance(
+    Pquery const&                   pquery,
+    tree::TreeNode const&           node,
+    tree::TreeDistanceOracle const& node_distances
+);
+
 /**
  * @brief Calculate the distance in branch length units between a PqueryPlacement and a
  * tree::TreeNode.
@@ -215,6 +262,16 @@ double placement_distance(
     utils::Matrix<double> const& node_distances
 );
 
+/**
+ * @brief Calculate the distance in branch length units between a PqueryPlacement and a
+ * tree::TreeNode, using a tree::TreeDistanceOracle to look up the distances between nodes.
+ */
+double placement_distance(
+    PqueryPlacement const&          placement,
+    tree::TreeNode const&           node,
+    tree::TreeDistanceOracle const& node_distances
+);
+
 // /**
 //  * @brief Calculate the weighted discrete distance between the PqueryPlacement%s of a Pquery and a
 //  * tree::TreeNode, in number of nodes, using the `like_weight_ratio` of the PqueryPlacement%s
@@ -98,6 +98,26 @@ std::vector<double> placement_mass_per_edges_with_multiplicities( Sample const&
     return result;
 }
 
+void placement_mass_per_edges_with_multiplicities(
+    Pquery const&        pquery,
+    std::vector<double>& masses
+) {
+    // Check all placements first, so that we do not leave partially accumulated masses.
+    for( auto const& place : pquery.placements() ) {
+        if( place.edge().index() >= masses.size() ) {
+            throw std::runtime_error(
+                "Cannot accumulate placement masses per edge in a vector that is smaller than "
+                "the number of edges of the tree."
+            );
+        }
+    }
+
+    auto const mult = total_multiplicity( pquery );
+    for( auto const& place : pquery.placements() ) {
+        masses[ place.edge().index() ] += place.like_weight_ratio * mult;
+    }
+}
+
 utils::Matrix<double> placement_mass_per_edges_with_multiplicities( SampleSet const& sample_set )
 {
     auto result = utils::Matrix<double>();
@@ -67,6 +67,23 @@ double total_multiplicity( Sample const& sample );
  */
 std::vector<double> placement_mass_per_edges_with_multiplicities( Sample const& sample );
 
+/**
+ * @brief Add the masses of the PqueryPlacement%s of a Pquery to a vector of masses per
+ * @link ::PlacementTreeEdge edge@endlink, using the
+ * @link PqueryName::multiplicity multiplicities @endlink as factors.
+ *
+ * The vector is indexed using the @link PlacementTreeEdge::index() index@endlink of the edges,
+ * and needs to have the size of the edge count of the tree. If it is too small for any of the
+ * placements, an exception is thrown, and the @p masses are left unchanged.
+ * This is useful for accumulating masses one Pquery at a time, for example when iterating
+ * over a large file with a JplaceInputIterator, without keeping a whole Sample in memory.
+ * See placement_mass_per_edges_with_multiplicities( Sample const& ) for the Sample version.
+ */
+void placement_mass_per_edges_with_multiplicities(
+    Pquery const&        pquery,
+    std::vector<double>& masses
+);
+
 /**
  * @brief Return a Matrix that contains the placement masses per edge, using the
  * @link PqueryName::multiplicity multiplicities @endlink as factors.
@@ -41,6 +41,8 @@
 #include "genesis/placement/sample.hpp"
 
 #include "genesis/tree/common_tree/distances.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/function/tree_set.hpp"
@@ -76,7 +78,12 @@ namespace placement {
 //     Expected Distance between Placement Locations
 // =================================================================================================
 
-double edpl( Pquery const& pquery, utils::Matrix<double> const& node_distances )
+/**
+ * @brief Local helper function that calculates the edpl() of a Pquery,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double edpl_( Pquery const& pquery, NodeDistances const& node_distances )
 {
     double result = 0.0;
 
@@ -98,7 +105,22 @@ double edpl( Pquery const& pquery, utils::Matrix<double> const& node_distances )
     return 2 * result;
 }
 
-std::vector<double> edpl( Sample const& sample, utils::Matrix<double> const& node_distances )
+double edpl( Pquery const& pquery, utils::Matrix<double> const& node_distances )
+{
+    return edpl_( pquery, node_distances );
+}
+
+double edpl( Pquery const& pquery, tree::TreeDistanceOracle const& node_distances )
+{
+    return edpl_( pquery, node_distances );
+}
+
+/**
+ * @brief Local helper function that calculates the edpl() of all Pqueries of a Sample,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static std::vector<double> edpl_( Sample const& sample, NodeDistances const& node_distances )
 {
     // Prepare result (facilitate copy elision).
     auto result = std::vector<double>( sample.size(), 0 );
@@ -107,11 +129,24 @@ std::vector<double> edpl( Sample const& sample, utils::Matrix<double> const& nod
     #pragma omp parallel for
     for( size_t qi = 0; qi < sample.size(); ++qi ) {
         auto const& pquery = sample.at( qi );
-        result[qi] = edpl( pquery, node_distances );
+        result[qi] = edpl_( pquery, node_distances );
     }
     return result;
 }
 
+std::vector<double> edpl( Sample const& sample, utils::Matrix<double> const& node_distances )
+{
+    return edpl_( sample, node_distances );
+}
+
+std::vector<double> edpl( Sample const& sample, tree::TreeDistanceOracle const& node_distances )
+{
+    if( node_distances.node_count() != sample.tree().node_count() ) {
+        throw std::invalid_argument( "TreeDistanceOracle does not fit the tree of the Sample." );
+    }
+    return edpl_( sample, node_distances );
+}
+
 double edpl( Sample const& sample, Pquery const& pquery )
 {
     auto const node_distances = node_branch_length_distance_matrix( sample.tree() );
@@ -124,19 +159,30 @@ std::vector<double> edpl( Sample const& sample )
     return edpl( sample, node_distances );
 }
 
+std::vector<double> edpl( Sample const& sample, tree::FlatTree const& tree )
+{
+    if( tree.node_count() != sample.tree().node_count() ) {
+        throw std::invalid_argument( "FlatTree does not fit the tree of the Sample." );
+    }
+    auto const node_distances = node_branch_length_distance_matrix( tree );
+    return edpl( sample, node_distances );
+}
+
 // =================================================================================================
 //     Pairwise Distance
 // =================================================================================================
 
-double pairwise_distance(
-    const Sample& smp_a,
-    const Sample& smp_b,
-    bool          with_pendant_length
+/**
+ * @brief Local helper function that calculates the pairwise_distance() of two Samples,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double pairwise_distance_(
+    const Sample&        smp_a,
+    const Sample&        smp_b,
+    NodeDistances const& node_distances,
+    bool                 with_pendant_length
 ) {
-    if (!compatible_trees(smp_a, smp_b)) {
-        throw std::invalid_argument("pairwise_distance: Incompatible trees.");
-    }
-
     // Init.
     double sum = 0.0;
 
@@ -146,12 +192,6 @@ double pairwise_distance(
     std::vector<PqueryPlain> const pqueries_a = plain_queries( smp_a );
     std::vector<PqueryPlain> const pqueries_b = plain_queries( smp_b );
 
-    // Calculate a matrix containing the pairwise distance between all nodes. This way, we
-    // do not need to search a path between placements every time. We use the tree of the first smp
-    // here, ignoring branch lengths on tree b.
-    // FIXME this might be made better by using average or so in the future.
-    auto node_distances = node_branch_length_distance_matrix(smp_a.tree());
-
     for (const PqueryPlain& pqry_a : pqueries_a) {
         for (const PqueryPlain& pqry_b : pqueries_b) {
             auto dist = pquery_distance( pqry_a, pqry_b, node_distances, with_pendant_length );
@@ -164,6 +204,38 @@ double pairwise_distance(
     return sum / total_placement_mass_with_multiplicities( smp_a ) / total_placement_mass_with_multiplicities( smp_b );
 }
 
+double pairwise_distance(
+    const Sample& smp_a,
+    const Sample& smp_b,
+    bool          with_pendant_length
+) {
+    if (!compatible_trees(smp_a, smp_b)) {
+        throw std::invalid_argument("pairwise_distance: Incompatible trees.");
+    }
+
+    // Calculate a matrix containing the pairwise distance between all nodes. This way, we
+    // do not need to search a path between placements every time. We use the tree of the first smp
+    // here, ignoring branch lengths on tree b.
+    // FIXME this might be made better by using average or so in the future.
+    auto node_distances = node_branch_length_distance_matrix(smp_a.tree());
+    return pairwise_distance_( smp_a, smp_b, node_distances, with_pendant_length );
+}
+
+double pairwise_distance(
+    const Sample&                   smp_a,
+    const Sample&                   smp_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length
+) {
+    if (!compatible_trees(smp_a, smp_b)) {
+        throw std::invalid_argument("pairwise_distance: Incompatible trees.");
+    }
+    if( node_distances.node_count() != smp_a.tree().node_count() ) {
+        throw std::invalid_argument( "TreeDistanceOracle does not fit the tree of the Sample." );
+    }
+    return pairwise_distance_( smp_a, smp_b, node_distances, with_pendant_length );
+}
+
 // =================================================================================================
 //     Variance
 // =================================================================================================
@@ -175,10 +247,11 @@ double pairwise_distance(
  * This function is intended to be called by variance() or variance_thread_() -- it is not a
  * stand-alone function.
  */
+template<class NodeDistances>
 static double variance_partial_ (
     const PqueryPlain&              pqry_a,
     const std::vector<PqueryPlain>& pqrys_b,
-    const utils::Matrix<double>&    node_distances,
+    const NodeDistances&            node_distances,
     bool                            with_pendant_length
 ) {
     double partial = 0.0;
@@ -205,11 +278,12 @@ static double variance_partial_ (
  * It takes an offset and an incrementation value and does an interleaved loop over the pqueries,
  * similar to the sequential version for calculating the variance.
  */
+template<class NodeDistances>
 static void variance_thread_ (
     const int                       offset,
     const int                       incr,
     const std::vector<PqueryPlain>* pqrys,
-    const utils::Matrix<double>*    node_distances,
+    const NodeDistances*            node_distances,
     double*                         partial,
     bool                            with_pendant_length
 ) {
@@ -229,9 +303,15 @@ static void variance_thread_ (
     *partial = tmp_partial;
 }
 
-double variance(
-    const Sample& smp,
-    bool          with_pendant_length
+/**
+ * @brief Local helper function that calculates the variance() of a Sample,
+ * for both a distance matrix and a tree::TreeDistanceOracle as @p node_distances.
+ */
+template<class NodeDistances>
+static double variance_(
+    const Sample&        smp,
+    NodeDistances const& node_distances,
+    bool                 with_pendant_length
 ) {
     // Init.
     double variance = 0.0;
@@ -241,10 +321,6 @@ double variance(
     // and furthermore, the data is close in memory. This gives a tremendous speedup!
     std::vector<PqueryPlain> vd_pqueries = plain_queries( smp );
 
-    // Also, calculate a matrix containing the pairwise distance between all nodes. this way, we
-    // do not need to search a path between placements every time.
-    auto node_distances = node_branch_length_distance_matrix(smp.tree());
-
 #ifdef GENESIS_PTHREADS
 
     // Prepare storage for thread data.
@@ -255,7 +331,7 @@ double variance(
     // Start all threads.
     for (int i = 0; i < num_threads; ++i) {
         threads.emplace_back(
-            &variance_thread_,
+            &variance_thread_<NodeDistances>,
             i, num_threads, &vd_pqueries, &node_distances,
             &partials[i],
             with_pendant_length
@@ -289,14 +365,30 @@ double variance(
         }
     }
 
-    // As we conditionally compile the above, we add dummies here to avoid compiler warnings
-    // about unused functions:
-    (void) variance_thread_;
-    (void) variance_partial_;
-
     // Return the normalized value.
     return ((variance / mass) / mass);
 }
 
+double variance(
+    const Sample& smp,
+    bool          with_pendant_length
+) {
+    // Calculate a matrix containing the pairwise distance between all nodes. this way, we
+    // do not need to search a path between placements every time.
+    auto node_distances = node_branch_length_distance_matrix(smp.tree());
+    return variance_( smp, node_distances, with_pendant_length );
+}
+
+double variance(
+    const Sample&                   smp,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length
+) {
+    if( node_distances.node_count() != smp.tree().node_count() ) {
+        throw std::invalid_argument( "TreeDistanceOracle does not fit the tree of the Sample." );
+    }
+    return variance_( smp, node_distances, with_pendant_length );
+}
+
 } // namespace placement
 } // namespace genesis
@@ -55,6 +55,13 @@ namespace placement {
 
 }
 
+namespace tree {
+
+    class FlatTree;
+    class TreeDistanceOracle;
+
+}
+
 namespace utils {
 
     template<typename T>
@@ -84,6 +91,14 @@ namespace placement {
  */
 double edpl( Pquery const& pquery, utils::Matrix<double> const& node_distances );
 
+/**
+ * @brief Calculate the EDPL uncertainty values for a Pquery, using a tree::TreeDistanceOracle
+ * to look up the distances between nodes.
+ *
+ * @see edpl( Sample const&, tree::TreeDistanceOracle const& ) for details.
+ */
+double edpl( Pquery const& pquery, tree::TreeDistanceOracle const& node_distances );
+
 /**
  * @brief Calculate the @link edpl( Sample const&, Pquery const& ) edpl()@endlink
  * for all @link Pquery Pqueries@endlink in the Sample.
@@ -137,6 +152,31 @@ double edpl( Sample const& sample, Pquery const& pquery );
  */
 std::vector<double> edpl( Sample const& sample );
 
+/**
+ * @brief Calculate the edpl() for all @link Pquery Pqueries@endlink in a Sample, using the
+ * branch lengths stored in a tree::FlatTree of its PlacementTree.
+ *
+ * The FlatTree computes the node distance matrix in one linear pass per node, which is faster
+ * than the pointer based computation on the PlacementTree itself. The @p tree has to be built
+ * from the tree of the @p sample (or one with the same topology and branch lengths).
+ *
+ * @see edpl( Sample const& ) for details.
+ */
+std::vector<double> edpl( Sample const& sample, tree::FlatTree const& tree );
+
+/**
+ * @brief Calculate the edpl() for all @link Pquery Pqueries@endlink in a Sample, using a
+ * tree::TreeDistanceOracle to look up the distances between nodes.
+ *
+ * The other versions of this function need a node distance matrix, whose size is quadratic in the
+ * number of nodes of the tree, and which hence cannot be computed for large reference trees.
+ * The @p node_distances oracle instead only needs memory that is linear in the size of the tree,
+ * and answers each lookup in constant time. It has to be built from the tree of the @p sample.
+ *
+ * @see edpl( Sample const& ) for details.
+ */
+std::vector<double> edpl( Sample const& sample, tree::TreeDistanceOracle const& node_distances );
+
 // =================================================================================================
 //     Pairwise Distance
 // =================================================================================================
@@ -161,6 +201,21 @@ double pairwise_distance (
     bool          with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the normalized pairwise distance between all placements of the two Samples,
+ * using a tree::TreeDistanceOracle to look up the distances between nodes.
+ *
+ * This is the same as pairwise_distance( Sample const&, Sample const&, bool ), but instead of
+ * a node distance matrix, which is quadratic in the size of the tree, it uses the
+ * @p node_distances oracle, which is linear. It has to be built from the tree of @p smp_a.
+ */
+double pairwise_distance (
+    const Sample&                   smp_a,
+    const Sample&                   smp_b,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length = false
+);
+
 // double closest_pair_distance (
 //     const Sample& smp_a,
 //     const Sample& smp_b,
@@ -200,6 +255,20 @@ double variance (
     bool          with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the variance of the placements on a tree, using a tree::TreeDistanceOracle
+ * to look up the distances between nodes.
+ *
+ * This is the same as variance( Sample const&, bool ), but instead of a node distance matrix,
+ * which is quadratic in the size of the tree, it uses the @p node_distances oracle, which is
+ * linear. It has to be built from the tree of the @p smp.
+ */
+double variance (
+    const Sample&                   smp,
+    tree::TreeDistanceOracle const& node_distances,
+    bool                            with_pendant_length = false
+);
+
 } // namespace placement
 } // namespace genesis
 
@@ -39,6 +39,7 @@
 #include "genesis/placement/sample.hpp"
 
 #include "genesis/tree/common_tree/distances.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/functions.hpp"
 
@@ -66,24 +67,52 @@ namespace placement {
 // -------------------------------------------------------------------------------------------------
 
 /**
- * @brief Local helper function to create a set of Histograms without any weights for a given Tree.
+ * @brief Local helper function to check that the matrices used for the Histograms fit the Tree.
  */
-static NodeDistanceHistogramSet make_empty_node_distance_histogram_set_ (
+static void check_node_distance_histogram_matrices_(
     tree::Tree const& tree,
     utils::Matrix<double> const& node_distances,
-    utils::Matrix<signed char> const& node_sides,
-    size_t const  histogram_bins
+    utils::Matrix<signed char> const& node_sides
 ) {
     auto const node_count = tree.node_count();
-    if( tree.empty() ) {
-        throw std::runtime_error( "Tree is empty. Cannot use Node Histogram Distance." );
-    }
     if( node_distances.rows() != node_count || node_distances.cols() != node_count ) {
         throw std::runtime_error( "Node Distance Matrix has wrong size." );
     }
     if( node_sides.rows() != node_count || node_sides.cols() != node_count ) {
         throw std::runtime_error( "Node Sides Matrix has wrong size." );
     }
+}
+
+/**
+ * @brief Local helper function to check that a tree::TreeDistanceOracle fits the Tree.
+ */
+static void check_node_distance_histogram_oracle_(
+    tree::Tree const& tree,
+    tree::TreeDistanceOracle const& node_distances
+) {
+    if( node_distances.node_count() != tree.node_count() ) {
+        throw std::runtime_error( "TreeDistanceOracle has wrong size." );
+    }
+}
+
+/**
+ * @brief Local helper function to create a set of Histograms without any weights for a given Tree.
+ *
+ * The @p node_distances and @p node_sides are either the matrices as described in
+ * node_distance_histogram_set(), or functors that offer the same `operator()`.
+ * Their size is expected to be checked by the caller.
+ */
+template<class NodeDistances, class NodeSides>
+static NodeDistanceHistogramSet make_empty_node_distance_histogram_set_ (
+    tree::Tree const& tree,
+    NodeDistances const& node_distances,
+    NodeSides const& node_sides,
+    size_t const  histogram_bins
+) {
+    auto const node_count = tree.node_count();
+    if( tree.empty() ) {
+        throw std::runtime_error( "Tree is empty. Cannot use Node Histogram Distance." );
+    }
 
     // Prepare a vector of histograms for each node of the tree.
     // We init with default values, so that we can better parallelize later.
@@ -141,11 +170,14 @@ static NodeDistanceHistogramSet make_empty_node_distance_histogram_set_ (
 
 /**
  * @brief Local helper function to fill the placements of a Sample into Histograms.
+ *
+ * See make_empty_node_distance_histogram_set_() for the @p node_distances and @p node_sides.
  */
+template<class NodeDistances, class NodeSides>
 static void fill_node_distance_histogram_set_ (
     Sample const& sample,
-    utils::Matrix<double> const& node_distances,
-    utils::Matrix<signed char> const& node_sides,
+    NodeDistances const& node_distances,
+    NodeSides const& node_sides,
     NodeDistanceHistogramSet& histogram_set
 ) {
     // Basic checks.
@@ -153,12 +185,6 @@ static void fill_node_distance_histogram_set_ (
     if( histogram_set.histograms.size() != node_count ) {
         throw std::runtime_error( "Number of histograms does not equal number of tree nodes." );
     }
-    if( node_distances.rows() != node_count || node_distances.cols() != node_count ) {
-        throw std::runtime_error( "Node Distance Matrix has wrong size." );
-    }
-    if( node_sides.rows() != node_count || node_sides.cols() != node_count ) {
-        throw std::runtime_error( "Node Sides Matrix has wrong size." );
-    }
 
     // Convert placements to plain form. We are later going to loop over them for every node of the
     // tree, so this plain form speeds things up a lot there.
@@ -255,6 +281,26 @@ NodeDistanceHistogramSet node_distance_histogram_set (
     utils::Matrix<signed char> const& node_sides,
     size_t const  histogram_bins
 ) {
+    check_node_distance_histogram_matrices_( sample.tree(), node_distances, node_sides );
+
+    // Make the histograms, fill them, return them.
+    auto histograms = make_empty_node_distance_histogram_set_(
+        sample.tree(), node_distances, node_sides, histogram_bins
+    );
+    fill_node_distance_histogram_set_( sample, node_distances, node_sides, histograms );
+    return histograms;
+}
+
+NodeDistanceHistogramSet node_distance_histogram_set (
+    Sample const& sample,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const  histogram_bins
+) {
+    check_node_distance_histogram_oracle_( sample.tree(), node_distances );
+    auto const node_sides = [&]( size_t node_index, size_t other_index ){
+        return node_distances.root_direction( node_index, other_index );
+    };
+
     // Make the histograms, fill them, return them.
     auto histograms = make_empty_node_distance_histogram_set_(
         sample.tree(), node_distances, node_sides, histogram_bins
@@ -412,27 +458,43 @@ double node_histogram_distance (
     return node_histogram_distance( hist_vec_a, hist_vec_b );
 }
 
+double node_histogram_distance (
+    Sample const& sample_a,
+    Sample const& sample_b,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const  histogram_bins
+) {
+    if( ! compatible_trees( sample_a, sample_b ) ) {
+        throw std::invalid_argument( "Incompatible trees." );
+    }
+
+    // Get the histograms describing the distances from placements to all nodes. Both use the
+    // distances of the oracle, which is expected to be built from the tree of the first sample.
+    auto const hist_vec_a = node_distance_histogram_set( sample_a, node_distances, histogram_bins );
+    auto const hist_vec_b = node_distance_histogram_set( sample_b, node_distances, histogram_bins );
+    assert( hist_vec_a.histograms.size() == hist_vec_b.histograms.size() );
+
+    return node_histogram_distance( hist_vec_a, hist_vec_b );
+}
+
 // -------------------------------------------------------------------------------------------------
 //     Sample Set
 // -------------------------------------------------------------------------------------------------
 
 /**
  * @brief Local helper function that calculates all Histograms for all Samples in a SampleSet.
+ *
+ * See make_empty_node_distance_histogram_set_() for the @p node_distances and @p node_sides.
  */
-static std::vector<NodeDistanceHistogramSet> node_distance_histogram_set(
+template<class NodeDistances, class NodeSides>
+static std::vector<NodeDistanceHistogramSet> node_distance_histogram_set_(
     SampleSet const& sample_set,
+    NodeDistances const& node_distances,
+    NodeSides const& node_sides,
     size_t const  histogram_bins
 ) {
     auto const set_size = sample_set.size();
-
-    // Edge case.
-    if( set_size == 0 ) {
-        return {};
-    }
-
-    // Prepare lookup for the trees. This assumes identical trees for all samples.
-    auto const node_distances = node_branch_length_distance_matrix( sample_set[0].tree() );
-    auto const node_sides = node_root_direction_matrix( sample_set[0].tree() );
+    assert( set_size > 0 );
 
     // Prepare histograms for all samples, by copying empty histograms for the first sample.
     auto const empty_hist = make_empty_node_distance_histogram_set_(
@@ -468,8 +530,42 @@ utils::Matrix<double> node_histogram_distance (
     SampleSet const& sample_set,
     size_t const     histogram_bins
 ) {
+    // Edge case.
+    if( sample_set.size() == 0 ) {
+        return node_histogram_distance( std::vector<NodeDistanceHistogramSet>() );
+    }
+
+    // Prepare lookup for the trees. This assumes identical trees for all samples.
+    auto const node_distances = node_branch_length_distance_matrix( sample_set[0].tree() );
+    auto const node_sides = node_root_direction_matrix( sample_set[0].tree() );
+
     // Get the histograms and calculate the distance.
-    auto const hist_vecs = node_distance_histogram_set( sample_set, histogram_bins );
+    auto const hist_vecs = node_distance_histogram_set_(
+        sample_set, node_distances, node_sides, histogram_bins
+    );
+    return node_histogram_distance( hist_vecs );
+}
+
+utils::Matrix<double> node_histogram_distance (
+    SampleSet const& sample_set,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const     histogram_bins
+) {
+    // Edge case.
+    if( sample_set.size() == 0 ) {
+        return node_histogram_distance( std::vector<NodeDistanceHistogramSet>() );
+    }
+
+    // Prepare lookup for the trees. This assumes identical trees for all samples.
+    check_node_distance_histogram_oracle_( sample_set[0].tree(), node_distances );
+    auto const node_sides = [&]( size_t node_index, size_t other_index ){
+        return node_distances.root_direction( node_index, other_index );
+    };
+
+    // Get the histograms and calculate the distance.
+    auto const hist_vecs = node_distance_histogram_set_(
+        sample_set, node_distances, node_sides, histogram_bins
+    );
     return node_histogram_distance( hist_vecs );
 }
 
@@ -50,6 +50,7 @@ namespace placement {
 namespace tree {
 
     class Tree;
+    class TreeDistanceOracle;
 
 }
 
@@ -106,6 +107,21 @@ NodeDistanceHistogramSet node_distance_histogram_set(
     size_t const  histogram_bins
 );
 
+/**
+ * @brief Calculate the NodeDistanceHistogramSet representing a single Sample, using a
+ * tree::TreeDistanceOracle of its tree.
+ *
+ * This is the same as the version that takes the two matrices, but it looks up the distances
+ * between nodes and their sides relative to each other in the @p node_distances oracle instead.
+ * This only needs memory that is linear in the size of the tree, and thus also works for large
+ * trees, for which the two matrices are too big.
+ */
+NodeDistanceHistogramSet node_distance_histogram_set(
+    Sample const& sample,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const  histogram_bins
+);
+
 /**
  * @brief Given the histogram sets that describe two Sample%s, calculate their distance.
  */
@@ -141,6 +157,21 @@ double node_histogram_distance(
     size_t const  histogram_bins = 25
 );
 
+/**
+* @brief Calculate the Node Histogram Distance of two Sample%s, using a tree::TreeDistanceOracle
+* instead of the node matrices.
+*
+* The @p node_distances oracle has to be built from the tree of @p sample_a, and is used for both
+* Sample%s. See node_distance_histogram_set( Sample const&, tree::TreeDistanceOracle const&, size_t )
+* for details.
+*/
+double node_histogram_distance(
+    Sample const& sample_a,
+    Sample const& sample_b,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const  histogram_bins = 25
+);
+
 /**
 * @brief Calculate the Node Histogram Distance of every pair of Sample%s in the SampleSet.
 *
@@ -152,6 +183,18 @@ utils::Matrix<double> node_histogram_distance(
     size_t const     histogram_bins = 25
 );
 
+/**
+* @brief Calculate the Node Histogram Distance of every pair of Sample%s in the SampleSet,
+* using a tree::TreeDistanceOracle instead of the node matrices.
+*
+* The @p node_distances oracle has to be built from the tree of the first Sample in the set.
+*/
+utils::Matrix<double> node_histogram_distance(
+    SampleSet const& sample_set,
+    tree::TreeDistanceOracle const& node_distances,
+    size_t const     histogram_bins = 25
+);
+
 } // namespace placement
 } // namespace genesis
 
@@ -33,6 +33,7 @@
  * make_genesis_header.sh in ./tools/deploy to update this file.
  */
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/counts.hpp"
 #include "genesis/sequence/formats/fasta_input_iterator.hpp"
 #include "genesis/sequence/formats/fasta_output_iterator.hpp"
@@ -48,9 +49,11 @@
 #include "genesis/sequence/functions/signatures.hpp"
 #include "genesis/sequence/functions/signature_specifications.hpp"
 #include "genesis/sequence/functions/stats.hpp"
+#include "genesis/sequence/packed_sequence.hpp"
 #include "genesis/sequence/printers/bitmap.hpp"
 #include "genesis/sequence/printers/simple.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/sequence/sequence_set.hpp"
+#include "genesis/sequence/sequence_view.hpp"
 
 #endif // include guard
@@ -0,0 +1,153 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup sequence
+ */
+
+#include "genesis/sequence/compact_sequence_set.hpp"
+
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/sequence/sequence.hpp"
+
+#include <stdexcept>
+
+namespace genesis {
+namespace sequence {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+CompactSequenceSet::CompactSequenceSet( SequenceSet const& set )
+{
+    size_t label_chars = 0;
+    size_t site_chars  = 0;
+    for( auto const& seq : set ) {
+        label_chars += seq.label().size();
+        site_chars  += seq.sites().size();
+    }
+    reserve( set.size(), label_chars, site_chars );
+
+    for( auto const& seq : set ) {
+        add( seq );
+    }
+}
+
+// =================================================================================================
+//     Accessors
+// =================================================================================================
+
+SequenceView CompactSequenceSet::at( size_t index ) const
+{
+    if( index >= entries_.size() ) {
+        throw std::out_of_range(
+            "Invalid index " + std::to_string( index ) + " in CompactSequenceSet of size "
+            + std::to_string( entries_.size() ) + "."
+        );
+    }
+    return (*this)[ index ];
+}
+
+// =================================================================================================
+//     Modifiers
+// =================================================================================================
+
+void CompactSequenceSet::add( SequenceView const& sequence )
+{
+    Entry entry;
+    entry.label_offset = labels_.size();
+    entry.label_size   = sequence.label_size();
+    entry.sites_offset = sites_.size();
+    entry.sites_size   = sequence.size();
+    entry.abundance    = sequence.abundance();
+
+    labels_.append( sequence.label_data(), sequence.label_size() );
+    sites_.append( sequence.sites_data(), sequence.size() );
+    entries_.push_back( entry );
+}
+
+void CompactSequenceSet::add( std::string const& label, std::string const& sites, size_t abundance )
+{
+    add( SequenceView( label.data(), label.size(), sites.data(), sites.size(), abundance ));
+}
+
+void CompactSequenceSet::reserve( size_t sequences, size_t label_chars, size_t site_chars )
+{
+    entries_.reserve( sequences );
+    labels_.reserve( label_chars );
+    sites_.reserve( site_chars );
+}
+
+void CompactSequenceSet::shrink_to_fit()
+{
+    entries_.shrink_to_fit();
+    labels_.shrink_to_fit();
+    sites_.shrink_to_fit();
+}
+
+void CompactSequenceSet::clear()
+{
+    entries_.clear();
+    labels_.clear();
+    sites_.clear();
+}
+
+SequenceSet CompactSequenceSet::to_sequence_set() const
+{
+    SequenceSet result;
+    for( auto const& view : *this ) {
+        result.add( view.to_sequence() );
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Iterators
+// =================================================================================================
+
+CompactSequenceSet::const_iterator CompactSequenceSet::begin() const
+{
+    return const_iterator( *this, 0 );
+}
+
+CompactSequenceSet::const_iterator CompactSequenceSet::end() const
+{
+    return const_iterator( *this, entries_.size() );
+}
+
+CompactSequenceSet::const_iterator CompactSequenceSet::cbegin() const
+{
+    return const_iterator( *this, 0 );
+}
+
+CompactSequenceSet::const_iterator CompactSequenceSet::cend() const
+{
+    return const_iterator( *this, entries_.size() );
+}
+
+} // namespace sequence
+} // namespace genesis
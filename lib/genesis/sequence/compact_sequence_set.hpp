@@ -0,0 +1,310 @@
+#ifndef GENESIS_SEQUENCE_COMPACT_SEQUENCE_SET_H_
+#define GENESIS_SEQUENCE_COMPACT_SEQUENCE_SET_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup sequence
+ */
+
+#include "genesis/sequence/sequence_view.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace sequence {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Sequence;
+class SequenceSet;
+
+// =================================================================================================
+//     Compact Sequence Set
+// =================================================================================================
+
+/**
+ * @brief Store a set of sequences in contiguous memory.
+ *
+ * A SequenceSet stores each Sequence with its own strings for label and sites, which means two
+ * memory allocations per Sequence. For data with many short sequences, such as sets of reads,
+ * this takes considerable time and memory, and the sequences are scattered in memory.
+ *
+ * This class instead stores the labels and sites of all sequences in two large blocks of memory,
+ * plus a list of offsets into them. Its elements are accessed as SequenceView%s, which offer the
+ * same read access as a Sequence. The set can only be appended to; for modifications of
+ * the sequences, use a SequenceSet instead, see to_sequence_set().
+ *
+ * The FastaReader and PhylipReader can read directly into this class, and many of the functions
+ * in sequence/functions as well as SiteCounts accept it as well.
+ *
+ * Adding a sequence can move the data in memory. This invalidates all SequenceView%s and
+ * iterators obtained from the set before. Use reserve() to avoid this if the size is known.
+ */
+class CompactSequenceSet
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs and Enums
+    // -------------------------------------------------------------------------
+
+    class ConstIterator;
+
+    typedef ConstIterator iterator;
+    typedef ConstIterator const_iterator;
+
+    typedef SequenceView value_type;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    CompactSequenceSet() = default;
+
+    /**
+     * @brief Create a set with a copy of all Sequence%s of a SequenceSet.
+     */
+    explicit CompactSequenceSet( SequenceSet const& set );
+
+    ~CompactSequenceSet() = default;
+
+    CompactSequenceSet( CompactSequenceSet const& ) = default;
+    CompactSequenceSet( CompactSequenceSet&& )      = default;
+
+    CompactSequenceSet& operator= ( CompactSequenceSet const& ) = default;
+    CompactSequenceSet& operator= ( CompactSequenceSet&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * Return the number of sequences in the set.
+     */
+    size_t size() const
+    {
+        return entries_.size();
+    }
+
+    /**
+     * Return whether the set is empty, i.e. whether its size() is 0.
+     */
+    bool empty() const
+    {
+        return entries_.empty();
+    }
+
+    /**
+     * @brief Return a view of the sequence at the given @p index, with bounds checking.
+     */
+    SequenceView at( size_t index ) const;
+
+    /**
+     * @brief Return a view of the sequence at the given @p index.
+     */
+    SequenceView operator[] ( size_t index ) const
+    {
+        auto const& e = entries_[ index ];
+        return SequenceView(
+            labels_.data() + e.label_offset, e.label_size,
+            sites_.data()  + e.sites_offset, e.sites_size,
+            e.abundance
+        );
+    }
+
+    /**
+     * @brief Return the total number of sites of all sequences, that is, the size of the
+     * memory block that stores the sites.
+     */
+    size_t total_sites() const
+    {
+        return sites_.size();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Modifiers
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Add a copy of a sequence, given as a Sequence or a SequenceView, to the set.
+     */
+    void add( SequenceView const& sequence );
+
+    /**
+     * @brief Add a sequence, given by its label, sites, and abundance, to the set.
+     */
+    void add( std::string const& label, std::string const& sites, size_t abundance = 1 );
+
+    /**
+     * @brief Reserve memory for the given number of @p sequences, and the total number of chars
+     * in their labels and sites.
+     */
+    void reserve( size_t sequences, size_t label_chars = 0, size_t site_chars = 0 );
+
+    /**
+     * @brief Reduce the memory of the set to what is needed for its data.
+     */
+    void shrink_to_fit();
+
+    /**
+     * @brief Remove all sequences from the set, leaving it with a size() of 0.
+     */
+    void clear();
+
+    /**
+     * @brief Return a SequenceSet with a copy of all sequences of this set.
+     */
+    SequenceSet to_sequence_set() const;
+
+    // -------------------------------------------------------------------------
+    //     Iterators
+    // -------------------------------------------------------------------------
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Position of the data of one sequence in the memory blocks.
+     */
+    struct Entry
+    {
+        size_t label_offset;
+        size_t label_size;
+        size_t sites_offset;
+        size_t sites_size;
+        size_t abundance;
+    };
+
+    std::string        labels_;
+    std::string        sites_;
+    std::vector<Entry> entries_;
+
+};
+
+// =================================================================================================
+//     Compact Sequence Set Iterator
+// =================================================================================================
+
+/**
+ * @brief Iterator over the sequences of a CompactSequenceSet, yielding SequenceView%s.
+ */
+class CompactSequenceSet::ConstIterator
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Member Types
+    // -------------------------------------------------------------------------
+
+    using self_type         = ConstIterator;
+    using value_type        = SequenceView;
+    using pointer           = SequenceView const*;
+    using reference         = SequenceView;
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    ConstIterator() = default;
+
+    ConstIterator( CompactSequenceSet const& set, size_t index )
+        : set_( &set )
+        , index_( index )
+    {}
+
+    ~ConstIterator() = default;
+
+    ConstIterator( ConstIterator const& ) = default;
+    ConstIterator( ConstIterator&& )      = default;
+
+    ConstIterator& operator= ( ConstIterator const& ) = default;
+    ConstIterator& operator= ( ConstIterator&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Operators
+    // -------------------------------------------------------------------------
+
+    SequenceView operator * () const
+    {
+        return ( *set_ )[ index_ ];
+    }
+
+    self_type& operator ++ ()
+    {
+        ++index_;
+        return *this;
+    }
+
+    self_type operator ++ ( int )
+    {
+        self_type tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator == ( self_type const& other ) const
+    {
+        return set_ == other.set_ && index_ == other.index_;
+    }
+
+    bool operator != ( self_type const& other ) const
+    {
+        return !( *this == other );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    CompactSequenceSet const* set_   = nullptr;
+    size_t                    index_ = 0;
+
+};
+
+} // namespace sequence
+} // namespace genesis
+
+#endif // include guard
@@ -30,12 +30,16 @@
 
 #include "genesis/sequence/counts.hpp"
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/functions/codes.hpp"
+#include "genesis/sequence/packed_sequence.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/sequence/sequence_set.hpp"
+#include "genesis/sequence/sequence_view.hpp"
 #include "genesis/utils/text/string.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <limits>
 #include <stdexcept>
@@ -139,41 +143,66 @@ void SiteCounts::add_sequence( Sequence const& sequence, bool use_abundance )
 
 void SiteCounts::add_sequence( std::string const& sites, CountsIntType weight )
 {
-    if( num_seqs_ >= std::numeric_limits< CountsIntType >::max() - weight ) {
-        throw std::runtime_error(
-            "Cannot add Sequence to SiteCounts as it might lead to an overflow in the counts."
-        );
-    }
-    if( sites.size() != counts_.rows() ) {
-        throw std::runtime_error(
-            "Cannot add Sequence to SiteCounts if it has different number of sites: Expected "
-            + std::to_string( counts_.rows() ) + " sites, but sequence has "
-            + std::to_string( sites.size() ) + " sites."
-        );
-    }
-
-    for( size_t site_idx = 0; site_idx < sites.size(); ++site_idx ) {
-        // Get the index of the char. If not found, this char is not to be counted, so continue.
-        auto char_idx = lookup_[ static_cast< size_t >( sites[ site_idx ] ) ];
-        if( char_idx == characters_.size() ) {
-            continue;
-        }
+    add_sites_( sites.data(), sites.size(), weight );
+}
 
-        // Increase the count at that index.
-        counts_( site_idx, char_idx ) += weight;
+void SiteCounts::add_sequences( SequenceSet const& sequences, bool use_abundances )
+{
+    for( auto const& seq : sequences ) {
+        add_sequence( seq, use_abundances );
     }
+}
 
-    // We finished a sequence. Add to the counter.
-    num_seqs_ += weight;
+void SiteCounts::add_sequence( SequenceView const& sequence, bool use_abundance )
+{
+    auto const weight = use_abundance ? static_cast<CountsIntType>( sequence.abundance() ) : 1;
+    add_sites_( sequence.sites_data(), sequence.size(), weight );
 }
 
-void SiteCounts::add_sequences( SequenceSet const& sequences, bool use_abundances )
+void SiteCounts::add_sequences( CompactSequenceSet const& sequences, bool use_abundances )
 {
     for( auto const& seq : sequences ) {
         add_sequence( seq, use_abundances );
     }
 }
 
+void SiteCounts::add_sequence( PackedSequence const& sequence, bool use_abundance )
+{
+    using WordType = PackedSequence::WordType;
+
+    auto const weight = use_abundance ? static_cast<CountsIntType>( sequence.abundance() ) : 1;
+    check_added_sequence_( sequence.size(), weight );
+
+    // Translate all possible codes to their char index once.
+    auto const bps       = sequence.bits_per_site();
+    auto const spw       = sequence.sites_per_word();
+    auto const code_mask = ( WordType( 1 ) << bps ) - 1;
+    std::array<size_t, 16> code_index;
+    for( size_t c = 0; c <= code_mask; ++c ) {
+        auto const site = PackedSequence::decode( c, sequence.encoding() );
+        code_index[c] = lookup_[ static_cast< size_t >( site ) ];
+    }
+
+    auto const& data = sequence.data();
+    for( size_t wi = 0; wi < data.size(); ++wi ) {
+        auto word = data[wi];
+        auto const end = std::min( sequence.size(), ( wi + 1 ) * spw );
+        for( size_t site_idx = wi * spw; site_idx < end; ++site_idx ) {
+            auto const char_idx = code_index[ word & code_mask ];
+            word >>= bps;
+
+            // If the char is not to be counted, continue. Otherwise, increase its count.
+            if( char_idx == characters_.size() ) {
+                continue;
+            }
+            counts_( site_idx, char_idx ) += weight;
+        }
+    }
+
+    // We finished a sequence. Add to the counter.
+    num_seqs_ += weight;
+}
+
 void SiteCounts::clear()
 {
     characters_ = "";
@@ -190,5 +219,44 @@ void SiteCounts::clear_counts()
     num_seqs_ = 0;
 }
 
+// ================================================================================================
+//     Internal Helpers
+// ================================================================================================
+
+void SiteCounts::check_added_sequence_( size_t length, CountsIntType weight ) const
+{
+    if( num_seqs_ >= std::numeric_limits< CountsIntType >::max() - weight ) {
+        throw std::runtime_error(
+            "Cannot add Sequence to SiteCounts as it might lead to an overflow in the counts."
+        );
+    }
+    if( length != counts_.rows() ) {
+        throw std::runtime_error(
+            "Cannot add Sequence to SiteCounts if it has different number of sites: Expected "
+            + std::to_string( counts_.rows() ) + " sites, but sequence has "
+            + std::to_string( length ) + " sites."
+        );
+    }
+}
+
+void SiteCounts::add_sites_( char const* sites, size_t length, CountsIntType weight )
+{
+    check_added_sequence_( length, weight );
+
+    for( size_t site_idx = 0; site_idx < length; ++site_idx ) {
+        // Get the index of the char. If not found, this char is not to be counted, so continue.
+        auto char_idx = lookup_[ static_cast< size_t >( sites[ site_idx ] ) ];
+        if( char_idx == characters_.size() ) {
+            continue;
+        }
+
+        // Increase the count at that index.
+        counts_( site_idx, char_idx ) += weight;
+    }
+
+    // We finished a sequence. Add to the counter.
+    num_seqs_ += weight;
+}
+
 } // namespace sequence
 } // namespace genesis
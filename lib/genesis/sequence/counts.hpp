@@ -44,8 +44,11 @@ namespace sequence {
 //     Forwardd Declarations
 // =================================================================================================
 
+class CompactSequenceSet;
+class PackedSequence;
 class Sequence;
 class SequenceSet;
+class SequenceView;
 
 // =================================================================================================
 //     Sequence Counts
@@ -215,6 +218,35 @@ public:
     */
     void add_sequences( SequenceSet const& sequences, bool use_abundances = true );
 
+    /**
+     * @brief Process a single SequenceView and add its counts to the existing ones.
+     *
+     * If @p use_abundance is `true` (default), the abundance of the sequence is used as weight
+     * for the counting. Otherwise, a weight of `1` is used.
+     */
+    void add_sequence( SequenceView const& sequence, bool use_abundance = true );
+
+    /**
+    * @brief Process a CompactSequenceSet and add its counts to the existing ones for all contained
+    * sequences.
+    *
+    * If @p use_abundances is `true` (default), the abundances of the sequences are used as weights
+    * for the counting. Otherwise, a weight of `1` is used.
+    */
+    void add_sequences( CompactSequenceSet const& sequences, bool use_abundances = true );
+
+    /**
+     * @brief Process a single PackedSequence and add its counts to the existing ones.
+     *
+     * The sites are counted as their unpacked chars, see PackedSequence for details. As there are
+     * only 4 or 16 possible codes, they are translated to their count indices once, and the
+     * packed words are then processed without unpacking them.
+     *
+     * If @p use_abundance is `true` (default), the abundance of the sequence is used as weight
+     * for the counting. Otherwise, a weight of `1` is used.
+     */
+    void add_sequence( PackedSequence const& sequence, bool use_abundance = true );
+
     /**
      * @brief Clear the object, that is, delete everything.
      *
@@ -237,11 +269,19 @@ public:
     void clear_counts();
 
     // -------------------------------------------------------------------------
-    //     Data Members
+    //     Internal Helpers
     // -------------------------------------------------------------------------
 
 private:
 
+    void add_sites_( char const* sites, size_t length, CountsIntType weight );
+
+    void check_added_sequence_( size_t length, CountsIntType weight ) const;
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
     std::string                        characters_;
     utils::CharLookup< unsigned char > lookup_;
     utils::Matrix< CountsIntType >     counts_;
@@ -30,21 +30,28 @@
 
 #include "genesis/sequence/formats/fasta_reader.hpp"
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/functions/labels.hpp"
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/options.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/char_search.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/io/scanner.hpp"
+#include "genesis/utils/io/string_input_source.hpp"
 #include "genesis/utils/text/char.hpp"
 #include "genesis/utils/text/string.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <exception>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace genesis {
 namespace sequence {
@@ -65,8 +72,7 @@ FastaReader::FastaReader()
 SequenceSet FastaReader::read( std::shared_ptr< utils::BaseInputSource > source ) const
 {
     SequenceSet result;
-    utils::InputStream is( source );
-    parse_document( is, result );
+    read( source, result );
     return result;
 }
 
@@ -74,8 +80,28 @@ void FastaReader::read(
     std::shared_ptr< utils::BaseInputSource > source,
     SequenceSet& sequence_set
 ) const {
-    utils::InputStream is( source );
-    parse_document( is, sequence_set );
+    read_( source, [&]( Sequence&& seq ){
+        sequence_set.add( std::move( seq ));
+    });
+}
+
+void FastaReader::read(
+    std::shared_ptr< utils::BaseInputSource > source,
+    CompactSequenceSet& sequence_set
+) const {
+    read_( source, [&]( Sequence&& seq ){
+        sequence_set.add( seq );
+    });
+}
+
+void FastaReader::read(
+    std::shared_ptr< utils::BaseInputSource > source,
+    std::vector<PackedSequence>&              sequences,
+    PackedSequence::Encoding                  encoding
+) const {
+    read_( source, [&]( Sequence&& seq ){
+        sequences.emplace_back( seq, encoding );
+    });
 }
 
 // =================================================================================================
@@ -86,22 +112,30 @@ void FastaReader::parse_document(
     utils::InputStream& input_stream,
     SequenceSet&        sequence_set
 ) const {
-    Sequence seq;
-
-    if( parsing_method_ == ParsingMethod::kDefault ) {
-        while( parse_sequence( input_stream, seq ) ) {
-            sequence_set.add( seq );
-        }
+    parse_document_( input_stream, [&]( Sequence&& seq ){
+        sequence_set.add( std::move( seq ));
+    });
+}
 
-    } else if( parsing_method_ == ParsingMethod::kPedantic ) {
-        while( parse_sequence_pedantic( input_stream, seq ) ) {
-            sequence_set.add( seq );
-        }
+void FastaReader::parse_document(
+    utils::InputStream& input_stream,
+    CompactSequenceSet& sequence_set
+) const {
+    // Copy the data of the sequence into the contiguous memory of the set.
+    parse_document_( input_stream, [&]( Sequence&& seq ){
+        sequence_set.add( seq );
+    });
+}
 
-    } else {
-        // There are no other methods currently implemented.
-        assert( false );
-    }
+void FastaReader::parse_document(
+    utils::InputStream&          input_stream,
+    std::vector<PackedSequence>& sequences,
+    PackedSequence::Encoding     encoding
+) const {
+    // Only keep the packed copies of the sequences.
+    parse_document_( input_stream, [&]( Sequence&& seq ){
+        sequences.emplace_back( seq, encoding );
+    });
 }
 
 bool FastaReader::parse_sequence(
@@ -358,6 +392,170 @@ bool FastaReader::parse_sequence_pedantic(
     return true;
 }
 
+// =================================================================================================
+//     Internal Helpers
+// =================================================================================================
+
+void FastaReader::read_(
+    std::shared_ptr< utils::BaseInputSource > source,
+    std::function<void( Sequence&& )> const&  add_sequence
+) const {
+    if( threads_ != 1 ) {
+        parse_document_parallel_( source, add_sequence );
+        return;
+    }
+
+    utils::InputStream is( source );
+    parse_document_( is, add_sequence );
+}
+
+void FastaReader::parse_document_(
+    utils::InputStream&                      input_stream,
+    std::function<void( Sequence&& )> const& add_sequence
+) const {
+    // We re-use the same Sequence for all parsing, so that its memory is only allocated once
+    // if the callback does not take it over.
+    Sequence seq;
+
+    if( parsing_method_ == ParsingMethod::kDefault ) {
+        while( parse_sequence( input_stream, seq ) ) {
+            add_sequence( std::move( seq ));
+        }
+
+    } else if( parsing_method_ == ParsingMethod::kPedantic ) {
+        while( parse_sequence_pedantic( input_stream, seq ) ) {
+            add_sequence( std::move( seq ));
+        }
+
+    } else {
+        // There are no other methods currently implemented.
+        assert( false );
+    }
+}
+
+/**
+ * @brief Local helper that reads the next chunk of a Fasta input.
+ *
+ * The chunk is read into @p chunk, starting with the @p rest of the previous call, and is cut
+ * at the beginning of the last sequence in the data, which is then kept in @p rest for the
+ * next call. Hence, a chunk only contains complete sequences. If the whole input is read,
+ * the @p rest is empty and the returned chunk contains the remaining sequences.
+ */
+static void fasta_read_chunk_(
+    utils::BaseInputSource& source,
+    size_t                  chunk_size,
+    std::string&            chunk,
+    std::string&            rest
+) {
+    chunk.swap( rest );
+    rest.clear();
+
+    // Read until we have a chunk boundary or the end of the input. If a sequence is larger than
+    // the chunk size, we need more than one round for this.
+    size_t search_start = 0;
+    while( true ) {
+        auto const old_size = chunk.size();
+        chunk.resize( old_size + chunk_size );
+        auto const count = source.read( &chunk[ old_size ], chunk_size );
+        chunk.resize( old_size + count );
+        if( count == 0 ) {
+            return;
+        }
+
+        // Find the last '>' at the beginning of a line in the new data, but not the one at the
+        // very beginning of the chunk, as that would not make any progress.
+        auto pos = chunk.size();
+        while( pos > std::max<size_t>( search_start, 1 )) {
+            --pos;
+            if( chunk[ pos ] == '>' && ( chunk[ pos - 1 ] == '\n' || chunk[ pos - 1 ] == '\r' )) {
+                rest.assign( chunk, pos, std::string::npos );
+                chunk.resize( pos );
+                return;
+            }
+        }
+
+        // The boundary might be right at the end of the old data, so we have to search
+        // from there again in the next round.
+        search_start = chunk.size();
+    }
+}
+
+void FastaReader::parse_document_parallel_(
+    std::shared_ptr< utils::BaseInputSource > source,
+    std::function<void( Sequence&& )> const&  add_sequence
+) const {
+    auto const num_threads = threads_ > 0
+        ? threads_
+        : static_cast<size_t>( utils::Options::get().number_of_threads() )
+    ;
+    auto const chunk_size = std::max<size_t>( chunk_size_, 1 );
+
+    // We read as many chunks as we have threads, parse them in parallel, and add their sequences
+    // to the result in order. We also keep track of the lines in the input, for error reporting.
+    std::vector<std::string>        chunks( num_threads );
+    std::vector<SequenceSet>        results( num_threads );
+    std::vector<std::exception_ptr> errors( num_threads );
+    std::vector<size_t>             line_counts( num_threads );
+    std::string rest;
+    size_t      line_offset = 1;
+
+    bool done = false;
+    while( ! done ) {
+
+        // Read the next chunks. This is sequential, as we can only read from the source in order.
+        size_t chunk_count = 0;
+        while( chunk_count < num_threads ) {
+            fasta_read_chunk_( *source, chunk_size, chunks[ chunk_count ], rest );
+            if( chunks[ chunk_count ].empty() ) {
+                assert( rest.empty() );
+                done = true;
+                break;
+            }
+            ++chunk_count;
+        }
+
+        // Parse them in parallel. We cannot throw from within the parallel region,
+        // so we store errors to re-throw them later.
+        #pragma omp parallel for schedule( dynamic ) num_threads( num_threads )
+        for( size_t i = 0; i < chunk_count; ++i ) {
+            auto const& chunk = chunks[i];
+            results[i].clear();
+            line_counts[i] = utils::count_char( chunk.data(), chunk.data() + chunk.size(), '\n' );
+            errors[i] = nullptr;
+            try {
+                utils::InputStream is( std::make_shared<utils::StringInputSource>(
+                    chunk.data(), chunk.size()
+                ));
+                parse_document_( is, [&]( Sequence&& seq ){
+                    results[i].add( std::move( seq ));
+                });
+            } catch( ... ) {
+                errors[i] = std::current_exception();
+            }
+        }
+
+        // Add the sequences in the order of the input, or report the first error.
+        for( size_t i = 0; i < chunk_count; ++i ) {
+            if( errors[i] ) {
+                try {
+                    std::rethrow_exception( errors[i] );
+                } catch( std::exception const& ex ) {
+                    throw std::runtime_error(
+                        std::string( ex.what() ) + " (The input was read in parallel chunks; "
+                        "line numbers are relative to the chunk, which starts at line "
+                        + std::to_string( line_offset ) + " of " + source->source_name() + ".)"
+                    );
+                }
+            }
+            for( auto& seq : results[i] ) {
+                add_sequence( std::move( seq ));
+            }
+            results[i].clear();
+            line_offset += line_counts[i];
+        }
+    }
+}
+
 // =================================================================================================
 //     Properties
 // =================================================================================================
@@ -425,5 +623,27 @@ utils::CharLookup<bool>& FastaReader::valid_char_lookup()
     return lookup_;
 }
 
+FastaReader& FastaReader::threads( size_t value )
+{
+    threads_ = value;
+    return *this;
+}
+
+size_t FastaReader::threads() const
+{
+    return threads_;
+}
+
+FastaReader& FastaReader::chunk_size( size_t value )
+{
+    chunk_size_ = value;
+    return *this;
+}
+
+size_t FastaReader::chunk_size() const
+{
+    return chunk_size_;
+}
+
 } // namespace sequence
 } // namespace genesis
@@ -31,12 +31,15 @@
  * @ingroup sequence
  */
 
+#include "genesis/sequence/packed_sequence.hpp"
 #include "genesis/utils/tools/char_lookup.hpp"
 #include "genesis/utils/io/input_source.hpp"
 
+#include <functional>
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace genesis {
 
@@ -49,6 +52,7 @@ namespace utils {
 }
 
 namespace sequence {
+    class CompactSequenceSet;
     class SequenceSet;
     class Sequence;
 }
@@ -88,6 +92,8 @@ namespace sequence {
  *
  * Using site_casing(), the sequences can automatically be turned into upper or lower case letter.
  * Also, see valid_chars( std::string const& chars ) for a way of checking correct input sequences.
+ *
+ * For large files, the reading can be done in parallel, see threads().
  */
 class FastaReader
 {
@@ -197,6 +203,32 @@ public:
      */
     void read( std::shared_ptr< utils::BaseInputSource > source, SequenceSet& sequence_set ) const;
 
+    /**
+     * @brief Read all Sequence%s from an input source in Fasta format into a CompactSequenceSet.
+     *
+     * This is the same as read( std::shared_ptr< utils::BaseInputSource >, SequenceSet& ) const,
+     * but stores the sequences in the contiguous memory of a CompactSequenceSet, which is better
+     * suited for large numbers of short sequences.
+     */
+    void read(
+        std::shared_ptr< utils::BaseInputSource > source,
+        CompactSequenceSet&                       sequence_set
+    ) const;
+
+    /**
+     * @brief Read all Sequence%s from an input source in Fasta format into PackedSequence%s.
+     *
+     * The sequences are packed while reading, that is, only one unpacked sequence is kept in
+     * memory at a time. This needs a fourth or half of the memory for the sites, depending on
+     * the @p encoding, see PackedSequence for details. An `std::invalid_argument` exception is
+     * thrown if a sequence contains chars that cannot be stored in the @p encoding.
+     */
+    void read(
+        std::shared_ptr< utils::BaseInputSource > source,
+        std::vector<PackedSequence>&              sequences,
+        PackedSequence::Encoding                  encoding = PackedSequence::Encoding::kFourbit
+    ) const;
+
     // ---------------------------------------------------------------------
     //     Parsing
     // ---------------------------------------------------------------------
@@ -212,6 +244,27 @@ public:
         SequenceSet&        sequence_set
     ) const;
 
+    /**
+     * @brief Parse a whole fasta document into a CompactSequenceSet.
+     *
+     * See parse_document( utils::InputStream&, SequenceSet& ) const for details.
+     */
+    void parse_document(
+        utils::InputStream& input_stream,
+        CompactSequenceSet& sequence_set
+    ) const;
+
+    /**
+     * @brief Parse a whole fasta document into PackedSequence%s.
+     *
+     * See parse_document( utils::InputStream&, SequenceSet& ) const for details.
+     */
+    void parse_document(
+        utils::InputStream&          input_stream,
+        std::vector<PackedSequence>& sequences,
+        PackedSequence::Encoding     encoding = PackedSequence::Encoding::kFourbit
+    ) const;
+
     /**
      * @brief Parse a Sequence in Fasta format.
      *
@@ -329,6 +382,81 @@ public:
      */
     utils::CharLookup<bool>& valid_char_lookup();
 
+    /**
+     * @brief Set the number of threads used by the read() functions.
+     *
+     * Default is `1`, that is, the input is parsed sequentially. With a larger value, the input is
+     * instead read in chunks of about chunk_size() many bytes, which are split at the beginning
+     * of a sequence (a `>` at the start of a line). The chunks are then parsed in parallel, using
+     * the currently set parsing_method(), and their sequences are added to the SequenceSet in the
+     * order in which they appear in the input. If set to `0`, Options::get().number_of_threads()
+     * is used.
+     *
+     * This is useful for large files, and works best with input sources that are fast to read,
+     * such as utils::from_mapped_file(), or a ParallelGzipInputSource for BGZF files. The parallel
+     * parsing needs OpenMP; without it, the chunks are parsed one after another.
+     *
+     * In case of errors in the input, the reported line numbers are relative to the chunk in which
+     * the error occurs. The error message hence additionally contains the line in the input where
+     * that chunk starts. Also, the parse_document() function is not affected by this setting,
+     * as it works on a single InputStream.
+     */
+    FastaReader& threads( size_t value );
+
+    /**
+     * @brief Return the number of threads used for reading.
+     */
+    size_t threads() const;
+
+    /**
+     * @brief Set the approximate size in bytes of the chunks that are parsed in parallel
+     * if threads() is not `1`.
+     *
+     * Default is 32MB. A chunk always contains complete sequences, so if a sequence is longer
+     * than this size, its chunk is accordingly larger.
+     */
+    FastaReader& chunk_size( size_t value );
+
+    /**
+     * @brief Return the size of the chunks that are parsed in parallel.
+     */
+    size_t chunk_size() const;
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Read the input and hand over each Sequence to a callback, which stores it in the
+     * target of the read() function. Dispatches to parse_document_parallel_() if needed.
+     */
+    void read_(
+        std::shared_ptr< utils::BaseInputSource > source,
+        std::function<void( Sequence&& )> const&  add_sequence
+    ) const;
+
+    /**
+     * @brief Parse a whole document, using the parsing_method(), and hand over each Sequence
+     * to a callback, which stores it in the target of the parse_document() function.
+     *
+     * The Sequence is re-used for parsing the next one, so the callback can either move from it,
+     * or copy its data.
+     */
+    void parse_document_(
+        utils::InputStream&                      input_stream,
+        std::function<void( Sequence&& )> const& add_sequence
+    ) const;
+
+    /**
+     * @brief Read the input in chunks and parse them in parallel, see threads().
+     */
+    void parse_document_parallel_(
+        std::shared_ptr< utils::BaseInputSource > source,
+        std::function<void( Sequence&& )> const&  add_sequence
+    ) const;
+
     // ---------------------------------------------------------------------
     //     Members
     // ---------------------------------------------------------------------
@@ -342,6 +470,9 @@ private:
     bool                    use_validation_   = false;
     utils::CharLookup<bool> lookup_;
 
+    size_t                  threads_    = 1;
+    size_t                  chunk_size_ = 1 << 25;
+
 };
 
 } // namespace sequence
@@ -91,9 +91,9 @@ void FastaWriter::to_stream( SequenceSet const& sset, std::ostream& os ) const
 
 void FastaWriter::to_file( SequenceSet const& sset, std::string const& filename ) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sset, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( sset, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 std::string FastaWriter::to_string ( SequenceSet const& sset ) const
@@ -30,6 +30,7 @@
 
 #include "genesis/sequence/formats/phylip_reader.hpp"
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/algorithm.hpp"
@@ -89,6 +90,18 @@ void PhylipReader::read( std::shared_ptr<utils::BaseInputSource> source, Sequenc
     }
 }
 
+void PhylipReader::read(
+    std::shared_ptr<utils::BaseInputSource> source,
+    CompactSequenceSet& target
+) const {
+    // Read into a normal set first, see the function documentation for the reason.
+    SequenceSet tmp;
+    read( source, tmp );
+    for( auto const& seq : tmp ) {
+        target.add( seq );
+    }
+}
+
 // =================================================================================================
 //     Parsing
 // =================================================================================================
@@ -51,6 +51,7 @@ class InputStream;
 
 namespace sequence {
 
+class CompactSequenceSet;
 class SequenceSet;
 class Sequence;
 
@@ -204,6 +205,16 @@ public:
      */
     void read( std::shared_ptr<utils::BaseInputSource> source, SequenceSet& target ) const;
 
+    /**
+     * @brief Read all Sequence%s from an input source in Phylip format into a CompactSequenceSet.
+     *
+     * As the interleaved format needs to append to all sequences while reading, the sequences
+     * are first read into a SequenceSet, and then copied. Phylip files are typically alignments
+     * of moderate size, so this is not an issue in practice. For large numbers of sequences,
+     * the Fasta format is better suited anyway, see FastaReader.
+     */
+    void read( std::shared_ptr<utils::BaseInputSource> source, CompactSequenceSet& target ) const;
+
     // ---------------------------------------------------------------------
     //     Parsing
     // ---------------------------------------------------------------------
@@ -109,12 +109,15 @@ void PhylipWriter::to_stream( SequenceSet const& sset, std::ostream& os ) const
  * already exists, an exception is thrown.
  * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
  * change this behaviour.
+ *
+ * If the file name ends in `.gz`, the output is gzip-compressed,
+ * see utils::make_file_output_stream().
  */
 void PhylipWriter::to_file( SequenceSet const& sset, std::string const& filename ) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sset, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( sset, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 /**
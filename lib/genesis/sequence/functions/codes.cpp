@@ -30,6 +30,7 @@
 
 #include "genesis/sequence/functions/codes.hpp"
 
+#include "genesis/sequence/packed_sequence.hpp"
 #include "genesis/utils/text/string.hpp"
 #include "genesis/utils/tools/color.hpp"
 
@@ -555,6 +556,67 @@ std::string reverse_complement( std::string const& sequence, bool accept_degener
     return result;
 }
 
+/**
+ * @brief Local helper function that reverses the order of the sites in a packed word,
+ * and for the four bit encoding, also reverses the bits of each site.
+ */
+static PackedSequence::WordType reverse_packed_word_( PackedSequence::WordType x, bool fourbit )
+{
+    // Swap halves, then quarters, etc, down to the sites. For four bit sites, continue with the
+    // pairs and single bits, so that the bits within each site are reversed, which complements it.
+    x = ( x >> 32 ) | ( x << 32 );
+    x = (( x >> 16 ) & 0x0000FFFF0000FFFFul ) | (( x & 0x0000FFFF0000FFFFul ) << 16 );
+    x = (( x >>  8 ) & 0x00FF00FF00FF00FFul ) | (( x & 0x00FF00FF00FF00FFul ) <<  8 );
+    x = (( x >>  4 ) & 0x0F0F0F0F0F0F0F0Ful ) | (( x & 0x0F0F0F0F0F0F0F0Ful ) <<  4 );
+    x = (( x >>  2 ) & 0x3333333333333333ul ) | (( x & 0x3333333333333333ul ) <<  2 );
+    if( fourbit ) {
+        x = (( x >> 1 ) & 0x5555555555555555ul ) | (( x & 0x5555555555555555ul ) << 1 );
+    }
+    return x;
+}
+
+PackedSequence reverse_complement( PackedSequence const& sequence )
+{
+    using WordType = PackedSequence::WordType;
+    auto const fourbit = ( sequence.encoding() == PackedSequence::Encoding::kFourbit );
+    auto const word_bits = sizeof( WordType ) * 8;
+
+    // Copy label and properties, and then overwrite the data.
+    auto result = sequence;
+    auto const& src = sequence.data();
+    auto& dst = result.data();
+    auto const n = src.size();
+    if( n == 0 ) {
+        return result;
+    }
+
+    // Reverse the order of the words and the sites within them.
+    for( size_t i = 0; i < n; ++i ) {
+        dst[ n - 1 - i ] = reverse_packed_word_( src[i], fourbit );
+    }
+
+    // The unused bits of the last word are now at the beginning. Shift everything down.
+    auto const pad = n * word_bits - sequence.size() * sequence.bits_per_site();
+    assert( pad < word_bits );
+    if( pad > 0 ) {
+        for( size_t i = 0; i < n - 1; ++i ) {
+            dst[i] = ( dst[i] >> pad ) | ( dst[ i + 1 ] << ( word_bits - pad ));
+        }
+        dst[ n - 1 ] >>= pad;
+    }
+
+    // In the two bit encoding, the complement is a flip of all bits, except for the unused ones.
+    if( ! fourbit ) {
+        for( auto& word : dst ) {
+            word = ~word;
+        }
+        if( pad > 0 ) {
+            dst[ n - 1 ] &= ~WordType( 0 ) >> pad;
+        }
+    }
+    return result;
+}
+
 bool nucleic_acid_code_containment( char a, char b, bool undetermined_matches_all )
 {
     // This is slightly bad, because we are not actually encoding binary,
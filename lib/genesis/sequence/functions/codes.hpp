@@ -43,6 +43,12 @@ namespace utils {
 
     class Color;
 
+}
+
+namespace sequence {
+
+    class PackedSequence;
+
 }
 }
 
@@ -156,6 +162,18 @@ char normalize_amino_acid_code( char code, bool accept_degenerated = true );
  */
 std::string reverse_complement( std::string const& sequence, bool accept_degenerated = true );
 
+/**
+ * @brief Get the reverse complement of a PackedSequence.
+ *
+ * This works on the packed words directly instead of on single sites: In both encodings,
+ * reversing the order of the sites in a word is a series of bit swaps, and complementing is
+ * either a flip of both bits (two bit encoding, where `A = 0` and `T = 3`), or a reversal of the
+ * four bits of each site (four bit encoding, where `A`, `C`, `G` and `T` are bits 0 to 3).
+ * Degenerated codes are thus flipped as in the string version of this function, `N` stays `N`,
+ * and gaps stay gaps.
+ */
+PackedSequence reverse_complement( PackedSequence const& sequence );
+
 /**
  * @brief Compare two nucleic acid codes and check if they are equal, taking degenerated/ambiguous
  * characters into account.
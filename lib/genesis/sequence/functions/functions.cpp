@@ -30,6 +30,7 @@
 
 #include "genesis/sequence/functions/functions.hpp"
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/sequence/printers/simple.hpp"
@@ -68,13 +69,34 @@ utils::Bitvector find_sites(
     return find_sites( seq, lookup );
 }
 
+/**
+ * @brief Local helper function that returns a Bitvector word with the bits set for those sites
+ * of the word with the given index for which the lookup is true.
+ */
+static utils::Bitvector::IntType find_sites_word_(
+    Sequence const& seq,
+    utils::CharLookup<bool> const& chars,
+    size_t word_index
+) {
+    using IntType = utils::Bitvector::IntType;
+
+    auto const begin = word_index * utils::Bitvector::IntSize;
+    auto const end   = std::min( begin + utils::Bitvector::IntSize, seq.length() );
+    IntType result = 0;
+    for( size_t i = begin; i < end; ++i ) {
+        result |= static_cast<IntType>( chars[ seq[ i ] ] ) << ( i - begin );
+    }
+    return result;
+}
+
 utils::Bitvector find_sites(
     Sequence const& seq,
     utils::CharLookup<bool> const& chars
 ) {
+    // Assemble whole words, instead of setting each bit in memory.
     auto result = utils::Bitvector( seq.length(), false );
-    for( size_t i = 0; i < seq.length(); ++i ) {
-        result.set( i, chars[ seq[ i ] ] );
+    for( size_t w = 0; w < result.word_count(); ++w ) {
+        result.set_word( w, find_sites_word_( seq, chars, w ));
     }
     return result;
 }
@@ -108,24 +130,27 @@ utils::Bitvector gap_sites( SequenceSet const& set, std::string const& gap_chars
 
         // Process the sites of the sequence. If it is not a gap, set it to false in the bitvector.
         // This way, only sites that are all-gap will remain with value `true` in the end.
-        for( size_t i = 0; i < seq.length(); ++i ) {
-            if( ! lookup[ seq[ i ] ] ) {
-                result.set( i, false );
-            }
+        // We work on whole words of the bitvector at a time.
+        for( size_t w = 0; w < result.word_count(); ++w ) {
+            result.set_word( w, result.get_word( w ) & find_sites_word_( seq, lookup, w ));
         }
     }
 
     return result;
 }
 
-bool validate_chars( SequenceSet const& set, std::string const& chars )
+/**
+ * @brief Local helper function that validates the chars of a SequenceSet or CompactSequenceSet.
+ */
+template< class SequenceSetType >
+static bool validate_chars_( SequenceSetType const& set, std::string const& chars )
 {
     // Init array to false, then set all necessary chars to true.
     auto lookup = utils::CharLookup<bool>( false );
     lookup.set_selection_upper_lower( chars, true );
 
-    for( auto& s : set ) {
-        for( auto& c : s ) {
+    for( auto const& s : set ) {
+        for( auto const& c : s ) {
             // get rid of this check and leave it to the parser/lexer/stream iterator
             if( c < 0 ) {
                 return false;
@@ -139,6 +164,16 @@ bool validate_chars( SequenceSet const& set, std::string const& chars )
     return true;
 }
 
+bool validate_chars( SequenceSet const& set, std::string const& chars )
+{
+    return validate_chars_( set, chars );
+}
+
+bool validate_chars( CompactSequenceSet const& set, std::string const& chars )
+{
+    return validate_chars_( set, chars );
+}
+
 // -------------------------------------------------------------------------
 //     Length and length checks
 // -------------------------------------------------------------------------
@@ -152,6 +187,15 @@ size_t longest_sequence_length( SequenceSet const& set )
     return max;
 }
 
+size_t longest_sequence_length( CompactSequenceSet const& set )
+{
+    size_t max = 0;
+    for( auto const& seq : set ) {
+        max = std::max( max, seq.length() );
+    }
+    return max;
+}
+
 size_t total_length( SequenceSet const& set )
 {
     return std::accumulate( set.begin(), set.end(), 0,
@@ -161,6 +205,12 @@ size_t total_length( SequenceSet const& set )
     );
 }
 
+size_t total_length( CompactSequenceSet const& set )
+{
+    // All sites are stored in one block, so its size is the total length.
+    return set.total_sites();
+}
+
 bool is_alignment( SequenceSet const& set )
 {
     if( set.size() == 0 ) {
@@ -176,6 +226,21 @@ bool is_alignment( SequenceSet const& set )
     return true;
 }
 
+bool is_alignment( CompactSequenceSet const& set )
+{
+    if( set.size() == 0 ) {
+        return true;
+    }
+
+    size_t length = set[0].length();
+    for( auto const& s : set ) {
+        if( s.length() != length ) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // =================================================================================================
 //     Modifiers
 // =================================================================================================
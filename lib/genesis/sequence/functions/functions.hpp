@@ -46,6 +46,7 @@ namespace sequence {
 //     Forwad Declarations
 // =================================================================================================
 
+class CompactSequenceSet;
 class Sequence;
 class SequenceSet;
 
@@ -131,6 +132,26 @@ size_t total_length( SequenceSet const& set );
  */
 bool is_alignment( SequenceSet const& set );
 
+/**
+ * @copydoc validate_chars( SequenceSet const&, std::string const& )
+ */
+bool validate_chars( CompactSequenceSet const& set, std::string const& chars );
+
+/**
+ * @brief Return the length of the longest sequence in the CompactSequenceSet.
+ */
+size_t longest_sequence_length( CompactSequenceSet const& set );
+
+/**
+ * @brief Return the total length (sum) of all sequences in the CompactSequenceSet.
+ */
+size_t total_length( CompactSequenceSet const& set );
+
+/**
+ * @brief Return true iff all sequences in the CompactSequenceSet have the same length.
+ */
+bool is_alignment( CompactSequenceSet const& set );
+
 // =================================================================================================
 //     Modifiers
 // =================================================================================================
@@ -33,12 +33,14 @@
 #include "genesis/sequence/functions/codes.hpp"
 #include "genesis/sequence/functions/signature_specifications.hpp"
 #include "genesis/sequence/functions/stats.hpp"
+#include "genesis/sequence/packed_sequence.hpp"
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/math/statistics.hpp"
 #include "genesis/utils/tools/char_lookup.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <limits>
 #include <numeric>
@@ -114,6 +116,107 @@ std::vector<size_t> signature_counts(
     return result;
 }
 
+std::vector<size_t> signature_counts(
+    PackedSequence const&          sequence,
+    SignatureSpecifications const& settings
+) {
+    using WordType = PackedSequence::WordType;
+
+    // Get alphabet.
+    auto const& w = settings.alphabet();
+    auto const ws = w.size();
+
+    // Get the number of entries in the kmer list.
+    size_t const p = settings.kmer_list_size();
+
+    // Result vector. Count the occurance of each possible kmer.
+    auto result = std::vector<size_t>( p, 0 );
+
+    // If the sequence is not long enough and does not contain even one kmer, we are done already.
+    if( sequence.size() < settings.k() ) {
+        return result;
+    }
+
+    // Translate all possible codes to their index in the alphabet once.
+    auto const encoding  = sequence.encoding();
+    auto const bps       = sequence.bits_per_site();
+    auto const spw       = sequence.sites_per_word();
+    auto const code_mask = ( WordType( 1 ) << bps ) - 1;
+    std::array<size_t, 16> code_index;
+    bool identity = true;
+    for( size_t c = 0; c <= code_mask; ++c ) {
+        code_index[c] = settings.char_index( PackedSequence::decode( c, encoding ));
+        identity &= ( code_index[c] == c );
+    }
+
+    // Store the index of the count vector for the current kmer,
+    // and the number of valid processed chars of the sequence.
+    size_t index  = 0;
+    size_t valids = 0;
+    auto const& data = sequence.data();
+
+    // Fast path: All codes are valid and equal to their index. As then ws == 4 and p is a power
+    // of two, the index is built by shifting in the codes and masking.
+    if( identity && ws == 4 ) {
+        assert( encoding == PackedSequence::Encoding::kTwobit );
+        for( size_t wi = 0; wi < data.size(); ++wi ) {
+            auto word = data[wi];
+            auto const end = std::min( sequence.size(), ( wi + 1 ) * spw );
+            for( size_t pos = wi * spw; pos < end; ++pos ) {
+                index = (( index << 2 ) | ( word & code_mask )) & ( p - 1 );
+                word >>= bps;
+                ++valids;
+                if( valids >= settings.k() ) {
+                    assert( index < result.size() );
+                    ++result[ index ];
+                }
+            }
+        }
+        return result;
+    }
+
+    // Process the sequence.
+    for( size_t wi = 0; wi < data.size(); ++wi ) {
+        auto word = data[wi];
+        auto const end = std::min( sequence.size(), ( wi + 1 ) * spw );
+        for( size_t pos = wi * spw; pos < end; ++pos ) {
+            auto const code = word & code_mask;
+            auto const cur  = code_index[ code ];
+            word >>= bps;
+
+            // Check if the char is valid in the alphabet
+            if( cur == settings.InvalidCharIndex ) {
+                switch( settings.unknown_char_behavior() ) {
+                    case SignatureSpecifications::UnknownCharBehavior::kSkip:
+                        continue;
+                    case SignatureSpecifications::UnknownCharBehavior::kThrow:
+                        throw std::runtime_error(
+                            "Unknown Sequence char for kmer counting: '" +
+                            std::string( 1, PackedSequence::decode( code, encoding )) + "'"
+                        );
+                    default:
+                        assert( false );
+                }
+            }
+
+            // Build up the index.
+            index *= ws;
+            index %= p;
+            index += cur;
+            ++valids;
+
+            // Only if we already have seen enough valid chars for one k-mer length (or more),
+            // store the kmer.
+            if( valids >= settings.k() ) {
+                assert( index < result.size() );
+                ++result[ index ];
+            }
+        }
+    }
+
+    return result;
+}
+
 std::vector<double> signature_frequencies(
     Sequence const& sequence,
     SignatureSpecifications const& settings
@@ -42,6 +42,7 @@ namespace sequence {
 //     Forwad Declarations
 // =================================================================================================
 
+class PackedSequence;
 class SignatureSpecifications;
 class Sequence;
 class SequenceSet;
@@ -61,6 +62,19 @@ std::vector<size_t> signature_counts(
     SignatureSpecifications const& settings
 );
 
+/**
+ * @brief Count the occurences of k-mers in a PackedSequence according to the @p settings.
+ *
+ * This gives the same result as the Sequence version of this function for the unpacked sites,
+ * see PackedSequence for how they are unpacked. The function walks the packed words directly,
+ * and translates each code via a small table. For the common case of the two bit encoding and
+ * the alphabet `ACGT`, the k-mer index is computed with bit operations only.
+ */
+std::vector<size_t> signature_counts(
+    PackedSequence const&          sequence,
+    SignatureSpecifications const& settings
+);
+
 /**
  * @brief Calculate the frequencies of occurences of k-mers in the @p sequence according to the
  * @p settings.
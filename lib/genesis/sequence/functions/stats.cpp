@@ -30,10 +30,12 @@
 
 #include "genesis/sequence/functions/stats.hpp"
 
+#include "genesis/sequence/compact_sequence_set.hpp"
 #include "genesis/sequence/counts.hpp"
 #include "genesis/sequence/functions/functions.hpp"
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
+#include "genesis/sequence/sequence_view.hpp"
 #include "genesis/utils/tools/char_lookup.hpp"
 
 #include <array>
@@ -50,7 +52,11 @@ namespace sequence {
 //     Site Histogram
 // -------------------------------------------------------------------------
 
-std::map<char, size_t> site_histogram( Sequence const& seq )
+/**
+ * @brief Local helper function that counts the sites of a Sequence or SequenceView.
+ */
+template< class SequenceType >
+static std::map<char, size_t> site_histogram_sequence_( SequenceType const& seq )
 {
     // We do a detour via an array, as this has way faster access times.
 
@@ -74,7 +80,12 @@ std::map<char, size_t> site_histogram( Sequence const& seq )
     }
     return result;
 }
-std::map<char, size_t> site_histogram( SequenceSet const& set )
+
+/**
+ * @brief Local helper function that counts the sites of a SequenceSet or CompactSequenceSet.
+ */
+template< class SequenceSetType >
+static std::map<char, size_t> site_histogram_set_( SequenceSetType const& set )
 {
     // We do a detour via an array, as this has way faster access times.
 
@@ -101,6 +112,26 @@ std::map<char, size_t> site_histogram( SequenceSet const& set )
     return result;
 }
 
+std::map<char, size_t> site_histogram( Sequence const& seq )
+{
+    return site_histogram_sequence_( seq );
+}
+
+std::map<char, size_t> site_histogram( SequenceView const& seq )
+{
+    return site_histogram_sequence_( seq );
+}
+
+std::map<char, size_t> site_histogram( SequenceSet const& set )
+{
+    return site_histogram_set_( set );
+}
+
+std::map<char, size_t> site_histogram( CompactSequenceSet const& set )
+{
+    return site_histogram_set_( set );
+}
+
 // -------------------------------------------------------------------------
 //     Base Frequencies
 // -------------------------------------------------------------------------
@@ -144,19 +175,31 @@ std::map<char, double> base_frequencies( SequenceSet const& set, std::string con
     return base_frequencies_accumulator( sh, plain_chars );
 }
 
+std::map<char, double> base_frequencies(
+    CompactSequenceSet const& set,
+    std::string const&        plain_chars
+) {
+    auto const sh = site_histogram( set );
+    return base_frequencies_accumulator( sh, plain_chars );
+}
+
 // -------------------------------------------------------------------------
 //     Char counting and validation
 // -------------------------------------------------------------------------
 
-size_t count_chars( SequenceSet const& set, std::string const& chars )
+/**
+ * @brief Local helper function that counts chars in a SequenceSet or CompactSequenceSet.
+ */
+template< class SequenceSetType >
+static size_t count_chars_( SequenceSetType const& set, std::string const& chars )
 {
     // Init array to false, then set all necessary chars to true.
     auto lookup = utils::CharLookup<bool>( false );
     lookup.set_selection_upper_lower( chars, true );
 
     size_t counter = 0;
-    for( auto& s : set ) {
-        for( auto& c : s ) {
+    for( auto const& s : set ) {
+        for( auto const& c : s ) {
             // get rid of this check and leave it to the parser/lexer/stream iterator
             if( c < 0 ) {
                 continue;
@@ -170,11 +213,25 @@ size_t count_chars( SequenceSet const& set, std::string const& chars )
     return counter;
 }
 
+size_t count_chars( SequenceSet const& set, std::string const& chars )
+{
+    return count_chars_( set, chars );
+}
+
+size_t count_chars( CompactSequenceSet const& set, std::string const& chars )
+{
+    return count_chars_( set, chars );
+}
+
 // -------------------------------------------------------------------------
 //     Gap Counting
 // -------------------------------------------------------------------------
 
-double gapyness( SequenceSet const& set, std::string const& gap_chars )
+/**
+ * @brief Local helper function for the gapyness of a SequenceSet or CompactSequenceSet.
+ */
+template< class SequenceSetType >
+static double gapyness_( SequenceSetType const& set, std::string const& gap_chars )
 {
     size_t gaps = count_chars( set, gap_chars );
     size_t len  = total_length( set );
@@ -187,6 +244,16 @@ double gapyness( SequenceSet const& set, std::string const& gap_chars )
     return ret;
 }
 
+double gapyness( SequenceSet const& set, std::string const& gap_chars )
+{
+    return gapyness_( set, gap_chars );
+}
+
+double gapyness( CompactSequenceSet const& set, std::string const& gap_chars )
+{
+    return gapyness_( set, gap_chars );
+}
+
 size_t gap_site_count( SiteCounts const& counts )
 {
     size_t res = 0;
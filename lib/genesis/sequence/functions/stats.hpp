@@ -42,7 +42,9 @@ namespace sequence {
 //     Forwad Declarations
 // =================================================================================================
 
+class CompactSequenceSet;
 class Sequence;
+class SequenceView;
 class SiteCounts;
 class SequenceSet;
 
@@ -66,6 +68,16 @@ std::map<char, size_t> site_histogram( Sequence    const& seq );
  */
 std::map<char, size_t> site_histogram( SequenceSet const& set );
 
+/**
+ * @brief Get a histogram of the occurrences of particular sites, given a SequenceView.
+ */
+std::map<char, size_t> site_histogram( SequenceView const& seq );
+
+/**
+ * @brief Get a histogram of the occurrences of particular sites, given a CompactSequenceSet.
+ */
+std::map<char, size_t> site_histogram( CompactSequenceSet const& set );
+
 /**
  * @brief Get the base frequencies of the sites in a Sequence given the base chars.
  *
@@ -85,6 +97,16 @@ std::map<char, double> base_frequencies( Sequence    const& seq, std::string con
  */
 std::map<char, double> base_frequencies( SequenceSet const& set, std::string const& plain_chars );
 
+/**
+ * @brief Get the base frequencies of the sites in a CompactSequenceSet given the base chars.
+ *
+ * See the Sequence implementation of this function for details.
+ */
+std::map<char, double> base_frequencies(
+    CompactSequenceSet const& set,
+    std::string const&        plain_chars
+);
+
 /**
  * @brief Count the number of occurrences of the given `chars` within the sites of the SequenceSet.
  *
@@ -97,6 +119,11 @@ std::map<char, double> base_frequencies( SequenceSet const& set, std::string con
  */
 size_t count_chars( SequenceSet const& set, std::string const& chars );
 
+/**
+ * @copydoc count_chars( SequenceSet const&, std::string const& )
+ */
+size_t count_chars( CompactSequenceSet const& set, std::string const& chars );
+
 /**
  * @brief Return the "gapyness" of the Sequence%s, i.e., the proportion of gap chars
  * and other completely undetermined chars to the total length of all sequences.
@@ -110,6 +137,11 @@ size_t count_chars( SequenceSet const& set, std::string const& chars );
  */
 double gapyness( SequenceSet    const& set, std::string const& gap_chars );
 
+/**
+ * @copydoc gapyness( SequenceSet const&, std::string const& )
+ */
+double gapyness( CompactSequenceSet const& set, std::string const& gap_chars );
+
 size_t gap_site_count( SiteCounts const& counts );
 
 } // namespace sequence
@@ -0,0 +1,249 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup sequence
+ */
+
+#include "genesis/sequence/packed_sequence.hpp"
+
+#include "genesis/sequence/sequence.hpp"
+#include "genesis/utils/text/char.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+namespace genesis {
+namespace sequence {
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Marker for chars that cannot be packed in the lookup tables.
+ */
+static const unsigned char packed_sequence_invalid_code_ = 0xFF;
+
+/**
+ * @brief Local helper function that builds the char to code lookup table of an encoding.
+ */
+static std::array<unsigned char, 256> packed_sequence_make_codes_( bool fourbit )
+{
+    std::array<unsigned char, 256> codes;
+    codes.fill( packed_sequence_invalid_code_ );
+
+    auto set = [&]( char c, unsigned char code ){
+        codes[ static_cast<unsigned char>( utils::to_upper_ascii( c )) ] = code;
+        codes[ static_cast<unsigned char>( utils::to_lower_ascii( c )) ] = code;
+    };
+
+    if( ! fourbit ) {
+        set( 'A', 0 );
+        set( 'C', 1 );
+        set( 'G', 2 );
+        set( 'T', 3 );
+        set( 'U', 3 );
+        return codes;
+    }
+
+    // Plain nucleotides, as bit masks.
+    set( 'A', 0x1 );
+    set( 'C', 0x2 );
+    set( 'G', 0x4 );
+    set( 'T', 0x8 );
+    set( 'U', 0x8 );
+
+    // Degenerated codes are the union of their nucleotides.
+    set( 'W', 0x1 | 0x8 );
+    set( 'S', 0x2 | 0x4 );
+    set( 'M', 0x1 | 0x2 );
+    set( 'K', 0x4 | 0x8 );
+    set( 'R', 0x1 | 0x4 );
+    set( 'Y', 0x2 | 0x8 );
+    set( 'B', 0x2 | 0x4 | 0x8 );
+    set( 'D', 0x1 | 0x4 | 0x8 );
+    set( 'H', 0x1 | 0x2 | 0x8 );
+    set( 'V', 0x1 | 0x2 | 0x4 );
+
+    // Undetermined codes. N can be any nucleotide, the others are treated as gaps.
+    set( 'N', 0xF );
+    set( 'O', 0x0 );
+    set( 'X', 0x0 );
+    set( '.', 0x0 );
+    set( '-', 0x0 );
+    set( '?', 0x0 );
+    return codes;
+}
+
+/**
+ * @brief Local helper function that returns the char to code lookup table of an encoding.
+ */
+static std::array<unsigned char, 256> const& packed_sequence_codes_( PackedSequence::Encoding encoding )
+{
+    static const auto twobit  = packed_sequence_make_codes_( false );
+    static const auto fourbit = packed_sequence_make_codes_( true );
+    return encoding == PackedSequence::Encoding::kTwobit ? twobit : fourbit;
+}
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+PackedSequence::PackedSequence(
+    std::string const& label,
+    std::string const& sites,
+    Encoding           encoding,
+    size_t             abundance
+)
+    : label_( label )
+    , abundance_( abundance )
+{
+    assign( sites, encoding );
+}
+
+PackedSequence::PackedSequence( Sequence const& sequence, Encoding encoding )
+    : label_( sequence.label() )
+    , abundance_( sequence.abundance() )
+{
+    assign( sequence.sites(), encoding );
+}
+
+// =================================================================================================
+//     Accessors
+// =================================================================================================
+
+char PackedSequence::site_at( size_t index ) const
+{
+    if( index >= size_ ) {
+        throw std::out_of_range( "PackedSequence::site_at()" );
+    }
+    return (*this)[ index ];
+}
+
+std::string PackedSequence::sites() const
+{
+    auto result = std::string( size_, '-' );
+
+    auto const bps  = bits_per_site();
+    auto const spw  = sites_per_word();
+    auto const mask = ( WordType( 1 ) << bps ) - 1;
+    for( size_t w = 0; w < data_.size(); ++w ) {
+        // Shift through the word instead of computing the position of each site anew.
+        auto word = data_[w];
+        auto const end = std::min( size_, ( w + 1 ) * spw );
+        for( size_t i = w * spw; i < end; ++i ) {
+            result[i] = decode( static_cast<unsigned char>( word & mask ), encoding_ );
+            word >>= bps;
+        }
+    }
+    return result;
+}
+
+Sequence PackedSequence::to_sequence() const
+{
+    return Sequence( label_, sites(), abundance_ );
+}
+
+// =================================================================================================
+//     Packing
+// =================================================================================================
+
+unsigned char PackedSequence::encode( char site, Encoding encoding )
+{
+    auto const code = packed_sequence_codes_( encoding )[ static_cast<unsigned char>( site ) ];
+    if( code == packed_sequence_invalid_code_ ) {
+        throw std::invalid_argument(
+            "Cannot pack char " + utils::char_to_hex( site ) + " into a sequence with "
+            + std::to_string( bits_per_site( encoding )) + " bits per site."
+        );
+    }
+    return code;
+}
+
+char PackedSequence::decode( unsigned char code, Encoding encoding )
+{
+    // Inverse of the codes above, indexed by code.
+    static const char twobit[]  = "ACGT";
+    static const char fourbit[] = "-ACMGRSVTWYHKDBN";
+
+    if( encoding == Encoding::kTwobit ) {
+        assert( code < 4 );
+        return twobit[ code ];
+    }
+    assert( code < 16 );
+    return fourbit[ code ];
+}
+
+// =================================================================================================
+//     Modifiers
+// =================================================================================================
+
+void PackedSequence::assign( std::string const& sites, Encoding encoding )
+{
+    encoding_ = encoding;
+    size_     = sites.size();
+
+    auto const& codes = packed_sequence_codes_( encoding );
+    auto const bps = bits_per_site();
+    auto const spw = sites_per_word();
+
+    data_.assign(( size_ + spw - 1 ) / spw, 0 );
+    for( size_t w = 0; w < data_.size(); ++w ) {
+        auto const begin = w * spw;
+        auto const end   = std::min( size_, begin + spw );
+
+        // Collect all codes of the word, and check them once at the end,
+        // as the invalid code has all bits set.
+        WordType word = 0;
+        unsigned char all = 0;
+        for( size_t i = end; i > begin; --i ) {
+            auto const code = codes[ static_cast<unsigned char>( sites[ i - 1 ] ) ];
+            all  |= code;
+            word <<= bps;
+            word |= static_cast<WordType>( code );
+        }
+        if( all == packed_sequence_invalid_code_ ) {
+            for( size_t i = begin; i < end; ++i ) {
+                encode( sites[i], encoding );
+            }
+        }
+        data_[w] = word;
+    }
+}
+
+void PackedSequence::clear()
+{
+    label_     = "";
+    abundance_ = 1;
+    size_      = 0;
+    data_.clear();
+}
+
+} // namespace sequence
+} // namespace genesis
@@ -0,0 +1,297 @@
+#ifndef GENESIS_SEQUENCE_PACKED_SEQUENCE_H_
+#define GENESIS_SEQUENCE_PACKED_SEQUENCE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup sequence
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace sequence {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Sequence;
+
+// =================================================================================================
+//     Packed Sequence
+// =================================================================================================
+
+/**
+ * @brief Nucleic acid sequence that stores its sites with two or four bits each.
+ *
+ * A Sequence uses one byte per site. For nucleic acids, this is more than needed, so this class
+ * packs the sites into 64bit words, which cuts the memory by a factor of 4 or 2, respectively,
+ * and lets per-site loops touch less memory. There are two encodings:
+ *
+ *   * Encoding::kTwobit stores the plain nucleotides `ACGT` as values 0 to 3, in the same way
+ *     as utils::TwobitVector does. Any other char cannot be stored.
+ *   * Encoding::kFourbit stores all nucleic acid codes, see nucleic_acid_codes_all(). Each site is
+ *     stored as a bit mask of the nucleotides that it can stand for, with `A = 1`, `C = 2`,
+ *     `G = 4` and `T = 8`. Degenerated codes are the union of their nucleotides, e.g.,
+ *     `R = A | G = 5`, and `N` is the union of all four. The other undetermined chars (gaps etc)
+ *     are stored as 0.
+ *
+ * Packing is case-insensitive and treats `U` as `T`. Unpacking yields upper case chars,
+ * with `-` for all undetermined chars except `N`, which is in line with
+ * normalize_nucleic_acid_code().
+ *
+ * Site `i` is stored in word `i / sites_per_word()`, starting at the least significant bits.
+ * The unused bits of the last word are always 0.
+ */
+class PackedSequence
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs and Enums
+    // -------------------------------------------------------------------------
+
+    using WordType = uint64_t;
+
+    enum class Encoding
+    {
+        kTwobit,
+        kFourbit
+    };
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    PackedSequence() = default;
+
+    /**
+     * @brief Create a packed sequence from its label and sites.
+     *
+     * Throws an `std::invalid_argument` if any of the @p sites cannot be stored
+     * with the given @p encoding.
+     */
+    PackedSequence(
+        std::string const& label,
+        std::string const& sites,
+        Encoding           encoding = Encoding::kFourbit,
+        size_t             abundance = 1
+    );
+
+    /**
+     * @brief Create a packed copy of a Sequence.
+     *
+     * Throws an `std::invalid_argument` if any of the sites cannot be stored
+     * with the given @p encoding.
+     */
+    explicit PackedSequence( Sequence const& sequence, Encoding encoding = Encoding::kFourbit );
+
+    ~PackedSequence() = default;
+
+    PackedSequence( PackedSequence const& ) = default;
+    PackedSequence( PackedSequence&& )      = default;
+
+    PackedSequence& operator= ( PackedSequence const& ) = default;
+    PackedSequence& operator= ( PackedSequence&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Properties
+    // -------------------------------------------------------------------------
+
+    std::string const& label() const
+    {
+        return label_;
+    }
+
+    void label( std::string const& value )
+    {
+        label_ = value;
+    }
+
+    size_t abundance() const
+    {
+        return abundance_;
+    }
+
+    void abundance( size_t value )
+    {
+        abundance_ = value;
+    }
+
+    Encoding encoding() const
+    {
+        return encoding_;
+    }
+
+    /**
+     * @brief Return the number of bits used per site, that is, 2 or 4.
+     */
+    size_t bits_per_site() const
+    {
+        return bits_per_site( encoding_ );
+    }
+
+    /**
+     * @brief Return the number of sites stored in one word, that is, 32 or 16.
+     */
+    size_t sites_per_word() const
+    {
+        return sizeof( WordType ) * 8 / bits_per_site();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+    * @brief Return the length (number of sites) of this sequence.
+    */
+    size_t length() const
+    {
+        return size_;
+    }
+
+    /**
+     * @brief Alias for length().
+     */
+    size_t size() const
+    {
+        return size_;
+    }
+
+    /**
+     * @brief Return the packed code of the site at the given @p index.
+     */
+    unsigned char code_at( size_t index ) const
+    {
+        auto const bps = bits_per_site();
+        auto const spw = sites_per_word();
+        auto const mask = ( WordType( 1 ) << bps ) - 1;
+        return static_cast<unsigned char>(
+            ( data_[ index / spw ] >> ( bps * ( index % spw ))) & mask
+        );
+    }
+
+    /**
+     * @brief Return the unpacked char of the site at the given @p index, with bounds checking.
+     */
+    char site_at( size_t index ) const;
+
+    /**
+     * @brief Return the unpacked char of the site at the given @p index.
+     */
+    char operator [] ( size_t index ) const
+    {
+        return decode( code_at( index ), encoding_ );
+    }
+
+    /**
+     * @brief Return the unpacked sites.
+     */
+    std::string sites() const;
+
+    /**
+     * @brief Return a Sequence with the label, unpacked sites, and abundance of this sequence.
+     */
+    Sequence to_sequence() const;
+
+    /**
+     * @brief Return the words that store the packed sites.
+     */
+    std::vector<WordType> const& data() const
+    {
+        return data_;
+    }
+
+    /**
+     * @brief Return the words that store the packed sites, for functions that work on them
+     * directly.
+     *
+     * Callers have to make sure that the unused bits of the last word remain 0.
+     */
+    std::vector<WordType>& data()
+    {
+        return data_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Packing
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of bits per site of an @p encoding.
+     */
+    static size_t bits_per_site( Encoding encoding )
+    {
+        return encoding == Encoding::kTwobit ? 2 : 4;
+    }
+
+    /**
+     * @brief Return the code of a site char in the given @p encoding.
+     *
+     * Throws an `std::invalid_argument` if the char cannot be stored in that encoding.
+     */
+    static unsigned char encode( char site, Encoding encoding );
+
+    /**
+     * @brief Return the site char of a @p code in the given @p encoding.
+     */
+    static char decode( unsigned char code, Encoding encoding );
+
+    // -------------------------------------------------------------------------
+    //     Modifiers
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Replace the sites by the given ones, packed with the given @p encoding.
+     */
+    void assign( std::string const& sites, Encoding encoding );
+
+    void clear();
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    std::string           label_;
+    size_t                abundance_ = 1;
+    Encoding              encoding_  = Encoding::kFourbit;
+    size_t                size_      = 0;
+    std::vector<WordType> data_;
+
+};
+
+} // namespace sequence
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,228 @@
+#ifndef GENESIS_SEQUENCE_SEQUENCE_VIEW_H_
+#define GENESIS_SEQUENCE_SEQUENCE_VIEW_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup sequence
+ */
+
+#include "genesis/sequence/sequence.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace genesis {
+namespace sequence {
+
+// =================================================================================================
+//     Sequence View
+// =================================================================================================
+
+/**
+ * @brief Read-only view of the label, sites, and abundance of a sequence, without owning them.
+ *
+ * This is the element type of a CompactSequenceSet, where the data of all sequences is stored
+ * in large contiguous blocks of memory. It offers the same read access as a Sequence, so that
+ * functions can work on both. A view can also be created from a Sequence, in which case it points
+ * to the data of that Sequence.
+ *
+ * As the view only points to the data, it is invalidated when the underlying Sequence or
+ * CompactSequenceSet is changed or destroyed.
+ */
+class SequenceView
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs and Enums
+    // -------------------------------------------------------------------------
+
+    typedef char const* iterator;
+    typedef char const* const_iterator;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    SequenceView() = default;
+
+    SequenceView(
+        char const* label, size_t label_size,
+        char const* sites, size_t sites_size,
+        size_t abundance = 1
+    )
+        : label_( label )
+        , label_size_( label_size )
+        , sites_( sites )
+        , sites_size_( sites_size )
+        , abundance_( abundance )
+    {}
+
+    /**
+     * @brief Create a view of a Sequence.
+     */
+    SequenceView( Sequence const& sequence )
+        : label_( sequence.label().data() )
+        , label_size_( sequence.label().size() )
+        , sites_( sequence.sites().data() )
+        , sites_size_( sequence.sites().size() )
+        , abundance_( sequence.abundance() )
+    {}
+
+    ~SequenceView() = default;
+
+    SequenceView( SequenceView const& ) = default;
+    SequenceView( SequenceView&& )      = default;
+
+    SequenceView& operator= ( SequenceView const& ) = default;
+    SequenceView& operator= ( SequenceView&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Properties
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return a copy of the label.
+     */
+    std::string label() const
+    {
+        return std::string( label_, label_size_ );
+    }
+
+    char const* label_data() const
+    {
+        return label_;
+    }
+
+    size_t label_size() const
+    {
+        return label_size_;
+    }
+
+    /**
+     * @brief Return a copy of the sites.
+     */
+    std::string sites() const
+    {
+        return std::string( sites_, sites_size_ );
+    }
+
+    char const* sites_data() const
+    {
+        return sites_;
+    }
+
+    size_t abundance() const
+    {
+        return abundance_;
+    }
+
+    /**
+     * @brief Return a Sequence with a copy of the data of this view.
+     */
+    Sequence to_sequence() const
+    {
+        return Sequence( label(), sites(), abundance_ );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+    * @brief Return the length (number of sites) of this sequence.
+    */
+    size_t length() const
+    {
+        return sites_size_;
+    }
+
+    /**
+     * @brief Alias for length().
+     */
+    size_t size() const
+    {
+        return sites_size_;
+    }
+
+    char site_at( size_t index ) const
+    {
+        if( index >= sites_size_ ) {
+            throw std::out_of_range( "SequenceView::site_at()" );
+        }
+        return sites_[ index ];
+    }
+
+    char operator [] ( size_t index ) const
+    {
+        return sites_[ index ];
+    }
+
+    // -------------------------------------------------------------------------
+    //     Iterators
+    // -------------------------------------------------------------------------
+
+    const_iterator begin() const
+    {
+        return sites_;
+    }
+
+    const_iterator end() const
+    {
+        return sites_ + sites_size_;
+    }
+
+    const_iterator cbegin() const
+    {
+        return sites_;
+    }
+
+    const_iterator cend() const
+    {
+        return sites_ + sites_size_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    char const* label_      = nullptr;
+    size_t      label_size_ = 0;
+    char const* sites_      = nullptr;
+    size_t      sites_size_ = 0;
+    size_t      abundance_  = 1;
+
+};
+
+} // namespace sequence
+} // namespace genesis
+
+#endif // include guard
@@ -70,9 +70,9 @@ void TaxonomyWriter::to_stream( Taxonomy const& tax, std::ostream& os ) const
 
 void TaxonomyWriter::to_file( Taxonomy const& tax, std::string const& filename ) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( tax, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( tax, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 std::string TaxonomyWriter::to_string( Taxonomy const& tax ) const
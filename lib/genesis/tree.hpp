@@ -37,8 +37,10 @@
 #include "genesis/tree/attribute_tree/keyed_newick_reader.hpp"
 #include "genesis/tree/attribute_tree/tree.hpp"
 #include "genesis/tree/bipartition/bipartition.hpp"
+#include "genesis/tree/bipartition/consensus.hpp"
 #include "genesis/tree/bipartition/functions.hpp"
 #include "genesis/tree/bipartition/rf.hpp"
+#include "genesis/tree/bipartition/split_table.hpp"
 #include "genesis/tree/common_tree/distances.hpp"
 #include "genesis/tree/common_tree/edge_color.hpp"
 #include "genesis/tree/common_tree/functions.hpp"
@@ -47,12 +49,14 @@
 #include "genesis/tree/common_tree/operators.hpp"
 #include "genesis/tree/common_tree/phyloxml_writer.hpp"
 #include "genesis/tree/common_tree/tree.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
 #include "genesis/tree/drawing/circular_layout.hpp"
 #include "genesis/tree/drawing/functions.hpp"
 #include "genesis/tree/drawing/heat_tree.hpp"
 #include "genesis/tree/drawing/layout_base.hpp"
 #include "genesis/tree/drawing/layout_tree.hpp"
 #include "genesis/tree/drawing/rectangular_layout.hpp"
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/formats/color_writer_plugin.hpp"
 #include "genesis/tree/formats/newick/broker.hpp"
 #include "genesis/tree/formats/newick/color_writer_plugin.hpp"
@@ -75,8 +79,11 @@
 #include "genesis/tree/iterator/path_set.hpp"
 #include "genesis/tree/iterator/postorder.hpp"
 #include "genesis/tree/iterator/preorder.hpp"
+#include "genesis/tree/iterator/traversal_order.hpp"
 #include "genesis/tree/mass_tree/balances.hpp"
+#include "genesis/tree/mass_tree/binned_mass_tree.hpp"
 #include "genesis/tree/mass_tree/emd.hpp"
+#include "genesis/tree/mass_tree/flat_mass_tree.hpp"
 #include "genesis/tree/mass_tree/functions.hpp"
 #include "genesis/tree/mass_tree/kmeans.hpp"
 #include "genesis/tree/mass_tree/phylo_factor_colors.hpp"
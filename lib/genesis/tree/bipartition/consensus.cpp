@@ -0,0 +1,299 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/bipartition/consensus.hpp"
+
+#include "genesis/tree/bipartition/rf.hpp"
+#include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/formats/newick/broker.hpp"
+#include "genesis/tree/formats/newick/element.hpp"
+#include "genesis/utils/math/bitvector/operators.hpp"
+#include "genesis/utils/text/string.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper function that returns whether two normalized splits can be in the same Tree.
+ *
+ * As both splits do not contain taxon 0, their complements always overlap, so that they are
+ * compatible iff one is contained in the other, or if they are disjoint. We get this from the
+ * size of their intersection, given the sizes @p lhs_count and @p rhs_count of the splits.
+ */
+static bool consensus_splits_compatible_(
+    utils::Bitvector const& lhs, size_t lhs_count,
+    utils::Bitvector const& rhs, size_t rhs_count
+) {
+    auto const both = utils::count_and( lhs, rhs );
+    return both == 0 || both == lhs_count || both == rhs_count;
+}
+
+/**
+ * @brief Local helper function that selects the ids of the splits of a consensus Tree,
+ * in order of decreasing frequency.
+ */
+static std::vector<SplitTable::SplitId> consensus_select_splits_(
+    SplitTable const& table,
+    ConsensusMethod method
+) {
+    using SplitId = SplitTable::SplitId;
+    auto const tree_count = table.tree_count();
+    auto const taxon_count = table.taxon_count();
+
+    // Get all splits that are candidates for the method. We skip splits that do not actually
+    // split the taxa into two parts with at least two taxa each, which can only result from
+    // unusual trees, and do not need a node in the consensus.
+    std::vector<SplitId> candidates;
+    for( size_t i = 0; i < table.split_count(); ++i ) {
+        auto const id = static_cast<SplitId>( i );
+        auto const freq = table.split_frequency( id );
+        auto const size = table.split_bitvector( id ).count();
+        if( freq == 0 || size < 2 || size + 2 > taxon_count ) {
+            continue;
+        }
+
+        bool use = false;
+        switch( method ) {
+            case ConsensusMethod::kStrict:
+                use = ( freq == tree_count );
+                break;
+            case ConsensusMethod::kMajorityRule:
+                use = ( 2 * freq > tree_count );
+                break;
+            case ConsensusMethod::kExtendedMajorityRule:
+                use = true;
+                break;
+            default:
+                throw std::invalid_argument( "Invalid ConsensusMethod." );
+        }
+        if( use ) {
+            candidates.push_back( id );
+        }
+    }
+
+    // Sort by frequency. Ties are resolved by id, that is, by the order in which the splits
+    // were first seen in the input, so that the result is deterministic.
+    std::stable_sort( candidates.begin(), candidates.end(), [&]( SplitId lhs, SplitId rhs ){
+        return table.split_frequency( lhs ) > table.split_frequency( rhs );
+    });
+
+    // Strict and majority rule splits are always compatible with each other.
+    // For the extended majority rule, we greedily add compatible splits.
+    if( method != ConsensusMethod::kExtendedMajorityRule ) {
+        return candidates;
+    }
+    std::vector<SplitId> result;
+    std::vector<size_t> result_counts;
+    for( auto const id : candidates ) {
+        auto const& bitvec = table.split_bitvector( id );
+        auto const count = bitvec.count();
+        bool compatible = true;
+        for( size_t i = 0; i < result.size(); ++i ) {
+            auto const& other = table.split_bitvector( result[i] );
+            if( ! consensus_splits_compatible_( bitvec, count, other, result_counts[i] )) {
+                compatible = false;
+                break;
+            }
+        }
+        if( compatible ) {
+            result.push_back( id );
+            result_counts.push_back( count );
+        }
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Consensus Tree
+// =================================================================================================
+
+Tree consensus_tree( SplitTable const& table, ConsensusMethod method )
+{
+    if( ! table.verify() ) {
+        throw std::invalid_argument(
+            "Cannot build consensus tree from a SplitTable that was created without verification, "
+            "as the Bitvectors of the splits are needed."
+        );
+    }
+    if( table.tree_count() == 0 || table.taxon_count() == 0 ) {
+        return Tree();
+    }
+    auto const taxon_count = table.taxon_count();
+
+    // Get the taxon names by their index.
+    auto taxa = std::vector<std::string>( taxon_count );
+    for( auto const& name : table.taxon_names() ) {
+        taxa[ name.second ] = name.first;
+    }
+
+    // Get the splits, and sort them by size, so that each one comes after all that contain it.
+    // The splits are the clades of the consensus Tree, when rooting it at taxon 0.
+    auto splits = consensus_select_splits_( table, method );
+    auto sizes  = std::vector<size_t>( splits.size() );
+    for( size_t i = 0; i < splits.size(); ++i ) {
+        sizes[i] = table.split_bitvector( splits[i] ).count();
+    }
+    auto order = std::vector<size_t>( splits.size() );
+    for( size_t i = 0; i < order.size(); ++i ) {
+        order[i] = i;
+    }
+    std::stable_sort( order.begin(), order.end(), [&]( size_t lhs, size_t rhs ){
+        return sizes[ lhs ] > sizes[ rhs ];
+    });
+
+    // Find the parent of each clade, which is the smallest clade that contains it. As the clades
+    // are compatible and sorted by size, this is the clade that was last assigned to its taxa.
+    // The root gets index splits.size(). We also keep the smallest taxon of each clade,
+    // in order to sort the children of each node by it.
+    auto const root = splits.size();
+    auto innermost  = std::vector<size_t>( taxon_count, root );
+    auto parents    = std::vector<size_t>( splits.size(), root );
+    auto min_taxa   = std::vector<size_t>( splits.size(), taxon_count );
+    for( auto const c : order ) {
+        auto const& bitvec = table.split_bitvector( splits[c] );
+        for( size_t t = 0; t < taxon_count; ++t ) {
+            if( ! bitvec[t] ) {
+                continue;
+            }
+            if( min_taxa[c] == taxon_count ) {
+                min_taxa[c] = t;
+                parents[c]  = innermost[t];
+            }
+            assert( parents[c] == innermost[t] );
+            innermost[t] = c;
+        }
+    }
+
+    // Collect the children of each clade and of the root, as pairs of their smallest taxon,
+    // and either a clade index, or a taxon index offset by the number of clades.
+    auto children = std::vector<std::vector<std::pair<size_t, size_t>>>( splits.size() + 1 );
+    for( size_t c = 0; c < splits.size(); ++c ) {
+        children[ parents[c] ].emplace_back( min_taxa[c], c );
+    }
+    for( size_t t = 0; t < taxon_count; ++t ) {
+        children[ innermost[t] ].emplace_back( t, root + 1 + t );
+    }
+    for( auto& list : children ) {
+        std::sort( list.begin(), list.end() );
+    }
+
+    // Build a broker in preorder, and turn it into a Tree. This is similar to taxonomy_to_tree().
+    NewickBroker broker;
+    broker.push_bottom( NewickBrokerElement( 0 ));
+    auto stack = std::vector<std::pair<size_t, long>>();
+    for( auto it = children[ root ].rbegin(); it != children[ root ].rend(); ++it ) {
+        stack.emplace_back( it->second, 1 );
+    }
+    while( ! stack.empty() ) {
+        auto const node  = stack.back().first;
+        auto const depth = stack.back().second;
+        stack.pop_back();
+
+        if( node > root ) {
+            broker.push_bottom({ taxa[ node - root - 1 ], depth });
+            continue;
+        }
+
+        auto const support = static_cast<double>( table.split_frequency( splits[ node ] ))
+                           / static_cast<double>( table.tree_count() );
+        broker.push_bottom({ utils::to_string_rounded( support ), depth });
+        for( auto it = children[ node ].rbegin(); it != children[ node ].rend(); ++it ) {
+            stack.emplace_back( it->second, depth + 1 );
+        }
+    }
+    broker.assign_ranks();
+
+    return CommonTreeNewickReader().broker_to_tree( broker );
+}
+
+Tree consensus_tree( TreeSet const& trees, ConsensusMethod method )
+{
+    if( trees.empty() ) {
+        return Tree();
+    }
+
+    auto table = SplitTable( rf_taxon_name_map( trees[0] ), SplitHashWidth::k64, true );
+    table.add_trees( trees );
+    return consensus_tree( table, method );
+}
+
+Tree consensus_tree(
+    NewickInputIterator& trees,
+    ConsensusMethod method,
+    size_t max_splits,
+    size_t block_size
+) {
+    if( ! trees ) {
+        return Tree();
+    }
+    block_size = std::max<size_t>( block_size, 1 );
+
+    // Read blocks of trees, process each block in parallel, and prune the table if needed.
+    // The error bound of the pruning is only meaningful if the table can at least hold
+    // the splits of one tree.
+    auto table = SplitTable( rf_taxon_name_map( *trees ), SplitHashWidth::k64, true );
+    auto const taxon_count = table.taxon_names().size();
+    if( max_splits > 0 && taxon_count > 3 && max_splits < taxon_count - 3 ) {
+        throw std::invalid_argument(
+            "Cannot compute consensus tree with max_splits = " + std::to_string( max_splits ) +
+            ", which is less than the number of splits of a tree with " +
+            std::to_string( taxon_count ) + " taxa."
+        );
+    }
+    TreeSet block;
+    while( trees ) {
+        block.clear();
+        while( trees && block.size() < block_size ) {
+            block.add( *trees );
+            ++trees;
+        }
+
+        table.add_trees( block );
+        if( max_splits > 0 ) {
+            table.reduce_to_frequent( max_splits );
+        }
+    }
+
+    return consensus_tree( table, method );
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,131 @@
+#ifndef GENESIS_TREE_BIPARTITION_CONSENSUS_H_
+#define GENESIS_TREE_BIPARTITION_CONSENSUS_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/bipartition/split_table.hpp"
+#include "genesis/tree/formats/newick/input_iterator.hpp"
+#include "genesis/tree/tree.hpp"
+#include "genesis/tree/tree_set.hpp"
+
+#include <cstddef>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Consensus Method
+// =================================================================================================
+
+/**
+ * @brief Rule for selecting the splits of a consensus_tree().
+ */
+enum class ConsensusMethod
+{
+    /**
+     * @brief Use only the splits that occur in all Tree%s.
+     */
+    kStrict,
+
+    /**
+     * @brief Use the splits that occur in more than half of the Tree%s.
+     */
+    kMajorityRule,
+
+    /**
+     * @brief Use the majority rule splits, and then greedily add further splits in order of
+     * decreasing frequency, as long as they are compatible with all splits added so far.
+     *
+     * This is also called the greedy consensus, and yields a mostly bifurcating Tree.
+     */
+    kExtendedMajorityRule
+};
+
+// =================================================================================================
+//     Consensus Tree
+// =================================================================================================
+
+/**
+ * @brief Build a consensus Tree from the splits in a SplitTable.
+ *
+ * The @p table needs to be created with `verify == true`, as the split_bitvector()s are needed
+ * for building the Tree. The result is an unrooted Tree with CommonNodeData and CommonEdgeData.
+ * The leaf nodes are named by the taxa, and each inner node (except for the root) is named by the
+ * support of the split of the edge towards the root, that is, the fraction of Tree%s in the table
+ * that contain the split. This is the usual way of storing support values in Newick files.
+ * As the splits do not have branch lengths, all branches get the default length of the
+ * CommonTreeNewickReader.
+ */
+Tree consensus_tree( SplitTable const& table, ConsensusMethod method );
+
+/**
+ * @brief Build a consensus Tree of all Tree%s in a TreeSet.
+ *
+ * The splits of the Tree%s are computed in parallel. See
+ * @link consensus_tree( SplitTable const&, ConsensusMethod ) consensus_tree( SplitTable const& )
+ * @endlink for details on the result.
+ */
+Tree consensus_tree(
+    TreeSet const& trees,
+    ConsensusMethod method = ConsensusMethod::kMajorityRule
+);
+
+/**
+ * @brief Build a consensus Tree of all Tree%s that are read from a NewickInputIterator.
+ *
+ * The Tree%s are read in blocks of @p block_size, and the splits of each block are computed
+ * in parallel and accumulated in a SplitTable, so that only one block needs to be kept in memory.
+ * The Tree%s need to have CommonNodeData, so the iterator should be created with a
+ * CommonTreeNewickReader.
+ *
+ * If @p max_splits is not zero, the table is reduced to at most @p max_splits splits after each
+ * block, see SplitTable::reduce_to_frequent(). This bounds the memory for large collections of
+ * diverse Tree%s, in which most splits are rare. The support values of the remaining splits are
+ * then lower bounds: With `s` splits per Tree (the number of taxa minus three for unrooted binary
+ * Tree%s), the support of each split is at most `s / ( max_splits + 1 )` below its true value,
+ * and any split with a higher true support is guaranteed to be kept. For example, a limit of
+ * twenty times the number of taxa yields an error below 5%. A limit that cannot even hold the
+ * splits of a single Tree is rejected with an exception.
+ *
+ * See @link consensus_tree( SplitTable const&, ConsensusMethod ) consensus_tree( SplitTable const& )
+ * @endlink for details on the result.
+ */
+Tree consensus_tree(
+    NewickInputIterator& trees,
+    ConsensusMethod method = ConsensusMethod::kMajorityRule,
+    size_t max_splits = 0,
+    size_t block_size = 1024
+);
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -256,14 +256,15 @@ std::vector<size_t> find_monophyletic_subtree_edges(
         }
 
         // If all tips of the bip are in our node list, we found a monophyletic clade.
-        if( ( bip.leaf_nodes() & leaves ) == bip.leaf_nodes() ) {
+        if( utils::is_subset( bip.leaf_nodes(), leaves ) ) {
             set_result_edges( bip );
         }
 
-        // Same for inverted case.
-        auto inverted = bip;
-        inverted.invert();
-        if( ( inverted.leaf_nodes() & leaves ) == inverted.leaf_nodes() ) {
+        // Same for inverted case. The inverted tips are all in our list iff together with the
+        // tips of the bip, they cover all nodes. This way, we only need to invert if that is the case.
+        if( utils::count_or( bip.leaf_nodes(), leaves ) == leaves.size() ) {
+            auto inverted = bip;
+            inverted.invert();
             set_result_edges( inverted );
         }
     }
@@ -38,6 +38,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <stdexcept>
 
 #ifdef GENESIS_OPENMP
@@ -352,70 +353,120 @@ std::unordered_map<utils::Bitvector, utils::Bitvector> rf_get_occurrences(
 }
 
 // =================================================================================================
-//     Absolute RF Distance Functions
+//     Getting Split Ids of Trees
 // =================================================================================================
 
-utils::Matrix<size_t> rf_distance_absolute( TreeSet const& trees )
-{
-    using utils::Matrix;
+std::vector<std::vector<SplitTable::SplitId>> rf_get_split_ids(
+    NewickInputIterator& trees,
+    SplitTable& table,
+    size_t block_size
+) {
+    std::vector<std::vector<SplitTable::SplitId>> result;
+    block_size = std::max<size_t>( block_size, 1 );
+
+    // Read blocks of trees, and process each block in parallel.
+    TreeSet block;
+    while( trees ) {
+        block.clear();
+        while( trees && block.size() < block_size ) {
+            block.add( *trees );
+            ++trees;
+        }
 
-    auto result = Matrix<size_t>( trees.size(), trees.size(), 0 );
-    auto const hash_occs = rf_get_occurrences( trees );
+        auto ids = table.add_trees( block );
+        for( auto& tree_ids : ids ) {
+            result.push_back( std::move( tree_ids ));
+        }
+    }
 
-    // We test every split that occurred in the trees.
-    for( auto const& hash_occ : hash_occs ) {
+    return result;
+}
 
-        // Go through all trees and see if it appeared in them.
-        for( size_t i = 0; i < trees.size(); ++i ) {
-            if( hash_occ.second[i] == false ) {
-                continue;
-            }
+// =================================================================================================
+//     Absolute RF Distance Functions
+// =================================================================================================
 
-            // If we are here, we have a split that occured in tree i.
-            // Now we check, if it also appeared in tree j (for all j!=i).
-            // If not, we have a split that is part of i but not of j,
-            // so it adds to their pairwise distance.
-            for( size_t j = 0; j < trees.size(); ++j ) {
-                if( i == j ) {
-                    continue;
-                }
-                if( hash_occ.second[j] == false ) {
-                    ++result( i, j );
-                    ++result( j, i );
-                }
-            }
+/**
+ * @brief Local helper function that counts the split ids that are in only one of two sorted lists.
+ */
+static size_t rf_split_ids_symmetric_difference_(
+    std::vector<SplitTable::SplitId> const& lhs,
+    std::vector<SplitTable::SplitId> const& rhs
+) {
+    size_t shared = 0;
+    auto lit = lhs.begin();
+    auto rit = rhs.begin();
+    while( lit != lhs.end() && rit != rhs.end() ) {
+        if( *lit < *rit ) {
+            ++lit;
+        } else if( *rit < *lit ) {
+            ++rit;
+        } else {
+            ++shared;
+            ++lit;
+            ++rit;
+        }
+    }
+    return lhs.size() + rhs.size() - 2 * shared;
+}
+
+utils::Matrix<size_t> rf_distance_absolute(
+    std::vector<std::vector<SplitTable::SplitId>> const& split_ids
+) {
+    auto const size = split_ids.size();
+    auto result = utils::Matrix<size_t>( size, size, 0 );
+
+    // The rows get shorter towards the end, so we use dynamic scheduling.
+    #pragma omp parallel for schedule(dynamic)
+    for( size_t i = 0; i < size; ++i ) {
+        for( size_t j = i + 1; j < size; ++j ) {
+            auto const dist = rf_split_ids_symmetric_difference_( split_ids[i], split_ids[j] );
+            result( i, j ) = dist;
+            result( j, i ) = dist;
         }
     }
 
     return result;
 }
 
-std::vector<size_t> rf_distance_absolute( Tree const& lhs, TreeSet const& rhs )
+utils::Matrix<size_t> rf_distance_absolute( TreeSet const& trees )
 {
-    auto result = std::vector<size_t>( rhs.size(), 0 );
-    auto const hash_occs = rf_get_occurrences( lhs, rhs );
+    if( trees.empty() ) {
+        return utils::Matrix<size_t>();
+    }
 
-    // We test every split that occurred in all of the trees.
-    for( auto const& hash_occ : hash_occs ) {
-        // See if it was in the lhs tree.
-        bool const in_lhs = hash_occ.second[0];
+    auto table = SplitTable( rf_taxon_name_map( trees[0] ), SplitHashWidth::k64, true );
+    return rf_distance_absolute( table.add_trees( trees ));
+}
+
+utils::Matrix<size_t> rf_distance_absolute(
+    NewickInputIterator& trees,
+    SplitHashWidth width,
+    bool verify
+) {
+    if( ! trees ) {
+        return utils::Matrix<size_t>();
+    }
 
-        // Now go through all rhs trees and see if it also appeared there.
-        for( size_t i = 0; i < rhs.size(); ++i ) {
-            bool const in_rhs = hash_occ.second[ 1 + i ];
+    auto table = SplitTable( rf_taxon_name_map( *trees ), width, verify );
+    return rf_distance_absolute( rf_get_split_ids( trees, table ));
+}
 
-            // Now, in_lhs and in_rhs indicate in which of the trees the split appeared.
-            // It adds to the distance between lhs and rhs[i] only if those two differ,
-            // which is the case if in_lhs ^ in_rhs == true.
+std::vector<size_t> rf_distance_absolute( Tree const& lhs, TreeSet const& rhs )
+{
+    auto result = std::vector<size_t>( rhs.size(), 0 );
+    if( rhs.empty() ) {
+        return result;
+    }
 
-            // Bool converts to 1, so we can use this to process without branching.
-            result[i] += (in_lhs ^ in_rhs);
+    // Get the splits of all trees, and compare the rhs ones to the lhs one.
+    auto table = SplitTable( rf_taxon_name_map( lhs ), SplitHashWidth::k64, true );
+    auto const lhs_ids = table.add_tree( lhs );
+    auto const rhs_ids = table.add_trees( rhs );
 
-            // Just in case, this is equivalent, but needs branching:
-            // if( in_lhs ^ in_rhs ) {
-            //     ++result[i];
-            // }
-        }
+    #pragma omp parallel for
+    for( size_t i = 0; i < rhs.size(); ++i ) {
+        result[i] = rf_split_ids_symmetric_difference_( lhs_ids, rhs_ids[i] );
     }
 
     return result;
@@ -31,6 +31,8 @@
  * @ingroup tree
  */
 
+#include "genesis/tree/bipartition/split_table.hpp"
+#include "genesis/tree/formats/newick/input_iterator.hpp"
 #include "genesis/tree/tree.hpp"
 #include "genesis/tree/tree_set.hpp"
 #include "genesis/utils/containers/matrix.hpp"
@@ -117,17 +119,62 @@ std::unordered_map<utils::Bitvector, utils::Bitvector> rf_get_occurrences(
     Tree const& rhs
 );
 
+/**
+ * @brief Get the sorted ids of the splits of all Tree%s that are read from a NewickInputIterator.
+ *
+ * This is a streaming variant of SplitTable::add_trees(): Instead of keeping all Tree%s in memory,
+ * only @p block_size of them are read at a time, and their splits are computed in parallel.
+ * Only the compact lists of split ids are kept, which can then be used for
+ * rf_distance_absolute( std::vector<std::vector<SplitTable::SplitId>> const& ).
+ *
+ * The Tree%s need to have CommonNodeData, so the iterator should be created with a
+ * CommonTreeNewickReader.
+ */
+std::vector<std::vector<SplitTable::SplitId>> rf_get_split_ids(
+    NewickInputIterator& trees,
+    SplitTable& table,
+    size_t block_size = 1024
+);
+
 // =================================================================================================
 //     Absolute RF Distance Functions
 // =================================================================================================
 
+/**
+ * @brief Compute the pairwise absolute RF (Robinson-Foulds) distance metric between Tree%s,
+ * given the sorted ids of their splits, as obtained from a SplitTable.
+ *
+ * The distance between two Tree%s is the number of splits that are in only one of them,
+ * which is computed by a merge of their id lists, in parallel for all pairs of Tree%s.
+ */
+utils::Matrix<size_t> rf_distance_absolute(
+    std::vector<std::vector<SplitTable::SplitId>> const& split_ids
+);
+
 /**
  * @brief Compute the pairwise absolute RF (Robinson-Foulds) distance metric between a set of @p trees.
  *
  * The function computes the unweighted absolute RF distance.
+ * It uses a SplitTable with verification, so that the result is exact. The Tree%s are added to
+ * the table in blocks, see SplitTable::add_trees(), so that besides the table itself, only
+ * the compact lists of split ids of all Tree%s are kept.
  */
 utils::Matrix<size_t> rf_distance_absolute( TreeSet const& trees );
 
+/**
+ * @brief Compute the pairwise absolute RF (Robinson-Foulds) distance metric between all Tree%s
+ * that are read from a NewickInputIterator.
+ *
+ * The Tree%s are streamed, so that only the compact lists of their split ids have to be kept
+ * in memory, see rf_get_split_ids(). The taxon names are taken from the first Tree.
+ * See SplitTable for the meaning of @p width and @p verify.
+ */
+utils::Matrix<size_t> rf_distance_absolute(
+    NewickInputIterator& trees,
+    SplitHashWidth width = SplitHashWidth::k64,
+    bool verify = false
+);
+
 /**
  * @brief Compute the absolute RF (Robinson-Foulds) distance metric between a given @p lhs Tree
  * and all of the trees in the @p rhs TreeSet.
@@ -0,0 +1,422 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/bipartition/split_table.hpp"
+
+#include "genesis/tree/common_tree/tree.hpp"
+#include "genesis/tree/function/functions.hpp"
+#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/tree_set.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#ifdef GENESIS_OPENMP
+#   include <omp.h>
+#endif
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constructor
+// =================================================================================================
+
+SplitTable::SplitTable(
+    std::unordered_map<std::string, size_t> const& names,
+    SplitHashWidth width,
+    bool verify,
+    std::uint64_t seed
+)
+    : names_( names )
+    , taxon_hashes_( names.size() )
+    , verify_( verify )
+{
+    // Draw a random word (or two) for each taxon, and combine all of them,
+    // which is needed to normalize the hashes of splits that contain taxon 0.
+    std::mt19937_64 engine( seed );
+    for( auto& hash : taxon_hashes_ ) {
+        hash.low = engine();
+        if( width == SplitHashWidth::k128 ) {
+            hash.high = engine();
+        }
+        all_taxa_hash_ ^= hash;
+    }
+
+    // Check that the names are usable as indices.
+    for( auto const& name : names_ ) {
+        if( name.second >= names_.size() ) {
+            throw std::invalid_argument(
+                "Cannot create SplitTable with taxon name map that does not use consecutive indices."
+            );
+        }
+    }
+}
+
+// =================================================================================================
+//     Accessors
+// =================================================================================================
+
+utils::Bitvector const& SplitTable::split_bitvector( SplitId id ) const
+{
+    if( ! verify_ ) {
+        throw std::runtime_error(
+            "SplitTable only stores the Bitvectors of splits when created with verify == true."
+        );
+    }
+    if( id >= bitvectors_.size() ) {
+        throw std::invalid_argument( "Invalid split id " + std::to_string( id ) + "." );
+    }
+    return bitvectors_[ id ];
+}
+
+// =================================================================================================
+//     Adding Trees
+// =================================================================================================
+
+std::vector<SplitHash> SplitTable::split_hashes( Tree const& tree ) const
+{
+    return compute_splits_( tree ).hashes;
+}
+
+std::vector<SplitTable::SplitId> SplitTable::add_tree( Tree const& tree )
+{
+    return insert_splits_( compute_splits_( tree ));
+}
+
+std::vector<std::vector<SplitTable::SplitId>> SplitTable::add_trees(
+    TreeSet const& trees,
+    size_t block_size
+) {
+    auto result = std::vector<std::vector<SplitId>>( trees.size() );
+    block_size = std::max<size_t>( block_size, 1 );
+
+    auto splits = std::vector<TreeSplits>();
+    auto errors = std::vector<std::exception_ptr>();
+    for( size_t begin = 0; begin < trees.size(); begin += block_size ) {
+        auto const end = std::min( begin + block_size, trees.size() );
+
+        // Compute the splits of the trees of the block in parallel. We cannot throw from within
+        // the parallel region, so we store errors to re-throw them later.
+        splits.assign( end - begin, TreeSplits() );
+        errors.assign( end - begin, nullptr );
+        #pragma omp parallel for schedule(dynamic)
+        for( size_t i = begin; i < end; ++i ) {
+            try {
+                splits[ i - begin ] = compute_splits_( trees[i] );
+            } catch( ... ) {
+                errors[ i - begin ] = std::current_exception();
+            }
+        }
+        for( auto const& error : errors ) {
+            if( error ) {
+                std::rethrow_exception( error );
+            }
+        }
+
+        // Add them in order, so that the ids do not depend on the scheduling.
+        for( size_t i = begin; i < end; ++i ) {
+            result[i] = insert_splits_( splits[ i - begin ] );
+            splits[ i - begin ] = TreeSplits();
+        }
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Pruning
+// =================================================================================================
+
+void SplitTable::retain_most_frequent( size_t max_splits )
+{
+    if( max_splits >= hashes_.size() ) {
+        return;
+    }
+
+    // Find the most frequent splits, and keep them in their original order.
+    auto order = std::vector<SplitId>( hashes_.size() );
+    for( size_t i = 0; i < order.size(); ++i ) {
+        order[i] = static_cast<SplitId>( i );
+    }
+    std::stable_sort( order.begin(), order.end(), [&]( SplitId lhs, SplitId rhs ){
+        return frequencies_[ lhs ] > frequencies_[ rhs ];
+    });
+    order.resize( max_splits );
+    std::sort( order.begin(), order.end() );
+    retain_splits_( order );
+}
+
+void SplitTable::reduce_to_frequent( size_t max_splits )
+{
+    if( max_splits >= hashes_.size() ) {
+        return;
+    }
+
+    // Get the frequency at rank max_splits + 1. All splits that are more frequent are kept,
+    // which are at most max_splits many.
+    auto sorted = frequencies_;
+    std::nth_element(
+        sorted.begin(), sorted.begin() + max_splits, sorted.end(), std::greater<size_t>()
+    );
+    auto const decrement = sorted[ max_splits ];
+    sorted = std::vector<size_t>();
+
+    auto kept = std::vector<SplitId>();
+    for( size_t i = 0; i < frequencies_.size(); ++i ) {
+        if( frequencies_[i] > decrement ) {
+            kept.push_back( static_cast<SplitId>( i ));
+        }
+    }
+    assert( kept.size() <= max_splits );
+    retain_splits_( kept );
+
+    for( auto& frequency : frequencies_ ) {
+        assert( frequency > decrement );
+        frequency -= decrement;
+    }
+    frequency_error_ += decrement;
+}
+
+// =================================================================================================
+//     Internal Helpers
+// =================================================================================================
+
+void SplitTable::retain_splits_( std::vector<SplitId> const& ids )
+{
+    // Rebuild all data with the new ids, in the order of the given old ids.
+    auto const invalid = std::numeric_limits<SplitId>::max();
+    auto hashes      = std::vector<SplitHash>();
+    auto frequencies = std::vector<size_t>();
+    auto bitvectors  = std::vector<utils::Bitvector>();
+    hashes.reserve( ids.size() );
+    frequencies.reserve( ids.size() );
+    ids_.clear();
+    collisions_.clear();
+
+    for( auto const old_id : ids ) {
+        auto const id = static_cast<SplitId>( hashes.size() );
+        hashes.push_back( hashes_[ old_id ] );
+        frequencies.push_back( frequencies_[ old_id ] );
+        if( verify_ ) {
+            bitvectors.push_back( std::move( bitvectors_[ old_id ] ));
+            collisions_.push_back( invalid );
+        }
+
+        // Add the split to the map, or, if its hash collides, to the end of the chain.
+        auto const it = ids_.find( hashes_[ old_id ] );
+        if( it == ids_.end() ) {
+            ids_.emplace( hashes_[ old_id ], id );
+        } else {
+            assert( verify_ );
+            auto last = it->second;
+            while( collisions_[ last ] != invalid ) {
+                last = collisions_[ last ];
+            }
+            collisions_[ last ] = id;
+        }
+    }
+
+    hashes_      = std::move( hashes );
+    frequencies_ = std::move( frequencies );
+    bitvectors_  = std::move( bitvectors );
+}
+
+SplitTable::TreeSplits SplitTable::compute_splits_( Tree const& tree ) const
+{
+    using utils::Bitvector;
+
+    TreeSplits result;
+    result.hashes.reserve( inner_edge_count( tree ));
+    if( verify_ ) {
+        result.bitvectors.reserve( inner_edge_count( tree ));
+    }
+
+    // Intermediate hashes and bitvectors for each edge, which are not yet normalized,
+    // and whether the subtree of the edge contains the taxon with index 0.
+    auto edge_hashes  = std::vector<SplitHash>( tree.edge_count() );
+    auto edge_bitvecs = std::vector<Bitvector>( verify_ ? tree.edge_count() : 0 );
+    auto edge_first   = std::vector<bool>( tree.edge_count(), false );
+
+    // We also keep track of names: each one needs to appear exactly once!
+    auto name_check = Bitvector( names_.size() );
+
+    // Same as in rf_get_bitvectors(): In rooted trees, one of the two root edges is skipped,
+    // as they induce the same split.
+    size_t root_skip = std::numeric_limits<size_t>::max();
+    if( is_rooted( tree )) {
+        assert( degree( tree.root_node()) == 2 );
+        root_skip = tree.root_node().primary_edge().secondary_node().index();
+    }
+
+    for( auto it : postorder( tree )) {
+        // We iterate edges, so we can skip the root node.
+        if( it.is_last_iteration() ) {
+            continue;
+        }
+        auto const eidx = it.edge().index();
+
+        if( is_leaf( it.node() )) {
+
+            // Get the index of the name of the leaf, and check that it did not appear yet.
+            auto const& name = it.node().data<CommonNodeData>().name;
+            auto const nit = names_.find( name );
+            if( nit == names_.end() ) {
+                throw std::runtime_error(
+                    "Cannot calculate splits with inconsistent node names. "
+                    "Name '" + name + "' is missing from a tree."
+                );
+            }
+            if( name_check[ nit->second ] ) {
+                throw std::runtime_error(
+                    "Cannot calculate splits of tree that has duplicate node names. "
+                    "Name '"+ name + "' appears multiple times."
+                );
+            }
+            name_check.set( nit->second );
+
+            // Trivial splits are not reported, but needed for the inner ones.
+            edge_hashes[ eidx ] = taxon_hashes_[ nit->second ];
+            edge_first[ eidx ]  = ( nit->second == 0 );
+            if( verify_ ) {
+                edge_bitvecs[ eidx ] = Bitvector( names_.size() );
+                edge_bitvecs[ eidx ].set( nit->second );
+            }
+
+        } else {
+
+            // Combine the subtrees of the node. The order of the postorder traversal makes sure
+            // that they have been processed already.
+            SplitHash hash;
+            bool first = false;
+            if( verify_ ) {
+                edge_bitvecs[ eidx ] = Bitvector( names_.size() );
+            }
+            for( auto l = &it.link().next(); l != &it.link(); l = &l->next() ) {
+                auto const sidx = l->edge().index();
+                hash  ^= edge_hashes[ sidx ];
+                first |= edge_first[ sidx ];
+                if( verify_ ) {
+                    edge_bitvecs[ eidx ] |= edge_bitvecs[ sidx ];
+                }
+            }
+            edge_hashes[ eidx ] = hash;
+            edge_first[ eidx ]  = first;
+
+            // Report the normalized split, that is, the side without taxon 0.
+            if( it.node().index() != root_skip ) {
+                if( first ) {
+                    hash ^= all_taxa_hash_;
+                }
+                result.hashes.push_back( hash );
+                if( verify_ ) {
+                    result.bitvectors.push_back( edge_bitvecs[ eidx ] );
+                    result.bitvectors.back().normalize();
+                }
+            }
+        }
+    }
+
+    if( name_check.count() != names_.size() ) {
+        throw std::runtime_error(
+            "Cannot calculate splits of trees that have different node names. "
+            "Some names are missing from one of the trees."
+        );
+    }
+    return result;
+}
+
+std::vector<SplitTable::SplitId> SplitTable::insert_splits_( TreeSplits const& splits )
+{
+    assert( ! verify_ || splits.bitvectors.size() == splits.hashes.size() );
+
+    auto result = std::vector<SplitId>( splits.hashes.size() );
+    for( size_t i = 0; i < splits.hashes.size(); ++i ) {
+        result[i] = find_or_insert_split_( splits, i );
+    }
+
+    // Inner nodes of degree two yield the same split twice, which we only count once.
+    std::sort( result.begin(), result.end() );
+    result.erase( std::unique( result.begin(), result.end() ), result.end() );
+    for( auto const id : result ) {
+        ++frequencies_[ id ];
+    }
+    ++tree_count_;
+    return result;
+}
+
+SplitTable::SplitId SplitTable::find_or_insert_split_( TreeSplits const& splits, size_t index )
+{
+    auto const invalid = std::numeric_limits<SplitId>::max();
+    auto const& hash = splits.hashes[ index ];
+
+    // Add a new split with the given hash, and return its id.
+    auto make_split = [&](){
+        if( hashes_.size() >= static_cast<size_t>( invalid )) {
+            throw std::runtime_error( "Too many unique splits for a SplitTable." );
+        }
+        auto const id = static_cast<SplitId>( hashes_.size() );
+        hashes_.push_back( hash );
+        frequencies_.push_back( 0 );
+        if( verify_ ) {
+            collisions_.push_back( invalid );
+            bitvectors_.push_back( splits.bitvectors[ index ] );
+        }
+        return id;
+    };
+
+    auto const it = ids_.find( hash );
+    if( it == ids_.end() ) {
+        auto const id = make_split();
+        ids_.emplace( hash, id );
+        return id;
+    }
+    if( ! verify_ ) {
+        return it->second;
+    }
+
+    // Walk the chain of splits with the same hash, and compare their bitvectors.
+    auto id = it->second;
+    while( bitvectors_[ id ] != splits.bitvectors[ index ] ) {
+        if( collisions_[ id ] == invalid ) {
+            auto const new_id = make_split();
+            collisions_[ id ] = new_id;
+            return new_id;
+        }
+        id = collisions_[ id ];
+    }
+    return id;
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,362 @@
+#ifndef GENESIS_TREE_BIPARTITION_SPLIT_TABLE_H_
+#define GENESIS_TREE_BIPARTITION_SPLIT_TABLE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/utils/math/bitvector.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Tree;
+class TreeSet;
+
+// =================================================================================================
+//     Split Hash
+// =================================================================================================
+
+/**
+ * @brief Number of random bits that are used for the hash of a split in a SplitTable.
+ *
+ * With `k64`, two different splits get the same hash with probability of about `2^-64` per pair
+ * of splits, which is enough for most data sets. Use `k128` if that is not good enough,
+ * or use the `verify` option of the SplitTable to resolve collisions exactly.
+ */
+enum class SplitHashWidth
+{
+    k64,
+    k128
+};
+
+/**
+ * @brief Randomized hash of a split, as computed by a SplitTable.
+ *
+ * For 64 bit hashes, only the @p low word is used, and the @p high word is always zero.
+ */
+struct SplitHash
+{
+    std::uint64_t low  = 0;
+    std::uint64_t high = 0;
+
+    SplitHash& operator ^= ( SplitHash const& other )
+    {
+        low  ^= other.low;
+        high ^= other.high;
+        return *this;
+    }
+
+    bool operator == ( SplitHash const& other ) const
+    {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator != ( SplitHash const& other ) const
+    {
+        return !( *this == other );
+    }
+};
+
+/**
+ * @brief Helper structure that yields a `std::size_t` hash of a SplitHash,
+ * for use in containers such as `std::unordered_map`.
+ *
+ * As the words of a SplitHash are random already, we simply combine them.
+ */
+struct SplitHashHasher
+{
+    std::size_t operator() ( SplitHash const& value ) const
+    {
+        return static_cast<std::size_t>( value.low ^ ( value.high * 0x9E3779B97F4A7C15ULL ));
+    }
+};
+
+// =================================================================================================
+//     Split Table
+// =================================================================================================
+
+/**
+ * @brief Table of the unique splits of a set of Tree%s, identified by randomized hashes.
+ *
+ * The functions in rf.hpp that work on utils::Bitvector%s need a full bitvector of all taxa for
+ * each split, and hashing and comparing those is expensive for large trees. Instead, this class
+ * assigns a random 64 or 128 bit word to each taxon, see SplitHashWidth. The hash of a split
+ * is then the xor of the words of all taxa on the side of the split that does not contain the
+ * taxon with index 0, which is the same normalization as Bitvector::normalize() does.
+ * This way, the hashes of all splits of a Tree are computed in a single postorder traversal.
+ *
+ * Each unique split that is added to the table gets a consecutive SplitId. Adding a Tree yields
+ * the sorted list of the ids of its splits, which is a compact representation of the Tree that
+ * can for example be used for computing RF distances, see rf_get_split_ids().
+ * Furthermore, the table counts in how many of the added Tree%s each split occurs,
+ * see split_frequency().
+ *
+ * If `verify` is set, the table additionally stores the Bitvector of each unique split,
+ * and compares it whenever a split with the same hash is added. Splits that collide are then
+ * stored separately, so that the result is exact. This of course needs more time and memory,
+ * but also allows to access the split_bitvector()s afterwards.
+ *
+ * As with rf_get_bitvectors(), only the splits of inner edges are considered, and a rooted tree
+ * contributes the split of its two root edges only once.
+ */
+class SplitTable
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs
+    // -------------------------------------------------------------------------
+
+    using SplitId = std::uint32_t;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Create a table for Tree%s with the given taxon @p names,
+     * as obtained from rf_taxon_name_map().
+     *
+     * The @p seed is used for the random words of the taxa. Split ids and hashes are only
+     * comparable between tables that were created with the same names, width and seed.
+     */
+    SplitTable(
+        std::unordered_map<std::string, size_t> const& names,
+        SplitHashWidth width = SplitHashWidth::k64,
+        bool verify = false,
+        std::uint64_t seed = 0
+    );
+
+    ~SplitTable() = default;
+
+    SplitTable( SplitTable const& ) = default;
+    SplitTable( SplitTable&& )      = default;
+
+    SplitTable& operator= ( SplitTable const& ) = default;
+    SplitTable& operator= ( SplitTable&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    size_t taxon_count() const
+    {
+        return names_.size();
+    }
+
+    /**
+     * @brief Return the mapping from taxon names to their indices, as used for the splits.
+     */
+    std::unordered_map<std::string, size_t> const& taxon_names() const
+    {
+        return names_;
+    }
+
+    /**
+     * @brief Return the number of unique splits that were added so far.
+     */
+    size_t split_count() const
+    {
+        return frequencies_.size();
+    }
+
+    /**
+     * @brief Return the number of Tree%s that were added so far.
+     */
+    size_t tree_count() const
+    {
+        return tree_count_;
+    }
+
+    bool verify() const
+    {
+        return verify_;
+    }
+
+    /**
+     * @brief Return the number of added Tree%s that contain the split with the given id.
+     *
+     * After reduce_to_frequent(), this is a lower bound of the true number, which is at most
+     * frequency_error() higher.
+     */
+    size_t split_frequency( SplitId id ) const
+    {
+        assert( id < frequencies_.size() );
+        return frequencies_[ id ];
+    }
+
+    /**
+     * @brief Return how much the split_frequency() of any split can be below its true value,
+     * due to reduce_to_frequent().
+     */
+    size_t frequency_error() const
+    {
+        return frequency_error_;
+    }
+
+    /**
+     * @brief Return the hash of the split with the given id.
+     */
+    SplitHash split_hash( SplitId id ) const
+    {
+        assert( id < hashes_.size() );
+        return hashes_[ id ];
+    }
+
+    /**
+     * @brief Return the normalized Bitvector of the split with the given id.
+     *
+     * This is only available if the table was created with `verify` set.
+     */
+    utils::Bitvector const& split_bitvector( SplitId id ) const;
+
+    // -------------------------------------------------------------------------
+    //     Adding Trees
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Compute the normalized hashes of all splits of a Tree, without adding them.
+     *
+     * The order is the same as for rf_get_bitvectors(). Duplicate splits, as induced by inner
+     * nodes of degree two, are kept.
+     */
+    std::vector<SplitHash> split_hashes( Tree const& tree ) const;
+
+    /**
+     * @brief Add the splits of a Tree to the table, and return their sorted and unique ids.
+     */
+    std::vector<SplitId> add_tree( Tree const& tree );
+
+    /**
+     * @brief Add the splits of all Tree%s in a TreeSet to the table, and return the sorted
+     * and unique ids for each of them.
+     *
+     * The splits of the Tree%s are computed in parallel, and then added in the order of the
+     * TreeSet, so that the ids are the same as when calling add_tree() for each Tree in turn.
+     * This is done in blocks of @p block_size Tree%s, so that only the splits of one block are
+     * kept in memory at a time before they are added to the table.
+     */
+    std::vector<std::vector<SplitId>> add_trees( TreeSet const& trees, size_t block_size = 1024 );
+
+    // -------------------------------------------------------------------------
+    //     Pruning
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Remove all but the @p max_splits most frequent splits from the table.
+     *
+     * This bounds the memory of the table when adding many Tree%s, for example when only the
+     * frequent splits are of interest, as for a consensus_tree(). Splits with the same frequency
+     * are kept in the order in which they were first added. The remaining splits get new
+     * consecutive ids in that order, so that any previously obtained ids become invalid.
+     *
+     * A split that is removed and later added again starts counting from zero, so that its
+     * split_frequency() is an underestimate, by an amount that is not tracked. This only affects
+     * splits that were rare at the time of pruning. Use reduce_to_frequent() for a bounded error.
+     */
+    void retain_most_frequent( size_t max_splits );
+
+    /**
+     * @brief Reduce the table to at most @p max_splits splits, with a guaranteed bound on the
+     * error of their frequencies.
+     *
+     * This is the merge step of the Misra-Gries frequent items summary: If there are more than
+     * @p max_splits splits, the frequency `d` of the split at rank `max_splits + 1` is subtracted
+     * from all frequencies, and the splits that are left with a frequency of zero are removed.
+     * Hence, each split_frequency() is at most the true number of Tree%s containing the split,
+     * and at most frequency_error() below it, which is the sum of all such `d`. This error is at
+     * most `N / ( max_splits + 1 )`, where `N` is the total number of splits of all added Tree%s,
+     * that is, the number of Tree%s times their number of splits. Any split that is contained in
+     * more than that number of Tree%s is guaranteed to still be in the table.
+     *
+     * As with retain_most_frequent(), the remaining splits get new consecutive ids in the order
+     * in which they were first added, so that any previously obtained ids become invalid.
+     */
+    void reduce_to_frequent( size_t max_splits );
+
+    // -------------------------------------------------------------------------
+    //     Internal Helpers
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Hashes of all splits of one Tree, and, if needed for verification, their Bitvectors.
+     */
+    struct TreeSplits
+    {
+        std::vector<SplitHash>        hashes;
+        std::vector<utils::Bitvector> bitvectors;
+    };
+
+    void retain_splits_( std::vector<SplitId> const& ids );
+
+    TreeSplits compute_splits_( Tree const& tree ) const;
+    std::vector<SplitId> insert_splits_( TreeSplits const& splits );
+    SplitId find_or_insert_split_( TreeSplits const& splits, size_t index );
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    std::unordered_map<std::string, size_t> names_;
+    std::vector<SplitHash> taxon_hashes_;
+    SplitHash              all_taxa_hash_;
+    bool                   verify_;
+
+    // Map from split hashes to the id of the first split with that hash. If verification is used,
+    // further splits with the same hash are chained via collisions_, ending in an invalid id.
+    std::unordered_map<SplitHash, SplitId, SplitHashHasher> ids_;
+    std::vector<SplitId>          collisions_;
+    std::vector<SplitHash>        hashes_;
+    std::vector<size_t>           frequencies_;
+    std::vector<utils::Bitvector> bitvectors_;
+
+    size_t tree_count_      = 0;
+    size_t frequency_error_ = 0;
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
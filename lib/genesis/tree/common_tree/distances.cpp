@@ -30,6 +30,7 @@
 
 #include "genesis/tree/common_tree/distances.hpp"
 
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/functions.hpp"
 #include "genesis/tree/function/lca_lookup.hpp"
 #include "genesis/tree/iterator/levelorder.hpp"
@@ -118,6 +119,17 @@ utils::Matrix<double> node_branch_length_distance_matrix(
     return result;
 }
 
+utils::Matrix<double> node_branch_length_distance_matrix(
+    FlatTree const& tree
+) {
+    if( ! tree.has_branch_lengths() ) {
+        throw std::runtime_error(
+            "Cannot calculate branch length distances on a FlatTree without branch lengths."
+        );
+    }
+    return flat_tree_node_distance_matrix( tree, tree.branch_lengths() );
+}
+
 std::vector<double> node_branch_length_distance_vector(
     Tree const& tree,
     TreeNode const* node
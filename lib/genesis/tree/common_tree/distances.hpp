@@ -39,6 +39,12 @@
 namespace genesis {
 namespace tree {
 
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class FlatTree;
+
 // =================================================================================================
 //     Branch Distance Measures
 // =================================================================================================
@@ -53,6 +59,18 @@ utils::Matrix<double> node_branch_length_distance_matrix(
     Tree const& tree
 );
 
+/**
+ * @brief Return a distance matrix containing pairwise distances between all nodes of a FlatTree,
+ * using its branch lengths as distance measurement.
+ *
+ * The result is the same as for the Tree that the FlatTree was built from. The FlatTree needs
+ * to have branch lengths, see FlatTree::has_branch_lengths(); otherwise, an exception is thrown.
+ * See flat_tree_node_distance_matrix() for details on the computation.
+ */
+utils::Matrix<double> node_branch_length_distance_matrix(
+    FlatTree const& tree
+);
+
 /**
  * @brief Return a vector containing the distance of all nodes with respect to the given start node,
  * where distance is measured in the sum of branch lengths between the nodes.
@@ -0,0 +1,78 @@
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
+
+#include "genesis/tree/common_tree/distances.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include <cassert>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Construction and Rule of Five
+// =================================================================================================
+
+TreeDistanceOracle::TreeDistanceOracle( Tree const& tree )
+    : lca_lookup_( tree )
+    , root_distances_( node_branch_length_distance_vector( tree ))
+{}
+
+// =================================================================================================
+//     Lookup
+// =================================================================================================
+
+std::vector<double> TreeDistanceOracle::distances(
+    std::vector<std::pair<size_t, size_t>> const& node_index_pairs,
+    LcaBatchMethod method
+) const {
+    // The lookup also checks the indices.
+    auto const lcas = lca_lookup_( node_index_pairs, method );
+    assert( lcas.size() == node_index_pairs.size() );
+
+    auto result = std::vector<double>( node_index_pairs.size() );
+    #pragma omp parallel for
+    for( size_t i = 0; i < node_index_pairs.size(); ++i ) {
+        auto const a = node_index_pairs[i].first;
+        auto const b = node_index_pairs[i].second;
+        if( a == b ) {
+            result[i] = 0.0;
+        } else {
+            result[i] = root_distances_[a] + root_distances_[b] - 2.0 * root_distances_[ lcas[i] ];
+        }
+    }
+    return result;
+}
+
+} // namespace tree
+} // namespace genesis
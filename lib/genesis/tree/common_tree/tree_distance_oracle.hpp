@@ -0,0 +1,207 @@
+#ifndef GENESIS_TREE_COMMON_TREE_TREE_DISTANCE_ORACLE_H_
+#define GENESIS_TREE_COMMON_TREE_TREE_DISTANCE_ORACLE_H_
+
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/function/lca_lookup.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Tree;
+
+// =================================================================================================
+//     Tree Distance Oracle
+// =================================================================================================
+
+/**
+ * @brief Look up the branch length distance between any two nodes of a Tree, using memory that is
+ * linear in the size of the Tree.
+ *
+ * The distance between two nodes is the sum of the branch lengths on the path between them.
+ * This is what node_branch_length_distance_matrix() computes for all pairs of nodes at once.
+ * That matrix however needs quadratic memory, which is too much for large trees. This class
+ * instead stores the distance of each node to the root, and uses an LcaLookup to find the lowest
+ * common ancestor (LCA) of two nodes. The distance between two nodes `a` and `b` is then
+ *
+ *     root_distance( a ) + root_distance( b ) - 2 * root_distance( lca( a, b ))
+ *
+ * which takes constant time per query. The results are the same as the entries of the distance
+ * matrix, apart from rounding differences.
+ *
+ * The class offers operator() with the same signature as the matrix, so that it can be used in
+ * its place. Several placement measures offer overloads that take an instance of this class,
+ * for example edpl(), pairwise_distance(), variance(), node_histogram_distance() and
+ * center_of_gravity_distance().
+ *
+ * All edges of the Tree need to have data that derives from CommonEdgeData. As with the LcaLookup,
+ * the Tree needs to outlive the instance of this class.
+ */
+class TreeDistanceOracle
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Construction and Rule of Five
+    // -------------------------------------------------------------------------
+
+    TreeDistanceOracle() = default;
+    explicit TreeDistanceOracle( Tree const& tree );
+
+    ~TreeDistanceOracle() = default;
+
+    TreeDistanceOracle( TreeDistanceOracle const& ) = default;
+    TreeDistanceOracle( TreeDistanceOracle&& )      = default;
+
+    TreeDistanceOracle& operator= ( TreeDistanceOracle const& ) = default;
+    TreeDistanceOracle& operator= ( TreeDistanceOracle&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    size_t node_count() const
+    {
+        return root_distances_.size();
+    }
+
+    /**
+     * @brief Return the branch length distance of a node to the root of the Tree.
+     */
+    double root_distance( size_t node_index ) const
+    {
+        assert( node_index < root_distances_.size() );
+        return root_distances_[ node_index ];
+    }
+
+    /**
+     * @brief Return the branch length distances of all nodes to the root of the Tree,
+     * indexed by node index.
+     */
+    std::vector<double> const& root_distances() const
+    {
+        return root_distances_;
+    }
+
+    LcaLookup const& lca_lookup() const
+    {
+        return lca_lookup_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Lookup
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the index of the lowest common ancestor of two nodes,
+     * with respect to the root of the Tree.
+     */
+    size_t lca( size_t node_index_a, size_t node_index_b ) const
+    {
+        return lca_lookup_( node_index_a, node_index_b );
+    }
+
+    /**
+     * @brief Return the branch length distance between two nodes.
+     */
+    double distance( size_t node_index_a, size_t node_index_b ) const
+    {
+        if( node_index_a == node_index_b ) {
+            return 0.0;
+        }
+        auto const lca_index = lca( node_index_a, node_index_b );
+        return root_distances_[ node_index_a ] + root_distances_[ node_index_b ]
+            - 2.0 * root_distances_[ lca_index ]
+        ;
+    }
+
+    /**
+     * @brief Return the branch length distance between two nodes.
+     *
+     * This is the same as distance(), and offered so that the class can be used in place of the
+     * matrix of node_branch_length_distance_matrix().
+     */
+    double operator()( size_t node_index_a, size_t node_index_b ) const
+    {
+        return distance( node_index_a, node_index_b );
+    }
+
+    /**
+     * @brief Return the branch length distances between a batch of pairs of nodes.
+     *
+     * The LCAs of all pairs are looked up at once, see
+     * @link LcaLookup::operator()( std::vector<std::pair<size_t, size_t>> const&, LcaBatchMethod ) const
+     * LcaLookup::operator()@endlink for the @p method.
+     */
+    std::vector<double> distances(
+        std::vector<std::pair<size_t, size_t>> const& node_index_pairs,
+        LcaBatchMethod method = LcaBatchMethod::kAutomatic
+    ) const;
+
+    /**
+     * @brief Return whether the node @p other_index is on the root side of the node @p node_index.
+     *
+     * The value is `1` if the @p other_index node is in the subtree of @p node_index that contains
+     * the root, `-1` if it is in one of the other subtrees, and `0` if both are the same node.
+     * This is the same as the entries of node_root_direction_matrix().
+     */
+    signed char root_direction( size_t node_index, size_t other_index ) const
+    {
+        if( node_index == other_index ) {
+            return 0;
+        }
+        return lca( node_index, other_index ) == node_index ? -1 : 1;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    LcaLookup           lca_lookup_;
+    std::vector<double> root_distances_;
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,122 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/flat_tree.hpp"
+
+#include "genesis/tree/common_tree/tree.hpp"
+#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/iterator/preorder.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include <limits>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constants
+// =================================================================================================
+
+const size_t FlatTree::InvalidIndex = std::numeric_limits<size_t>::max();
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+FlatTree::FlatTree( Tree const& tree )
+{
+    if( tree.empty() ) {
+        return;
+    }
+
+    auto const node_count = tree.node_count();
+    auto const edge_count = tree.edge_count();
+    root_node_ = tree.root_node().index();
+
+    // Edges. Also collect the branch lengths, if all edges have them.
+    edge_primary_node_.resize( edge_count );
+    edge_secondary_node_.resize( edge_count );
+    branch_lengths_.resize( edge_count );
+    bool all_branch_lengths = true;
+    parent_node_.assign( node_count, InvalidIndex );
+    parent_edge_.assign( node_count, InvalidIndex );
+    for( auto const& edge : tree.edges() ) {
+        auto const pi = edge.primary_node().index();
+        auto const si = edge.secondary_node().index();
+        edge_primary_node_[ edge.index() ]   = pi;
+        edge_secondary_node_[ edge.index() ] = si;
+        parent_node_[ si ] = pi;
+        parent_edge_[ si ] = edge.index();
+
+        auto const data = edge.data_cast<CommonEdgeData>();
+        if( data ) {
+            branch_lengths_[ edge.index() ] = data->branch_length;
+        } else {
+            all_branch_lengths = false;
+        }
+    }
+    if( ! all_branch_lengths ) {
+        branch_lengths_.clear();
+    }
+
+    // Children, in the order of the links. For the root, all its links lead to children,
+    // for all other nodes, we skip the link that leads to the parent.
+    child_offsets_.reserve( node_count + 1 );
+    children_.reserve( node_count > 0 ? node_count - 1 : 0 );
+    for( auto const& node : tree.nodes() ) {
+        child_offsets_.push_back( children_.size() );
+
+        auto const start = &node.primary_link();
+        if( node.index() == root_node_ ) {
+            children_.push_back( start->outer().node().index() );
+        }
+        for( auto link = &start->next(); link != start; link = &link->next() ) {
+            children_.push_back( link->outer().node().index() );
+        }
+    }
+    child_offsets_.push_back( children_.size() );
+
+    // Traversal orders, as given by the iterators.
+    postorder_.reserve( node_count );
+    for( auto it : tree::postorder( tree )) {
+        postorder_.push_back( it.node().index() );
+    }
+    preorder_.reserve( node_count );
+    preorder_position_.resize( node_count );
+    for( auto it : tree::preorder( tree )) {
+        preorder_position_[ it.node().index() ] = preorder_.size();
+        preorder_.push_back( it.node().index() );
+    }
+    assert( postorder_.size() == node_count );
+    assert( preorder_.size()  == node_count );
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,386 @@
+#ifndef GENESIS_TREE_FLAT_TREE_H_
+#define GENESIS_TREE_FLAT_TREE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/utils/containers/matrix.hpp"
+#include "genesis/utils/core/range.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Tree;
+
+// =================================================================================================
+//     Flat Tree
+// =================================================================================================
+
+/**
+ * @brief Immutable, array based representation of the topology of a Tree.
+ *
+ * A Tree stores its elements and their data each behind their own pointers, which is flexible,
+ * but makes every traversal step follow several pointers. For read-only analyses on large trees,
+ * this class stores the topology of a Tree in a few contiguous arrays instead:
+ *
+ *   * For each node: the index of its parent node and of the edge towards the parent,
+ *     and its children, stored as offsets into one array of child node indices.
+ *   * For each edge: its primary and secondary node, and its branch length.
+ *   * The order of the nodes in a postorder() and a preorder() traversal from the root,
+ *     as computed by the respective Tree iterators.
+ *
+ * All indices are the same as in the Tree that the FlatTree was built from, so that results can
+ * be used interchangeably. Traversals then become linear scans over these arrays, for example:
+ *
+ *     for( auto node_index : flat.postorder() ) {
+ *         if( node_index != flat.root_node() ) {
+ *             auto const edge_index = flat.parent_edge( node_index );
+ *             ...
+ *         }
+ *     }
+ *
+ * Several functions offer overloads that work on a FlatTree, such as subtree_sizes(),
+ * node_path_length_matrix(), node_branch_length_distance_matrix(), edpl(), and
+ * earth_movers_distance().
+ *
+ * The FlatTree does not keep a reference to the Tree. If the Tree is changed afterwards,
+ * a new FlatTree needs to be built.
+ */
+class FlatTree
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs and Constants
+    // -------------------------------------------------------------------------
+
+    using IndexRange = utils::Range< std::vector<size_t>::const_iterator >;
+
+    /**
+     * @brief Value used for the parent_node() and parent_edge() of the root node.
+     */
+    static const size_t InvalidIndex;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    FlatTree() = default;
+
+    /**
+     * @brief Build the FlatTree from the topology of a Tree.
+     *
+     * If all edges of the Tree have data that derives from CommonEdgeData, their branch lengths
+     * are copied as well, see has_branch_lengths().
+     */
+    explicit FlatTree( Tree const& tree );
+
+    ~FlatTree() = default;
+
+    FlatTree( FlatTree const& ) = default;
+    FlatTree( FlatTree&& )      = default;
+
+    FlatTree& operator= ( FlatTree const& ) = default;
+    FlatTree& operator= ( FlatTree&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Sizes and Root
+    // -------------------------------------------------------------------------
+
+    bool empty() const
+    {
+        return parent_node_.empty();
+    }
+
+    size_t node_count() const
+    {
+        return parent_node_.size();
+    }
+
+    size_t edge_count() const
+    {
+        return edge_primary_node_.size();
+    }
+
+    size_t root_node() const
+    {
+        return root_node_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Nodes
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the index of the node towards the root, or InvalidIndex for the root.
+     */
+    size_t parent_node( size_t node_index ) const
+    {
+        assert( node_index < parent_node_.size() );
+        return parent_node_[ node_index ];
+    }
+
+    /**
+     * @brief Return the index of the edge towards the root, or InvalidIndex for the root.
+     */
+    size_t parent_edge( size_t node_index ) const
+    {
+        assert( node_index < parent_edge_.size() );
+        return parent_edge_[ node_index ];
+    }
+
+    /**
+     * @brief Return the number of nodes that are adjacent to the node away from the root.
+     */
+    size_t child_count( size_t node_index ) const
+    {
+        assert( node_index + 1 < child_offsets_.size() );
+        return child_offsets_[ node_index + 1 ] - child_offsets_[ node_index ];
+    }
+
+    /**
+     * @brief Return the indices of the nodes that are adjacent to the node away from the root,
+     * in the order of their links in the Tree.
+     */
+    IndexRange children( size_t node_index ) const
+    {
+        assert( node_index + 1 < child_offsets_.size() );
+        return IndexRange(
+            children_.cbegin() + child_offsets_[ node_index ],
+            children_.cbegin() + child_offsets_[ node_index + 1 ]
+        );
+    }
+
+    /**
+     * @brief Return the number of nodes adjacent to the node, that is, its number of children,
+     * plus one for the parent if the node is not the root.
+     */
+    size_t degree( size_t node_index ) const
+    {
+        return child_count( node_index ) + ( node_index == root_node_ ? 0 : 1 );
+    }
+
+    bool is_leaf( size_t node_index ) const
+    {
+        return degree( node_index ) == 1;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Edges
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the index of the node of the edge that is closer to the root.
+     */
+    size_t primary_node( size_t edge_index ) const
+    {
+        assert( edge_index < edge_primary_node_.size() );
+        return edge_primary_node_[ edge_index ];
+    }
+
+    /**
+     * @brief Return the index of the node of the edge that is further away from the root.
+     */
+    size_t secondary_node( size_t edge_index ) const
+    {
+        assert( edge_index < edge_secondary_node_.size() );
+        return edge_secondary_node_[ edge_index ];
+    }
+
+    /**
+     * @brief Return whether the branch lengths of the Tree were copied.
+     */
+    bool has_branch_lengths() const
+    {
+        return branch_lengths_.size() == edge_primary_node_.size();
+    }
+
+    double branch_length( size_t edge_index ) const
+    {
+        assert( edge_index < branch_lengths_.size() );
+        return branch_lengths_[ edge_index ];
+    }
+
+    /**
+     * @brief Return the branch lengths of all edges, indexed by edge index.
+     */
+    std::vector<double> const& branch_lengths() const
+    {
+        return branch_lengths_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Traversal Orders
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the node indices in postorder, starting at a leaf, and ending with the root.
+     *
+     * The order is the same as the one of the postorder() iterator of the Tree.
+     */
+    std::vector<size_t> const& postorder() const
+    {
+        return postorder_;
+    }
+
+    /**
+     * @brief Return the node indices in preorder, starting at the root.
+     *
+     * The order is the same as the one of the preorder() iterator of the Tree. In this order,
+     * all nodes of a subtree are contiguous, see preorder_position().
+     */
+    std::vector<size_t> const& preorder() const
+    {
+        return preorder_;
+    }
+
+    /**
+     * @brief Return the position of a node in the preorder() list.
+     *
+     * The nodes of the subtree below a node are the ones following it in the preorder, that is,
+     * the node with index `i` and the `subtree_sizes( flat )[i]` next ones.
+     */
+    size_t preorder_position( size_t node_index ) const
+    {
+        assert( node_index < preorder_position_.size() );
+        return preorder_position_[ node_index ];
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    size_t root_node_ = 0;
+
+    std::vector<size_t> parent_node_;
+    std::vector<size_t> parent_edge_;
+    std::vector<size_t> child_offsets_;
+    std::vector<size_t> children_;
+
+    std::vector<size_t> edge_primary_node_;
+    std::vector<size_t> edge_secondary_node_;
+    std::vector<double> branch_lengths_;
+
+    std::vector<size_t> postorder_;
+    std::vector<size_t> preorder_;
+    std::vector<size_t> preorder_position_;
+
+};
+
+// =================================================================================================
+//     Flat Tree Functions
+// =================================================================================================
+
+/**
+ * @brief Return a matrix of the distances between all pairs of nodes of a FlatTree, where the
+ * distance is the sum of the @p edge_weights (indexed by edge index) on the path between them.
+ *
+ * This is the basis for the FlatTree versions of node_path_length_matrix() and
+ * node_branch_length_distance_matrix(). The distances from the root are accumulated in preorder.
+ * Then, the row of each further node is computed from the row of its parent: nodes in the subtree
+ * of the node are one edge closer, all others one edge further away. As the subtree is a
+ * contiguous range of the preorder, each row is computed in one linear pass.
+ */
+template< typename T >
+utils::Matrix<T> flat_tree_node_distance_matrix(
+    FlatTree const&       tree,
+    std::vector<T> const& edge_weights
+) {
+    if( edge_weights.size() != tree.edge_count() ) {
+        throw std::invalid_argument(
+            "Cannot calculate node distances with edge weights that do not match the tree."
+        );
+    }
+
+    auto const node_count = tree.node_count();
+    auto result = utils::Matrix<T>( node_count, node_count, T{} );
+    if( node_count == 0 ) {
+        return result;
+    }
+    auto const& preorder = tree.preorder();
+
+    // Subtree sizes in terms of preorder positions, including the node itself.
+    auto subtree_end = std::vector<size_t>( node_count, 1 );
+    for( auto node_index : tree.postorder() ) {
+        if( node_index != tree.root_node() ) {
+            subtree_end[ tree.parent_node( node_index ) ] += subtree_end[ node_index ];
+        }
+    }
+    for( size_t i = 0; i < node_count; ++i ) {
+        subtree_end[i] += tree.preorder_position( i );
+    }
+
+    // Distances from the root.
+    auto const root = tree.root_node();
+    for( size_t pos = 1; pos < node_count; ++pos ) {
+        auto const node_index = preorder[ pos ];
+        auto const weight = edge_weights[ tree.parent_edge( node_index ) ];
+        result( root, node_index ) = result( root, tree.parent_node( node_index )) + weight;
+    }
+
+    // Rows of all other nodes, from the row of their parent.
+    for( size_t pos = 1; pos < node_count; ++pos ) {
+        auto const node_index = preorder[ pos ];
+        auto const parent     = tree.parent_node( node_index );
+        auto const weight     = edge_weights[ tree.parent_edge( node_index ) ];
+        auto const end        = subtree_end[ node_index ];
+
+        for( size_t i = 0; i < pos; ++i ) {
+            auto const other = preorder[i];
+            result( node_index, other ) = result( parent, other ) + weight;
+        }
+        for( size_t i = pos; i < end; ++i ) {
+            auto const other = preorder[i];
+            result( node_index, other ) = result( parent, other ) - weight;
+        }
+        for( size_t i = end; i < node_count; ++i ) {
+            auto const other = preorder[i];
+            result( node_index, other ) = result( parent, other ) + weight;
+        }
+    }
+
+    return result;
+}
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
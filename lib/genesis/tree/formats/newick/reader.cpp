@@ -637,16 +637,33 @@ NewickBroker NewickReader::parse_tree_to_broker_( utils::InputStream& input_stre
 //     Broker to Tree
 // =================================================================================================
 
+struct NewickReader::ElementPools
+{
+    // Each broker element becomes a node. All but the root have an edge towards the root.
+    // Each node has a link towards the root, and one link for each of its children.
+    // The link towards the root of the root node itself is removed again when finishing the tree.
+    explicit ElementPools( size_t node_count )
+        : links( node_count > 0 ? 2 * node_count - 1 : 0 )
+        , nodes( node_count )
+        , edges( node_count > 0 ? node_count - 1 : 0 )
+    {}
+
+    TreeElementPool< TreeLink > links;
+    TreeElementPool< TreeNode > nodes;
+    TreeElementPool< TreeEdge > edges;
+};
+
 Tree NewickReader::broker_to_tree( NewickBroker const& broker ) const
 {
     // Prepare result and intermediate data.
     Tree tree;
     std::vector< TreeLink* > link_stack;
+    ElementPools pools( broker.size() );
     broker_to_tree_prepare_( broker, tree );
 
     // Iterate over all nodes of the tree broker.
     for( auto b_itr = broker.cbegin(); b_itr != broker.cend(); ++b_itr ) {
-        broker_to_tree_element_( *b_itr, link_stack, tree );
+        broker_to_tree_element_( *b_itr, link_stack, pools, tree );
     }
     assert(link_stack.empty());
 
@@ -660,12 +677,13 @@ Tree NewickReader::broker_to_tree_destructive( NewickBroker& broker ) const
     // Prepare result and intermediate data.
     Tree tree;
     std::vector< TreeLink* > link_stack;
+    ElementPools pools( broker.size() );
     broker_to_tree_prepare_( broker, tree );
 
     // Iterate over all nodes of the tree broker,
     // then delete the element from the broker to save space.
     while( ! broker.empty() ) {
-        broker_to_tree_element_( broker.top(), link_stack, tree );
+        broker_to_tree_element_( broker.top(), link_stack, pools, tree );
         broker.pop_top();
     }
     assert(link_stack.empty());
@@ -680,6 +698,12 @@ void NewickReader::broker_to_tree_prepare_( NewickBroker const& broker, Tree& tr
     // we need the ranks (number of immediate children) of all nodes
     broker.assign_ranks();
 
+    // We know the number of elements, so we can reserve the containers.
+    auto const node_count = broker.size();
+    tree.expose_node_container().reserve( node_count );
+    tree.expose_edge_container().reserve( node_count > 0 ? node_count - 1 : 0 );
+    tree.expose_link_container().reserve( node_count > 0 ? 2 * node_count - 1 : 0 );
+
     // Call all prepare plugins
     for( auto const& prepare_plugin : prepare_reading_plugins ) {
         prepare_plugin( broker, tree );
@@ -689,6 +713,7 @@ void NewickReader::broker_to_tree_prepare_( NewickBroker const& broker, Tree& tr
 void NewickReader::broker_to_tree_element_(
     NewickBrokerElement const& broker_node,
     std::vector<TreeLink*>& link_stack,
+    ElementPools& pools,
     Tree& tree
 ) const {
     // Shortcut to tree containers.
@@ -697,7 +722,7 @@ void NewickReader::broker_to_tree_element_(
     auto& edges = tree.expose_edge_container();
 
     // create the tree node for this broker node
-    auto cur_node_u  = utils::make_unique< TreeNode >();
+    auto cur_node_u  = pools.nodes.make();
     auto cur_node    = cur_node_u.get();
     cur_node->reset_index( nodes.size() );
 
@@ -717,7 +742,7 @@ void NewickReader::broker_to_tree_element_(
 
     // create the link that points towards the root.
     // this link is created for every node, root, inner and leaves.
-    auto up_link_u  = utils::make_unique< TreeLink >();
+    auto up_link_u  = pools.links.make();
     auto up_link    = up_link_u.get();
     up_link->reset_node( cur_node );
     cur_node->reset_primary_link( up_link );
@@ -737,7 +762,7 @@ void NewickReader::broker_to_tree_element_(
         link_stack.back()->reset_outer( up_link );
 
         // also, create an edge that connects both nodes
-        auto up_edge = utils::make_unique< TreeEdge >(
+        auto up_edge = pools.edges.make(
             edges.size(),
             link_stack.back(),
             up_link
@@ -774,7 +799,7 @@ void NewickReader::broker_to_tree_element_(
     // in summary, make all next pointers of a node point to each other in a circle.
     auto prev_link = up_link;
     for (int i = 0; i < broker_node.rank(); ++i) {
-        auto down_link = utils::make_unique< TreeLink >();
+        auto down_link = pools.links.make();
         prev_link->reset_next( down_link.get() );
         prev_link = down_link.get();
 
@@ -363,6 +363,12 @@ public:
 
 private:
 
+    /**
+     * @brief Internal helper that creates the elements of a Tree in contiguous blocks of memory,
+     * see TreeElementPool.
+     */
+    struct ElementPools;
+
     /**
      * @brief Internal function to prepare a Tree for filling it with data from a NewickBroker.
      *
@@ -381,6 +387,7 @@ private:
     void broker_to_tree_element_(
         NewickBrokerElement const& broker_node,
         std::vector<TreeLink*>& link_stack,
+        ElementPools& pools,
         Tree& tree
     ) const;
 
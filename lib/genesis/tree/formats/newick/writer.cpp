@@ -64,9 +64,9 @@ void NewickWriter::to_stream( Tree const& tree, std::ostream& os ) const
 void NewickWriter::to_file(
     Tree const& tree, std::string const& filename
 ) const {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( tree, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( tree, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 void NewickWriter::to_string (
@@ -179,9 +179,9 @@ void NewickWriter::broker_to_stream( NewickBroker const& broker, std::ostream& o
 
 void NewickWriter::broker_to_file( NewickBroker const& broker, std::string const& filename) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    broker_to_stream( broker, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    broker_to_stream( broker, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 void NewickWriter::broker_to_string( NewickBroker const& broker, std::string& ts ) const
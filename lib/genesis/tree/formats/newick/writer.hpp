@@ -176,6 +176,9 @@ public:
      * already exists, an exception is thrown.
      * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
      * change this behaviour.
+     *
+     * If the file name ends in `.gz`, the output is gzip-compressed,
+     * see utils::make_file_output_stream().
      */
     void to_file( Tree const& tree, std::string const& filename) const;
 
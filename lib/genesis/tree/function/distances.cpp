@@ -30,6 +30,7 @@
 
 #include "genesis/tree/function/distances.hpp"
 
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/functions.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/iterator/levelorder.hpp"
@@ -95,6 +96,12 @@ utils::Matrix<size_t> node_path_length_matrix(
     return mat;
 }
 
+utils::Matrix<size_t> node_path_length_matrix( FlatTree const& tree )
+{
+    // Each edge counts as one.
+    return flat_tree_node_distance_matrix( tree, std::vector<size_t>( tree.edge_count(), 1 ));
+}
+
 std::vector<size_t> node_path_length_vector(
     Tree const& tree,
     TreeNode const& node
@@ -42,6 +42,7 @@ namespace tree {
 //     Foward Declarations
 // =================================================================================================
 
+class FlatTree;
 class Tree;
 class TreeNode;
 class TreeEdge;
@@ -61,6 +62,14 @@ class TreeLink;
  */
 utils::Matrix<size_t> node_path_length_matrix( Tree const& tree );
 
+/**
+ * @brief Return a matrix containing the pairwise depth of all nodes of a FlatTree.
+ *
+ * The result is the same as for the Tree that the FlatTree was built from.
+ * See flat_tree_node_distance_matrix() for details on the computation.
+ */
+utils::Matrix<size_t> node_path_length_matrix( FlatTree const& tree );
+
 /**
  * @brief Return a vector containing the depth of all nodes with respect to the given start node.
  *
@@ -30,6 +30,7 @@
 
 #include "genesis/tree/function/functions.hpp"
 
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/iterator/eulertour.hpp"
@@ -437,6 +438,19 @@ std::vector<size_t> subtree_sizes( Tree const& tree )
     return subtree_sizes( tree, tree.root_node() );
 }
 
+std::vector<size_t> subtree_sizes( FlatTree const& tree )
+{
+    // In postorder, all children are visited before their parent,
+    // so we can simply add up the sizes towards the root.
+    auto result = std::vector<size_t>( tree.node_count(), 0 );
+    for( auto const node_index : tree.postorder() ) {
+        if( node_index != tree.root_node() ) {
+            result[ tree.parent_node( node_index ) ] += result[ node_index ] + 1;
+        }
+    }
+    return result;
+}
+
 size_t subtree_max_path_height( Tree const& tree, TreeLink const& link )
 {
     if( ! belongs_to( tree, link )) {
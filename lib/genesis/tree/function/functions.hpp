@@ -43,6 +43,7 @@ namespace tree {
 //     Forward Declarations
 // =================================================================================================
 
+class FlatTree;
 class Tree;
 class TreeNode;
 class TreeEdge;
@@ -266,6 +267,14 @@ std::vector<size_t> subtree_sizes( Tree const& tree, TreeNode const& node );
  */
 std::vector<size_t> subtree_sizes( Tree const& tree );
 
+/**
+ * @brief Calculate the sizes of all subtrees as seen from the root of a FlatTree.
+ *
+ * The result is the same as for the Tree that the FlatTree was built from, but is computed
+ * with a single scan over the postorder of the FlatTree.
+ */
+std::vector<size_t> subtree_sizes( FlatTree const& tree );
+
 /**
  * @brief Calculate the height of a subtree, that is, the maximum path length to a leaf of that
  * subtree, measured in edges between the link and the leaf.
@@ -35,6 +35,8 @@
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/iterator/eulertour.hpp"
 
+#include "genesis/utils/core/options.hpp"
+
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -80,6 +82,32 @@ TreeNode const& LcaLookup::operator()( TreeNode const& node_a, TreeNode const& n
     return tree_->node_at( idx );
 }
 
+std::vector<size_t> LcaLookup::operator()(
+    std::vector<std::pair<size_t, size_t>> const& node_index_pairs,
+    LcaBatchMethod method
+) const {
+    // Check all indices first, so that we do not need to throw from the parallel loop.
+    auto const sz = eulertour_first_occurrence_.size();
+    for( auto const& node_pair : node_index_pairs ) {
+        if( node_pair.first >= sz || node_pair.second >= sz ) {
+            throw std::invalid_argument( "Invalid index out of bounds for LCA lookup." );
+        }
+    }
+
+    if( method == LcaBatchMethod::kAutomatic ) {
+        auto const threads = static_cast<size_t>( utils::Options::get().number_of_threads() );
+        if( node_index_pairs.size() > sz * std::max<size_t>( threads, 1 )) {
+            method = LcaBatchMethod::kOffline;
+        } else {
+            method = LcaBatchMethod::kOnline;
+        }
+    }
+    if( method == LcaBatchMethod::kOffline ) {
+        return batch_offline_( node_index_pairs );
+    }
+    return batch_online_( node_index_pairs );
+}
+
 // =================================================================================================
 //     Internal Helper Functions
 // =================================================================================================
@@ -129,6 +157,107 @@ size_t LcaLookup::eulertour_query_( size_t i, size_t j ) const
     }
 }
 
+std::vector<size_t> LcaLookup::batch_online_(
+    std::vector<std::pair<size_t, size_t>> const& node_index_pairs
+) const {
+    auto result = std::vector<size_t>( node_index_pairs.size() );
+
+    #pragma omp parallel for
+    for( size_t i = 0; i < node_index_pairs.size(); ++i ) {
+        auto const u_euler_idx = eulertour_first_occurrence_[ node_index_pairs[i].first  ];
+        auto const v_euler_idx = eulertour_first_occurrence_[ node_index_pairs[i].second ];
+        result[i] = eulertour_order_[ eulertour_query_( u_euler_idx, v_euler_idx )];
+    }
+    return result;
+}
+
+std::vector<size_t> LcaLookup::batch_offline_(
+    std::vector<std::pair<size_t, size_t>> const& node_index_pairs
+) const {
+    auto const node_count = eulertour_first_occurrence_.size();
+    auto result = std::vector<size_t>( node_index_pairs.size() );
+
+    // Sort the queries by node, so that we can find all queries of a node when we are done with
+    // its subtree. Each query is stored at both of its nodes, as pairs of the other node
+    // and the index of the query.
+    auto query_offsets = std::vector<size_t>( node_count + 1, 0 );
+    for( auto const& node_pair : node_index_pairs ) {
+        ++query_offsets[ node_pair.first  + 1 ];
+        ++query_offsets[ node_pair.second + 1 ];
+    }
+    for( size_t i = 0; i < node_count; ++i ) {
+        query_offsets[ i + 1 ] += query_offsets[ i ];
+    }
+    auto queries = std::vector<std::pair<size_t, size_t>>( 2 * node_index_pairs.size() );
+    auto query_fill = std::vector<size_t>( query_offsets.begin(), query_offsets.end() - 1 );
+    for( size_t i = 0; i < node_index_pairs.size(); ++i ) {
+        auto const& node_pair = node_index_pairs[i];
+        queries[ query_fill[ node_pair.first  ]++ ] = { node_pair.second, i };
+        queries[ query_fill[ node_pair.second ]++ ] = { node_pair.first,  i };
+    }
+
+    // Union-find over the nodes, where each set consists of finished subtrees that are merged
+    // into the node on the current path from the root that they hang from, which is stored as the
+    // ancestor of the set.
+    auto set_parents  = std::vector<size_t>( node_count );
+    auto set_sizes    = std::vector<size_t>( node_count, 1 );
+    auto set_ancestor = std::vector<size_t>( node_count );
+    auto finished     = std::vector<char>( node_count, 0 );
+    for( size_t i = 0; i < node_count; ++i ) {
+        set_parents[i]  = i;
+        set_ancestor[i] = i;
+    }
+    auto find_set = [&]( size_t x ){
+        while( set_parents[x] != x ) {
+            set_parents[x] = set_parents[ set_parents[x] ];
+            x = set_parents[x];
+        }
+        return x;
+    };
+
+    // Once all nodes of the subtree of a node are finished, the LCA of the node and each of the
+    // finished nodes is the ancestor of the set of that node. Then, the node is merged into the
+    // set of its parent.
+    auto finish_node = [&]( size_t node_index, size_t parent_index ){
+        finished[ node_index ] = 1;
+        for( size_t q = query_offsets[ node_index ]; q < query_offsets[ node_index + 1 ]; ++q ) {
+            if( finished[ queries[q].first ] ) {
+                result[ queries[q].second ] = set_ancestor[ find_set( queries[q].first ) ];
+            }
+        }
+        if( parent_index == node_count ) {
+            return;
+        }
+
+        auto a = find_set( node_index );
+        auto b = find_set( parent_index );
+        if( set_sizes[a] > set_sizes[b] ) {
+            std::swap( a, b );
+        }
+        set_parents[a]  = b;
+        set_sizes[b]   += set_sizes[a];
+        set_ancestor[b] = parent_index;
+    };
+
+    // Walk the eulertour. Each step either goes down to a node that is visited for the first time,
+    // or goes up from a node whose subtree is finished to its parent. The tour ends at the last
+    // child of the root, so that this one and the root itself are finished afterwards.
+    auto const& tour = eulertour_order_;
+    for( size_t k = 0; k + 1 < tour.size(); ++k ) {
+        if( eulertour_first_occurrence_[ tour[ k + 1 ]] != k + 1 ) {
+            finish_node( tour[k], tour[ k + 1 ] );
+        }
+    }
+    if( ! tour.empty() && tour.back() != root_idx_ ) {
+        finish_node( tour.back(), root_idx_ );
+    }
+    if( node_count > 0 ) {
+        finish_node( root_idx_, node_count );
+    }
+
+    return result;
+}
+
 size_t LcaLookup::lookup_( size_t node_index_a, size_t node_index_b, size_t root_index ) const
 {
     auto const sz = eulertour_first_occurrence_.size();
@@ -33,6 +33,7 @@
 
 #include "genesis/utils/math/range_minimum_query.hpp"
 
+#include <utility>
 #include <vector>
 
 namespace genesis {
@@ -45,6 +46,34 @@ namespace tree {
 class Tree;
 class TreeNode;
 
+// =================================================================================================
+//     LCA Batch Method
+// =================================================================================================
+
+/**
+ * @brief Algorithm used by LcaLookup to answer a batch of queries at once.
+ *
+ * See @link LcaLookup::operator()( std::vector<std::pair<size_t, size_t>> const&, LcaBatchMethod ) const
+ * LcaLookup::operator()@endlink for details.
+ */
+enum class LcaBatchMethod
+{
+    /**
+     * @brief Select the method depending on the size of the batch, relative to the size of the Tree.
+     */
+    kAutomatic,
+
+    /**
+     * @brief Answer each query with the RangeMinimumQuery, in parallel.
+     */
+    kOnline,
+
+    /**
+     * @brief Answer all queries in one walk over the eulertour, using Tarjan's offline algorithm.
+     */
+    kOffline
+};
+
 // =================================================================================================
 //     LCA Lookup
 // =================================================================================================
@@ -92,6 +121,28 @@ public:
     size_t operator()( size_t node_index_a, size_t node_index_b ) const;
     TreeNode const& operator()( TreeNode const& node_a, TreeNode const& node_b ) const;
 
+    /**
+     * @brief Return the indices of the lowest common ancestors of a batch of pairs of nodes,
+     * given by their indices, using the root node of the Tree.
+     *
+     * This is meant for workloads that need many LCAs at once, such as distances between all
+     * pairs of placements. There are two algorithms to answer the queries, see LcaBatchMethod:
+     *
+     *   * The online method answers each query independently with the RangeMinimumQuery of this
+     *     class, in parallel over the batch.
+     *   * The offline method uses Tarjan's algorithm: The queries are sorted by node, and then all
+     *     of them are answered during one walk over the eulertour of the Tree, using a union-find
+     *     structure. This needs time that is linear in the size of the Tree plus the number of
+     *     queries, and accesses the data of each node only once. It runs on a single thread.
+     *
+     * By default, the offline method is used if the batch has more queries than the Tree has
+     * nodes per available thread, as the walk is then amortized.
+     */
+    std::vector<size_t> operator()(
+        std::vector<std::pair<size_t, size_t>> const& node_index_pairs,
+        LcaBatchMethod method = LcaBatchMethod::kAutomatic
+    ) const;
+
     // -------------------------------------------------------------------------
     //     Internal Helper Functions
     // -------------------------------------------------------------------------
@@ -115,6 +166,20 @@ private:
      */
     size_t lookup_( size_t node_index_a, size_t node_index_b, size_t root_index ) const;
 
+    /**
+     * @brief Answer a batch of queries with the RangeMinimumQuery, in parallel.
+     */
+    std::vector<size_t> batch_online_(
+        std::vector<std::pair<size_t, size_t>> const& node_index_pairs
+    ) const;
+
+    /**
+     * @brief Answer a batch of queries with Tarjan's offline LCA algorithm.
+     */
+    std::vector<size_t> batch_offline_(
+        std::vector<std::pair<size_t, size_t>> const& node_index_pairs
+    ) const;
+
     // -------------------------------------------------------------------------
     //     Data Members
     // -------------------------------------------------------------------------
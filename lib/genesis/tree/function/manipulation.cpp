@@ -766,6 +766,9 @@ void ladderize( Tree& tree, LadderizeOrder order )
             assert( !cl );
         }
     }
+
+    // We changed the links directly, so the cached traversals are outdated.
+    tree.invalidate_traversal_orders();
 }
 
 } // namespace tree
@@ -0,0 +1,243 @@
+#ifndef GENESIS_TREE_ITERATOR_TRAVERSAL_ORDER_H_
+#define GENESIS_TREE_ITERATOR_TRAVERSAL_ORDER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/tree.hpp"
+#include "genesis/utils/core/range.hpp"
+
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Traversal Order Iterator
+// =================================================================================================
+
+/**
+ * @brief Iterator over a traversal order of a Tree that is cached in the Tree,
+ * see Tree::traversal_link_indices().
+ *
+ * The iterator offers the same members as the postorder, preorder and levelorder iterators,
+ * and visits the same links in the same order as they do when started at the root of the Tree.
+ * Instead of keeping a stack or queue of links to visit, it simply walks the array of cached
+ * link indices, and hence does not allocate any memory.
+ *
+ * Use the wrapper functions cached_postorder(), cached_preorder() and cached_levelorder()
+ * to obtain a range of this iterator.
+ */
+template< bool is_const = true >
+class IteratorTraversalOrder
+{
+public:
+
+    // -----------------------------------------------------
+    //     Typedefs
+    // -----------------------------------------------------
+
+    // Make the member types const or not, depending on iterator type.
+    using TreeType = typename std::conditional< is_const, Tree const, Tree >::type;
+    using LinkType = typename std::conditional< is_const, TreeLink const, TreeLink >::type;
+    using NodeType = typename std::conditional< is_const, TreeNode const, TreeNode >::type;
+    using EdgeType = typename std::conditional< is_const, TreeEdge const, TreeEdge >::type;
+
+    using IndexIterator     = std::vector<size_t>::const_iterator;
+
+    using self_type         = IteratorTraversalOrder< is_const >;
+    using iterator_category = std::forward_iterator_tag;
+
+    // -----------------------------------------------------
+    //     Constructors and Rule of Five
+    // -----------------------------------------------------
+
+    IteratorTraversalOrder()
+        : tree_( nullptr )
+    {}
+
+    IteratorTraversalOrder( TreeType& tree, IndexIterator begin, IndexIterator end, IndexIterator pos )
+        : tree_( &tree )
+        , begin_( begin )
+        , end_( end )
+        , pos_( pos )
+    {}
+
+    ~IteratorTraversalOrder() = default;
+
+    IteratorTraversalOrder( IteratorTraversalOrder const& ) = default;
+    IteratorTraversalOrder( IteratorTraversalOrder&& )      = default;
+
+    IteratorTraversalOrder& operator= ( IteratorTraversalOrder const& ) = default;
+    IteratorTraversalOrder& operator= ( IteratorTraversalOrder&& )      = default;
+
+    // -----------------------------------------------------
+    //     Operators
+    // -----------------------------------------------------
+
+    self_type operator * ()
+    {
+        return *this;
+    }
+
+    self_type operator ++ ()
+    {
+        ++pos_;
+        return *this;
+    }
+
+    self_type operator ++ (int)
+    {
+        self_type tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator == (const self_type &other) const
+    {
+        return other.pos_ == pos_;
+    }
+
+    bool operator != (const self_type &other) const
+    {
+        return !(other == *this);
+    }
+
+    // -----------------------------------------------------
+    //     Members
+    // -----------------------------------------------------
+
+    bool is_first_iteration() const
+    {
+        return pos_ == begin_;
+    }
+
+    bool is_last_iteration() const
+    {
+        return pos_ + 1 == end_;
+    }
+
+    LinkType& link() const
+    {
+        assert( tree_ && pos_ != end_ );
+        return tree_->link_at( *pos_ );
+    }
+
+    NodeType& node() const
+    {
+        return link().node();
+    }
+
+    EdgeType& edge() const
+    {
+        return link().edge();
+    }
+
+    // -----------------------------------------------------
+    //     Data Members
+    // -----------------------------------------------------
+
+private:
+
+    TreeType*     tree_;
+    IndexIterator begin_;
+    IndexIterator end_;
+    IndexIterator pos_;
+
+};
+
+// =================================================================================================
+//     Traversal Order Wrapper Functions
+// =================================================================================================
+
+/**
+ * @brief Return a range over a cached traversal of the Tree, in the given @p order.
+ *
+ * The range is only valid as long as the topology of the Tree is not changed,
+ * see Tree::traversal_link_indices().
+ */
+template< typename TreeType >
+utils::Range< IteratorTraversalOrder< std::is_const< TreeType >::value >>
+cached_traversal( TreeType& tree, TreeTraversalOrder order )
+{
+    using Iterator = IteratorTraversalOrder< std::is_const< TreeType >::value >;
+    auto const& indices = tree.traversal_link_indices( order );
+    return {
+        Iterator( tree, indices.cbegin(), indices.cend(), indices.cbegin() ),
+        Iterator( tree, indices.cbegin(), indices.cend(), indices.cend() )
+    };
+}
+
+/**
+ * @brief Return a range over the cached postorder traversal of the Tree.
+ *
+ * This visits the same links as `postorder( tree )`, but without any allocation after the first
+ * traversal of the Tree.
+ */
+template< typename TreeType >
+utils::Range< IteratorTraversalOrder< std::is_const< TreeType >::value >>
+cached_postorder( TreeType& tree )
+{
+    return cached_traversal( tree, TreeTraversalOrder::kPostorder );
+}
+
+/**
+ * @brief Return a range over the cached preorder traversal of the Tree.
+ *
+ * This visits the same links as `preorder( tree )`, but without any allocation after the first
+ * traversal of the Tree.
+ */
+template< typename TreeType >
+utils::Range< IteratorTraversalOrder< std::is_const< TreeType >::value >>
+cached_preorder( TreeType& tree )
+{
+    return cached_traversal( tree, TreeTraversalOrder::kPreorder );
+}
+
+/**
+ * @brief Return a range over the cached levelorder traversal of the Tree.
+ *
+ * This visits the same links as `levelorder( tree )`, but without any allocation after the first
+ * traversal of the Tree.
+ */
+template< typename TreeType >
+utils::Range< IteratorTraversalOrder< std::is_const< TreeType >::value >>
+cached_levelorder( TreeType& tree )
+{
+    return cached_traversal( tree, TreeTraversalOrder::kLevelorder );
+}
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,107 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/mass_tree/binned_mass_tree.hpp"
+
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+BinnedMassTree::BinnedMassTree( MassTree const& tree, size_t bin_count )
+    : bin_count_( bin_count )
+{
+    if( bin_count == 0 ) {
+        throw std::invalid_argument( "Cannot use bin_count == 0." );
+    }
+
+    auto const edge_count = tree.edge_count();
+    auto const nb = static_cast<double>( bin_count );
+    branch_lengths_.resize( edge_count );
+    masses_.resize( edge_count * bin_count, 0.0 );
+    absolute_masses_.resize( edge_count * bin_count, 0.0 );
+
+    for( size_t e = 0; e < edge_count; ++e ) {
+        auto const& data = tree.edge_at( e ).data<MassTreeEdgeData>();
+        auto const bl = data.branch_length;
+        branch_lengths_[e] = bl;
+
+        // Same bins as in mass_tree_binify_masses(): Trim and scale the position to be in the
+        // interval [ 0.0, nb ), and floor it to get the bin. For branches of length zero,
+        // all masses end up in the first bin.
+        for( auto const& mass : data.masses ) {
+            auto const pn = std::min(
+                std::max( 0.0, bl > 0.0 ? mass.first / bl * nb : 0.0 ),
+                std::nextafter( nb, 0.0 )
+            );
+            auto const bin = e * bin_count + static_cast<size_t>( std::floor( pn ));
+            masses_[ bin ]          += mass.second;
+            absolute_masses_[ bin ] += std::abs( mass.second );
+        }
+    }
+}
+
+// =================================================================================================
+//     Binning Error
+// =================================================================================================
+
+double BinnedMassTree::binning_error( double p ) const
+{
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // Work per bin, see the documentation for the derivation.
+    double const factor = std::max( 1.0, std::pow( 2.0, 1.0 - p ));
+    double error = 0.0;
+    for( size_t e = 0; e < branch_lengths_.size(); ++e ) {
+        double const half_width = branch_lengths_[e] / static_cast<double>( bin_count_ ) / 2.0;
+        double edge_error = 0.0;
+        for( size_t b = e * bin_count_; b < ( e + 1 ) * bin_count_; ++b ) {
+            edge_error += std::pow( absolute_masses_[b], p );
+        }
+        error += factor * edge_error * half_width;
+    }
+    return error;
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,162 @@
+#ifndef GENESIS_TREE_MASS_TREE_BINNED_MASS_TREE_H_
+#define GENESIS_TREE_MASS_TREE_BINNED_MASS_TREE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Tree;
+using MassTree = Tree;
+
+// =================================================================================================
+//     Binned Mass Tree
+// =================================================================================================
+
+/**
+ * @brief Masses of a MassTree, accumulated into a fixed number of bins per edge,
+ * and stored in dense arrays.
+ *
+ * Each branch is divided into bin_count() intervals of equal size, and each mass is moved to the
+ * mid point of its interval, in the same way as mass_tree_binify_masses() does. The sums of the
+ * masses per bin are stored in one array with bin_count() entries per edge, so that all edges
+ * have the same layout, independently of how many masses there are on them. This is meant for
+ * the fast approximation of the earth mover's distance, see binned_earth_movers_distance().
+ *
+ * Furthermore, the absolute masses per bin are stored, from which binning_error() computes
+ * how much the binning can change the distance at most.
+ */
+class BinnedMassTree
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    BinnedMassTree() = default;
+
+    /**
+     * @brief Accumulate the masses of a MassTree into @p bin_count bins per edge.
+     *
+     * All edges of the tree need to have MassTreeEdgeData. Masses outside of the branch
+     * are moved to the first or last bin, respectively.
+     */
+    BinnedMassTree( MassTree const& tree, size_t bin_count );
+
+    ~BinnedMassTree() = default;
+
+    BinnedMassTree( BinnedMassTree const& ) = default;
+    BinnedMassTree( BinnedMassTree&& )      = default;
+
+    BinnedMassTree& operator= ( BinnedMassTree const& ) = default;
+    BinnedMassTree& operator= ( BinnedMassTree&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    size_t edge_count() const
+    {
+        return branch_lengths_.size();
+    }
+
+    size_t bin_count() const
+    {
+        return bin_count_;
+    }
+
+    double branch_length( size_t edge_index ) const
+    {
+        assert( edge_index < branch_lengths_.size() );
+        return branch_lengths_[ edge_index ];
+    }
+
+    /**
+     * @brief Return the sums of the masses in all bins of all edges. The bins of edge `e` are
+     * stored at `[ e * bin_count(), ( e + 1 ) * bin_count() )`, from the start of the branch to
+     * its end.
+     */
+    std::vector<double> const& masses() const
+    {
+        return masses_;
+    }
+
+    /**
+     * @brief Return the sums of the absolute masses in all bins, in the same layout as masses().
+     */
+    std::vector<double> const& absolute_masses() const
+    {
+        return absolute_masses_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Binning Error
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return an upper bound of the earth mover's work that moving the masses to their bins
+     * takes, using the exponent @p p.
+     *
+     * Moving the masses of a bin to its mid point changes the mass that passes any point of the
+     * bin by at most the absolute mass `A` of the bin, and only within the bin, that is, over at
+     * most half the bin width `w` on either side of the mid point. The work is hence at most
+     * `c * A^p * w / 2` per bin, with `c = 1` for `p >= 1` and `c = 2^(1-p)` for `p < 1`.
+     *
+     * This is the work without the outer exponent `1/p` that is applied for `p > 1`.
+     */
+    double binning_error( double p = 1.0 ) const;
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    size_t              bin_count_ = 0;
+    std::vector<double> branch_lengths_;
+    std::vector<double> masses_;
+    std::vector<double> absolute_masses_;
+
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -30,8 +30,11 @@
 
 #include "genesis/tree/mass_tree/emd.hpp"
 
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/operators.hpp"
-#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/iterator/traversal_order.hpp"
+#include "genesis/tree/mass_tree/binned_mass_tree.hpp"
+#include "genesis/tree/mass_tree/flat_mass_tree.hpp"
 #include "genesis/tree/mass_tree/tree.hpp"
 #include "genesis/tree/tree.hpp"
 
@@ -42,6 +45,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -57,6 +61,184 @@ namespace tree {
 //     Earth Movers Distance
 // =================================================================================================
 
+/**
+ * @brief Local helper function that adds the @p work of moving the masses of two trees
+ * along one of their edges.
+ *
+ * The masses of both trees are given as ranges of `( position, mass )` pairs that are sorted by
+ * position in descending order, that is, from the end of the branch to its start.
+ * The @p current_mass is the mass that comes from the subtree below the edge. It is updated
+ * to the mass that arrives at the upper node of the edge.
+ */
+template< class Iterator >
+static void earth_movers_distance_edge_(
+    Iterator     lhs_it,
+    Iterator     lhs_end,
+    Iterator     rhs_it,
+    Iterator     rhs_end,
+    double const branch_length,
+    double&      current_mass,
+    double&      work,
+    double const p
+) {
+    // We start a "normal" earth movers distance caluclation along the current edge.
+    // We start at the end of the branch, with the mass that comes from the subtree below it...
+    double current_pos = branch_length;
+
+    // ... and move the mass along the branch, balancing it with the masses found on the branch.
+    // We merge both sorted ranges on the fly, using the masses of the rhs with negative sign.
+    // Masses at the same position are combined, as if they were stored in a common map.
+    while( lhs_it != lhs_end || rhs_it != rhs_end ) {
+        double position;
+        double mass;
+        if( rhs_it == rhs_end || ( lhs_it != lhs_end && lhs_it->first > rhs_it->first )) {
+            position = lhs_it->first;
+            mass     = lhs_it->second;
+            ++lhs_it;
+        } else if( lhs_it == lhs_end || rhs_it->first > lhs_it->first ) {
+            position = rhs_it->first;
+            mass     = -rhs_it->second;
+            ++rhs_it;
+        } else {
+            position = lhs_it->first;
+            mass     = lhs_it->second - rhs_it->second;
+            ++lhs_it;
+            ++rhs_it;
+        }
+
+        // The work is accumulated: The mass that we are currently moving times the distances
+        // that we move it.
+        work += std::pow( std::abs( current_mass ), p ) * ( current_pos - position );
+
+        // Update the current position and mass.
+        current_pos   = position;
+        current_mass += mass;
+    }
+
+    // After we finished moving along the branch, we need extra work to move the remaining mass
+    // to the node at the top end of the branch.
+    work += std::pow( std::abs( current_mass ), p ) * current_pos;
+}
+
+/**
+ * @brief Local helper function that adds the @p work of moving the masses of two MassTree%s
+ * along one of their edges.
+ */
+static void earth_movers_distance_edge_(
+    MassTreeEdgeData const& lhs_data,
+    MassTreeEdgeData const& rhs_data,
+    double&                 current_mass,
+    double&                 work,
+    double const            p
+) {
+    earth_movers_distance_edge_(
+        lhs_data.masses.crbegin(), lhs_data.masses.crend(),
+        rhs_data.masses.crbegin(), rhs_data.masses.crend(),
+        std::max( lhs_data.branch_length, rhs_data.branch_length ),
+        current_mass, work, p
+    );
+}
+
+/**
+ * @brief Local helper function that checks that all @p trees have the same topology as
+ * the FlatTree, which is expected to be built from one of them.
+ */
+static void earth_movers_distance_check_topology_(
+    FlatTree const&              topology,
+    std::vector<MassTree> const& trees
+) {
+    for( auto const& tree : trees ) {
+        if( tree.edge_count() != topology.edge_count() ) {
+            throw std::invalid_argument( "MassTrees need to have same size." );
+        }
+        for( auto const& edge : tree.edges() ) {
+            if(
+                edge.primary_node().index()   != topology.primary_node( edge.index() ) ||
+                edge.secondary_node().index() != topology.secondary_node( edge.index() )
+            ) {
+                throw std::invalid_argument( "Incompatible MassTrees." );
+            }
+        }
+    }
+}
+
+/**
+ * @brief Local helper function that numbers the edges of a FlatTree in the order in which
+ * a postorder traversal visits them, as used by EarthMoversDistanceBatch and
+ * IncrementalEarthMoversDistance.
+ *
+ * Returns the edge index at each step, and stores the step of the edge above each step in
+ * @p parent_steps. The root gets the step past the last edge, so that the mass that arrives
+ * there does not need special treatment.
+ */
+static std::vector<size_t> earth_movers_distance_postorder_steps_(
+    FlatTree const&      topology,
+    std::vector<size_t>& parent_steps
+) {
+    auto const edge_count = topology.edge_count();
+    auto node_steps = std::vector<size_t>( topology.node_count(), edge_count );
+    auto step_edges = std::vector<size_t>();
+    step_edges.reserve( edge_count );
+    for( auto const node_index : topology.postorder() ) {
+        if( node_index == topology.root_node() ) {
+            continue;
+        }
+        node_steps[ node_index ] = step_edges.size();
+        step_edges.push_back( topology.parent_edge( node_index ));
+    }
+    assert( step_edges.size() == edge_count );
+
+    parent_steps.resize( edge_count );
+    for( size_t k = 0; k < edge_count; ++k ) {
+        parent_steps[k] = node_steps[ topology.primary_node( step_edges[k] ) ];
+    }
+    return step_edges;
+}
+
+/**
+ * @brief Local helper function that copies the branch lengths and masses of all @p trees into
+ * flat arrays, with the edges in the order of the @p step_edges, and the masses of each edge
+ * in reverse order, from the end of the branch to its start.
+ *
+ * The masses of tree `t` at step `k` are stored in the range given by @p offsets at indices
+ * `t * edge_count + k` and the one after. This also accesses the edge data of all trees once
+ * before copying, so that wrong data types throw here, and not in the parallel loop.
+ */
+static void earth_movers_distance_pack_trees_(
+    std::vector<MassTree> const&                      trees,
+    std::vector<size_t> const&                        step_edges,
+    std::vector<size_t>&                              offsets,
+    std::vector<double>&                              branch_lengths,
+    std::vector<EarthMoversDistanceBatch::MassPoint>& masses
+) {
+    auto const tree_count = trees.size();
+    auto const edge_count = step_edges.size();
+
+    // Count the masses of all trees, so that we know where the block of each tree and edge starts.
+    offsets.resize( tree_count * edge_count + 1 );
+    size_t total = 0;
+    for( size_t t = 0; t < tree_count; ++t ) {
+        for( size_t k = 0; k < edge_count; ++k ) {
+            offsets[ t * edge_count + k ] = total;
+            total += trees[t].edge_at( step_edges[k] ).data<MassTreeEdgeData>().masses.size();
+        }
+    }
+    offsets.back() = total;
+
+    // Copy the data.
+    branch_lengths.resize( tree_count * edge_count );
+    masses.resize( total );
+    #pragma omp parallel for
+    for( size_t t = 0; t < tree_count; ++t ) {
+        for( size_t k = 0; k < edge_count; ++k ) {
+            auto const x = t * edge_count + k;
+            auto const& data = trees[t].edge_at( step_edges[k] ).data<MassTreeEdgeData>();
+            branch_lengths[x] = data.branch_length;
+            std::copy( data.masses.crbegin(), data.masses.crend(), masses.begin() + offsets[x] );
+        }
+    }
+}
+
 double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double const p )
 {
     // Check.
@@ -93,10 +275,14 @@ double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double c
     // masses are given as "proximal_length" on their branch, which always points away from the
     // root. Thus, if we decided to traverse from a different node than the root, we would have to
     // take this into account. So, we do start at the root, to keep it simple.
-    auto lhs_it  = postorder( lhs ).begin();
-    auto rhs_it  = postorder( rhs ).begin();
-    auto lhs_end = postorder( lhs ).end();
-    auto rhs_end = postorder( rhs ).end();
+    // We use the cached traversal order of the trees, as this function is typically called for
+    // many pairs of the same trees, e.g., when computing a distance matrix.
+    auto lhs_range = cached_postorder( lhs );
+    auto rhs_range = cached_postorder( rhs );
+    auto lhs_it  = lhs_range.begin();
+    auto rhs_it  = rhs_range.begin();
+    auto lhs_end = lhs_range.end();
+    auto rhs_end = rhs_range.end();
     for( ; lhs_it != lhs_end && rhs_it != rhs_end; ++lhs_it, ++rhs_it ) {
 
         // If we are at the last iteration, we reached the root. Thus, we have moved all masses
@@ -128,42 +314,14 @@ double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double c
         assert( sec_node_index == lhs_it.node().index() );
         assert( sec_node_index == rhs_it.node().index() );
 
-        // Add both masses to a common map, one of them with negative sign.
-        // This is faster than merging into a vector, and easier than doing a parallel iteration
-        // over the values in sorted order.
-        auto edge_masses = lhs_it.edge().data<MassTreeEdgeData>().masses;
-        for( auto const& mass : rhs_it.edge().data<MassTreeEdgeData>().masses ) {
-            edge_masses[ mass.first ] -= mass.second;
-        }
-
-        // We now start a "normal" earth movers distance caluclation along the current edge.
-        // We start at the end of the branch, with the mass that comes from the subtree below it...
-        double current_pos  = std::max(
-            lhs_it.edge().data<MassTreeEdgeData>().branch_length,
-            rhs_it.edge().data<MassTreeEdgeData>().branch_length
-        );
-        double current_mass = node_masses[ sec_node_index ];
-
-        // ... and move the mass along the branch, balancing it with the masses found on the branch.
-        // We use a reverse iterator in order to traverse the branch from end to start.
-        for(
-            auto mass_rit = edge_masses.crbegin();
-            mass_rit != edge_masses.crend();
-            ++mass_rit
-        ) {
-            // The work is accumulated: The mass that we are currently moving times the distances
-            // that we move it.
-            work += std::pow( std::abs( current_mass ), p ) * ( current_pos - mass_rit->first );
-
-            // Update the current position and mass.
-            current_pos   = mass_rit->first;
-            current_mass += mass_rit->second;
-        }
-
-        // After we finished moving along the branch, we need extra work to move the remaining mass
-        // to the node at the top end of the branch. Also, add the remaining mass to this node, so
+        // Move the masses along the edge, and add the remaining mass to the upper node, so
         // that it is available for when we process the upper part of that node (towards the root).
-        work += std::pow( std::abs( current_mass ), p ) * current_pos;
+        double current_mass = node_masses[ sec_node_index ];
+        earth_movers_distance_edge_(
+            lhs_it.edge().data<MassTreeEdgeData>(),
+            rhs_it.edge().data<MassTreeEdgeData>(),
+            current_mass, work, p
+        );
         node_masses[ pri_node_index ] += current_mass;
     }
 
@@ -180,58 +338,125 @@ double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double c
     return work;
 }
 
-utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees, double const p )
-{
+double earth_movers_distance(
+    FlatTree const& topology,
+    MassTree const& lhs,
+    MassTree const& rhs,
+    double const    p
+) {
     // Check.
     if( p <= 0.0 ) {
         throw std::runtime_error(
             "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
         );
     }
+    if(
+        lhs.edge_count() != topology.edge_count() || rhs.edge_count() != topology.edge_count() ||
+        lhs.node_count() != topology.node_count() || rhs.node_count() != topology.node_count()
+    ) {
+        throw std::invalid_argument( "MassTrees need to have the same size as the FlatTree." );
+    }
 
-    // Init result matrix.
-    auto result = utils::Matrix<double>( trees.size(), trees.size(), 0.0 );
+    // Same as the above, but using the postorder of the flat tree instead of the iterators.
+    // See there for details.
+    double work = 0.0;
+    auto node_masses = std::vector<double>( topology.node_count(), 0.0 );
+    for( auto const sec_node_index : topology.postorder() ) {
+        if( sec_node_index == topology.root_node() ) {
+            continue;
+        }
+        auto const edge_index     = topology.parent_edge( sec_node_index );
+        auto const pri_node_index = topology.parent_node( sec_node_index );
+        auto const& lhs_edge = lhs.edge_at( edge_index );
+        auto const& rhs_edge = rhs.edge_at( edge_index );
+
+        // The edges are accessed via their index, so we need to make sure that they fit.
+        if(
+            lhs_edge.secondary_link().node().index() != sec_node_index ||
+            rhs_edge.secondary_link().node().index() != sec_node_index
+        ) {
+            throw std::invalid_argument( "Incompatible MassTrees." );
+        }
 
-    // Parallel specialized code.
-    #ifdef GENESIS_OPENMP
+        double current_mass = node_masses[ sec_node_index ];
+        earth_movers_distance_edge_(
+            lhs_edge.data<MassTreeEdgeData>(),
+            rhs_edge.data<MassTreeEdgeData>(),
+            current_mass, work, p
+        );
+        node_masses[ pri_node_index ] += current_mass;
+    }
 
-        // We only need to calculate the upper triangle. Get the number of indices needed
-        // to describe this triangle.
-        size_t const max_k = utils::triangular_size( trees.size() );
+    // Apply the outer exponent.
+    if( p > 1.0 ) {
+        work = std::pow( work, 1.0 / p );
+    }
 
-        // Use dynamic parallelization, as trees might be of different size (in terms of number
-        // of mass points).
-        #pragma omp parallel for schedule( dynamic )
-        for( size_t k = 0; k < max_k; ++k ) {
+    return work;
+}
 
-            // For the given linear index, get the actual position in the Matrix.
-            auto const ij = utils::triangular_indices( k, trees.size() );
-            auto const i = ij.first;
-            auto const j = ij.second;
+double earth_movers_distance(
+    FlatTree const&     topology,
+    FlatMassTree const& lhs,
+    FlatMassTree const& rhs,
+    double const        p
+) {
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+    if( lhs.edge_count() != topology.edge_count() || rhs.edge_count() != topology.edge_count() ) {
+        throw std::invalid_argument( "FlatMassTrees need to have the same size as the FlatTree." );
+    }
 
-            // Calculate EMD and fill symmetric Matrix.
-            auto const emd = earth_movers_distance( trees[i], trees[j], p );
-            result( i, j ) = emd;
-            result( j, i ) = emd;
-        }
+    // Same as the above, but iterating the flat masses.
+    using ReverseIterator = std::reverse_iterator< std::vector<FlatMassTree::MassPoint>::const_iterator >;
+    auto const& lhs_masses = lhs.masses();
+    auto const& rhs_masses = rhs.masses();
 
-    // If no threads are available at all, use serial version.
-    #else
+    double work = 0.0;
+    auto node_masses = std::vector<double>( topology.node_count(), 0.0 );
+    for( auto const sec_node_index : topology.postorder() ) {
+        if( sec_node_index == topology.root_node() ) {
+            continue;
+        }
+        auto const edge_index     = topology.parent_edge( sec_node_index );
+        auto const pri_node_index = topology.parent_node( sec_node_index );
 
-        for( size_t i = 0; i < trees.size(); ++i ) {
+        double current_mass = node_masses[ sec_node_index ];
+        earth_movers_distance_edge_(
+            ReverseIterator( lhs_masses.cbegin() + lhs.mass_end( edge_index )),
+            ReverseIterator( lhs_masses.cbegin() + lhs.mass_begin( edge_index )),
+            ReverseIterator( rhs_masses.cbegin() + rhs.mass_end( edge_index )),
+            ReverseIterator( rhs_masses.cbegin() + rhs.mass_begin( edge_index )),
+            std::max( lhs.branch_length( edge_index ), rhs.branch_length( edge_index )),
+            current_mass, work, p
+        );
+        node_masses[ pri_node_index ] += current_mass;
+    }
 
-            // The result is symmetric - we only calculate the upper triangle.
-            for( size_t j = i + 1; j < trees.size(); ++j ) {
+    // Apply the outer exponent.
+    if( p > 1.0 ) {
+        work = std::pow( work, 1.0 / p );
+    }
 
-                auto const emd = earth_movers_distance( trees[i], trees[j], p );
-                result( i, j ) = emd;
-                result( j, i ) = emd;
-            }
-        }
+    return work;
+}
 
-    #endif
+utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees, double const p )
+{
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
 
-    return result;
+    // All pairs use the same topology and the same masses, so we prepare them once,
+    // and then compute all pairs on the prepared data.
+    return EarthMoversDistanceBatch( trees ).distance_matrix( p );
 }
 
 std::pair<double, double> earth_movers_distance( MassTree const& tree, double const p )
@@ -258,7 +483,7 @@ std::pair<double, double> earth_movers_distance( MassTree const& tree, double co
     // masses are given as "proximal_length" on their branch, which always points away from the
     // root. Thus, if we decided to traverse from a different node than the root, we would have to
     // take this into account. So, we do start at the root, to keep it simple.
-    for( auto tree_it : postorder(tree) ) {
+    for( auto tree_it : cached_postorder( tree ) ) {
 
         // If we are at the last iteration, we reached the root. Thus, we have moved all masses
         // and don't need to proceed. If we did, we would count an edge of the root again
@@ -315,5 +540,545 @@ std::pair<double, double> earth_movers_distance( MassTree const& tree, double co
     return { work, node_masses[ tree.root_node().index() ] };
 }
 
+// =================================================================================================
+//     Binned Earth Movers Distance
+// =================================================================================================
+
+/**
+ * @brief Local helper function that computes the work of the binned earth mover's distance,
+ * without the outer exponent.
+ */
+static double binned_earth_movers_distance_work_(
+    FlatTree const&       topology,
+    BinnedMassTree const& lhs,
+    BinnedMassTree const& rhs,
+    double const          p
+) {
+    auto const bin_count  = lhs.bin_count();
+    auto const nb         = static_cast<double>( bin_count );
+    auto const& lhs_masses = lhs.masses();
+    auto const& rhs_masses = rhs.masses();
+    assert( bin_count > 0 && bin_count == rhs.bin_count() );
+
+    // The work of moving a mass, without the distance.
+    auto const weigh = [p]( double mass ){
+        return p == 1.0 ? std::abs( mass ) : std::pow( std::abs( mass ), p );
+    };
+
+    // Same as the exact version, but instead of merging the mass points of the edges, we move along
+    // the bins. The mass that comes from below moves half a bin width to the mid point of the last
+    // bin, then a full bin width from mid point to mid point, and finally half a bin width from the
+    // mid point of the first bin to the upper node of the edge.
+    double work = 0.0;
+    auto node_masses = std::vector<double>( topology.node_count(), 0.0 );
+    for( auto const sec_node_index : topology.postorder() ) {
+        if( sec_node_index == topology.root_node() ) {
+            continue;
+        }
+        auto const edge_index     = topology.parent_edge( sec_node_index );
+        auto const pri_node_index = topology.parent_node( sec_node_index );
+        auto const first          = edge_index * bin_count;
+
+        double current_mass = node_masses[ sec_node_index ];
+        double steps = 0.5 * weigh( current_mass );
+        for( size_t b = first + bin_count - 1; b > first; --b ) {
+            current_mass += lhs_masses[b] - rhs_masses[b];
+            steps += weigh( current_mass );
+        }
+        current_mass += lhs_masses[ first ] - rhs_masses[ first ];
+        steps += 0.5 * weigh( current_mass );
+
+        work += steps * lhs.branch_length( edge_index ) / nb;
+        node_masses[ pri_node_index ] += current_mass;
+    }
+    return work;
+}
+
+/**
+ * @brief Local helper function that combines the binning errors of two trees into a bound
+ * of the error of their binned earth mover's distance.
+ */
+static double binned_earth_movers_distance_bound_(
+    double const lhs_error,
+    double const rhs_error,
+    double const p
+) {
+    if( p > 1.0 ) {
+        return std::pow( lhs_error, 1.0 / p ) + std::pow( rhs_error, 1.0 / p );
+    }
+    return lhs_error + rhs_error;
+}
+
+/**
+ * @brief Local helper function that checks that two BinnedMassTree%s can be compared.
+ */
+static void binned_earth_movers_distance_check_(
+    FlatTree const&       topology,
+    BinnedMassTree const& lhs,
+    BinnedMassTree const& rhs
+) {
+    if( lhs.edge_count() != topology.edge_count() || rhs.edge_count() != topology.edge_count() ) {
+        throw std::invalid_argument( "BinnedMassTrees need to have the same size as the FlatTree." );
+    }
+    if( lhs.bin_count() == 0 || lhs.bin_count() != rhs.bin_count() ) {
+        throw std::invalid_argument( "BinnedMassTrees need to have the same number of bins." );
+    }
+    for( size_t e = 0; e < topology.edge_count(); ++e ) {
+        if( lhs.branch_length( e ) != rhs.branch_length( e )) {
+            throw std::invalid_argument( "BinnedMassTrees need to have the same branch lengths." );
+        }
+    }
+}
+
+std::pair<double, double> binned_earth_movers_distance(
+    FlatTree const&       topology,
+    BinnedMassTree const& lhs,
+    BinnedMassTree const& rhs,
+    double const          p
+) {
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+    binned_earth_movers_distance_check_( topology, lhs, rhs );
+
+    auto work = binned_earth_movers_distance_work_( topology, lhs, rhs, p );
+    if( p > 1.0 ) {
+        work = std::pow( work, 1.0 / p );
+    }
+    auto const bound = binned_earth_movers_distance_bound_(
+        lhs.binning_error( p ), rhs.binning_error( p ), p
+    );
+    return { work, bound };
+}
+
+std::pair<utils::Matrix<double>, utils::Matrix<double>> binned_earth_movers_distance(
+    std::vector<MassTree> const& trees,
+    size_t const                 bin_count,
+    double const                 p
+) {
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // Init result matrices.
+    auto result = std::make_pair(
+        utils::Matrix<double>( trees.size(), trees.size(), 0.0 ),
+        utils::Matrix<double>( trees.size(), trees.size(), 0.0 )
+    );
+    if( trees.empty() ) {
+        return result;
+    }
+
+    // Prepare the topology, the bins, and the binning errors once for all trees.
+    // The bins are filled serially, as they access the edge data, which might throw.
+    auto const topology = FlatTree( trees.front() );
+    earth_movers_distance_check_topology_( topology, trees );
+    auto binned = std::vector<BinnedMassTree>();
+    binned.reserve( trees.size() );
+    for( auto const& tree : trees ) {
+        binned.emplace_back( tree, bin_count );
+    }
+    for( size_t i = 1; i < binned.size(); ++i ) {
+        binned_earth_movers_distance_check_( topology, binned[0], binned[i] );
+    }
+    auto errors = std::vector<double>( trees.size() );
+    #pragma omp parallel for
+    for( size_t i = 0; i < trees.size(); ++i ) {
+        errors[i] = binned[i].binning_error( p );
+    }
+
+    // Calculate the upper triangle in parallel.
+    size_t const max_k = utils::triangular_size( trees.size() );
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t k = 0; k < max_k; ++k ) {
+        auto const ij = utils::triangular_indices( k, trees.size() );
+        auto const i = ij.first;
+        auto const j = ij.second;
+
+        auto work = binned_earth_movers_distance_work_( topology, binned[i], binned[j], p );
+        if( p > 1.0 ) {
+            work = std::pow( work, 1.0 / p );
+        }
+        auto const bound = binned_earth_movers_distance_bound_( errors[i], errors[j], p );
+
+        result.first( i, j )  = work;
+        result.first( j, i )  = work;
+        result.second( i, j ) = bound;
+        result.second( j, i ) = bound;
+    }
+
+    // The diagonal stays zero, as the binned distance of a tree to itself is exact.
+    return result;
+}
+
+// =================================================================================================
+//     Earth Movers Distance Batch
+// =================================================================================================
+
+EarthMoversDistanceBatch::EarthMoversDistanceBatch( std::vector<MassTree> const& trees )
+    : tree_count_( trees.size() )
+{
+    if( trees.empty() ) {
+        return;
+    }
+
+    // All trees need to have the same topology. We get it from the first tree,
+    // and check the others against it.
+    auto const topology = FlatTree( trees.front() );
+    earth_movers_distance_check_topology_( topology, trees );
+
+    // Number the edges in postorder, and copy the data of all trees in that order.
+    auto const step_edges = earth_movers_distance_postorder_steps_( topology, parent_steps_ );
+    earth_movers_distance_pack_trees_( trees, step_edges, offsets_, branch_lengths_, masses_ );
+}
+
+double EarthMoversDistanceBatch::distance( size_t i, size_t j, double const p ) const
+{
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+    if( i >= tree_count_ || j >= tree_count_ ) {
+        throw std::invalid_argument( "Invalid tree index for earth mover's distance calculation." );
+    }
+
+    auto node_masses = std::vector<double>( edge_count() + 1 );
+    return distance_( i, j, p, node_masses );
+}
+
+utils::Matrix<double> EarthMoversDistanceBatch::distance_matrix( double const p ) const
+{
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // Init result matrix.
+    auto result = utils::Matrix<double>( tree_count_, tree_count_, 0.0 );
+    if( tree_count_ == 0 ) {
+        return result;
+    }
+
+    // We process the upper triangle of the matrix in tiles of trees, including the tiles on the
+    // diagonal. Those are the pairs `( a, b - 1 )` for all pairs `a < b` of tile indices in the
+    // range `[ 0, tile_count ]`, which we can enumerate with the triangular matrix functions.
+    auto const tile_size  = std::max<size_t>( tile_size_, 1 );
+    auto const tile_count = ( tree_count_ + tile_size - 1 ) / tile_size;
+    auto const tile_pairs = utils::triangular_size( tile_count + 1 );
+
+    // Use dynamic parallelization, as tiles on the diagonal have fewer pairs, and trees might be
+    // of different size (in terms of number of mass points).
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t t = 0; t < tile_pairs; ++t ) {
+        auto const tiles   = utils::triangular_indices( t, tile_count + 1 );
+        auto const i_begin = tiles.first * tile_size;
+        auto const i_end   = std::min( i_begin + tile_size, tree_count_ );
+        auto const j_begin = ( tiles.second - 1 ) * tile_size;
+        auto const j_end   = std::min( j_begin + tile_size, tree_count_ );
+
+        // The buffer for the node masses is reused for all pairs of the tile.
+        auto node_masses = std::vector<double>( edge_count() + 1 );
+        for( size_t i = i_begin; i < i_end; ++i ) {
+            for( size_t j = std::max( j_begin, i + 1 ); j < j_end; ++j ) {
+                auto const emd = distance_( i, j, p, node_masses );
+                result( i, j ) = emd;
+                result( j, i ) = emd;
+            }
+        }
+    }
+
+    return result;
+}
+
+double EarthMoversDistanceBatch::distance_(
+    size_t               i,
+    size_t               j,
+    double const         p,
+    std::vector<double>& node_masses
+) const {
+    auto const edge_count = parent_steps_.size();
+    assert( i < tree_count_ && j < tree_count_ );
+    assert( node_masses.size() == edge_count + 1 );
+    std::fill( node_masses.begin(), node_masses.end(), 0.0 );
+
+    // Same as the FlatTree versions, but with the edges already in postorder, and the masses
+    // already in the order in which they are processed. See there for details.
+    auto const masses = masses_.data();
+    auto const lhs_base = i * edge_count;
+    auto const rhs_base = j * edge_count;
+
+    double work = 0.0;
+    for( size_t k = 0; k < edge_count; ++k ) {
+        auto const lx = lhs_base + k;
+        auto const rx = rhs_base + k;
+
+        double current_mass = node_masses[k];
+        earth_movers_distance_edge_(
+            masses + offsets_[ lx ], masses + offsets_[ lx + 1 ],
+            masses + offsets_[ rx ], masses + offsets_[ rx + 1 ],
+            std::max( branch_lengths_[ lx ], branch_lengths_[ rx ] ),
+            current_mass, work, p
+        );
+        node_masses[ parent_steps_[k] ] += current_mass;
+    }
+
+    // Apply the outer exponent.
+    if( p > 1.0 ) {
+        work = std::pow( work, 1.0 / p );
+    }
+
+    return work;
+}
+
+// =================================================================================================
+//     Incremental Earth Movers Distance
+// =================================================================================================
+
+IncrementalEarthMoversDistance::IncrementalEarthMoversDistance(
+    MassTree const&              sample,
+    std::vector<MassTree> const& others,
+    double const                 p
+)
+    : p_( p )
+{
+    // Checks.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+    auto const topology = FlatTree( sample );
+    earth_movers_distance_check_topology_( topology, others );
+
+    // Number the edges in postorder, as in EarthMoversDistanceBatch.
+    auto const edge_count = topology.edge_count();
+    auto const step_edges = earth_movers_distance_postorder_steps_( topology, parent_steps_ );
+    edge_steps_.resize( edge_count );
+    for( size_t k = 0; k < edge_count; ++k ) {
+        edge_steps_[ step_edges[k] ] = k;
+    }
+    step_marks_.assign( edge_count, 0 );
+
+    // Store the steps below each step, so that we can collect the masses that flow into an edge.
+    // As the child steps are added in increasing order, their masses are added in the same order
+    // as in the other implementations.
+    child_offsets_.assign( edge_count + 1, 0 );
+    for( size_t k = 0; k < edge_count; ++k ) {
+        if( parent_steps_[k] < edge_count ) {
+            ++child_offsets_[ parent_steps_[k] + 1 ];
+        }
+    }
+    for( size_t k = 0; k < edge_count; ++k ) {
+        child_offsets_[ k + 1 ] += child_offsets_[k];
+    }
+    child_steps_.resize( child_offsets_.back() );
+    auto child_fill = std::vector<size_t>( child_offsets_.begin(), child_offsets_.end() - 1 );
+    for( size_t k = 0; k < edge_count; ++k ) {
+        if( parent_steps_[k] < edge_count ) {
+            child_steps_[ child_fill[ parent_steps_[k] ]++ ] = k;
+        }
+    }
+
+    // Copy the sample.
+    sample_branch_lengths_.resize( edge_count );
+    sample_masses_.resize( edge_count );
+    for( size_t edge_index = 0; edge_index < edge_count; ++edge_index ) {
+        copy_sample_edge_( sample, edge_index );
+    }
+
+    // Copy the others, in the same way as EarthMoversDistanceBatch does.
+    auto const other_count = others.size();
+    earth_movers_distance_pack_trees_(
+        others, step_edges, other_offsets_, other_branch_lengths_, other_masses_
+    );
+
+    // Compute the initial state for all edges.
+    outflows_.assign( other_count * edge_count, 0.0 );
+    works_.assign( other_count * edge_count, 0.0 );
+    total_work_.assign( other_count, 0.0 );
+    auto all_steps = std::vector<size_t>( edge_count );
+    for( size_t k = 0; k < edge_count; ++k ) {
+        all_steps[k] = k;
+    }
+    process_steps_( all_steps );
+}
+
+double IncrementalEarthMoversDistance::distance( size_t index ) const
+{
+    if( index >= total_work_.size() ) {
+        throw std::invalid_argument( "Invalid tree index for earth mover's distance calculation." );
+    }
+
+    // The work is updated by differences in between summing it up, so it might end up slightly
+    // below zero due to rounding. We do not want that to result in a NaN for p > 1.
+    auto const work = std::max( total_work_[ index ], 0.0 );
+    if( p_ > 1.0 ) {
+        return std::pow( work, 1.0 / p_ );
+    }
+    return work;
+}
+
+std::vector<double> IncrementalEarthMoversDistance::distances() const
+{
+    auto result = std::vector<double>( total_work_.size() );
+    for( size_t i = 0; i < total_work_.size(); ++i ) {
+        result[i] = distance( i );
+    }
+    return result;
+}
+
+void IncrementalEarthMoversDistance::update(
+    MassTree const&            sample,
+    std::vector<size_t> const& changed_edges
+) {
+    auto const edge_count = parent_steps_.size();
+    if( sample.edge_count() != edge_count ) {
+        throw std::invalid_argument( "MassTrees need to have same size." );
+    }
+    // Check everything before changing our state, so that it stays consistent in case of errors.
+    for( auto const edge_index : changed_edges ) {
+        if( edge_index >= edge_count ) {
+            throw std::invalid_argument( "Invalid edge index for earth mover's distance update." );
+        }
+        if( ! sample.edge_at( edge_index ).data_cast<MassTreeEdgeData>() ) {
+            throw std::invalid_argument( "Tree does not have MassTreeEdgeData." );
+        }
+    }
+
+    // Copy the new masses, and collect the steps of the changed edges and of all edges on their
+    // paths to the root. We stop walking once we reach an edge that is already marked, as the rest
+    // of the path is then already collected. This way, each edge is visited at most once.
+    auto steps = std::vector<size_t>();
+    for( auto const edge_index : changed_edges ) {
+        copy_sample_edge_( sample, edge_index );
+
+        auto step = edge_steps_[ edge_index ];
+        while( step < edge_count && ! step_marks_[ step ] ) {
+            step_marks_[ step ] = 1;
+            steps.push_back( step );
+            step = parent_steps_[ step ];
+        }
+    }
+    for( auto const step : steps ) {
+        step_marks_[ step ] = 0;
+    }
+
+    // The edges need to be processed from the leaves towards the root, which is the order
+    // of their steps.
+    std::sort( steps.begin(), steps.end() );
+    process_steps_( steps );
+}
+
+void IncrementalEarthMoversDistance::update( MassTree const& sample )
+{
+    if( sample.edge_count() != parent_steps_.size() ) {
+        throw std::invalid_argument( "MassTrees need to have same size." );
+    }
+
+    auto changed_edges = std::vector<size_t>();
+    for( size_t edge_index = 0; edge_index < sample.edge_count(); ++edge_index ) {
+        if( sample_edge_changed_( sample, edge_index )) {
+            changed_edges.push_back( edge_index );
+        }
+    }
+    update( sample, changed_edges );
+}
+
+bool IncrementalEarthMoversDistance::sample_edge_changed_(
+    MassTree const& sample,
+    size_t          edge_index
+) const {
+    auto const  step   = edge_steps_[ edge_index ];
+    auto const& data   = sample.edge_at( edge_index ).data<MassTreeEdgeData>();
+    auto const& stored = sample_masses_[ step ];
+    return data.branch_length != sample_branch_lengths_[ step ]
+        || data.masses.size() != stored.size()
+        || ! std::equal(
+            data.masses.crbegin(), data.masses.crend(), stored.begin(),
+            []( std::pair<const double, double> const& lhs, MassPoint const& rhs ){
+                return lhs.first == rhs.first && lhs.second == rhs.second;
+            }
+        )
+    ;
+}
+
+void IncrementalEarthMoversDistance::copy_sample_edge_( MassTree const& sample, size_t edge_index )
+{
+    auto const  step = edge_steps_[ edge_index ];
+    auto const& data = sample.edge_at( edge_index ).data<MassTreeEdgeData>();
+    sample_branch_lengths_[ step ] = data.branch_length;
+    sample_masses_[ step ].assign( data.masses.crbegin(), data.masses.crend() );
+}
+
+void IncrementalEarthMoversDistance::process_steps_( std::vector<size_t> const& steps )
+{
+    auto const edge_count  = parent_steps_.size();
+    auto const other_count = total_work_.size();
+    MassPoint const* masses = other_masses_.data();
+
+    // Each pair only touches its own entries, so we can process them in parallel.
+    #pragma omp parallel for
+    for( size_t t = 0; t < other_count; ++t ) {
+        auto const base = t * edge_count;
+        for( auto const k : steps ) {
+            assert( k < edge_count );
+            auto const x = base + k;
+
+            // Collect the mass balance that comes from the edges below, which are either
+            // unchanged, or were processed before in this loop.
+            double current_mass = 0.0;
+            for( size_t c = child_offsets_[k]; c < child_offsets_[ k + 1 ]; ++c ) {
+                current_mass += outflows_[ base + child_steps_[c] ];
+            }
+
+            // Move the masses along the edge, and replace the old work of the edge by the new one.
+            double work = 0.0;
+            auto const& sample_masses = sample_masses_[k];
+            earth_movers_distance_edge_(
+                sample_masses.data(), sample_masses.data() + sample_masses.size(),
+                masses + other_offsets_[ x ], masses + other_offsets_[ x + 1 ],
+                std::max( sample_branch_lengths_[k], other_branch_lengths_[ x ] ),
+                current_mass, work, p_
+            );
+            outflows_[x]    = current_mass;
+            total_work_[t] += work - works_[x];
+            works_[x]       = work;
+        }
+    }
+
+    // Every once in a while, get rid of the rounding errors of the differences. This costs about
+    // as much as processing the steps since the last time, so that the amortized cost is constant.
+    steps_since_sum_ += steps.size();
+    if( steps_since_sum_ >= edge_count ) {
+        sum_total_work_();
+    }
+}
+
+void IncrementalEarthMoversDistance::sum_total_work_()
+{
+    auto const edge_count  = parent_steps_.size();
+    auto const other_count = total_work_.size();
+
+    #pragma omp parallel for
+    for( size_t t = 0; t < other_count; ++t ) {
+        double total = 0.0;
+        for( size_t k = 0; k < edge_count; ++k ) {
+            total += works_[ t * edge_count + k ];
+        }
+        total_work_[t] = total;
+    }
+    steps_since_sum_ = 0;
+}
+
 } // namespace tree
 } // namespace genesis
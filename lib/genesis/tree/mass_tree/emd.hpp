@@ -50,6 +50,9 @@ namespace utils {
 
 namespace tree {
 
+    class BinnedMassTree;
+    class FlatMassTree;
+    class FlatTree;
     class Tree;
     class TreeNode;
     class TreeEdge;
@@ -114,12 +117,48 @@ namespace tree {
  */
 double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double p = 1.0 );
 
+/**
+ * @brief Calculate the earth mover's distance between two MassTree%s, using the traversal order
+ * of a FlatTree of their topology.
+ *
+ * This yields the same result as earth_movers_distance( MassTree const&, MassTree const&, double ),
+ * but instead of running two postorder traversals over the trees, it uses the precomputed postorder
+ * of the @p topology, and accesses the edges of the trees directly by their index. This is meant
+ * for computing the distances of many pairs of trees with the same topology, where the FlatTree
+ * only needs to be built once from any of them.
+ */
+double earth_movers_distance(
+    FlatTree const& topology,
+    MassTree const& lhs,
+    MassTree const& rhs,
+    double          p = 1.0
+);
+
+/**
+ * @brief Calculate the earth mover's distance between the masses of two FlatMassTree%s,
+ * using the traversal order of a FlatTree of their topology.
+ *
+ * This yields the same result as earth_movers_distance( MassTree const&, MassTree const&, double )
+ * for the MassTree%s that the FlatMassTree%s were built from. The masses of each edge are merged
+ * on the fly from their sorted vectors, so that no memory needs to be allocated per edge.
+ * For computing many distances between the same set of trees, see EarthMoversDistanceBatch.
+ */
+double earth_movers_distance(
+    FlatTree const&     topology,
+    FlatMassTree const& lhs,
+    FlatMassTree const& rhs,
+    double              p = 1.0
+);
+
 /**
  * @brief Calculate the pairwise earth mover's distance for all @link MassTree MassTrees@endlink.
  *
  * The result is a pairwise distance @link utils::Matrix Matrix@endlink using the indices of the
  * given `vector`. See earth_movers_distance( MassTree const&, MassTree const&, double ) for details
  * on the calculation.
+ *
+ * All trees need to have the same topology. Internally, an EarthMoversDistanceBatch is used,
+ * which prepares the topology and the masses of the trees once for all pairs.
  */
 utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees, double p = 1.0 );
 
@@ -149,6 +188,358 @@ utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees,
  */
 std::pair<double, double> earth_movers_distance( MassTree const& tree, double p = 1.0 );
 
+// =================================================================================================
+//     Binned Earth Movers Distance
+// =================================================================================================
+
+/**
+ * @brief Approximate the earth mover's distance between two MassTree%s, using their masses
+ * accumulated into bins, and return the distance together with an upper bound of its error.
+ *
+ * The distance is the exact earth mover's distance between the binned masses, that is, the same
+ * as earth_movers_distance( MassTree const&, MassTree const&, double ) after using
+ * mass_tree_binify_masses() on both trees (apart from numerical differences). As the bins of all
+ * edges are stored in dense arrays, this is a simple linear loop per edge, whose cost only depends
+ * on the number of bins, but not on the number of masses. This is meant for exploratory analyses
+ * of large sets of trees, where the exact distance is only needed for the final results.
+ *
+ * The function returns a pair, with the approximated distance as first value, and an upper bound
+ * of the absolute difference to the exact distance as second value. The bound is computed from the
+ * BinnedMassTree::binning_error() of both trees, which bounds how much the distance can change
+ * by moving the masses of each tree to their bins. It is the sum of both errors for `p <= 1`,
+ * and the sum of their `1/p`-th powers for `p > 1`, following the triangle inequality.
+ *
+ * Both trees need to have the same number of bins and the same branch lengths,
+ * so that their bins are at the same positions.
+ */
+std::pair<double, double> binned_earth_movers_distance(
+    FlatTree const&       topology,
+    BinnedMassTree const& lhs,
+    BinnedMassTree const& rhs,
+    double                p = 1.0
+);
+
+/**
+ * @brief Approximate the pairwise earth mover's distance for all @link MassTree MassTrees@endlink,
+ * using @p bin_count bins per edge.
+ *
+ * The function returns a pair of matrices: The first contains the approximated distances, the
+ * second contains the upper bounds of their error. See binned_earth_movers_distance( FlatTree
+ * const&, BinnedMassTree const&, BinnedMassTree const&, double ) for details.
+ */
+std::pair<utils::Matrix<double>, utils::Matrix<double>> binned_earth_movers_distance(
+    std::vector<MassTree> const& trees,
+    size_t                       bin_count,
+    double                       p = 1.0
+);
+
+// =================================================================================================
+//     Earth Movers Distance Batch
+// =================================================================================================
+
+/**
+ * @brief Calculate the earth mover's distances between all pairs of a set of MassTree%s.
+ *
+ * This is the engine behind earth_movers_distance( std::vector<MassTree> const&, double ), and can
+ * be used directly if distances are needed repeatedly or only for some pairs of the trees, or with
+ * different values of the exponent @p p.
+ *
+ * The constructor does all the preparations that do not depend on the pair of trees: It computes
+ * the postorder of the (common) topology of the trees once, and renumbers the edges in that order.
+ * Then, the branch lengths and masses of each tree are copied into one contiguous block per tree,
+ * in which the edges are stored in the order in which they are visited, and the masses of each edge
+ * are stored from the end of the branch to its start, that is, in the order in which the algorithm
+ * processes them. Computing the distance of a pair hence is a linear scan over the blocks of both
+ * trees, without any indirection via the topology.
+ *
+ * For the distance_matrix(), the trees are furthermore grouped into tiles of tile_size() trees,
+ * and pairs of tiles are processed in parallel, so that the blocks of the trees of two tiles stay
+ * in the cache while all pairs between them are computed.
+ *
+ * The results are identical to the ones of earth_movers_distance( MassTree const&, MassTree const&,
+ * double ) for each pair.
+ */
+class EarthMoversDistanceBatch
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs
+    // -------------------------------------------------------------------------
+
+    using MassPoint = std::pair< double, double >;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    EarthMoversDistanceBatch() = default;
+
+    /**
+     * @brief Prepare the distance computation for the given @p trees.
+     *
+     * All trees need to have the same topology, and all of their edges need to have
+     * MassTreeEdgeData. The trees are not needed any more after the constructor.
+     */
+    explicit EarthMoversDistanceBatch( std::vector<MassTree> const& trees );
+
+    ~EarthMoversDistanceBatch() = default;
+
+    EarthMoversDistanceBatch( EarthMoversDistanceBatch const& ) = default;
+    EarthMoversDistanceBatch( EarthMoversDistanceBatch&& )      = default;
+
+    EarthMoversDistanceBatch& operator= ( EarthMoversDistanceBatch const& ) = default;
+    EarthMoversDistanceBatch& operator= ( EarthMoversDistanceBatch&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors and Settings
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of trees.
+     */
+    size_t size() const
+    {
+        return tree_count_;
+    }
+
+    /**
+     * @brief Return the number of edges of the trees.
+     */
+    size_t edge_count() const
+    {
+        return parent_steps_.size();
+    }
+
+    /**
+     * @brief Set the number of trees per tile that is used for the distance_matrix().
+     *
+     * Should be chosen so that the masses of two tiles fit into the cache of a core.
+     * Default is 16. A value of 0 is treated as 1.
+     */
+    EarthMoversDistanceBatch& tile_size( size_t value )
+    {
+        tile_size_ = value;
+        return *this;
+    }
+
+    size_t tile_size() const
+    {
+        return tile_size_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Distances
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Calculate the earth mover's distance between the trees with indices @p i and @p j.
+     */
+    double distance( size_t i, size_t j, double p = 1.0 ) const;
+
+    /**
+     * @brief Calculate the pairwise earth mover's distance Matrix of all trees.
+     */
+    utils::Matrix<double> distance_matrix( double p = 1.0 ) const;
+
+    // -------------------------------------------------------------------------
+    //     Private Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    double distance_( size_t i, size_t j, double p, std::vector<double>& node_masses ) const;
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    size_t tree_count_ = 0;
+    size_t tile_size_  = 16;
+
+    // For each edge in postorder (the step), the step of the edge above it,
+    // or the number of edges for the edges at the root.
+    std::vector<size_t> parent_steps_;
+
+    // Branch lengths of all trees, with one entry per tree and step, at `tree * edge_count + step`.
+    std::vector<double> branch_lengths_;
+
+    // Masses of all trees, by tree, step, and descending position. The masses of tree `t` and
+    // step `k` are in the range `[ offsets_[ x ], offsets_[ x + 1 ] )` with `x = t * edge_count + k`.
+    std::vector<size_t>    offsets_;
+    std::vector<MassPoint> masses_;
+
+};
+
+// =================================================================================================
+//     Incremental Earth Movers Distance
+// =================================================================================================
+
+/**
+ * @brief Keep the earth mover's distances from one MassTree to a set of other MassTree%s up to
+ * date while the masses of the former change.
+ *
+ * The earth mover's distance is the sum of the work along all edges of the tree. The work on an
+ * edge only depends on the masses on that edge, and on the balance of the masses that come from the
+ * subtree below it. Hence, if the masses of the @p sample change on some edges, only the work on
+ * those edges and on the edges on their paths to the root changes. This class stores the work and
+ * the mass balance per edge for each pair of the sample and one of the @p others, so that an
+ * update() only needs to process these edges, instead of the whole tree.
+ *
+ * This is meant for interactive analyses, where one sample is repeatedly changed (e.g., filtered
+ * or extended by some pqueries), and its distances to all other samples are needed after each
+ * change. The distances are the same as the ones of earth_movers_distance( MassTree const&,
+ * MassTree const&, double ), apart from rounding differences, as the work is summed up per edge.
+ * The total work per pair is updated by the difference of the work of the processed edges, and
+ * summed up anew from the work per edge whenever about as many edges as the tree has were
+ * processed, so that rounding errors cannot accumulate over many updates.
+ *
+ * The class keeps a copy of the branch lengths and masses of the sample and of all @p others, in
+ * a compact form. Additionally, two values per edge are stored for each of the @p others.
+ */
+class IncrementalEarthMoversDistance
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs
+    // -------------------------------------------------------------------------
+
+    using MassPoint = EarthMoversDistanceBatch::MassPoint;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    IncrementalEarthMoversDistance() = default;
+
+    /**
+     * @brief Compute the distances from the @p sample to all @p others, and keep the intermediate
+     * results needed for updates.
+     *
+     * All trees need to have the same topology. The @p others are not needed any more after the
+     * constructor.
+     */
+    IncrementalEarthMoversDistance(
+        MassTree const&              sample,
+        std::vector<MassTree> const& others,
+        double                       p = 1.0
+    );
+
+    ~IncrementalEarthMoversDistance() = default;
+
+    IncrementalEarthMoversDistance( IncrementalEarthMoversDistance const& ) = default;
+    IncrementalEarthMoversDistance( IncrementalEarthMoversDistance&& )      = default;
+
+    IncrementalEarthMoversDistance& operator= ( IncrementalEarthMoversDistance const& ) = default;
+    IncrementalEarthMoversDistance& operator= ( IncrementalEarthMoversDistance&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of other trees, that is, the number of distances.
+     */
+    size_t size() const
+    {
+        return total_work_.size();
+    }
+
+    size_t edge_count() const
+    {
+        return parent_steps_.size();
+    }
+
+    double p() const
+    {
+        return p_;
+    }
+
+    /**
+     * @brief Return the current distance from the sample to the other tree with index @p index.
+     */
+    double distance( size_t index ) const;
+
+    /**
+     * @brief Return the current distances from the sample to all other trees.
+     */
+    std::vector<double> distances() const;
+
+    // -------------------------------------------------------------------------
+    //     Updates
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Update the distances after the masses or branch lengths of the @p sample have changed
+     * on the edges with the given indices.
+     *
+     * The @p sample needs to be the changed version of the tree that was used in the constructor
+     * (or in the last update). Changes on other edges than the given ones are not detected.
+     */
+    void update( MassTree const& sample, std::vector<size_t> const& changed_edges );
+
+    /**
+     * @brief Update the distances after the masses or branch lengths of the @p sample have changed.
+     *
+     * This compares the masses of the @p sample to the stored ones to find the changed edges,
+     * and then calls update( MassTree const&, std::vector<size_t> const& ) with them.
+     */
+    void update( MassTree const& sample );
+
+    // -------------------------------------------------------------------------
+    //     Private Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    bool sample_edge_changed_( MassTree const& sample, size_t edge_index ) const;
+    void copy_sample_edge_( MassTree const& sample, size_t edge_index );
+    void process_steps_( std::vector<size_t> const& steps );
+    void sum_total_work_();
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    double p_ = 1.0;
+
+    // Topology: The edges are numbered in the order of a postorder traversal, see
+    // EarthMoversDistanceBatch. For each such step, we store the step of the edge above it
+    // (or the number of edges for the edges at the root) and the steps of the edges below it.
+    // Furthermore, for each edge index, its step.
+    std::vector<size_t> parent_steps_;
+    std::vector<size_t> child_offsets_;
+    std::vector<size_t> child_steps_;
+    std::vector<size_t> edge_steps_;
+
+    // Buffer for marking the steps that need to be processed in an update. All zero in between.
+    std::vector<char> step_marks_;
+
+    // Branch lengths and masses of the sample per step, with masses in descending position.
+    std::vector<double>                 sample_branch_lengths_;
+    std::vector<std::vector<MassPoint>> sample_masses_;
+
+    // Branch lengths and masses of the others, in the same layout as in EarthMoversDistanceBatch.
+    std::vector<double>    other_branch_lengths_;
+    std::vector<size_t>    other_offsets_;
+    std::vector<MassPoint> other_masses_;
+
+    // For each pair of the sample and one of the others, and each step, at `other * edge_count +
+    // step`: the mass balance that leaves the edge at its upper end, and the work on the edge.
+    // Also, the total work per pair, and the number of steps processed since it was last summed
+    // up from the work per edge.
+    std::vector<double> outflows_;
+    std::vector<double> works_;
+    std::vector<double> total_work_;
+    size_t              steps_since_sum_ = 0;
+
+};
+
 } // namespace tree
 } // namespace genesis
 
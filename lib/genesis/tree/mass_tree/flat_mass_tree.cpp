@@ -0,0 +1,67 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/mass_tree/flat_mass_tree.hpp"
+
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/tree/tree.hpp"
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+FlatMassTree::FlatMassTree( MassTree const& tree )
+{
+    auto const edge_count = tree.edge_count();
+    branch_lengths_.resize( edge_count );
+    offsets_.resize( edge_count + 1 );
+
+    // Count the mass points first, so that we only need one allocation for them.
+    size_t total = 0;
+    for( size_t i = 0; i < edge_count; ++i ) {
+        total += tree.edge_at( i ).data<MassTreeEdgeData>().masses.size();
+    }
+    masses_.reserve( total );
+
+    // The maps are sorted by position already.
+    for( size_t i = 0; i < edge_count; ++i ) {
+        auto const& data = tree.edge_at( i ).data<MassTreeEdgeData>();
+        branch_lengths_[i] = data.branch_length;
+        offsets_[i] = masses_.size();
+        masses_.insert( masses_.end(), data.masses.begin(), data.masses.end() );
+    }
+    offsets_[ edge_count ] = masses_.size();
+}
+
+} // namespace tree
+} // namespace genesis
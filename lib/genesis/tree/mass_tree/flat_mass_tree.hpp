@@ -0,0 +1,156 @@
+#ifndef GENESIS_TREE_MASS_TREE_FLAT_MASS_TREE_H_
+#define GENESIS_TREE_MASS_TREE_FLAT_MASS_TREE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Tree;
+using MassTree = Tree;
+
+// =================================================================================================
+//     Flat Mass Tree
+// =================================================================================================
+
+/**
+ * @brief Masses and branch lengths of all edges of a MassTree, stored in sorted flat vectors.
+ *
+ * The @link MassTreeEdgeData::masses masses@endlink of a MassTree are stored in one `std::map` per
+ * edge, which is convenient for adding masses, but slow to iterate, as each mass point is a node
+ * of its own. Once all masses are added, this class can be used to store them in one contiguous
+ * vector instead, sorted by edge index and, within each edge, by position on the branch.
+ * The masses of edge `e` are found in the range `[ mass_begin( e ), mass_end( e ) )` of masses().
+ *
+ * This is meant for computations that iterate the masses of the same trees many times,
+ * most notably the pairwise earth_movers_distance() of many trees. The topology of the tree
+ * is not stored here; use a FlatTree for that.
+ */
+class FlatMassTree
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Position on the branch and mass, in the same way as in MassTreeEdgeData::masses.
+     */
+    using MassPoint = std::pair< double, double >;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    FlatMassTree() = default;
+
+    /**
+     * @brief Copy the branch lengths and masses of a MassTree.
+     *
+     * All edges of the tree need to have MassTreeEdgeData.
+     */
+    explicit FlatMassTree( MassTree const& tree );
+
+    ~FlatMassTree() = default;
+
+    FlatMassTree( FlatMassTree const& ) = default;
+    FlatMassTree( FlatMassTree&& )      = default;
+
+    FlatMassTree& operator= ( FlatMassTree const& ) = default;
+    FlatMassTree& operator= ( FlatMassTree&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    size_t edge_count() const
+    {
+        return branch_lengths_.size();
+    }
+
+    double branch_length( size_t edge_index ) const
+    {
+        assert( edge_index < branch_lengths_.size() );
+        return branch_lengths_[ edge_index ];
+    }
+
+    /**
+     * @brief Return the position in masses() of the first mass point of an edge.
+     */
+    size_t mass_begin( size_t edge_index ) const
+    {
+        assert( edge_index + 1 < offsets_.size() );
+        return offsets_[ edge_index ];
+    }
+
+    /**
+     * @brief Return the position in masses() past the last mass point of an edge.
+     */
+    size_t mass_end( size_t edge_index ) const
+    {
+        assert( edge_index + 1 < offsets_.size() );
+        return offsets_[ edge_index + 1 ];
+    }
+
+    /**
+     * @brief Return the mass points of all edges.
+     */
+    std::vector< MassPoint > const& masses() const
+    {
+        return masses_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    std::vector< double >    branch_lengths_;
+    std::vector< size_t >    offsets_;
+    std::vector< MassPoint > masses_;
+
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
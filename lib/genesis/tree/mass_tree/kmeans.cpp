@@ -202,6 +202,28 @@ void MassTreeKmeans::update_centroids(
     #endif
 }
 
+void MassTreeKmeans::move_centroid(
+    Point&       centroid,
+    Point const& datum,
+    double       weight
+) {
+    // Weighted average of the masses. The mass points of the datum are simply added to the
+    // centroid here; they are combined once per mini-batch in finish_moved_centroid().
+    mass_tree_merge_trees_inplace( centroid, datum, 1.0 - weight, weight );
+}
+
+void MassTreeKmeans::finish_moved_centroid( Point& centroid )
+{
+    // As in update_centroids(), put the masses in bins for speedup, so that the centroid does
+    // not accumulate the mass points of all data, and normalize.
+    if( accumulate_centroid_masses_ == 1 ) {
+        mass_tree_center_masses_on_branches_averaged( centroid );
+    } else if( accumulate_centroid_masses_ > 1 ) {
+        mass_tree_binify_masses( centroid, accumulate_centroid_masses_ );
+    }
+    mass_tree_normalize_masses( centroid );
+}
+
 double MassTreeKmeans::distance( Point const& lhs, Point const& rhs ) const
 {
     return earth_movers_distance( lhs, rhs );
@@ -65,7 +65,16 @@ public:
     //     Constructors and Rule of Five
     // -------------------------------------------------------------------------
 
+    /**
+     * @brief Default constructor.
+     *
+     * The earth mover's distance is a metric, so distance_bounds() can be activated in order to
+     * skip distance calculations. This is not done by default: The bounds need a copy of all
+     * centroids that moved in each iteration, and the pairwise distances between the centroids,
+     * which for large trees and few iterations can cost more than they save.
+     */
     MassTreeKmeans() = default;
+
     virtual ~MassTreeKmeans() override = default;
 
     MassTreeKmeans( MassTreeKmeans const& ) = default;
@@ -101,6 +110,14 @@ private:
         std::vector<Point>&        centroids
     ) override;
 
+    virtual void move_centroid(
+        Point&       centroid,
+        Point const& datum,
+        double       weight
+    ) override;
+
+    virtual void finish_moved_centroid( Point& centroid ) override;
+
     virtual double distance( Point const& lhs, Point const& rhs ) const override;
 
     // -------------------------------------------------------------------------
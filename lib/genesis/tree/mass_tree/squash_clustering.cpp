@@ -33,11 +33,13 @@
 #include "genesis/tree/mass_tree/emd.hpp"
 #include "genesis/tree/mass_tree/functions.hpp"
 
+#include "genesis/utils/containers/matrix/operators.hpp"
 #include "genesis/utils/core/logging.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -58,89 +60,147 @@ void SquashClustering::init_( std::vector<MassTree>&& trees )
     // Clear. Both its clusters and mergeres are empty.
     clear();
 
+    // Check. We do this here, so that the distance calculation below cannot throw.
+    if( p_ <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // Calculate the distances between all trees. Each tree initially gets its own slot in the
+    // condensed distance matrix. We need to prepare the trees for this before moving them.
+    auto const tree_count = trees.size();
+    distances_.resize( utils::triangular_size( tree_count ));
+    {
+        auto const batch = EarthMoversDistanceBatch( trees );
+
+        #pragma omp parallel for schedule(dynamic)
+        for( size_t k = 0; k < distances_.size(); ++k ) {
+            auto const ij = utils::triangular_indices( k, tree_count );
+            distances_[k] = batch.distance( ij.second, ij.first, p_ );
+        }
+    }
+
     // Move all trees as single data points to the cluster list, and make them active.
-    clusters_.resize( trees.size() );
-    for( size_t i = 0; i < trees.size(); ++i ) {
+    clusters_.resize( tree_count );
+    slot_clusters_.resize( tree_count );
+    cluster_slots_.resize( tree_count );
+    for( size_t i = 0; i < tree_count; ++i ) {
         clusters_[i].tree   = std::move( trees[i] );
         clusters_[i].count  = 1;
         clusters_[i].active = true;
-    }
-
-    // Fill the "lower triangle" of distances, i.e., all distances to elements with lower indices
-    // than the current one. We don't store this in a global distance matix, but in a vector
-    // for each cluster instead, as this makes it trivial to keep track of the data when merging
-    // clusters. No need to keep track of which row belongs to which cluster etc.
-    // We do this in a second loop, so that all trees haven been moved and OpenMP can access them.
-    for( size_t i = 0; i < clusters_.size(); ++i ) {
-
-        // The cluster need i many distance entries, i.e., cluster 0 needs 0 entries,
-        // cluster 1 needs 1 entry (to compare it to cluster 0), and so forth.
-        clusters_[i].distances.resize( i );
-
-        // Calculate the distances.
-        #pragma omp parallel for
-        for( size_t k = 0; k < i; ++k ) {
-            auto const dist = earth_movers_distance( clusters_[i].tree, clusters_[k].tree, p_ );
-            clusters_[i].distances[k] = dist;
-        }
+        slot_clusters_[i] = i;
+        cluster_slots_[i] = i;
 
         // Also, write out the trees for user output if needed.
         if( write_cluster_tree ) {
             write_cluster_tree( clusters_[i].tree, i );
         }
     }
+
+    // Find the closest other cluster for each cluster.
+    nearest_slots_.resize( tree_count );
+    nearest_distances_.resize( tree_count );
+    #pragma omp parallel for schedule(dynamic)
+    for( size_t s = 0; s < tree_count; ++s ) {
+        update_nearest_( s );
+    }
 }
 
-std::pair<size_t, size_t> SquashClustering::min_entry_() const
+bool SquashClustering::slot_active_( size_t slot ) const
 {
-    // Init.
-    size_t min_i = 0;
-    size_t min_j = 0;
-    double min_d = std::numeric_limits<double>::max();
+    assert( slot < slot_clusters_.size() );
+    return clusters_[ slot_clusters_[ slot ]].active;
+}
 
-    // Find min cell.
-    #pragma omp parallel for schedule(dynamic)
-    for( size_t i = 0; i < clusters_.size(); ++i ) {
-        if( ! clusters_[i].active ) {
+double& SquashClustering::distance_( size_t slot_a, size_t slot_b )
+{
+    assert( slot_a != slot_b );
+    auto const index = utils::triangular_index(
+        std::min( slot_a, slot_b ), std::max( slot_a, slot_b ), slot_clusters_.size()
+    );
+    assert( index < distances_.size() );
+    return distances_[ index ];
+}
+
+bool SquashClustering::closer_(
+    double distance_a, size_t slot_a1, size_t slot_a2,
+    double distance_b, size_t slot_b1, size_t slot_b2
+) const {
+    if( distance_a != distance_b ) {
+        return distance_a < distance_b;
+    }
+
+    // For equal distances, use the pair with the lower cluster indices, in the order in which
+    // a scan over the lower triangle of a distance matrix of all clusters would find them.
+    auto const ordered_clusters = [&]( size_t slot_1, size_t slot_2 ){
+        auto const c1 = slot_clusters_[ slot_1 ];
+        auto const c2 = slot_clusters_[ slot_2 ];
+        return std::make_pair( std::max( c1, c2 ), std::min( c1, c2 ));
+    };
+    return ordered_clusters( slot_a1, slot_a2 ) < ordered_clusters( slot_b1, slot_b2 );
+}
+
+void SquashClustering::update_nearest_( size_t slot )
+{
+    // If there is no other active slot, the slot is its own nearest one.
+    nearest_slots_[ slot ]     = slot;
+    nearest_distances_[ slot ] = std::numeric_limits<double>::max();
+
+    for( size_t other = 0; other < slot_clusters_.size(); ++other ) {
+        if( other == slot || ! slot_active_( other )) {
             continue;
         }
 
-        // We only need to check the "lower triangle".
-        assert( clusters_[i].distances.size() == i );
-        for( size_t j = 0; j < i; ++j ) {
-            if( ! clusters_[j].active ) {
-                continue;
-            }
+        auto const dist = distance_( slot, other );
+        if(
+            nearest_slots_[ slot ] == slot ||
+            closer_( dist, slot, other, nearest_distances_[ slot ], slot, nearest_slots_[ slot ] )
+        ) {
+            nearest_slots_[ slot ]     = other;
+            nearest_distances_[ slot ] = dist;
+        }
+    }
+}
 
-            // Comparison.
-            #pragma omp flush( min_d )
-            if( clusters_[i].distances[j] < min_d ) {
-                #pragma omp critical( GENESIS_TREE_MASS_TREE_SQUASH_CLUSTERING_MIN_ENTRY_UPDATE )
-                {
-                    if( clusters_[i].distances[j] < min_d ) {
-                        min_i = i;
-                        min_j = j;
-                        min_d = clusters_[i].distances[j];
-                    }
-                }
-            }
+std::pair<size_t, size_t> SquashClustering::min_entry_() const
+{
+    // The closest pair of clusters is the closest one of the pairs of each slot
+    // and its nearest slot.
+    size_t min_slot = slot_clusters_.size();
+    for( size_t s = 0; s < slot_clusters_.size(); ++s ) {
+        if( ! slot_active_( s ) || nearest_slots_[ s ] == s ) {
+            continue;
+        }
+        if(
+            min_slot == slot_clusters_.size() ||
+            closer_(
+                nearest_distances_[ s ], s, nearest_slots_[ s ],
+                nearest_distances_[ min_slot ], min_slot, nearest_slots_[ min_slot ]
+            )
+        ) {
+            min_slot = s;
         }
     }
+    assert( min_slot < slot_clusters_.size() );
 
-    // We return reverse order, so that i < j. This is just more intuitive to work with.
-    assert( min_i > min_j );
-    return { min_j, min_i };
+    // We return the cluster indices in order, so that i < j. This is just more intuitive to work with.
+    auto const ci = slot_clusters_[ min_slot ];
+    auto const cj = slot_clusters_[ nearest_slots_[ min_slot ]];
+    assert( ci != cj );
+    return { std::min( ci, cj ), std::max( ci, cj ) };
 }
 
 void SquashClustering::merge_clusters_( size_t i, size_t j )
 {
     assert( i < j );
     assert( i < clusters_.size() && j < clusters_.size() );
-    assert( i < clusters_[j].distances.size() );
+    assert( clusters_[i].active && clusters_[j].active );
 
     // Make new cluster.
     clusters_.emplace_back();
     auto& new_cluster = clusters_.back();
+    auto const new_index = clusters_.size() - 1;
 
     // Make a new cluster tree as the weighted average of both given trees.
     auto const weight_i = static_cast<double>( clusters_[i].count );
@@ -153,59 +213,66 @@ void SquashClustering::merge_clusters_( size_t i, size_t j )
     // If the user wants to write intermediate trees, to so now,
     // so that we later can free the memory again.
     if( write_cluster_tree ) {
-        assert( clusters_.size() > 0 );
-        write_cluster_tree( new_cluster.tree, clusters_.size() - 1 );
+        write_cluster_tree( new_cluster.tree, new_index );
     }
 
-    // Old way: Scale masses, merge them, scale back.
-    // Scale both trees according to their weight (= count).
-    // mass_tree_scale_masses( clusters_[i].tree, static_cast<double>( clusters_[i].count ));
-    // mass_tree_scale_masses( clusters_[j].tree, static_cast<double>( clusters_[j].count ));
-    // new_cluster.tree = mass_tree_merge_trees( clusters_[i].tree, clusters_[j].tree );
-    //
-    // mass_tree_normalize_masses( new_cluster.tree );
-    // mass_tree_scale_masses( clusters_[i].tree, 1.0 / static_cast<double>( clusters_[i].count ));
-    // mass_tree_scale_masses( clusters_[j].tree, 1.0 / static_cast<double>( clusters_[j].count ));
-
     // Set other properties of the new cluster.
     new_cluster.count  = clusters_[i].count + clusters_[j].count;
     new_cluster.active = true;
-    new_cluster.distances.resize( clusters_.size() - 1, 0.0 );
 
     // Calculate distances to still active clusters, which also includes the two clusters that
     // we are about to merge. We will deactivate them after the loop. This way, we also compute
     // their distances in parallel, maximizing OpenMP throughput!
+    auto const slot_count = slot_clusters_.size();
+    auto const slot_i = cluster_slots_[i];
+    auto const slot_j = cluster_slots_[j];
+    auto new_distances = std::vector<double>( slot_count, 0.0 );
     #pragma omp parallel for schedule(dynamic)
-    for( size_t k = 0; k < clusters_.size() - 1; ++k ) {
-        if( ! clusters_[k].active ) {
+    for( size_t s = 0; s < slot_count; ++s ) {
+        if( ! slot_active_( s )) {
             continue;
         }
-
-        auto const dist = earth_movers_distance( new_cluster.tree, clusters_[k].tree, p_ );
-        new_cluster.distances[k] = dist;
+        auto const& other = clusters_[ slot_clusters_[ s ]];
+        new_distances[s] = earth_movers_distance( new_cluster.tree, other.tree, p_ );
     }
 
     // Get the distance between the two clusters that we want to merge,
     // and make a new cluster merger.
-    mergers_.push_back({ i, new_cluster.distances[i], j, new_cluster.distances[j] });
-
-    // Test. How much does the avg dist differ from proper emd dist?
-    // We need to access the distance in reverse j i order, because of the lower triangle.
-    // auto const inner_dist = clusters_[j].distances[i];
-    // auto const avg_dist_i = inner_dist / static_cast<double>( clusters_[i].count );
-    // auto const avg_dist_j = inner_dist / static_cast<double>( clusters_[j].count );
+    mergers_.push_back({ i, new_distances[ slot_i ], j, new_distances[ slot_j ] });
 
     // Deactive. Those two clusters are now merged.
     clusters_[i].active = false;
     clusters_[j].active = false;
 
-    // We don't need the distances any more. Save mem.
-    clusters_[i].distances.clear();
-    clusters_[j].distances.clear();
-
     // We can also destroy those trees. They haven been written before, and are not needed any more.
     clusters_[i].tree.clear();
     clusters_[j].tree.clear();
+
+    // The new cluster takes the slot of cluster i. The slot of cluster j is not used any more,
+    // which we can see from cluster j being inactive.
+    slot_clusters_[ slot_i ] = new_index;
+    cluster_slots_.push_back( slot_i );
+    for( size_t s = 0; s < slot_count; ++s ) {
+        if( s != slot_i && slot_active_( s )) {
+            distance_( slot_i, s ) = new_distances[s];
+        }
+    }
+
+    // Update the nearest slots. Slots whose nearest cluster was merged need to search again,
+    // all others only need to check whether the new cluster is closer.
+    #pragma omp parallel for schedule(dynamic)
+    for( size_t s = 0; s < slot_count; ++s ) {
+        if( ! slot_active_( s )) {
+            continue;
+        }
+        auto const nearest = nearest_slots_[ s ];
+        if( s == slot_i || nearest == s || nearest == slot_i || nearest == slot_j ) {
+            update_nearest_( s );
+        } else if( closer_( new_distances[s], s, slot_i, nearest_distances_[ s ], s, nearest )) {
+            nearest_slots_[ s ]     = slot_i;
+            nearest_distances_[ s ] = new_distances[s];
+        }
+    }
 }
 
 void SquashClustering::run( std::vector<MassTree>&& trees )
@@ -277,6 +344,11 @@ void SquashClustering::clear()
     // p_ = 1.0;
     clusters_.clear();
     mergers_.clear();
+    distances_.clear();
+    slot_clusters_.clear();
+    cluster_slots_.clear();
+    nearest_slots_.clear();
+    nearest_distances_.clear();
 }
 
 } // namespace tree
@@ -50,6 +50,17 @@ namespace tree {
  * @brief Perform Squash Clustering.
  *
  * The class performs squash clustering and stores the results.
+ *
+ * The distances between the active clusters are stored in one condensed triangular matrix, with one
+ * slot per input tree: As each merger of two clusters yields one new cluster, the new cluster takes
+ * the slot of one of the merged ones, and the slot of the other one is freed. Furthermore, for each
+ * slot, the closest other slot is cached. Hence, finding the next pair of clusters to merge only
+ * needs one scan over the slots, and after each merger, only the slots whose closest cluster
+ * was merged need to scan their row again.
+ *
+ * The order of the mergers is the same as when scanning all pairs of active clusters for the
+ * smallest distance: Pairs with equal distance are ordered by the higher, and then by the lower
+ * index of their two clusters.
  */
 class SquashClustering
 {
@@ -83,16 +94,6 @@ public:
          * Only active clusters are considered for merging.
          */
         bool active;
-
-        /**
-         * @brief Distances from this cluster to all clusters with a lower index in the `clusters`
-         * vector.
-         *
-         * We don't store the distances in a global distance matix, but in a vector for each cluster
-         * instead, as this makes it trivial to keep track of the data when merging clusters.
-         * No need to keep track of which row belongs to which cluster etc.
-         */
-        std::vector<double> distances;
     };
 
     struct Merger
@@ -200,6 +201,14 @@ private:
     std::pair<size_t, size_t> min_entry_() const;
     void merge_clusters_( size_t i, size_t j );
 
+    bool slot_active_( size_t slot ) const;
+    double& distance_( size_t slot_a, size_t slot_b );
+    bool closer_(
+        double distance_a, size_t slot_a1, size_t slot_a2,
+        double distance_b, size_t slot_b1, size_t slot_b2
+    ) const;
+    void update_nearest_( size_t slot );
+
     // -------------------------------------------------------------------------
     //     Data Members
     // -------------------------------------------------------------------------
@@ -210,6 +219,17 @@ private:
 
     std::vector<Cluster> clusters_;
     std::vector<Merger>  mergers_;
+
+    // Condensed upper triangle of distances between the slots.
+    std::vector<double> distances_;
+
+    // Cluster that occupies each slot, and slot of each cluster.
+    std::vector<size_t> slot_clusters_;
+    std::vector<size_t> cluster_slots_;
+
+    // For each active slot, the closest other active slot and its distance.
+    std::vector<size_t> nearest_slots_;
+    std::vector<double> nearest_distances_;
 };
 
 } // namespace tree
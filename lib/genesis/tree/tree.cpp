@@ -30,8 +30,11 @@
 
 #include "genesis/tree/tree.hpp"
 
-#include "genesis/utils/core/std.hpp"
+#include "genesis/tree/iterator/levelorder.hpp"
+#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/iterator/preorder.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <stdexcept>
 #include <typeinfo>
@@ -115,15 +118,19 @@ Tree Tree::clone_topology() const
     res.edges_.resize( edge_count() );
 
     // Create all objects. We need two loops per array, because the pointers have to exist
-    // in order to be linked to each other.
+    // in order to be linked to each other. We know the number of elements, so we can create
+    // them in contiguous blocks of memory instead of allocating each of them.
+    TreeElementPool< TreeLink > link_pool( links_.size() );
+    TreeElementPool< TreeNode > node_pool( nodes_.size() );
+    TreeElementPool< TreeEdge > edge_pool( edges_.size() );
     for( size_t i = 0; i < links_.size(); ++i ) {
-        res.links_[i] = utils::make_unique< TreeLink >();
+        res.links_[i] = link_pool.make();
     }
     for( size_t i = 0; i < nodes_.size(); ++i ) {
-        res.nodes_[i] = utils::make_unique< TreeNode >();
+        res.nodes_[i] = node_pool.make();
     }
     for( size_t i = 0; i < edges_.size(); ++i ) {
-        res.edges_[i] = utils::make_unique< TreeEdge >();
+        res.edges_[i] = edge_pool.make();
     }
 
     // Set all pointers for the topology in a second round of loops.
@@ -167,6 +174,8 @@ void Tree::swap( Tree& other )
     swap( links_, other.links_ );
     swap( nodes_, other.nodes_ );
     swap( edges_, other.edges_ );
+
+    swap( traversal_orders_, other.traversal_orders_ );
 }
 
 void Tree::clear()
@@ -175,6 +184,7 @@ void Tree::clear()
     links_.clear();
     nodes_.clear();
     edges_.clear();
+    invalidate_traversal_orders();
 }
 
 // =================================================================================================
@@ -186,23 +196,95 @@ Tree& Tree::reset_root_link( TreeLink* root_link )
     assert( root_link->index() < links_.size() );
     assert( links_[root_link->index()].get() == root_link );
     root_link_ = root_link;
+    invalidate_traversal_orders();
     return *this;
 }
 
 Tree::LinkContainerType& Tree::expose_link_container()
 {
+    invalidate_traversal_orders();
     return links_;
 }
 
 Tree::NodeContainerType& Tree::expose_node_container()
 {
+    invalidate_traversal_orders();
     return nodes_;
 }
 
 Tree::EdgeContainerType& Tree::expose_edge_container()
 {
+    invalidate_traversal_orders();
     return edges_;
 }
 
+// =================================================================================================
+//     Traversal Orders
+// =================================================================================================
+
+/**
+ * @brief Local helper function that collects the link indices of a traversal.
+ */
+template< class Range >
+static void collect_traversal_link_indices_( Range range, std::vector<size_t>& result )
+{
+    for( auto it : range ) {
+        result.push_back( it.link().index() );
+    }
+}
+
+std::vector<size_t> const& Tree::traversal_link_indices( TreeTraversalOrder order ) const
+{
+    auto const pos = static_cast<size_t>( order );
+    assert( pos < traversal_orders_.size() );
+    auto& slot = traversal_orders_[ pos ];
+
+    // Fast path: the order was already computed.
+    auto current = std::atomic_load( &slot );
+    if( current ) {
+        return *current;
+    }
+
+    // Compute the order. All traversals visit each node exactly once.
+    auto indices = std::make_shared< std::vector<size_t> >();
+    if( ! empty() ) {
+        indices->reserve( nodes_.size() );
+        switch( order ) {
+            case TreeTraversalOrder::kPostorder: {
+                collect_traversal_link_indices_( postorder( *this ), *indices );
+                break;
+            }
+            case TreeTraversalOrder::kPreorder: {
+                collect_traversal_link_indices_( preorder( *this ), *indices );
+                break;
+            }
+            case TreeTraversalOrder::kLevelorder: {
+                collect_traversal_link_indices_( levelorder( *this ), *indices );
+                break;
+            }
+            default: {
+                throw std::invalid_argument( "Invalid TreeTraversalOrder." );
+            }
+        }
+        assert( indices->size() == nodes_.size() );
+    }
+
+    // Store it, unless another thread was faster, in which case we use its result,
+    // so that all callers get a reference to the same vector.
+    std::shared_ptr< std::vector<size_t> const > computed = std::move( indices );
+    if( std::atomic_compare_exchange_strong( &slot, &current, computed )) {
+        return *computed;
+    }
+    assert( current );
+    return *current;
+}
+
+void Tree::invalidate_traversal_orders()
+{
+    for( auto& slot : traversal_orders_ ) {
+        slot.reset();
+    }
+}
+
 } // namespace tree
 } // namespace genesis
@@ -41,10 +41,12 @@
 #include "genesis/tree/tree/link.hpp"
 #include "genesis/tree/tree/node_data.hpp"
 #include "genesis/tree/tree/edge_data.hpp"
+#include "genesis/tree/tree/element_pool.hpp"
 
 #include "genesis/utils/core/range.hpp"
 #include "genesis/utils/containers/deref_iterator.hpp"
 
+#include <array>
 #include <cassert>
 #include <memory>
 #include <vector>
@@ -59,6 +61,20 @@ namespace tree {
 class Tree;
 bool validate_topology( Tree const& tree );
 
+// =================================================================================================
+//     Tree Traversal Order
+// =================================================================================================
+
+/**
+ * @brief Traversal orders of a Tree that can be cached, see Tree::traversal_link_indices().
+ */
+enum class TreeTraversalOrder
+{
+    kPostorder,
+    kPreorder,
+    kLevelorder
+};
+
 // =================================================================================================
 //     Tree
 // =================================================================================================
@@ -93,6 +109,11 @@ bool validate_topology( Tree const& tree );
  *  *  The primary link of an edge has to point towards the root, the secondary away from it.
  *
  * Those invariants are established when the Tree is constructed.
+ *
+ * Furthermore, the Tree caches the link indices of its traversals from the root,
+ * see traversal_link_indices(). Functions that change the topology of the Tree by other means
+ * than the functions of this class (e.g., via TreeLink::reset_next()) have to call
+ * invalidate_traversal_orders() afterwards.
  */
 class Tree
 {
@@ -105,9 +126,13 @@ public:
     /**
      * @brief Alias for the container type that is used to store TreeLink%s, TreeNode%s and
      * TreeEdge%s.
+     *
+     * The elements are owned by `std::unique_ptr`s with a TreeElementDeleter, so that they can
+     * either be allocated individually (e.g., via `utils::make_unique()`), or be created in
+     * contiguous blocks via a TreeElementPool.
      */
     template< class T >
-    using ContainerType      = std::vector< std::unique_ptr< T >>;
+    using ContainerType      = std::vector< std::unique_ptr< T, TreeElementDeleter< T > >>;
 
     /**
      * @brief Alias for the container type that is used to store TreeLink%s.
@@ -353,6 +378,34 @@ public:
      */
     EdgeContainerType& expose_edge_container();
 
+    // -------------------------------------------------------------------------
+    //     Traversal Orders
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the indices of the TreeLink%s visited by a traversal from the root, in the
+     * given @p order.
+     *
+     * The links are the same as the ones visited by the postorder(), preorder() and levelorder()
+     * iterators started at the Tree, respectively. The result is computed on the first call,
+     * and cached for all later calls, so that repeated traversals over the same topology are a
+     * plain walk over an array, see cached_postorder(), cached_preorder() and cached_levelorder().
+     * It is safe to call this function concurrently on the same Tree.
+     *
+     * The cache is invalidated by all functions of this class that can change the topology,
+     * that is, reset_root_link() and the `expose_..._container()` functions, as well as
+     * clear() and swap(). Functions that change the topology via the links directly
+     * have to call invalidate_traversal_orders() themselves.
+     * The returned reference is valid until then.
+     */
+    std::vector<size_t> const& traversal_link_indices( TreeTraversalOrder order ) const;
+
+    /**
+     * @brief Discard the cached traversal_link_indices(), so that they are computed anew
+     * when needed.
+     */
+    void invalidate_traversal_orders();
+
     // -------------------------------------------------------------------------
     //     Iterators
     // -------------------------------------------------------------------------
@@ -482,6 +535,10 @@ private:
     NodeContainerType nodes_;
     EdgeContainerType edges_;
 
+    // Cached link indices of the traversals, one per TreeTraversalOrder, or nullptr if not yet
+    // computed. They are set atomically, so that concurrent reading is safe.
+    mutable std::array< std::shared_ptr< std::vector<size_t> const >, 3 > traversal_orders_;
+
 };
 
 } // namespace tree
@@ -0,0 +1,226 @@
+#ifndef GENESIS_TREE_TREE_ELEMENT_POOL_H_
+#define GENESIS_TREE_TREE_ELEMENT_POOL_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Tree Element Block
+// =================================================================================================
+
+/**
+ * @brief Contiguous memory for a fixed number of tree elements of the same type.
+ *
+ * The block is shared by the elements that were created in it, as well as by the
+ * TreeElementPool that creates them, and counts how many of them are still alive.
+ * It is freed once the last of them is gone, so that elements can be moved between containers
+ * (and Tree%s) freely, as if they were allocated individually.
+ */
+template< class T >
+struct TreeElementBlock
+{
+    using Storage = typename std::aligned_storage< sizeof( T ), alignof( T ) >::type;
+
+    explicit TreeElementBlock( size_t capacity )
+        : use_count( 1 )
+        , storage( new Storage[ capacity ] )
+    {}
+
+    std::atomic<size_t>          use_count;
+    std::unique_ptr< Storage[] > storage;
+};
+
+// =================================================================================================
+//     Tree Element Deleter
+// =================================================================================================
+
+/**
+ * @brief Deleter for the `std::unique_ptr`s that store the elements of a Tree.
+ *
+ * Elements that were allocated individually (e.g., via `utils::make_unique()`) are deleted
+ * as usual. Elements that were created in a TreeElementPool are destroyed in place,
+ * and release their TreeElementBlock.
+ */
+template< class T >
+class TreeElementDeleter
+{
+public:
+
+    TreeElementDeleter() = default;
+
+    /**
+     * @brief Implicit conversion from the default deleter, so that individually allocated
+     * elements can be stored in the containers of a Tree as before.
+     */
+    TreeElementDeleter( std::default_delete< T > const& )
+    {}
+
+    explicit TreeElementDeleter( TreeElementBlock< T >* block )
+        : block_( block )
+    {}
+
+    void operator() ( T* ptr ) const
+    {
+        if( ! block_ ) {
+            delete ptr;
+            return;
+        }
+
+        ptr->~T();
+        assert( block_->use_count > 0 );
+        if( --block_->use_count == 0 ) {
+            delete block_;
+        }
+    }
+
+private:
+
+    TreeElementBlock< T >* block_ = nullptr;
+};
+
+// =================================================================================================
+//     Tree Element Pool
+// =================================================================================================
+
+/**
+ * @brief Create tree elements in one contiguous block of memory.
+ *
+ * When the number of elements of a Tree is known in advance (e.g., when copying a Tree, or when
+ * building it from a NewickBroker), this saves one allocation per element, and places the elements
+ * next to each other in memory, which makes traversals more cache friendly.
+ * Once the @p capacity is exhausted, further elements are allocated individually.
+ *
+ * The elements keep their memory alive themselves, see TreeElementBlock, so the pool can be
+ * discarded as soon as all elements are created.
+ */
+template< class T >
+class TreeElementPool
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Typedefs
+    // -------------------------------------------------------------------------
+
+    using Deleter = TreeElementDeleter< T >;
+    using Pointer = std::unique_ptr< T, Deleter >;
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    explicit TreeElementPool( size_t capacity )
+        : block_( new TreeElementBlock< T >( capacity ))
+        , capacity_( capacity )
+    {}
+
+    ~TreeElementPool()
+    {
+        if( block_ && --block_->use_count == 0 ) {
+            delete block_;
+        }
+    }
+
+    TreeElementPool( TreeElementPool const& ) = delete;
+    TreeElementPool( TreeElementPool&& other )
+        : block_( other.block_ )
+        , capacity_( other.capacity_ )
+        , size_( other.size_ )
+    {
+        other.block_ = nullptr;
+    }
+
+    TreeElementPool& operator= ( TreeElementPool const& ) = delete;
+    TreeElementPool& operator= ( TreeElementPool&& )      = delete;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of elements that were created in the block so far.
+     */
+    size_t size() const
+    {
+        return size_;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Element Creation
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Create a new element, forwarding the @p args to its constructor.
+     */
+    template< class... Args >
+    Pointer make( Args&&... args )
+    {
+        assert( block_ );
+        if( size_ == capacity_ ) {
+            return Pointer( new T( std::forward< Args >( args )... ));
+        }
+
+        auto ptr = new( &block_->storage[ size_ ] ) T( std::forward< Args >( args )... );
+        ++size_;
+        ++block_->use_count;
+        return Pointer( ptr, Deleter( block_ ));
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    TreeElementBlock< T >* block_;
+    size_t                 capacity_;
+    size_t                 size_ = 0;
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
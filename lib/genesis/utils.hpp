@@ -81,14 +81,18 @@
 #include "genesis/utils/formats/xml/helper.hpp"
 #include "genesis/utils/formats/xml/writer.hpp"
 #include "genesis/utils/io/base_input_source.hpp"
+#include "genesis/utils/io/char_search.hpp"
 #include "genesis/utils/io/deserializer.hpp"
 #include "genesis/utils/io/file_input_source.hpp"
 #include "genesis/utils/io/gzip_input_source.hpp"
+#include "genesis/utils/io/gzip_stream.hpp"
 #include "genesis/utils/io/input_buffer.hpp"
 #include "genesis/utils/io/input_reader.hpp"
 #include "genesis/utils/io/input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/mmap_input_source.hpp"
 #include "genesis/utils/io/output_stream.hpp"
+#include "genesis/utils/io/parallel_gzip_input_source.hpp"
 #include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/io/serializer.hpp"
@@ -96,6 +100,7 @@
 #include "genesis/utils/io/string_input_source.hpp"
 #include "genesis/utils/math/bitvector.hpp"
 #include "genesis/utils/math/bitvector/operators.hpp"
+#include "genesis/utils/math/bitvector/word_ops.hpp"
 #include "genesis/utils/math/common.hpp"
 #include "genesis/utils/math/distance.hpp"
 #include "genesis/utils/math/euclidean_kmeans.hpp"
@@ -99,9 +99,9 @@ public:
         std::vector<std::string> const& col_names = {},
         std::string const& corner = ""
     ) const {
-        std::ofstream ofs;
-        utils::file_output_stream( fn, ofs );
-        to_stream_( mat, ofs, row_names, col_names, corner );
+        auto ofs = utils::make_file_output_stream( fn );
+        to_stream_( mat, *ofs, row_names, col_names, corner );
+        utils::finish_file_output_stream( *ofs, fn );
     }
 
     std::string to_string(
@@ -96,6 +96,12 @@ std::string CsvReader::parse_field( utils::InputStream& input_stream ) const
         return trim_chars_.find( c ) != std::string::npos;
     });
 
+    // Chars at which the inner loop below needs to stop to check what to do.
+    auto stop_chars = "\n" + separator_chars_ + quotation_chars_;
+    if( use_escapes_ ) {
+        stop_chars += '\\';
+    }
+
     // Read as long as there is input. We will break when finding a new line later.
     while( it ) {
 
@@ -144,9 +150,9 @@ std::string CsvReader::parse_field( utils::InputStream& input_stream ) const
             continue;
         }
 
-        // In any other case, simply read the char.
-        buffer_ += *it;
-        ++it;
+        // In any other case, read all chars up to the next one that needs special treatment.
+        // This is the same as reading them one by one, but faster.
+        it.read_until_any_of( buffer_, stop_chars );
     }
 
     // Now do the last trimming step and return the result.
@@ -55,9 +55,9 @@ void JsonWriter::to_stream( JsonDocument const& document, std::ostream& out ) co
 
 void JsonWriter::to_file( JsonDocument const& document, std::string const& filename ) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    print_value( document, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    print_value( document, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 void JsonWriter::to_string( JsonDocument const& document, std::string& output ) const
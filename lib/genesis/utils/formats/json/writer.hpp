@@ -85,6 +85,9 @@ public:
      * file already exists, an exception is thrown.
      * See @link Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink
      * to change this behaviour.
+     *
+     * If the file name ends in `.gz`, the output is gzip-compressed,
+     * see make_file_output_stream().
      */
     void        to_file   ( JsonDocument const& document, std::string const& filename) const;
 
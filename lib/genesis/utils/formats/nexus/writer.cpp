@@ -59,9 +59,9 @@ void NexusWriter::to_stream( NexusDocument const& doc, std::ostream& out ) const
 
 void NexusWriter::to_file( NexusDocument const& doc, std::string const& filename) const
 {
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( doc, ofs );
+    auto ofs = utils::make_file_output_stream( filename );
+    to_stream( doc, *ofs );
+    utils::finish_file_output_stream( *ofs, filename );
 }
 
 void NexusWriter::to_string( NexusDocument const& doc, std::string& output) const
@@ -45,7 +45,9 @@ namespace utils {
 /**
  * @brief Abstract base class for reading byte data from input sources.
  *
- * It offers to read() a certain amount of bytes into a char buffer.
+ * It offers to read() a certain amount of bytes into a char buffer. Sources that keep their whole
+ * data in memory anyway can additionally offer it via mapped_data(), so that it can be read
+ * without copying.
  */
 class BaseInputSource
 {
@@ -79,6 +81,23 @@ public:
         return read_( buffer, size );
     }
 
+    /**
+     * @brief Return a pointer to the whole data of the input source, if available in memory.
+     *
+     * Some sources, such as the MmapInputSource, provide their complete data as one contiguous
+     * range of memory. For those, this function returns a pointer to the data and sets @p size
+     * to its length in bytes. The data is followed by one extra byte containing a new line char,
+     * so that readers that expect a final new line do not need to copy anything. The data is
+     * valid as long as the source exists, and must not be modified.
+     *
+     * For all other sources, `nullptr` is returned, and the data has to be read via read().
+     */
+    char const* mapped_data( size_t& size )
+    {
+        // Non-virtual interface.
+        return mapped_data_( size );
+    }
+
     /**
      * @brief Get a name of the input source. This is intended for user output.
      */
@@ -106,6 +125,12 @@ private:
 
     virtual size_t read_( char* buffer, size_t size ) = 0;
 
+    virtual char const* mapped_data_( size_t& size )
+    {
+        size = 0;
+        return nullptr;
+    }
+
     virtual std::string source_name_() const = 0;
     virtual std::string source_string_() const = 0;
 
@@ -0,0 +1,311 @@
+#ifndef GENESIS_UTILS_IO_CHAR_SEARCH_H_
+#define GENESIS_UTILS_IO_CHAR_SEARCH_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief Functions to search for chars in a range of memory, using SIMD instructions if available.
+ *
+ * The functions in this file are the building blocks for fast scanning of input data, see for
+ * example InputStream::get_line() and InputStream::read_until(). They use AVX2 if the code is
+ * compiled for it (e.g., with `-mavx2` or `-march=native`), SSE2 on all other x86-64 platforms,
+ * and a plain scalar loop everywhere else. All variants yield identical results.
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#    define GENESIS_CHAR_SEARCH_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#    include <emmintrin.h>
+#    define GENESIS_CHAR_SEARCH_SSE2
+#endif
+
+#if defined( _MSC_VER )
+#    include <intrin.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Vector Helpers
+// =================================================================================================
+
+/**
+ * @brief Return the index of the lowest set bit of a non-zero mask.
+ */
+inline size_t char_search_first_bit_( uint32_t mask )
+{
+    #if defined( __GNUC__ ) || defined( __clang__ )
+        return static_cast<size_t>( __builtin_ctz( mask ));
+    #elif defined( _MSC_VER )
+        unsigned long index;
+        _BitScanForward( &index, mask );
+        return static_cast<size_t>( index );
+    #else
+        size_t index = 0;
+        while( ! ( mask & 1 )) {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+    #endif
+}
+
+/**
+ * @brief Return the number of set bits of a mask.
+ */
+inline size_t char_search_bit_count_( uint32_t mask )
+{
+    #if defined( __GNUC__ ) || defined( __clang__ )
+        return static_cast<size_t>( __builtin_popcount( mask ));
+    #else
+        size_t count = 0;
+        while( mask ) {
+            mask &= mask - 1;
+            ++count;
+        }
+        return count;
+    #endif
+}
+
+#if defined( GENESIS_CHAR_SEARCH_AVX2 )
+
+    using CharSearchVector = __m256i;
+    static const size_t CharSearchWidth = 32;
+
+    inline CharSearchVector char_search_load_( char const* ptr )
+    {
+        return _mm256_loadu_si256( reinterpret_cast<__m256i const*>( ptr ));
+    }
+
+    inline CharSearchVector char_search_set_( char c )
+    {
+        return _mm256_set1_epi8( c );
+    }
+
+    inline CharSearchVector char_search_eq_( CharSearchVector a, CharSearchVector b )
+    {
+        return _mm256_cmpeq_epi8( a, b );
+    }
+
+    inline CharSearchVector char_search_or_( CharSearchVector a, CharSearchVector b )
+    {
+        return _mm256_or_si256( a, b );
+    }
+
+    inline uint32_t char_search_mask_( CharSearchVector v )
+    {
+        return static_cast<uint32_t>( _mm256_movemask_epi8( v ));
+    }
+
+#elif defined( GENESIS_CHAR_SEARCH_SSE2 )
+
+    using CharSearchVector = __m128i;
+    static const size_t CharSearchWidth = 16;
+
+    inline CharSearchVector char_search_load_( char const* ptr )
+    {
+        return _mm_loadu_si128( reinterpret_cast<__m128i const*>( ptr ));
+    }
+
+    inline CharSearchVector char_search_set_( char c )
+    {
+        return _mm_set1_epi8( c );
+    }
+
+    inline CharSearchVector char_search_eq_( CharSearchVector a, CharSearchVector b )
+    {
+        return _mm_cmpeq_epi8( a, b );
+    }
+
+    inline CharSearchVector char_search_or_( CharSearchVector a, CharSearchVector b )
+    {
+        return _mm_or_si128( a, b );
+    }
+
+    inline uint32_t char_search_mask_( CharSearchVector v )
+    {
+        return static_cast<uint32_t>( _mm_movemask_epi8( v ));
+    }
+
+#endif
+
+// =================================================================================================
+//     Char Search
+// =================================================================================================
+
+/**
+ * @brief Return a pointer to the first occurrence of @p c in the range `[first, last)`,
+ * or @p last if there is none.
+ */
+inline char const* find_char( char const* first, char const* last, char c )
+{
+    #if defined( GENESIS_CHAR_SEARCH_AVX2 ) || defined( GENESIS_CHAR_SEARCH_SSE2 )
+        auto const vc = char_search_set_( c );
+        while( static_cast<size_t>( last - first ) >= CharSearchWidth ) {
+            auto const mask = char_search_mask_( char_search_eq_( char_search_load_( first ), vc ));
+            if( mask ) {
+                return first + char_search_first_bit_( mask );
+            }
+            first += CharSearchWidth;
+        }
+    #endif
+
+    while( first != last && *first != c ) {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * @brief Return a pointer to the first occurrence of either @p a or @p b in the range
+ * `[first, last)`, or @p last if there is none.
+ *
+ * This is the typical case of searching for a new line char, which is `\n` or `\r`.
+ */
+inline char const* find_either_char( char const* first, char const* last, char a, char b )
+{
+    #if defined( GENESIS_CHAR_SEARCH_AVX2 ) || defined( GENESIS_CHAR_SEARCH_SSE2 )
+        auto const va = char_search_set_( a );
+        auto const vb = char_search_set_( b );
+        while( static_cast<size_t>( last - first ) >= CharSearchWidth ) {
+            auto const data = char_search_load_( first );
+            auto const mask = char_search_mask_( char_search_or_(
+                char_search_eq_( data, va ), char_search_eq_( data, vb )
+            ));
+            if( mask ) {
+                return first + char_search_first_bit_( mask );
+            }
+            first += CharSearchWidth;
+        }
+    #endif
+
+    while( first != last && *first != a && *first != b ) {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * @brief Return a pointer to the first occurrence of any of the @p chars in the range
+ * `[first, last)`, or @p last if there is none.
+ *
+ * The cost per char of the range grows with the number of @p chars to search for,
+ * so this is meant for small sets of chars such as the separators and quotation marks of a
+ * CSV file.
+ */
+inline char const* find_any_of( char const* first, char const* last, std::string const& chars )
+{
+    // Use the special cases if possible.
+    if( chars.empty() ) {
+        return last;
+    }
+    if( chars.size() == 1 ) {
+        return find_char( first, last, chars[0] );
+    }
+    if( chars.size() == 2 ) {
+        return find_either_char( first, last, chars[0], chars[1] );
+    }
+
+    #if defined( GENESIS_CHAR_SEARCH_AVX2 ) || defined( GENESIS_CHAR_SEARCH_SSE2 )
+        while( static_cast<size_t>( last - first ) >= CharSearchWidth ) {
+            auto const data = char_search_load_( first );
+            auto found = char_search_eq_( data, char_search_set_( chars[0] ));
+            for( size_t i = 1; i < chars.size(); ++i ) {
+                found = char_search_or_( found, char_search_eq_( data, char_search_set_( chars[i] )));
+            }
+            auto const mask = char_search_mask_( found );
+            if( mask ) {
+                return first + char_search_first_bit_( mask );
+            }
+            first += CharSearchWidth;
+        }
+    #endif
+
+    while( first != last && chars.find( *first ) == std::string::npos ) {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * @brief Return a pointer to the first char in the range `[first, last)` that is not @p c,
+ * or @p last if there is none.
+ */
+inline char const* find_not_char( char const* first, char const* last, char c )
+{
+    #if defined( GENESIS_CHAR_SEARCH_AVX2 ) || defined( GENESIS_CHAR_SEARCH_SSE2 )
+        // All bits set in the mask means all chars equal c.
+        auto const vc = char_search_set_( c );
+        auto const full = static_cast<uint32_t>(( uint64_t( 1 ) << CharSearchWidth ) - 1 );
+        while( static_cast<size_t>( last - first ) >= CharSearchWidth ) {
+            auto const mask = char_search_mask_( char_search_eq_( char_search_load_( first ), vc ));
+            if( mask != full ) {
+                return first + char_search_first_bit_( ~mask & full );
+            }
+            first += CharSearchWidth;
+        }
+    #endif
+
+    while( first != last && *first == c ) {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * @brief Return how often @p c occurs in the range `[first, last)`.
+ */
+inline size_t count_char( char const* first, char const* last, char c )
+{
+    size_t count = 0;
+
+    #if defined( GENESIS_CHAR_SEARCH_AVX2 ) || defined( GENESIS_CHAR_SEARCH_SSE2 )
+        auto const vc = char_search_set_( c );
+        while( static_cast<size_t>( last - first ) >= CharSearchWidth ) {
+            auto const mask = char_search_mask_( char_search_eq_( char_search_load_( first ), vc ));
+            count += char_search_bit_count_( mask );
+            first += CharSearchWidth;
+        }
+    #endif
+
+    while( first != last ) {
+        count += ( *first == c );
+        ++first;
+    }
+    return count;
+}
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -174,6 +174,12 @@ size_t GzipInputSource::read_( char* buffer, size_t size )
                 report_zlib_error_( ret );
         }
 
+        // If there is no more input, but the deflate stream is not yet finished,
+        // the input is truncated. Without this check, we would loop forever here.
+        if( ret == Z_BUF_ERROR && in_pos_ == in_end_ ) {
+            throw std::runtime_error( "zlib: Unexpected end of compressed input." );
+        }
+
         // Update current positions.
         in_pos_ = in_end_ - z_stream_.avail_in;
         out_pos = out_end - z_stream_.avail_out;
@@ -181,17 +187,35 @@ size_t GzipInputSource::read_( char* buffer, size_t size )
         // Check if we reached the end of the input deflated stream
         if( ret == Z_STREAM_END ) {
 
-            // We only process whole gz files. So, if we reach the end of the deflate stream,
-            // we must also be at the end of the input.
-            assert( in_pos_ == in_end_ );
+            // A gzip file can consist of multiple members, which are simply concatenated
+            // (e.g., when produced by bgzip or by concatenating gz files). So if there is more
+            // input that starts like a gzip member, reset the stream and continue with it.
+            // Anything else after the end of the stream is ignored, as gzip does as well.
+            if( in_end_ - in_pos_ < 2 ) {
+                std::memmove( in_buf_, in_buf_ + in_pos_, in_end_ - in_pos_ );
+                in_end_ -= in_pos_;
+                in_pos_ = 0;
+                in_end_ += input_source_->read( in_buf_ + in_end_, BlockLength - in_end_ );
+            }
+            if(
+                in_end_ - in_pos_ >= 2 &&
+                static_cast<unsigned char>( in_buf_[ in_pos_ ]     ) == 0x1f &&
+                static_cast<unsigned char>( in_buf_[ in_pos_ + 1 ] ) == 0x8b
+            ) {
+                auto const reset_ret = inflateReset( &z_stream_ );
+                if( reset_ret != Z_OK ) {
+                    report_zlib_error_( reset_ret );
+                }
+                continue;
+            }
 
             break;
         }
     }
 
     // Either we filled up the whole buffer (and read size many bytes),
-    // or we reached the end of the input.
-    assert( out_pos == out_end || in_pos_ == in_end_ );
+    // or we reached the end of the compressed data.
+    assert( out_pos <= out_end );
 
     // Return how many bytes we have out into the output buffer.
     return out_pos;
@@ -0,0 +1,361 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/gzip_stream.hpp"
+
+#include "genesis/utils/io/output_stream.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#ifdef GENESIS_PTHREADS
+#    include <condition_variable>
+#    include <exception>
+#    include <mutex>
+#    include <thread>
+#endif
+
+#ifdef GENESIS_ZLIB
+#    include "zlib.h"
+#endif
+
+namespace genesis {
+namespace utils {
+
+#ifdef GENESIS_ZLIB
+
+// =================================================================================================
+//     Zlib Data
+// =================================================================================================
+
+/**
+ * @brief Zlib stream and output buffer, as well as the compression thread and the block that is
+ * handed over to it.
+ *
+ * The thread compresses one block at a time. The block is described by the job members, which
+ * are set by hand_over_(), and `busy` is true until the thread is done with it. Both sides wait
+ * for changes of this state via the condition variable.
+ */
+struct GzipStreamBuf::ZlibData
+{
+    z_stream          stream;
+    std::vector<char> out_buf;
+
+    #ifdef GENESIS_PTHREADS
+        std::thread             worker;
+        std::mutex              mutex;
+        std::condition_variable condition;
+
+        char*              job_data  = nullptr;
+        size_t             job_size  = 0;
+        int                job_flush = Z_NO_FLUSH;
+        bool               busy      = false;
+        bool               stop      = false;
+        std::exception_ptr error;
+    #endif
+};
+
+// =================================================================================================
+//     Gzip Stream Buffer
+// =================================================================================================
+
+GzipStreamBuf::GzipStreamBuf(
+    std::ostream&        sink,
+    GzipCompressionLevel level,
+    size_t               block_size
+)
+    : sink_( sink )
+    , put_block_( block_size > 0 ? block_size : 1 )
+    , work_block_( put_block_.size() )
+    , zlib_data_( new ZlibData() )
+{
+    // Init zlib for gzip output, that is, with a gzip header and trailer (window bits + 16).
+    auto& stream = zlib_data_->stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    auto const ret = deflateInit2(
+        &stream, static_cast<int>( level ), Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY
+    );
+    if( ret != Z_OK ) {
+        throw std::runtime_error( "zlib: Cannot initialize compression." );
+    }
+    zlib_data_->out_buf.resize( put_block_.size() );
+
+    // Use the first block as the put area.
+    setp( put_block_.data(), put_block_.data() + put_block_.size() );
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+    // We cannot throw from the destructor, so errors here go unnoticed.
+    // Call finish() explicitly to get them.
+    try {
+        finish();
+    } catch( ... ) {}
+
+    // Stop the compression thread. It is idle here, as finish() waits for the last block.
+    #ifdef GENESIS_PTHREADS
+        auto& data = *zlib_data_;
+        if( data.worker.joinable() ) {
+            {
+                std::lock_guard<std::mutex> lock( data.mutex );
+                data.stop = true;
+            }
+            data.condition.notify_all();
+            data.worker.join();
+        }
+    #endif
+
+    deflateEnd( &zlib_data_->stream );
+}
+
+void GzipStreamBuf::finish()
+{
+    if( finished_ ) {
+        return;
+    }
+    finished_ = true;
+
+    // Compress the remaining data, and leave no put area, so that any further writing fails.
+    hand_over_( Z_FINISH );
+    setp( nullptr, nullptr );
+    wait_();
+    sink_.flush();
+    if( ! sink_ ) {
+        throw std::runtime_error( "Cannot write gzip-compressed output." );
+    }
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow( int_type ch )
+{
+    if( finished_ ) {
+        return traits_type::eof();
+    }
+
+    // The put area is full, so hand it over, and put the char into the new one.
+    hand_over_( Z_NO_FLUSH );
+    if( ! traits_type::eq_int_type( ch, traits_type::eof() )) {
+        *pptr() = traits_type::to_char_type( ch );
+        pbump( 1 );
+    }
+    return traits_type::not_eof( ch );
+}
+
+int GzipStreamBuf::sync()
+{
+    if( finished_ ) {
+        return 0;
+    }
+
+    // Write all data so far, so that the sink is complete up to here.
+    try {
+        hand_over_( Z_SYNC_FLUSH );
+        wait_();
+    } catch( ... ) {
+        return -1;
+    }
+    sink_.flush();
+    return sink_.good() ? 0 : -1;
+}
+
+void GzipStreamBuf::hand_over_( int flush )
+{
+    // We need to wait for the previous block in any case, as zlib compresses sequentially.
+    wait_();
+
+    // Swap the blocks, so that the current one can be compressed, while the other one is filled.
+    size_t const size = static_cast<size_t>( pptr() - pbase() );
+    std::swap( put_block_, work_block_ );
+    setp( put_block_.data(), put_block_.data() + put_block_.size() );
+
+    #ifdef GENESIS_PTHREADS
+        auto& data = *zlib_data_;
+        if( ! data.worker.joinable() ) {
+            data.worker = std::thread( [this](){ run_worker_(); });
+        }
+        {
+            std::lock_guard<std::mutex> lock( data.mutex );
+            data.job_data  = work_block_.data();
+            data.job_size  = size;
+            data.job_flush = flush;
+            data.busy      = true;
+        }
+        data.condition.notify_all();
+    #else
+        compress_( work_block_.data(), size, flush );
+    #endif
+}
+
+void GzipStreamBuf::wait_()
+{
+    #ifdef GENESIS_PTHREADS
+        auto& data = *zlib_data_;
+        std::unique_lock<std::mutex> lock( data.mutex );
+        data.condition.wait( lock, [&](){ return ! data.busy; });
+        if( data.error ) {
+            auto const error = data.error;
+            data.error = nullptr;
+            std::rethrow_exception( error );
+        }
+    #endif
+}
+
+void GzipStreamBuf::run_worker_()
+{
+    #ifdef GENESIS_PTHREADS
+        auto& data = *zlib_data_;
+        std::unique_lock<std::mutex> lock( data.mutex );
+        while( true ) {
+            data.condition.wait( lock, [&](){ return data.busy || data.stop; });
+            if( ! data.busy ) {
+                return;
+            }
+
+            // Compress without holding the lock. The block is not touched by the other side
+            // until we are done with it. Errors are handed back to be rethrown by wait_().
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                compress_( data.job_data, data.job_size, data.job_flush );
+            } catch( ... ) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            data.error = error;
+            data.busy  = false;
+            data.condition.notify_all();
+        }
+    #endif
+}
+
+void GzipStreamBuf::compress_( char* data, size_t size, int flush )
+{
+    auto& stream  = zlib_data_->stream;
+    auto& out_buf = zlib_data_->out_buf;
+
+    // We use char data, but zlib expects unsigned char. The casts do not change the byte content.
+    stream.next_in  = reinterpret_cast<Bytef*>( data );
+    stream.avail_in = static_cast<unsigned int>( size );
+
+    // Deflate until all input is used, and zlib does not have any more output.
+    do {
+        stream.next_out  = reinterpret_cast<Bytef*>( out_buf.data() );
+        stream.avail_out = static_cast<unsigned int>( out_buf.size() );
+
+        auto const ret = deflate( &stream, flush );
+        if( ret == Z_STREAM_ERROR ) {
+            throw std::runtime_error( "zlib: Error while compressing data." );
+        }
+
+        auto const count = out_buf.size() - stream.avail_out;
+        sink_.write( out_buf.data(), static_cast<std::streamsize>( count ));
+        if( ! sink_ ) {
+            throw std::runtime_error( "Cannot write gzip-compressed output." );
+        }
+    } while( stream.avail_out == 0 );
+    assert( stream.avail_in == 0 );
+}
+
+// =================================================================================================
+//     Gzip Output File Stream
+// =================================================================================================
+
+GzipOFStream::GzipOFStream(
+    std::string const&   filename,
+    GzipCompressionLevel level
+)
+    : std::ostream( nullptr )
+{
+    file_output_stream( filename, file_, std::ios_base::out | std::ios_base::binary );
+    buffer_ = std::unique_ptr<GzipStreamBuf>( new GzipStreamBuf( file_, level ));
+    rdbuf( buffer_.get() );
+}
+
+#else // GENESIS_ZLIB
+
+// =================================================================================================
+//     Functions without zlib
+// =================================================================================================
+
+// Here, we define the class members as empty functions, throwing in the constructors.
+// This is offered to be able to write code that mentions the classes, without having to have zlib.
+
+struct GzipStreamBuf::ZlibData
+{
+    // Empty on purpose.
+};
+
+GzipStreamBuf::GzipStreamBuf( std::ostream& sink, GzipCompressionLevel, size_t )
+    : sink_( sink )
+{
+    throw std::runtime_error( "zlib: Library was not compiled with zlib support." );
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{}
+
+void GzipStreamBuf::finish()
+{}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow( int_type )
+{
+    return traits_type::eof();
+}
+
+int GzipStreamBuf::sync()
+{
+    return -1;
+}
+
+void GzipStreamBuf::hand_over_( int )
+{}
+
+void GzipStreamBuf::wait_()
+{}
+
+void GzipStreamBuf::compress_( char*, size_t, int )
+{}
+
+void GzipStreamBuf::run_worker_()
+{}
+
+GzipOFStream::GzipOFStream( std::string const&, GzipCompressionLevel )
+    : std::ostream( nullptr )
+{
+    throw std::runtime_error( "zlib: Library was not compiled with zlib support." );
+}
+
+#endif // GENESIS_ZLIB
+
+} // namespace utils
+} // namespace genesis
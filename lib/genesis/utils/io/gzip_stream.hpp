@@ -0,0 +1,269 @@
+#ifndef GENESIS_UTILS_IO_GZIP_STREAM_H_
+#define GENESIS_UTILS_IO_GZIP_STREAM_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Gzip Compression Level
+// =================================================================================================
+
+/**
+ * @brief List of possible compression levels used for GzipOStream.
+ *
+ * The compression levels are handed over to zlib for compression, which currently allows all values
+ * between 1 (best speed) and 9 (best compression), with the special case 0 (no compression), as
+ * well as -1 for the default compression. Currently, the zlib default compression level corresponds
+ * to level 6, which is a good compromise between speed and compression
+ * (it forms the "elbow" of the curve), hence we also use this as our default level.
+ *
+ * The enum only lists those four special levels. However, we use a fixed enum here (with the
+ * underlying type `int`), meaning that all values in the range `[ -1, 9 ]` are allowed to be used,
+ * by casting them with `static_cast<GzipCompressionLevel>( level )`.
+ */
+enum class GzipCompressionLevel : int
+{
+    kDefaultCompression = -1,
+    kNoCompression      = 0,
+    kBestSpeed          = 1,
+    kBestCompression    = 9
+};
+
+// =================================================================================================
+//     Gzip Stream Buffer
+// =================================================================================================
+
+/**
+ * @brief Output stream buffer that gzip-compresses its data and writes it to another stream.
+ *
+ * The data is collected in blocks. Once a block is full, it is compressed and written to the
+ * underlying stream. If threading is available (that is, if the `GENESIS_PTHREADS` macro definition
+ * is set), the blocks are compressed by a background thread, while the next block is being filled.
+ * This way, compression and producing the output overlap, which is useful when writing large
+ * files. The thread is started with the first full block, and kept until the buffer is destroyed.
+ *
+ * The compressed output is a complete gzip file once the buffer is destroyed. Calling `flush()` on
+ * a stream using this buffer hands over all pending data, so that the underlying stream contains
+ * everything written so far, at the cost of a bit of compression ratio.
+ *
+ * This class is usually not used directly; see GzipOStream and GzipOFStream instead.
+ */
+class GzipStreamBuf : public std::streambuf
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the buffer, writing to the given stream, which has to stay valid
+     * while the buffer is used.
+     *
+     * The @p block_size is the size of the uncompressed blocks that are compressed at a time.
+     */
+    explicit GzipStreamBuf(
+        std::ostream&        sink,
+        GzipCompressionLevel level = GzipCompressionLevel::kDefaultCompression,
+        size_t               block_size = 1 << 20
+    );
+
+    GzipStreamBuf( GzipStreamBuf const& ) = delete;
+    GzipStreamBuf( GzipStreamBuf&& )      = delete;
+
+    GzipStreamBuf& operator= ( GzipStreamBuf const& ) = delete;
+    GzipStreamBuf& operator= ( GzipStreamBuf&& )      = delete;
+
+    ~GzipStreamBuf() override;
+
+    // -------------------------------------------------------------
+    //     Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Compress all remaining data and write the end of the gzip file.
+     *
+     * This is called by the destructor, but can be called explicitly in order to get exceptions
+     * from writing, which the destructor has to swallow. It throws if compressing or writing to
+     * the underlying stream failed at any point. Afterwards, no more data can be written to the
+     * buffer.
+     */
+    void finish();
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+protected:
+
+    int_type overflow( int_type ch ) override;
+    int sync() override;
+
+    // -------------------------------------------------------------
+    //     Internal Helpers
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Hand the current block over for compression with the given zlib flush mode,
+     * and start a new block.
+     */
+    void hand_over_( int flush );
+
+    /**
+     * @brief Wait for the currently running compression, and rethrow its exceptions, if any.
+     */
+    void wait_();
+
+    /**
+     * @brief Compress the given data and write the result to the sink.
+     */
+    void compress_( char* data, size_t size, int flush );
+
+    /**
+     * @brief Main loop of the background thread, which compresses the blocks that are handed over.
+     */
+    void run_worker_();
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::ostream& sink_;
+    bool          finished_ = false;
+
+    // The block that is currently filled via the put area, and the one that is being compressed.
+    std::vector<char> put_block_;
+    std::vector<char> work_block_;
+
+    // We want to avoid including the zlib and threading headers here, so we use a PIMPL-like
+    // technique for the zlib related members and the compression thread.
+    struct ZlibData;
+    std::unique_ptr<ZlibData> zlib_data_;
+};
+
+// =================================================================================================
+//     Gzip Output Stream
+// =================================================================================================
+
+/**
+ * @brief Output stream that gzip-compresses its data and writes it to another stream.
+ *
+ * Example:
+ *
+ *     std::ofstream file( "path/to/file.fasta.gz", std::ios_base::out | std::ios_base::binary );
+ *     GzipOStream gzip( file );
+ *     FastaWriter().to_stream( sequences, gzip );
+ *
+ * The other stream has to stay valid while this stream is used, and the compressed data is only
+ * complete once this stream is destroyed. See GzipStreamBuf for details.
+ * See GzipOFStream for a version that directly writes to a file.
+ */
+class GzipOStream : public std::ostream
+{
+public:
+
+    explicit GzipOStream(
+        std::ostream&        sink,
+        GzipCompressionLevel level = GzipCompressionLevel::kDefaultCompression
+    )
+        : std::ostream( nullptr )
+        , buffer_( sink, level )
+    {
+        rdbuf( &buffer_ );
+    }
+
+    ~GzipOStream() override = default;
+
+    /**
+     * @brief Write the end of the gzip data. See GzipStreamBuf::finish().
+     */
+    void finish()
+    {
+        buffer_.finish();
+    }
+
+private:
+
+    GzipStreamBuf buffer_;
+};
+
+// =================================================================================================
+//     Gzip Output File Stream
+// =================================================================================================
+
+/**
+ * @brief Output file stream that gzip-compresses its data.
+ *
+ * The file is opened using file_output_stream(), and hence follows the same rules for overwriting
+ * existing files. See GzipOStream for details on the compression.
+ */
+class GzipOFStream : public std::ostream
+{
+public:
+
+    explicit GzipOFStream(
+        std::string const&   filename,
+        GzipCompressionLevel level = GzipCompressionLevel::kDefaultCompression
+    );
+
+    ~GzipOFStream() override = default;
+
+    /**
+     * @brief Write the end of the gzip data. See GzipStreamBuf::finish().
+     */
+    void finish()
+    {
+        buffer_->finish();
+    }
+
+private:
+
+    // The file needs to be destroyed after the buffer, which writes its remaining data
+    // to the file on destruction.
+    std::ofstream                  file_;
+    std::unique_ptr<GzipStreamBuf> buffer_;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
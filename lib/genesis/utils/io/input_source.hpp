@@ -34,6 +34,8 @@
 #include "genesis/utils/io/base_input_source.hpp"
 #include "genesis/utils/io/file_input_source.hpp"
 #include "genesis/utils/io/gzip_input_source.hpp"
+#include "genesis/utils/io/mmap_input_source.hpp"
+#include "genesis/utils/io/parallel_gzip_input_source.hpp"
 #include "genesis/utils/io/stream_input_source.hpp"
 #include "genesis/utils/io/string_input_source.hpp"
 
@@ -61,6 +63,8 @@ namespace utils {
  * If the parameter @p detect_compression is `true` (default), it is first determined whether the
  * file is gzip compressed, and if so, a transparent decompression layer is added.
  * That means, gzip-compressed files can be decompressed automatically and on the fly.
+ * For files in the BGZF format (as produced by `bgzip`), decompression runs on multiple threads,
+ * see ParallelGzipInputSource for details.
  *
  * @see from_files(), from_string(), from_strings(), and from_stream() for similar
  * helper functions for other types of input sources.
@@ -70,7 +74,7 @@ inline std::shared_ptr<BaseInputSource> from_file(
     bool detect_compression = true
 ) {
     if( detect_compression && is_gzip_compressed_file( file_name )) {
-        return std::make_shared<utils::GzipInputSource>(
+        return std::make_shared<utils::ParallelGzipInputSource>(
             std::make_shared< FileInputSource >( file_name )
         );
     } else {
@@ -99,6 +103,46 @@ inline std::vector<std::shared_ptr<BaseInputSource>> from_files(
     return ret;
 }
 
+/**
+ * @brief Obtain an input source for reading from a file that is mapped into memory.
+ *
+ * This works as from_file(), but uses a MmapInputSource instead of a FileInputSource. Readers
+ * then directly walk the mapped file, instead of copying it block by block into their buffer.
+ * This is useful for large uncompressed local files. If the file is gzip compressed (and
+ * @p detect_compression is `true`), the mapped file is decompressed on the fly as usual.
+ *
+ * @see from_mapped_files() for reading from multiple files.
+ */
+inline std::shared_ptr<BaseInputSource> from_mapped_file(
+    std::string const& file_name,
+    bool detect_compression = true
+) {
+    if( detect_compression && is_gzip_compressed_file( file_name )) {
+        return std::make_shared<utils::ParallelGzipInputSource>(
+            std::make_shared< MmapInputSource >( file_name )
+        );
+    } else {
+        return std::make_shared< MmapInputSource >( file_name );
+    }
+}
+
+/**
+ * @brief Obtain a set of input sources for reading from files that are mapped into memory.
+ *
+ * See from_mapped_file() and from_files() for details. The files are only mapped once
+ * they are read from.
+ */
+inline std::vector<std::shared_ptr<BaseInputSource>> from_mapped_files(
+    std::vector<std::string> const& file_names,
+    bool detect_compression = true
+) {
+    std::vector<std::shared_ptr<BaseInputSource>> ret;
+    for( size_t i = 0; i < file_names.size(); ++i ) {
+        ret.emplace_back( from_mapped_file( file_names[i], detect_compression ));
+    }
+    return ret;
+}
+
 /**
  * @brief Obtain an input sources for reading from a string.
  *
@@ -32,9 +32,11 @@
  */
 
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/char_search.hpp"
 #include "genesis/utils/io/input_reader.hpp"
 #include "genesis/utils/io/input_source.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <stdexcept>
@@ -71,6 +73,12 @@ namespace utils {
  * position. The member function current() furthermore provides a checked version of the
  * dereference operator.
  *
+ * Usually, the input is read in blocks into an internal buffer, using an InputReader that reads
+ * the next block asynchronously while the current one is processed. If the input source provides
+ * its whole data in memory via BaseInputSource::mapped_data() instead, as the MmapInputSource
+ * does, the stream directly walks that data without any copies. In that case, there is also
+ * no limit on the length of lines that can be read with get_line().
+ *
  * Implementation details inspired by
  * [fast-cpp-csv-parser](https://github.com/ben-strasser/fast-cpp-csv-parser) by Ben Strasser,
  * see also @link supplement_acknowledgements_code_reuse_input_stream Acknowledgements@endlink.
@@ -118,7 +126,9 @@ public:
 
     ~InputStream()
     {
-        delete[] buffer_;
+        if( ! mapped_source_ ) {
+            delete[] buffer_;
+        }
         buffer_ = nullptr;
     }
 
@@ -138,14 +148,15 @@ public:
             return *this;
         }
 
-        input_reader_ = std::move( other.input_reader_ );
-        source_name_  = std::move( other.source_name_ );
-
-        // Need to free our current buffer.
-        if( buffer_ ) {
+        // Need to free our current buffer, unless it is the data of a mapped source.
+        if( buffer_ && ! mapped_source_ ) {
             delete[] buffer_;
         }
 
+        input_reader_  = std::move( other.input_reader_ );
+        mapped_source_ = std::move( other.mapped_source_ );
+        source_name_   = std::move( other.source_name_ );
+
         // Move the data.
         buffer_   = other.buffer_;
         data_pos_ = other.data_pos_;
@@ -219,7 +230,7 @@ public:
 
         // Read data if necessary.
         update_blocks_();
-        assert( data_pos_ < BlockLength );
+        assert( mapped_source_ || data_pos_ < BlockLength );
 
         // In case we are moving to a new line, set the counters accordingly.
         if( current_ == '\n' ) {
@@ -281,20 +292,14 @@ public:
         while( true ) {
             // Read data if necessary.
             update_blocks_();
-            assert( data_pos_ < BlockLength );
+            assert( mapped_source_ || data_pos_ < BlockLength );
 
             // Read until the end of the line, but also stop before the end of the data,
             // and after we read a full block. End of data: we are done anyway.
             // End of block: need to read the next one first, so loop again.
             size_t const start = data_pos_;
-            while(
-                data_pos_ != data_end_          &&
-                data_pos_ - start < BlockLength &&
-                buffer_[ data_pos_ ] != '\n'    &&
-                buffer_[ data_pos_ ] != '\r'
-            ) {
-                ++data_pos_;
-            }
+            size_t const limit = std::min( data_end_, start + BlockLength );
+            data_pos_ = find_either_char( buffer_ + start, buffer_ + limit, '\n', '\r' ) - buffer_;
 
             // Store what we have so far.
             target.append( buffer_ + start, data_pos_ - start );
@@ -311,7 +316,7 @@ public:
 
         // Some safty.
         assert( data_pos_ <= data_end_ );
-        assert( data_pos_ < 2 * BlockLength );
+        assert( mapped_source_ || data_pos_ < 2 * BlockLength );
 
         // Check all cases that can occur.
         if( data_pos_ == data_end_ ) {
@@ -359,6 +364,111 @@ public:
         return result;
     }
 
+    // -------------------------------------------------------------
+    //     Char Search
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Move forward until the current char equals @p criterion, or until the end of the
+     * input is reached.
+     *
+     * This is equivalent to calling advance() until the condition is met, but searches the
+     * buffered data in bulk, see char_search.hpp, and updates the line and column counters
+     * only once per chunk of data.
+     */
+    void skip_until( char criterion )
+    {
+        scan_until_(
+            [&]( char const* first, char const* last ){
+                return find_either_char( first, last, criterion, '\r' );
+            },
+            [&]( char c ){
+                return c == criterion;
+            },
+            nullptr
+        );
+    }
+
+    /**
+     * @brief Move forward until the current char equals @p criterion, and append all chars
+     * up to there to @p target.
+     *
+     * This is the equivalent of skip_until(), but keeps the chars. As with all other functions,
+     * new lines are turned into `\n`.
+     */
+    void read_until( std::string& target, char criterion )
+    {
+        scan_until_(
+            [&]( char const* first, char const* last ){
+                return find_either_char( first, last, criterion, '\r' );
+            },
+            [&]( char c ){
+                return c == criterion;
+            },
+            &target
+        );
+    }
+
+    /**
+     * @brief Move forward until the current char is one of the given @p chars, or until the end
+     * of the input is reached.
+     *
+     * This is meant for small sets of chars, such as the separator and quotation chars of
+     * a CSV file.
+     */
+    void skip_until_any_of( std::string const& chars )
+    {
+        auto const stops = chars + '\r';
+        scan_until_(
+            [&]( char const* first, char const* last ){
+                return find_any_of( first, last, stops );
+            },
+            [&]( char c ){
+                return chars.find( c ) != std::string::npos;
+            },
+            nullptr
+        );
+    }
+
+    /**
+     * @brief Move forward until the current char is one of the given @p chars, and append all
+     * chars up to there to @p target.
+     */
+    void read_until_any_of( std::string& target, std::string const& chars )
+    {
+        auto const stops = chars + '\r';
+        scan_until_(
+            [&]( char const* first, char const* last ){
+                return find_any_of( first, last, stops );
+            },
+            [&]( char c ){
+                return chars.find( c ) != std::string::npos;
+            },
+            &target
+        );
+    }
+
+    /**
+     * @brief Move forward while the current char equals @p criterion.
+     */
+    void skip_while( char criterion )
+    {
+        // The stream never yields `\r`, so there is nothing to skip in that case.
+        // For all other criteria, the search also stops at `\r`, as it differs from them.
+        if( criterion == '\r' ) {
+            return;
+        }
+        scan_until_(
+            [&]( char const* first, char const* last ){
+                return find_not_char( first, last, criterion );
+            },
+            [&]( char c ){
+                return c != criterion;
+            },
+            nullptr
+        );
+    }
+
     // -------------------------------------------------------------
     //     State
     // -------------------------------------------------------------
@@ -461,10 +571,11 @@ private:
         assert( data_pos_ <  data_end_ );
 
         // If this assertion breaks, someone tempered with our internal invariants.
-        assert( data_end_ <= BlockLength * 2 );
+        assert( mapped_source_ || data_end_ <= BlockLength * 2 );
 
         // If we are past the first block, we need to load more data into the blocks.
-        if( data_pos_ >= BlockLength ) {
+        // Mapped data is available as a whole, so nothing to do in that case.
+        if( data_pos_ >= BlockLength && ! mapped_source_ ) {
 
             // Move the second to the first block.
             std::memcpy( buffer_, buffer_ + BlockLength, BlockLength );
@@ -481,7 +592,79 @@ private:
         }
 
         // After the update, the current position needs to be within the first block.
-        assert( data_pos_ < BlockLength );
+        assert( mapped_source_ || data_pos_ < BlockLength );
+    }
+
+    /**
+     * @brief Move forward until @p is_stop is true for the current char, using @p search to skip
+     * over chunks of the data at once. If a @p target is given, the chars are appended to it.
+     *
+     * The @p search function needs to find the first char in a range for which @p is_stop
+     * is true, but also has to stop at every `\r`, which we hand over to advance() instead,
+     * so that the new line handling of set_current_char_() stays in one place.
+     */
+    template< typename Search, typename IsStop >
+    void scan_until_( Search search, IsStop is_stop, std::string* target )
+    {
+        while( data_pos_ < data_end_ && ! is_stop( current_ )) {
+            bulk_advance_( search, target );
+            if( data_pos_ >= data_end_ || is_stop( current_ )) {
+                break;
+            }
+
+            // The search stopped at a char that needs special treatment, or we are at the end
+            // of the current block or data. Go on with the next char one by one.
+            if( target ) {
+                target->push_back( current_ );
+            }
+            advance();
+        }
+    }
+
+    /**
+     * @brief Move forward in one go to the position found by @p search within the buffered data,
+     * and update the counters accordingly.
+     */
+    template< typename Search >
+    void bulk_advance_( Search search, std::string* target )
+    {
+        if( data_pos_ >= data_end_ ) {
+            return;
+        }
+        update_blocks_();
+
+        // Stay before the last char of the data, as set_current_char_() might need to add a
+        // closing new line there. Also, do not search further than one block, see get_line().
+        size_t const end = std::min( data_end_ - 1, data_pos_ + BlockLength );
+        if( data_pos_ >= end ) {
+            return;
+        }
+        auto const first = buffer_ + data_pos_;
+        auto const found = search( first, buffer_ + end );
+        assert( found >= first && found <= buffer_ + end );
+        auto const count = static_cast<size_t>( found - first );
+        if( count == 0 ) {
+            return;
+        }
+        if( target ) {
+            target->append( first, count );
+        }
+
+        // Update the counters for all chars that we skipped, in the same way as advance() does.
+        auto const lines = count_char( first, found, '\n' );
+        if( lines == 0 ) {
+            column_ += count;
+        } else {
+            auto line_start = found;
+            while( *( line_start - 1 ) != '\n' ) {
+                --line_start;
+            }
+            line_   += lines;
+            column_  = static_cast<size_t>( found - line_start ) + 1;
+        }
+
+        data_pos_ += count;
+        set_current_char_();
     }
 
     /**
@@ -497,22 +680,29 @@ private:
             return;
         }
 
-        // Treat stupid Windows and Mac lines breaks. Set them to \n, so that downstream parsers
-        // don't have to deal with this.
+        // Treat stupid Windows and Mac lines breaks. Turn them into \n, so that downstream parsers
+        // don't have to deal with this. We do not change the buffer here, as it might be the
+        // data of a mapped source, which has to stay untouched.
         if( buffer_[ data_pos_ ] == '\r' ) {
-            buffer_[ data_pos_ ] = '\n';
 
             // If this is a Win line break \r\n, skip one of them, so that only a single \n
             // is visible to the outside.
             if( data_pos_ + 1 < data_end_ && buffer_[ data_pos_ + 1 ] == '\n' ) {
                 ++data_pos_;
+            } else {
+                current_ = '\n';
+                return;
             }
         }
 
         // If this is the last char of the data, but there is no closing \n, add one.
+        // Mapped sources already provide this char after their data, so we must not write it.
         if( data_pos_ + 1 == data_end_ && buffer_[ data_pos_ ] != '\n' ) {
+            if( ! mapped_source_ ) {
+                buffer_[ data_pos_ + 1 ] = '\n';
+            }
+            assert( buffer_[ data_pos_ + 1 ] == '\n' );
             ++data_end_;
-            buffer_[ data_pos_ + 1 ] = '\n';
         }
 
         // Set the char.
@@ -538,6 +728,19 @@ private:
             return;
         }
 
+        // If the source provides its data in memory, we can directly read from there.
+        // We keep a pointer to the source, so that the data stays valid while we read.
+        // The data is never written to, see set_current_char_().
+        size_t mapped_size = 0;
+        auto const mapped_data = input_source->mapped_data( mapped_size );
+        if( mapped_data ) {
+            source_name_   = input_source->source_name();
+            mapped_source_ = input_source;
+            buffer_        = const_cast<char*>( mapped_data );
+            init_data_( mapped_size );
+            return;
+        }
+
         // We use three buffer blocks: The first two for the current block/line.
         // The max line length is one buffer length, so the beginning of the line is always
         // in the first block, while its end can reach into the second block, but never exeed it.
@@ -549,26 +752,7 @@ private:
             source_name_ = input_source->source_name();
 
             // Read up to two blocks.
-            data_pos_ = 0;
-            data_end_ = input_source->read( buffer_, 2 * BlockLength );
-
-            // Skip UTF-8 BOM, if found.
-            if( data_end_  >= 3      &&
-                buffer_[0] == '\xEF' &&
-                buffer_[1] == '\xBB' &&
-                buffer_[2] == '\xBF'
-            ) {
-                data_pos_ = 3;
-            }
-
-            // If there was no data, set to "empty" values.
-            if( data_pos_ == data_end_ ) {
-                reset_();
-
-            // If there is data, set char value.
-            } else {
-                set_current_char_();
-            }
+            init_data_( input_source->read( buffer_, 2 * BlockLength ));
 
             // If there is more data after the two blocks that we just read, start the
             // reading process (possibly async, if pthreads is available).
@@ -588,6 +772,33 @@ private:
         }
     }
 
+    /**
+     * @brief Set the data range of the buffer, and move to its first char.
+     */
+    void init_data_( size_t data_end )
+    {
+        data_pos_ = 0;
+        data_end_ = data_end;
+
+        // Skip UTF-8 BOM, if found.
+        if( data_end_  >= 3      &&
+            buffer_[0] == '\xEF' &&
+            buffer_[1] == '\xBB' &&
+            buffer_[2] == '\xBF'
+        ) {
+            data_pos_ = 3;
+        }
+
+        // If there was no data, set to "empty" values.
+        if( data_pos_ == data_end_ ) {
+            reset_();
+
+        // If there is data, set char value.
+        } else {
+            set_current_char_();
+        }
+    }
+
     // -------------------------------------------------------------
     //     Data Members
     // -------------------------------------------------------------
@@ -599,6 +810,9 @@ private:
     std::unique_ptr<InputReader> input_reader_ = nullptr;
     std::string source_name_;
 
+    // ...or it is directly taken from a mapped source, which we need to keep alive.
+    std::shared_ptr<BaseInputSource> mapped_source_ = nullptr;
+
     // ...and is buffered here.
     char*  buffer_;
     size_t data_pos_;
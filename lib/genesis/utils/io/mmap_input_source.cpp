@@ -0,0 +1,196 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/mmap_input_source.hpp"
+
+#include "genesis/utils/core/fs.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined( _WIN32 ) || defined(  _WIN64  )
+#   include <fstream>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+MmapInputSource::MmapInputSource( std::string const& file_name )
+    : file_name_( file_name )
+{
+    if( ! file_exists( file_name ) ) {
+        throw std::runtime_error( "File does not exist or is not readable: " + file_name );
+    }
+}
+
+MmapInputSource::~MmapInputSource()
+{
+    if( data_ == nullptr ) {
+        return;
+    }
+
+    #if defined( _WIN32 ) || defined(  _WIN64  )
+        delete[] data_;
+    #else
+        munmap( data_, capacity_ );
+    #endif
+}
+
+// =================================================================================================
+//     Overloaded Internal Members
+// =================================================================================================
+
+size_t MmapInputSource::read_( char* buffer, size_t size )
+{
+    map_();
+
+    assert( read_pos_ <= size_ );
+    size_t const count = std::min( size, size_ - read_pos_ );
+    std::memcpy( buffer, data_ + read_pos_, count );
+    read_pos_ += count;
+    return count;
+}
+
+char const* MmapInputSource::mapped_data_( size_t& size )
+{
+    map_();
+
+    size = size_;
+    return data_;
+}
+
+// =================================================================================================
+//     Mapping
+// =================================================================================================
+
+#if defined( _WIN32 ) || defined(  _WIN64  )
+
+void MmapInputSource::map_()
+{
+    if( data_ ) {
+        return;
+    }
+
+    // Without mmap, we simply read the whole file at once.
+    std::ifstream file( file_name_, std::ios::in | std::ios::binary | std::ios::ate );
+    if( ! file ) {
+        throw std::runtime_error( "Cannot open file " + file_name_ );
+    }
+    size_     = static_cast<size_t>( file.tellg() );
+    capacity_ = size_ + 1;
+    data_     = new char[ capacity_ ];
+    file.seekg( 0 );
+    if( ! file.read( data_, size_ )) {
+        delete[] data_;
+        data_ = nullptr;
+        throw std::runtime_error( "Cannot read from file: " + file_name_ );
+    }
+    data_[ size_ ] = '\n';
+}
+
+#else
+
+void MmapInputSource::map_()
+{
+    if( data_ ) {
+        return;
+    }
+
+    errno = 0;
+    int const fd = open( file_name_.c_str(), O_RDONLY );
+    if( fd < 0 ) {
+        throw std::runtime_error(
+            "Cannot open file " + file_name_ + ": " + std::string( strerror( errno ))
+        );
+    }
+
+    struct stat info;
+    if( fstat( fd, &info ) != 0 ) {
+        close( fd );
+        throw std::runtime_error( "Cannot read from file: " + file_name_ );
+    }
+    size_ = static_cast<size_t>( info.st_size );
+
+    // We need one byte after the data for the closing new line char. As mapping the file beyond
+    // its end is not allowed, we first reserve an anonymous region that is large enough for this,
+    // and then map the file over its beginning. The mapping is private, so that writing the new
+    // line char does not change the file.
+    auto const page_size = static_cast<size_t>( sysconf( _SC_PAGESIZE ));
+    capacity_ = (( size_ + 1 + page_size - 1 ) / page_size ) * page_size;
+    void* region = mmap(
+        nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+    if( region == MAP_FAILED ) {
+        close( fd );
+        throw std::runtime_error(
+            "Cannot map file " + file_name_ + ": " + std::string( strerror( errno ))
+        );
+    }
+    if( size_ > 0 ) {
+        void* file_region = mmap(
+            region, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0
+        );
+        if( file_region == MAP_FAILED ) {
+            munmap( region, capacity_ );
+            close( fd );
+            throw std::runtime_error(
+                "Cannot map file " + file_name_ + ": " + std::string( strerror( errno ))
+            );
+        }
+        assert( file_region == region );
+
+        // We read the file front to back, so tell the system to read ahead aggressively.
+        // This is only a hint, so we do not care whether it worked.
+        madvise( region, size_, MADV_SEQUENTIAL );
+    }
+
+    // The mapping stays valid after closing the file.
+    close( fd );
+
+    data_ = static_cast<char*>( region );
+    data_[ size_ ] = '\n';
+}
+
+#endif
+
+} // namespace utils
+} // namespace genesis
@@ -0,0 +1,141 @@
+#ifndef GENESIS_UTILS_IO_MMAP_INPUT_SOURCE_H_
+#define GENESIS_UTILS_IO_MMAP_INPUT_SOURCE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/base_input_source.hpp"
+
+#include <string>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Mmap Input Source
+// =================================================================================================
+
+/**
+ * @brief Input source for reading byte data from a file that is mapped into memory.
+ *
+ * The input file name is provided via the constructor. The file is mapped on first use, so that
+ * creating many of these sources (e.g., via from_mapped_files()) does not map all files at once.
+ * The mapping is kept until the source is destroyed.
+ *
+ * Other than the FileInputSource, this source provides its data via mapped_data(). An InputStream
+ * that reads from it hence walks the mapping directly, instead of copying blocks of the file
+ * into its buffer with an asynchronous reader thread. This avoids the double buffering for large
+ * local files. The operating system takes care of reading the pages of the file as needed.
+ * The source can also be read via the usual read() function, for example when wrapped in a
+ * GzipInputSource.
+ *
+ * On systems without `mmap`, the whole file is read into memory at once instead.
+ *
+ * The class can neither be copied nor moved, as it owns the mapping.
+ * Use it via a `std::shared_ptr`, as all other input sources.
+ */
+class MmapInputSource : public BaseInputSource
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the input source from a file with the given file name.
+     */
+    explicit MmapInputSource( std::string const& file_name );
+
+    MmapInputSource( MmapInputSource const& ) = delete;
+    MmapInputSource( MmapInputSource&& )      = delete;
+
+    MmapInputSource& operator= ( MmapInputSource const& ) = delete;
+    MmapInputSource& operator= ( MmapInputSource&& )      = delete;
+
+    ~MmapInputSource() override;
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Override of the read function. Copies from the mapping.
+     */
+    size_t read_( char* buffer, size_t size ) override;
+
+    /**
+     * @brief Override of the mapped data function. Returns the whole mapping.
+     */
+    char const* mapped_data_( size_t& size ) override;
+
+    /**
+     * @brief Override of the source name funtion. Returns "input file (<file_name>)".
+     */
+    std::string source_name_() const override
+    {
+        return "input file (" + file_name_ + ")";
+    }
+
+    /**
+     * @brief Override of the source string funtion. Returns the file name.
+     */
+    std::string source_string_() const override
+    {
+        return file_name_;
+    }
+
+    /**
+     * @brief Map the file into memory, if not yet done.
+     */
+    void map_();
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::string file_name_;
+
+    // The mapped data, its size (excluding the extra new line char), and the length of the
+    // whole memory region that we reserved for it.
+    char*       data_     = nullptr;
+    size_t      size_     = 0;
+    size_t      capacity_ = 0;
+
+    // Position for reading via read_().
+    size_t      read_pos_ = 0;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
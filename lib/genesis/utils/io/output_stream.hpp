@@ -34,11 +34,15 @@
 #include "genesis/utils/core/exception.hpp"
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/options.hpp"
+#include "genesis/utils/io/gzip_stream.hpp"
 
 #include <fstream>
+#include <memory>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace genesis {
 namespace utils {
@@ -84,6 +88,53 @@ inline void file_output_stream(
     }
 }
 
+/**
+ * @brief Helper function to obtain an output stream to a file, which is gzip-compressed
+ * if the file name ends in `.gz`.
+ *
+ * This function is used by the `to_file()` functions of the writers for text formats, so that
+ * for example `FastaWriter().to_file( sequences, "sequences.fasta.gz" )` writes a compressed file,
+ * which can be read again with utils::from_file(). The compression is done by a GzipOFStream.
+ * If @p detect_compression is `false`, or the file name does not end in `.gz`, a normal
+ * `std::ofstream` is returned.
+ *
+ * In both cases, the file is opened via file_output_stream(), and hence the same checks for
+ * existing files apply.
+ */
+inline std::unique_ptr<std::ostream> make_file_output_stream(
+    std::string const& filename,
+    bool detect_compression = true
+) {
+    if( detect_compression && file_extension( filename ) == "gz" ) {
+        return std::unique_ptr<std::ostream>( new GzipOFStream( filename ));
+    }
+
+    auto ofs = std::unique_ptr<std::ofstream>( new std::ofstream() );
+    file_output_stream( filename, *ofs );
+    return std::unique_ptr<std::ostream>( std::move( ofs ));
+}
+
+/**
+ * @brief Helper function to finish writing to a stream obtained from make_file_output_stream().
+ *
+ * For compressed files, this writes the end of the gzip data. In both cases, the stream is then
+ * flushed, and the function throws if any write to the file failed. The destructors of the streams
+ * cannot report such errors, so without this, a full disk for example would silently result in
+ * a truncated file. The `to_file()` functions of the writers call this after writing their data.
+ */
+inline void finish_file_output_stream( std::ostream& out_stream, std::string const& filename )
+{
+    auto const gzip_stream = dynamic_cast<GzipOFStream*>( &out_stream );
+    if( gzip_stream ) {
+        gzip_stream->finish();
+    }
+
+    out_stream.flush();
+    if( out_stream.fail() ) {
+        throw std::runtime_error( "Cannot write to file '" + filename + "'." );
+    }
+}
+
 } // namespace utils
 } // namespace genesis
 
@@ -0,0 +1,619 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/parallel_gzip_input_source.hpp"
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/options.hpp"
+#include "genesis/utils/io/gzip_input_source.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+#ifdef GENESIS_PTHREADS
+#    include <condition_variable>
+#    include <exception>
+#    include <future>
+#    include <mutex>
+#    include <thread>
+#endif
+
+#ifdef GENESIS_ZLIB
+#    include "zlib.h"
+#endif
+
+#ifdef GENESIS_OPENMP
+#   include <omp.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Input source that first yields a given prefix, and then the data of another source.
+ *
+ * We use this to hand over the input that we already read for detecting the format
+ * to the fallback GzipInputSource.
+ */
+class PrefixedInputSource : public BaseInputSource
+{
+public:
+
+    PrefixedInputSource( std::string&& prefix, std::shared_ptr<BaseInputSource> input_source )
+        : prefix_( std::move( prefix ))
+        , input_source_( input_source )
+    {}
+
+    ~PrefixedInputSource() override = default;
+
+private:
+
+    size_t read_( char* buffer, size_t size ) override
+    {
+        // Use the prefix first, and then the rest from the source.
+        size_t const count = std::min( size, prefix_.size() - prefix_pos_ );
+        std::memcpy( buffer, prefix_.data() + prefix_pos_, count );
+        prefix_pos_ += count;
+        if( count < size ) {
+            return count + input_source_->read( buffer + count, size - count );
+        }
+        return count;
+    }
+
+    std::string source_name_() const override
+    {
+        return input_source_->source_name();
+    }
+
+    std::string source_string_() const override
+    {
+        return input_source_->source_string();
+    }
+
+    std::string                      prefix_;
+    size_t                           prefix_pos_ = 0;
+    std::shared_ptr<BaseInputSource> input_source_;
+};
+
+/**
+ * @brief Read a little endian 16 bit unsigned integer, as used in gzip headers.
+ */
+static size_t read_uint16_le( char const* data )
+{
+    auto const bytes = reinterpret_cast<unsigned char const*>( data );
+    return static_cast<size_t>( bytes[0] ) | ( static_cast<size_t>( bytes[1] ) << 8 );
+}
+
+/**
+ * @brief Read a little endian 32 bit unsigned integer, as used in gzip trailers.
+ */
+static size_t read_uint32_le( char const* data )
+{
+    return read_uint16_le( data ) | ( read_uint16_le( data + 2 ) << 16 );
+}
+
+/**
+ * @brief Size of the fixed part of the header of a gzip member with extra field,
+ * that is, until the beginning of the extra subfields.
+ */
+static const size_t gzip_header_length = 12;
+
+/**
+ * @brief Check whether the given gzip member header is a BGZF block header.
+ *
+ * The data needs to contain the fixed part of the header (gzip_header_length) as well as all extra
+ * subfields. If it is a BGZF block, the total size of the block is stored in @p block_size.
+ */
+static bool bgzf_block_size( char const* data, size_t& block_size )
+{
+    auto const bytes = reinterpret_cast<unsigned char const*>( data );
+
+    // Magic bytes, deflate compression method, and the flag for extra fields.
+    if( bytes[0] != 0x1f || bytes[1] != 0x8b || bytes[2] != 8 || ( bytes[3] & 4 ) == 0 ) {
+        return false;
+    }
+
+    // Walk the extra subfields and look for the BGZF one, which contains the block size.
+    size_t const xlen = read_uint16_le( data + 10 );
+    size_t pos = gzip_header_length;
+    while( pos + 4 <= gzip_header_length + xlen ) {
+        size_t const slen = read_uint16_le( data + pos + 2 );
+        if( pos + 4 + slen > gzip_header_length + xlen ) {
+            break;
+        }
+        if( data[ pos ] == 'B' && data[ pos + 1 ] == 'C' && slen == 2 ) {
+            block_size = read_uint16_le( data + pos + 4 ) + 1;
+            return block_size > gzip_header_length + xlen + 8;
+        }
+        pos += 4 + slen;
+    }
+    return false;
+}
+
+#ifdef GENESIS_ZLIB
+
+// =================================================================================================
+//     Decompression
+// =================================================================================================
+
+/**
+ * @brief Decompress the given consecutive BGZF blocks.
+ *
+ * This is the function that is run by the worker threads.
+ * It checks the size and CRC32 of each block.
+ */
+static std::string inflate_bgzf_blocks( std::string const& data )
+{
+    // Get the total size of the decompressed data, which is stored at the end of each block.
+    // The block structure was already checked when the blocks were read, but the stored sizes are
+    // not. BGZF blocks hold at most 64kB of uncompressed data, so anything above that is corrupt,
+    // and we do not want to allocate memory for it.
+    size_t total_size = 0;
+    size_t pos = 0;
+    while( pos < data.size() ) {
+        size_t block_size = 0;
+        bgzf_block_size( data.data() + pos, block_size );
+        size_t const isize = read_uint32_le( data.data() + pos + block_size - 4 );
+        if( isize > 65536 ) {
+            throw std::runtime_error( "zlib: Invalid uncompressed size of BGZF block." );
+        }
+        total_size += isize;
+        pos += block_size;
+    }
+    assert( pos == data.size() );
+
+    // Prepare a raw inflate stream, as we already know where the compressed data of each block is.
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.avail_in = 0;
+    stream.next_in = Z_NULL;
+    if( inflateInit2( &stream, -MAX_WBITS ) != Z_OK ) {
+        throw std::runtime_error( "zlib: Cannot initialize decompression." );
+    }
+
+    std::string result( total_size, '\0' );
+    size_t out_pos = 0;
+    pos = 0;
+    while( pos < data.size() ) {
+        size_t block_size = 0;
+        bgzf_block_size( data.data() + pos, block_size );
+        size_t const header_size = gzip_header_length + read_uint16_le( data.data() + pos + 10 );
+        size_t const crc   = read_uint32_le( data.data() + pos + block_size - 8 );
+        size_t const isize = read_uint32_le( data.data() + pos + block_size - 4 );
+
+        // Inflate the block. We cast between char and unsigned char here, which does not change
+        // the byte content.
+        inflateReset( &stream );
+        stream.avail_in  = static_cast<unsigned int>( block_size - header_size - 8 );
+        stream.next_in   = reinterpret_cast<Bytef*>( const_cast<char*>( data.data() + pos + header_size ));
+        stream.avail_out = static_cast<unsigned int>( isize );
+        stream.next_out  = reinterpret_cast<Bytef*>( &result[ out_pos ] );
+        auto const ret = inflate( &stream, Z_FINISH );
+
+        // Check that the block was complete and correct, that is, that it ended exactly after
+        // the stated number of bytes, and that these have the stated checksum.
+        auto const out_ptr = reinterpret_cast<Bytef const*>( result.data() + out_pos );
+        if(
+            ret != Z_STREAM_END || stream.avail_out != 0 || stream.total_out != isize ||
+            crc32( crc32( 0L, Z_NULL, 0 ), out_ptr, static_cast<unsigned int>( isize )) != crc
+        ) {
+            inflateEnd( &stream );
+            throw std::runtime_error( "zlib: Invalid or incomplete deflate data." );
+        }
+
+        out_pos += isize;
+        pos += block_size;
+    }
+    inflateEnd( &stream );
+
+    assert( out_pos == total_size );
+    return result;
+}
+
+// =================================================================================================
+//     Task Queue
+// =================================================================================================
+
+/**
+ * @brief Tasks that are being decompressed, in the order of the input.
+ *
+ * With threading, the tasks are processed by a fixed set of worker threads, which take the
+ * compressed data from a queue of jobs, and hand the result back via the future of the task.
+ * The threads are joined when the queue is destroyed, dropping all jobs that are not yet started.
+ */
+struct ParallelGzipInputSource::TaskQueue
+{
+    #ifdef GENESIS_PTHREADS
+
+        struct Job
+        {
+            std::string                data;
+            std::promise<std::string>  result;
+        };
+
+        ~TaskQueue()
+        {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                stop = true;
+            }
+            condition.notify_all();
+            for( auto& worker : workers ) {
+                worker.join();
+            }
+        }
+
+        void start_workers( size_t num_threads )
+        {
+            assert( workers.empty() );
+            for( size_t i = 0; i < num_threads; ++i ) {
+                workers.emplace_back( [this](){ run_worker(); });
+            }
+        }
+
+        void add( std::string&& data )
+        {
+            Job job;
+            job.data = std::move( data );
+            tasks.emplace_back( job.result.get_future() );
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                jobs.push_back( std::move( job ));
+            }
+            condition.notify_one();
+        }
+
+        void run_worker()
+        {
+            while( true ) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock( mutex );
+                    condition.wait( lock, [this](){ return stop || ! jobs.empty(); });
+                    if( stop ) {
+                        return;
+                    }
+                    job = std::move( jobs.front() );
+                    jobs.pop_front();
+                }
+
+                // Errors are handed to the reading thread, which re-throws them from the future.
+                try {
+                    job.result.set_value( inflate_bgzf_blocks( job.data ));
+                } catch( ... ) {
+                    job.result.set_exception( std::current_exception() );
+                }
+            }
+        }
+
+        std::deque<std::future<std::string>> tasks;
+
+        std::deque<Job>          jobs;
+        std::mutex               mutex;
+        std::condition_variable  condition;
+        bool                     stop = false;
+        std::vector<std::thread> workers;
+
+    #else
+
+        std::deque<std::string> tasks;
+
+    #endif
+};
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+ParallelGzipInputSource::ParallelGzipInputSource(
+    std::shared_ptr<BaseInputSource> input_source,
+    size_t blocks_per_task,
+    size_t num_threads
+)
+    : input_source_( input_source )
+    , blocks_per_task_( std::max( blocks_per_task, static_cast<size_t>( 1 )))
+    , num_threads_( num_threads )
+    , tasks_(
+        new TaskQueue(),
+        []( TaskQueue *impl ) { delete impl; }
+    )
+{
+    // The number of threads is resolved in init_(), once we know where we are read from.
+}
+
+ParallelGzipInputSource::~ParallelGzipInputSource()
+{
+    // The worker threads are stopped and joined by the destructor of the task queue.
+}
+
+// =================================================================================================
+//     Overloaded Internal Members
+// =================================================================================================
+
+size_t ParallelGzipInputSource::read_( char* buffer, size_t size )
+{
+    // Check the format on first use, so that we do not read from all sources at once
+    // when creating many of them via from_files().
+    if( ! initialized_ ) {
+        init_();
+    }
+
+    size_t done = 0;
+    while( done < size ) {
+
+        // If the current task is used up, get the next one, waiting for it if needed.
+        // We immediately start a new task to replace it, so that the workers stay busy.
+        if( out_pos_ >= out_buf_.size() ) {
+            start_tasks_();
+            auto& tasks = tasks_->tasks;
+
+            // Once all BGZF blocks are done, the rest of the input (if any) is read by the fallback.
+            if( tasks.empty() ) {
+                if( fallback_ ) {
+                    done += fallback_->read( buffer + done, size - done );
+                }
+                break;
+            }
+
+            #ifdef GENESIS_PTHREADS
+                out_buf_ = tasks.front().get();
+            #else
+                out_buf_ = std::move( tasks.front() );
+            #endif
+            tasks.pop_front();
+            out_pos_ = 0;
+
+            start_tasks_();
+            continue;
+        }
+
+        // Copy as much as we can.
+        size_t const count = std::min( size - done, out_buf_.size() - out_pos_ );
+        std::memcpy( buffer + done, out_buf_.data() + out_pos_, count );
+        out_pos_ += count;
+        done += count;
+    }
+
+    return done;
+}
+
+std::string ParallelGzipInputSource::source_string_() const
+{
+    // Check if the extension is one that we want to remove.
+    auto const bn = file_basename( input_source_->source_string() );
+    auto const ex = file_extension( bn );
+
+    // If so, use the full name again to get the complete path, but remove the extension.
+    if( ex == "gz" || ex == "gzip" || ex == "bgz" ) {
+        return file_filename( input_source_->source_string() );
+    }
+    return input_source_->source_string();
+}
+
+// =================================================================================================
+//     Internal Helpers
+// =================================================================================================
+
+void ParallelGzipInputSource::init_()
+{
+    assert( ! initialized_ );
+    initialized_ = true;
+    in_buf_.resize( BlockLength );
+
+    // When we are read within a parallel region, for example by the readers that process many
+    // files in parallel, the threads are already busy. Starting our own set of workers would then
+    // oversubscribe the machine with the square of the number of threads. So by default, we
+    // use a normal gzip input source in that case, which decompresses on the calling thread.
+    if( num_threads_ == 0 ) {
+        #ifdef GENESIS_OPENMP
+            if( omp_in_parallel() ) {
+                start_fallback_();
+                return;
+            }
+        #endif
+        num_threads_ = Options::get().number_of_threads();
+        num_threads_ = std::max( num_threads_, static_cast<size_t>( 1 ));
+    }
+
+    // If the input starts with a BGZF block, we can use parallel decompression.
+    size_t block_size = 0;
+    if(
+        fill_input_( gzip_header_length ) &&
+        fill_input_( gzip_header_length + read_uint16_le( in_buf_.data() + in_pos_ + 10 )) &&
+        bgzf_block_size( in_buf_.data() + in_pos_, block_size )
+    ) {
+        return;
+    }
+
+    // If not, use a normal gzip input source for all of the input.
+    start_fallback_();
+}
+
+void ParallelGzipInputSource::start_fallback_()
+{
+    assert( ! fallback_ );
+
+    // Hand the input that we have read so far and the rest of the source over to a normal
+    // gzip input source. We do not need our buffer any more then.
+    auto prefix = std::string( in_buf_.data() + in_pos_, in_end_ - in_pos_ );
+    fallback_ = std::make_shared<GzipInputSource>(
+        std::make_shared<PrefixedInputSource>( std::move( prefix ), input_source_ )
+    );
+    in_buf_ = std::vector<char>();
+    in_pos_ = 0;
+    in_end_ = 0;
+}
+
+bool ParallelGzipInputSource::fill_input_( size_t size )
+{
+    assert( size <= in_buf_.size() );
+    assert( in_pos_ <= in_end_ );
+
+    // Move the remaining input to the beginning of the buffer, and fill up the rest.
+    if( in_end_ - in_pos_ < size && ! in_finished_ ) {
+        std::memmove( in_buf_.data(), in_buf_.data() + in_pos_, in_end_ - in_pos_ );
+        in_end_ -= in_pos_;
+        in_pos_ = 0;
+
+        size_t const wanted = in_buf_.size() - in_end_;
+        size_t const got = input_source_->read( in_buf_.data() + in_end_, wanted );
+        in_end_ += got;
+        if( got < wanted ) {
+            in_finished_ = true;
+        }
+    }
+    return in_end_ - in_pos_ >= size;
+}
+
+std::string ParallelGzipInputSource::read_task_()
+{
+    std::string result;
+    for( size_t i = 0; i < blocks_per_task_; ++i ) {
+
+        // Check for the end of the input.
+        if( ! fill_input_( 1 )) {
+            break;
+        }
+
+        // Read the header of the block. If it is not a BGZF block, we cannot split the input
+        // any further, and leave the rest to a normal gzip input source, which also takes care
+        // of reporting invalid input.
+        size_t block_size = 0;
+        if(
+            ! fill_input_( gzip_header_length ) ||
+            ! fill_input_( gzip_header_length + read_uint16_le( in_buf_.data() + in_pos_ + 10 )) ||
+            ! bgzf_block_size( in_buf_.data() + in_pos_, block_size )
+        ) {
+            start_fallback_();
+            break;
+        }
+        if( ! fill_input_( block_size )) {
+            throw std::runtime_error(
+                "Unexpected end of " + input_source_->source_name() + " within a BGZF block."
+            );
+        }
+
+        result.append( in_buf_.data() + in_pos_, block_size );
+        in_pos_ += block_size;
+    }
+    return result;
+}
+
+void ParallelGzipInputSource::start_tasks_()
+{
+    auto& tasks = tasks_->tasks;
+    while( tasks.size() < num_threads_ && ! fallback_ ) {
+        auto data = read_task_();
+        if( data.empty() ) {
+            break;
+        }
+
+        #ifdef GENESIS_PTHREADS
+            if( tasks_->workers.empty() ) {
+                tasks_->start_workers( num_threads_ );
+            }
+            tasks_->add( std::move( data ));
+        #else
+            tasks.emplace_back( inflate_bgzf_blocks( data ));
+        #endif
+    }
+}
+
+#else // GENESIS_ZLIB
+
+// =================================================================================================
+//     Functions without zlib
+// =================================================================================================
+
+// Here, we define the class members as empty functions, throwing in the constructor.
+// This is offered to be able to write code that mentions the class, without having to have zlib.
+
+ParallelGzipInputSource::~ParallelGzipInputSource()
+{
+    // Empty on purpose.
+}
+
+ParallelGzipInputSource::ParallelGzipInputSource(
+    std::shared_ptr<BaseInputSource>,
+    size_t,
+    size_t
+)
+    : input_source_()
+    , blocks_per_task_( 0 )
+    , num_threads_( 0 )
+    , tasks_( nullptr, []( TaskQueue* ){} )
+{
+    // Just avoid doing anything really.
+    throw std::runtime_error( "zlib: Library was not compiled with zlib support." );
+}
+
+size_t ParallelGzipInputSource::read_( char*, size_t )
+{
+    return 0;
+}
+
+std::string ParallelGzipInputSource::source_string_() const
+{
+    return "";
+}
+
+void ParallelGzipInputSource::init_()
+{}
+
+void ParallelGzipInputSource::start_fallback_()
+{}
+
+bool ParallelGzipInputSource::fill_input_( size_t )
+{
+    return false;
+}
+
+std::string ParallelGzipInputSource::read_task_()
+{
+    return "";
+}
+
+void ParallelGzipInputSource::start_tasks_()
+{}
+
+#endif // GENESIS_ZLIB
+
+} // namespace utils
+} // namespace genesis
@@ -0,0 +1,209 @@
+#ifndef GENESIS_UTILS_IO_PARALLEL_GZIP_INPUT_SOURCE_H_
+#define GENESIS_UTILS_IO_PARALLEL_GZIP_INPUT_SOURCE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/base_input_source.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Parallel Gzip Input Source
+// =================================================================================================
+
+/**
+ * @brief Input source for reading byte data from a gzip-compressed source, decompressing
+ * independent blocks of the input in parallel.
+ *
+ * The [BGZF](https://samtools.github.io/hts-specs/SAMv1.pdf) format, as produced by `bgzip`, is a
+ * gzip file that consists of many small gzip members, each of which stores its own compressed size
+ * in its header. This allows to split the input into independent tasks of some of these blocks
+ * without decompressing them, and to decompress them on worker threads, ahead of where the input
+ * is currently read. The decompressed data is then handed out in the original order. As the
+ * InputStream additionally reads the next buffer block asynchronously, reading, decompressing and
+ * parsing of the input then all happen in parallel.
+ *
+ * Other gzip files do not store the boundaries of their members, and hence cannot be split without
+ * decompressing them. For those, as well as for zlib-compressed input, this class falls back to
+ * a normal GzipInputSource, which decompresses on the calling thread. This also happens in the
+ * middle of the input, once a gzip member is found that is not a BGZF block, for example for
+ * a BGZF file and a normal gzip file that were concatenated. The rest of the input is then read
+ * by the GzipInputSource. It is thus safe to use this class for any compressed input.
+ *
+ * The number of tasks that are decompressed ahead, and hence the number of worker threads, is
+ * given by the @p num_threads constructor argument, which defaults to
+ * Options::get().number_of_threads(). The worker threads are started once the first task is
+ * ready, and are kept until the source is destroyed. If threading is not available (that is,
+ * `GENESIS_PTHREADS` is not set), the blocks are decompressed on the calling thread.
+ * The same happens by default if the source is first read from within an OpenMP parallel region,
+ * such as when many files are read in parallel, as the threads are then already busy with reading.
+ *
+ * The class can be moved, but not copied, because of the internal state that is kept for
+ * decompression, and which would mess up the input source if copied.
+ */
+class ParallelGzipInputSource : public BaseInputSource
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the input source using another input source
+     * (FileInputSource, MmapInputSource, StreamInputSource, etc),
+     * and add parallel gzip decompression on top.
+     *
+     * The @p blocks_per_task determines how many BGZF blocks (each at most 64kB in size) are
+     * decompressed as one task on a worker thread. The default yields tasks of up to 4MB of
+     * decompressed data. If @p num_threads is `0`, Options::get().number_of_threads() is used,
+     * unless the source is read from within a parallel region, see the class description.
+     */
+    explicit ParallelGzipInputSource(
+        std::shared_ptr<BaseInputSource> input_source,
+        size_t blocks_per_task = 64,
+        size_t num_threads = 0
+    );
+
+    ParallelGzipInputSource( ParallelGzipInputSource const& ) = delete;
+    ParallelGzipInputSource( ParallelGzipInputSource&& )      = default;
+
+    ParallelGzipInputSource& operator= ( ParallelGzipInputSource const& ) = delete;
+    ParallelGzipInputSource& operator= ( ParallelGzipInputSource&& )      = default;
+
+    ~ParallelGzipInputSource() override;
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Block length for internal input buffering (1MB).
+     */
+    static const size_t BlockLength = 1 << 20;
+
+    /**
+     * @brief Override of the read function.
+     */
+    size_t read_( char* buffer, size_t size ) override;
+
+    /**
+     * @brief Override of the source name funtion. Returns "gzip-compressed <original_source>".
+     */
+    std::string source_name_() const override
+    {
+        return "gzip-compressed " + input_source_->source_name();
+    }
+
+    /**
+     * @brief Override of the source string funtion. Returns the source string of its own
+     * source, potentially removing a trailing ".gz" (for convenience when reading files).
+     */
+    std::string source_string_() const override;
+
+    // -------------------------------------------------------------
+    //     Internal Helpers
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Check the beginning of the input, and decide whether we can use parallel
+     * decompression, or need to fall back to a GzipInputSource.
+     */
+    void init_();
+
+    /**
+     * @brief Hand the remaining input, that is, the rest of our buffer and of the source,
+     * over to a normal GzipInputSource.
+     */
+    void start_fallback_();
+
+    /**
+     * @brief Make sure that at least @p size bytes of input are available in the buffer,
+     * starting at the current position. Return whether this was possible.
+     */
+    bool fill_input_( size_t size );
+
+    /**
+     * @brief Read the compressed data of the next task, that is, of the next `blocks_per_task_`
+     * BGZF blocks of the input. Returns an empty string at the end of the input.
+     *
+     * If a gzip member is found that is not a BGZF block, the task ends before it,
+     * and the rest of the input is handed over to the fallback, see start_fallback_().
+     */
+    std::string read_task_();
+
+    /**
+     * @brief Read and start new tasks, until as many are in flight as we have threads,
+     * and start the worker threads if not yet done.
+     */
+    void start_tasks_();
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::shared_ptr<BaseInputSource> input_source_;
+    size_t blocks_per_task_;
+    size_t num_threads_;
+
+    // If the input is not in BGZF format, or once the first member that is not a BGZF block is
+    // found, we use a normal GzipInputSource for the rest of the input.
+    bool initialized_ = false;
+    std::shared_ptr<BaseInputSource> fallback_;
+
+    // Buffer for the compressed input, with the current position and past-the-end position.
+    std::vector<char> in_buf_;
+    size_t in_pos_ = 0;
+    size_t in_end_ = 0;
+    bool   in_finished_ = false;
+
+    // Decompressed data of the current task, and our position in it.
+    std::string out_buf_;
+    size_t out_pos_ = 0;
+
+    // Tasks that are currently being decompressed. We use a PIMPL-like technique here,
+    // so that the threading headers are not needed in this header.
+    struct TaskQueue;
+    std::unique_ptr<TaskQueue, void (*)(TaskQueue *)> tasks_;
+
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -31,6 +31,8 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/input_stream.hpp"
+
 #include <cassert>
 #include <cctype>
 #include <functional>
@@ -121,6 +123,18 @@ inline void skip_to_end_of_line(
     }
 }
 
+/**
+ * @brief Lexing function that advances the stream to the end of the line, i.e., to the new line
+ * char.
+ *
+ * Overload for InputStream, which searches for the new line in bulk.
+ */
+inline void skip_to_end_of_line(
+    InputStream& source
+) {
+    source.skip_until( '\n' );
+}
+
 /**
  * @brief Lexing function that reads until the end of the line (i.e., to the new line char),
  * and returns the read chars (excluding the new line char).
@@ -140,6 +154,20 @@ inline std::string read_to_end_of_line(
     return target;
 }
 
+/**
+ * @brief Lexing function that reads until the end of the line (i.e., to the new line char),
+ * and returns the read chars (excluding the new line char).
+ *
+ * Overload for InputStream, which searches for the new line in bulk.
+ */
+inline std::string read_to_end_of_line(
+    InputStream& source
+) {
+    std::string target;
+    source.read_until( target, '\n' );
+    return target;
+}
+
 // -------------------------------------------------------------------------
 //     skip while
 // -------------------------------------------------------------------------
@@ -157,6 +185,18 @@ inline void skip_while(
     }
 }
 
+/**
+ * @brief Lexing function that advances the stream while its current char equals the provided one.
+ *
+ * Overload for InputStream, which skips the chars in bulk.
+ */
+inline void skip_while(
+    InputStream& source,
+    char         criterion
+) {
+    source.skip_while( criterion );
+}
+
 /**
  * @brief Lexing function that advances the stream while its current char fulfills the provided
  * criterion.
@@ -188,6 +228,18 @@ inline void skip_until(
     }
 }
 
+/**
+ * @brief Lexing function that advances the stream until its current char equals the provided one.
+ *
+ * Overload for InputStream, which searches for the char in bulk.
+ */
+inline void skip_until(
+    InputStream& source,
+    char         criterion
+) {
+    source.skip_until( criterion );
+}
+
 /**
  * @brief Lexing function that advances the stream until its current char fulfills the provided
  * criterion.
@@ -261,6 +313,21 @@ inline std::string read_until(
     return target;
 }
 
+/**
+ * @brief Lexing function that reads from the stream until its current char equals the provided one.
+ * The read chars are returned.
+ *
+ * Overload for InputStream, which searches for the char in bulk.
+ */
+inline std::string read_until(
+    InputStream& source,
+    char         criterion
+) {
+    std::string target;
+    source.read_until( target, criterion );
+    return target;
+}
+
 /**
  * @brief Lexing function that reads from the stream until its current char fulfills the provided
  * criterion. The read chars are returned.
@@ -31,6 +31,7 @@
 #include "genesis/utils/math/bitvector.hpp"
 
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/math/bitvector/word_ops.hpp"
 
 #include <algorithm>
 #include <functional>
@@ -93,17 +94,6 @@ const Bitvector::IntType Bitvector::ones_mask_[Bitvector::IntSize] =
     Bitvector::all_1_ >> 4,  Bitvector::all_1_ >> 3,  Bitvector::all_1_ >> 2,  Bitvector::all_1_ >> 1
 };
 
-/**
- * @brief Mask used for quickly counting the number of set bits, see count().
- */
-const Bitvector::IntType Bitvector::count_mask_[4] =
-{
-    0x5555555555555555,  //binary: 0101...
-    0x3333333333333333,  //binary: 00110011...
-    0x0f0f0f0f0f0f0f0f,  //binary: 4 zeros, 4 ones...
-    0x0101010101010101   //the sum of 256 to the power of 0,1,2,3...
-};
-
 // =============================================================================
 //     Operators
 // =============================================================================
@@ -114,9 +104,7 @@ Bitvector& Bitvector::operator &= (Bitvector const& rhs)
         throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
     }
 
-    for (size_t i = 0; i < data_.size(); ++i) {
-        data_[i] &= rhs.data_[i];
-    }
+    bitvector_apply_words_( data_.data(), rhs.data_.data(), data_.size(), BitvectorWordAnd() );
     return *this;
 }
 
@@ -126,9 +114,7 @@ Bitvector& Bitvector::operator |= (Bitvector const& rhs)
         throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
     }
 
-    for (size_t i = 0; i < data_.size(); ++i) {
-        data_[i] |= rhs.data_[i];
-    }
+    bitvector_apply_words_( data_.data(), rhs.data_.data(), data_.size(), BitvectorWordOr() );
     return *this;
 }
 
@@ -138,9 +124,7 @@ Bitvector& Bitvector::operator ^= (Bitvector const& rhs)
         throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
     }
 
-    for (size_t i = 0; i < data_.size(); ++i) {
-        data_[i] ^= rhs.data_[i];
-    }
+    bitvector_apply_words_( data_.data(), rhs.data_.data(), data_.size(), BitvectorWordXor() );
     return *this;
 }
 
@@ -175,20 +159,10 @@ bool Bitvector::operator != (const Bitvector &other) const
 
 size_t Bitvector::count() const
 {
-    size_t res = 0;
-    for (IntType x : data_) {
-        // put count of each 2 bits into those 2 bits
-        x -= (x >> 1) & count_mask_[0];
-
-        // put count of each 4 bits into those 4 bits
-        x = (x & count_mask_[1]) + ((x >> 2) & count_mask_[1]);
-
-        // put count of each 8 bits into those 8 bits
-        x = (x + (x >> 4)) & count_mask_[2];
-
-        // take left 8 bits of x + (x<<8) + (x<<16) + (x<<24) + ...
-        res += (x * count_mask_[3]) >> 56;
-    }
+    // The padding bits are always unset, so we can simply count all words.
+    auto const res = bitvector_count_words_(
+        data_.data(), data_.data(), data_.size(), BitvectorWordLhs()
+    );
 
     // safe, but slow version...
     //~ size_t tmp = 0;
@@ -178,6 +178,50 @@ public:
         data_[index / IntSize] ^= bit_mask_[index % IntSize];
     }
 
+    // ---------------------------------------------------------
+    //     Word Functions
+    // ---------------------------------------------------------
+
+    /**
+     * @brief Return the number of words of IntSize bits that store the Bitvector.
+     */
+    inline size_t word_count() const
+    {
+        return data_.size();
+    }
+
+    /**
+     * @brief Return the word at a given index, which contains the bits
+     * `[ index * IntSize, ( index + 1 ) * IntSize )`, starting at the least significant bit.
+     */
+    inline IntType get_word( size_t index ) const
+    {
+        assert( index < data_.size() );
+        return data_[ index ];
+    }
+
+    /**
+     * @brief Set all bits of the word at a given index at once, see get_word().
+     *
+     * Bits of the last word beyond size() are ignored.
+     */
+    inline void set_word( size_t index, IntType value )
+    {
+        assert( index < data_.size() );
+        data_[ index ] = value;
+        if( index + 1 == data_.size() ) {
+            unset_padding_();
+        }
+    }
+
+    /**
+     * @brief Return all words of the Bitvector, for fast word-wise processing.
+     */
+    inline std::vector<IntType> const& data() const
+    {
+        return data_;
+    }
+
     // ---------------------------------------------------------
     //     Operators
     // ---------------------------------------------------------
@@ -204,6 +248,9 @@ public:
 
     /**
      * @brief Count the number of set bits in the Bitvector, that is, its Hamming weight.
+     *
+     * See count_and(), count_or() and count_xor() for counting the set bits of a combination of
+     * two Bitvector%s without creating it.
      */
     size_t count() const;
 
@@ -263,8 +310,6 @@ private:
     static const IntType bit_mask_[IntSize];
     static const IntType ones_mask_[IntSize];
 
-    static const IntType count_mask_[4];
-
     // ---------------------------------------------------------
     //     Data Members
     // ---------------------------------------------------------
@@ -30,7 +30,10 @@
 
 #include "genesis/utils/math/bitvector/operators.hpp"
 
+#include "genesis/utils/math/bitvector/word_ops.hpp"
+
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 namespace genesis {
@@ -124,17 +127,63 @@ Bitvector bitwise_xor (Bitvector const& lhs, Bitvector const& rhs)
 
 Bitvector set_minus (Bitvector const& lhs, Bitvector const& rhs)
 {
-    return lhs & (~rhs);
+    if( lhs.size() != rhs.size() ) {
+        throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
+    }
+
+    // Work on the words directly, instead of creating the negation of rhs first.
+    auto result = Bitvector( lhs.size() );
+    for( size_t i = 0; i < lhs.word_count(); ++i ) {
+        result.set_word( i, lhs.get_word( i ) & ~rhs.get_word( i ));
+    }
+    return result;
 }
 
 Bitvector symmetric_difference (Bitvector const& lhs, Bitvector const& rhs)
 {
-    return (lhs | rhs) & ~(lhs & rhs);
+    return lhs ^ rhs;
+}
+
+// =================================================================================================
+//     Bitvector Counts
+// =================================================================================================
+
+/**
+ * @brief Local helper function that counts the set bits of an operation on two Bitvector%s.
+ */
+template< class Operation >
+static size_t bitvector_count_op_( Bitvector const& lhs, Bitvector const& rhs, Operation const& op )
+{
+    if( lhs.size() != rhs.size() ) {
+        throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
+    }
+
+    // The padding bits are unset in both, so that none of the operations can set them.
+    return bitvector_count_words_( lhs.data().data(), rhs.data().data(), lhs.word_count(), op );
 }
 
+size_t count_and( Bitvector const& lhs, Bitvector const& rhs )
+{
+    return bitvector_count_op_( lhs, rhs, BitvectorWordAnd() );
+}
+
+size_t count_or( Bitvector const& lhs, Bitvector const& rhs )
+{
+    return bitvector_count_op_( lhs, rhs, BitvectorWordOr() );
+}
+
+size_t count_xor( Bitvector const& lhs, Bitvector const& rhs )
+{
+    return bitvector_count_op_( lhs, rhs, BitvectorWordXor() );
+}
+
+// =================================================================================================
+//     Bitvector Relations
+// =================================================================================================
+
 bool is_strict_subset( Bitvector const& sub, Bitvector const& super )
 {
-    return ((sub & super) == sub) && (sub.count() < super.count());
+    return is_subset( sub, super ) && ( sub.count() < super.count() );
 }
 
 bool is_strict_superset( Bitvector const& super, Bitvector const& sub )
@@ -144,12 +193,19 @@ bool is_strict_superset( Bitvector const& super, Bitvector const& sub )
 
 bool is_subset( Bitvector const& sub, Bitvector const& super )
 {
-    return (sub == super) || is_strict_subset(sub, super);
+    if( sub.size() != super.size() ) {
+        throw std::runtime_error( "Cannot use operator on Bitvectors of different size." );
+    }
+
+    // sub is a subset iff it has no bits that are not in super. This stops at the first such bit.
+    return bitvector_none_words_(
+        sub.data().data(), super.data().data(), sub.word_count(), BitvectorWordAndNot()
+    );
 }
 
 bool is_superset( Bitvector const& super, Bitvector const& sub )
 {
-    return (super == sub) || is_strict_superset(super, sub);
+    return is_subset( sub, super );
 }
 
 std::ostream& operator << (std::ostream& s, Bitvector const& bv)
@@ -76,6 +76,35 @@ Bitvector bitwise_xor (Bitvector const& lhs, Bitvector const& rhs);
 Bitvector set_minus (Bitvector const& lhs, Bitvector const& rhs);
 Bitvector symmetric_difference (Bitvector const& lhs, Bitvector const& rhs);
 
+// =================================================================================================
+//     Bitvector Counts
+// =================================================================================================
+
+/**
+ * @brief Return the number of set bits of `lhs & rhs`, without creating that Bitvector.
+ *
+ * Both Bitvector%s need to have the same size.
+ */
+size_t count_and( Bitvector const& lhs, Bitvector const& rhs );
+
+/**
+ * @brief Return the number of set bits of `lhs | rhs`, without creating that Bitvector.
+ *
+ * Both Bitvector%s need to have the same size.
+ */
+size_t count_or( Bitvector const& lhs, Bitvector const& rhs );
+
+/**
+ * @brief Return the number of set bits of `lhs ^ rhs`, without creating that Bitvector.
+ *
+ * This is the Hamming distance between the two Bitvector%s, which need to have the same size.
+ */
+size_t count_xor( Bitvector const& lhs, Bitvector const& rhs );
+
+// =================================================================================================
+//     Bitvector Relations
+// =================================================================================================
+
 /**
  * @brief Strict subset.
  */
@@ -31,6 +31,7 @@
 #include "genesis/utils/math/euclidean_kmeans.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 
 namespace genesis {
@@ -46,7 +47,10 @@ namespace utils {
 
 EuclideanKmeans::EuclideanKmeans( size_t dimensions )
     : dimensions_( dimensions )
-{}
+{
+    // The euclidean distance is a metric, so we can skip distance calculations.
+    distance_bounds( true );
+}
 
 // -------------------------------------------------------------------------
 //     Default K-Means Functions
@@ -150,6 +154,17 @@ void EuclideanKmeans::update_centroids(
     #endif
 }
 
+void EuclideanKmeans::move_centroid(
+    Point&       centroid,
+    Point const& datum,
+    double       weight
+) {
+    assert( centroid.size() == dimensions_ && datum.size() == dimensions_ );
+    for( size_t d = 0; d < dimensions_; ++d ) {
+        centroid[ d ] += weight * ( datum[ d ] - centroid[ d ] );
+    }
+}
+
 double EuclideanKmeans::distance( Point const& lhs, Point const& rhs ) const
 {
     // Simple euclidean distance
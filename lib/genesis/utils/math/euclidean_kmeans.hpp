@@ -94,6 +94,12 @@ private:
         std::vector<Point>&        centroids
     ) override;
 
+    virtual void move_centroid(
+        Point&       centroid,
+        Point const& datum,
+        double       weight
+    ) override;
+
     virtual double distance( Point const& lhs, Point const& rhs ) const override;
 
     // -------------------------------------------------------------------------
@@ -66,6 +66,7 @@ enum class KmeansInitializationStrategy
     kRandomAssignments,
     kRandomCentroids,
     kKmeansPlusPlus,
+    kKmeansParallel,
     kNone
 };
 
@@ -124,6 +125,9 @@ public:
         // Run basic checks. This throws if necessary.
         argument_checks_( data, k );
 
+        // Bounds of a previous run are not valid for the new data.
+        clear_distance_bounds_();
+
         // Init assigments and centroids.
         initialize( data, k );
 
@@ -135,6 +139,13 @@ public:
         // expansion points and custom behaviour, that we better check thoroughly.
         runtime_checks_( data, k );
 
+        // In mini-batch mode, we use a different main loop.
+        if( mini_batch_size_ > 0 ) {
+            auto const iterations = run_mini_batches_( data, k );
+            post_loop_hook( data, assignments_, centroids_ );
+            return iterations;
+        }
+
         size_t iteration = 0;
         bool changed_assigment;
 
@@ -210,6 +221,7 @@ public:
     {
         assignments_.clear();
         centroids_.clear();
+        clear_distance_bounds_();
     }
 
     // -------------------------------------------------------------------------
@@ -247,6 +259,93 @@ public:
         return *this;
     }
 
+    size_t mini_batch_size() const
+    {
+        return mini_batch_size_;
+    }
+
+    /**
+     * @brief Set the number of data points per mini-batch, or `0` to use all data points in each
+     * iteration (default).
+     *
+     * In mini-batch mode, each iteration draws a random sample (with replacement) of this many data
+     * points, assigns them to their nearest centroid, and moves each centroid towards its points,
+     * with a learning rate of one over the number of points that the centroid has received so far,
+     * following Sculley (2010). This runs for max_iterations() iterations, after which all data
+     * points are assigned to their nearest centroid once. Hence, the data is only passed over once
+     * for the final assignments, instead of once (or more) per iteration. Empty clusters after
+     * the final assignment are treated as in the normal mode, see treat_empty_centroids().
+     *
+     * The derived class needs to implement move_centroid() for this, and can implement
+     * finish_moved_centroid() for work that only needs to be done once per mini-batch.
+     */
+    Kmeans& mini_batch_size( size_t value )
+    {
+        mini_batch_size_ = value;
+        return *this;
+    }
+
+    size_t parallel_initialization_rounds() const
+    {
+        return parallel_init_rounds_;
+    }
+
+    /**
+     * @brief Set the number of rounds of the KmeansInitializationStrategy::kKmeansParallel
+     * initialization (k-means||). Default is 5.
+     */
+    Kmeans& parallel_initialization_rounds( size_t value )
+    {
+        parallel_init_rounds_ = value;
+        return *this;
+    }
+
+    double parallel_initialization_oversampling() const
+    {
+        return parallel_init_oversampling_;
+    }
+
+    /**
+     * @brief Set the oversampling factor of the KmeansInitializationStrategy::kKmeansParallel
+     * initialization (k-means||), that is, the expected number of candidates per round
+     * as a multiple of `k`. Default is 2.
+     */
+    Kmeans& parallel_initialization_oversampling( double value )
+    {
+        if( value <= 0.0 ) {
+            throw std::runtime_error( "Cannot use oversampling factor <= 0 for Kmeans." );
+        }
+        parallel_init_oversampling_ = value;
+        return *this;
+    }
+
+    bool distance_bounds() const
+    {
+        return distance_bounds_;
+    }
+
+    /**
+     * @brief Set whether to use bounds of the distances between data points and centroids
+     * in order to skip distance calculations when assigning the data points to centroids.
+     *
+     * This uses the triangle inequality to keep an upper bound of the distance from each data
+     * point to its assigned centroid, and a lower bound of the distance to all other centroids,
+     * following the algorithm of Hamerly (2010). While the upper bound is smaller than the lower
+     * bound, as well as smaller than half the distance from the assigned centroid to its closest
+     * other centroid, the assignment cannot change, and no distances need to be calculated.
+     * The bounds are updated in each iteration by how far the centroids moved.
+     *
+     * The resulting assignments are the same as without bounds, but this is only valid if
+     * distance() is a metric, that is, if it satisfies the triangle inequality. Also, a custom
+     * find_nearest_cluster() is not used when the bounds are active.
+     */
+    Kmeans& distance_bounds( bool value )
+    {
+        distance_bounds_ = value;
+        clear_distance_bounds_();
+        return *this;
+    }
+
     // -------------------------------------------------------------------------
     //     Progress Report
     // -------------------------------------------------------------------------
@@ -276,6 +375,10 @@ protected:
                 init_with_kmeans_plus_plus_( data, k );
                 break;
             }
+            case KmeansInitializationStrategy::kKmeansParallel: {
+                init_with_kmeans_parallel_( data, k );
+                break;
+            }
             default: {}
         }
 
@@ -340,6 +443,11 @@ protected:
         std::vector<Point> const& centroids,
         std::vector<size_t>&      assignments
     ) {
+        // Use the bounded version if wanted.
+        if( distance_bounds_ ) {
+            return assign_to_centroids_with_bounds_( data, centroids, assignments );
+        }
+
         // Store whether anything changed.
         bool changed_assigment = false;
 
@@ -515,6 +623,38 @@ protected:
         std::vector<Point>&        centroids
     ) = 0;
 
+    /**
+     * @brief Move a @p centroid towards a @p datum, so that it becomes the weighted average
+     * `( 1 - weight ) * centroid + weight * datum`.
+     *
+     * This is needed for the mini-batch mode, see mini_batch_size(). The default implementation
+     * throws, so that derived classes that do not support this can still be used for the normal
+     * mode.
+     */
+    virtual void move_centroid(
+        Point&       centroid,
+        Point const& datum,
+        double       weight
+    ) {
+        (void) centroid;
+        (void) datum;
+        (void) weight;
+        throw std::runtime_error( "This Kmeans implementation does not support mini-batches." );
+    }
+
+    /**
+     * @brief Finish a @p centroid after it was moved towards the data points of a mini-batch
+     * via move_centroid().
+     *
+     * This is called once per mini-batch for each centroid that received data points, so that
+     * derived classes can do work here that is not needed after every single point, such as
+     * compacting the representation of the centroid. The default does nothing.
+     */
+    virtual void finish_moved_centroid( Point& centroid )
+    {
+        (void) centroid;
+    }
+
     virtual void post_loop_hook(
         std::vector<Point>  const& data,
         std::vector<size_t>&       assignments,
@@ -631,36 +771,384 @@ private:
         std::uniform_int_distribution<size_t> first_dist( 0, data.size() - 1 );
         centroids_.push_back( data[ first_dist(engine) ]);
 
-        // Prepare a vector of probabilities to select each data point as a centroid.
-        auto data_probs = std::vector<double>( data.size(), 0.0 );
+        // Keep the distance from each data point to its closest centroid (of the ones that are
+        // produced so far). We only need to compare each point to the newest centroid then,
+        // instead of to all of them.
+        auto min_dists = std::vector<double>( data.size(), std::numeric_limits<double>::max() );
+        update_min_distances_( data, centroids_.back(), min_dists );
 
         // Add more centroids.
         for( size_t i = 1; i < k; ++i ) {
 
-            // For each data point...
+            // Select a new centroid from the data, using the square of the distance of each point
+            // to its closest centroid as probability to select it.
+            auto const idx = sample_by_squared_distance_( min_dists, engine );
+            assert( idx < data.size() );
+            centroids_.push_back( data[ idx ] );
+            update_min_distances_( data, centroids_.back(), min_dists );
+        }
+
+        assert( centroids_.size() == k );
+    }
+
+    void init_with_kmeans_parallel_(
+        std::vector<Point> const& data,
+        size_t const              k
+    ) {
+        // This implements k-means|| of Bahmani et al. (2012): Instead of selecting one centroid
+        // after another, which needs k passes over the data, we select a set of candidates
+        // in a few rounds, each selecting about oversampling * k points at once.
+        // The candidates are then weighted by the number of data points closest to them,
+        // and reduced to k centroids using a weighted k-means++.
+        auto& engine = Options::get().random_engine();
+        auto const oversampling = parallel_init_oversampling_ * static_cast<double>( k );
+
+        // Start with a random point as first candidate.
+        auto candidates = std::vector<size_t>();
+        std::uniform_int_distribution<size_t> first_dist( 0, data.size() - 1 );
+        candidates.push_back( first_dist( engine ));
+
+        // Keep the distance from each data point to its closest candidate, and which one that is.
+        auto min_dists = std::vector<double>( data.size(), std::numeric_limits<double>::max() );
+        auto nearest   = std::vector<size_t>( data.size(), 0 );
+        auto const add_candidates = [&]( size_t first ){
             #pragma omp parallel for
             for( size_t di = 0; di < data.size(); ++di ) {
+                for( size_t c = first; c < candidates.size(); ++c ) {
+                    auto const dist = distance( data[ di ], data[ candidates[c] ]);
+                    if( dist < min_dists[ di ] ) {
+                        min_dists[ di ] = dist;
+                        nearest[ di ]   = c;
+                    }
+                }
+            }
+        };
+        add_candidates( 0 );
+
+        // Select more candidates, each point with a probability proportional to its squared
+        // distance to the closest candidate so far.
+        std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+        for( size_t r = 0; r < parallel_init_rounds_; ++r ) {
+            double cost = 0.0;
+            for( auto const d : min_dists ) {
+                cost += d * d;
+            }
+            if( cost == 0.0 ) {
+                break;
+            }
 
-                // ...find the closest centroid (of the ones that are produced so far), ...
-                double const min_d = find_nearest_cluster( centroids_, data[ di ] ).second;
-
-                // ...and use its square as probability to select this point.
-                // (No need for OpenMP locking here, as di is unique to each thread).
-                data_probs[ di ] = min_d * min_d;
+            auto const first = candidates.size();
+            for( size_t di = 0; di < data.size(); ++di ) {
+                auto const prob = oversampling * min_dists[ di ] * min_dists[ di ] / cost;
+                if( uniform( engine ) < prob ) {
+                    candidates.push_back( di );
+                }
             }
+            add_candidates( first );
+        }
 
-            // Now select a new centroid from the data, according to the given probabilities.
-            std::discrete_distribution<size_t> distribution(
-                data_probs.begin(), data_probs.end()
-            );
-            auto idx = distribution( engine );
-            assert( idx < data.size() );
-            centroids_.push_back( data[ idx ] );
+        // Weigh each candidate by the number of data points that are closest to it.
+        auto weights = std::vector<double>( candidates.size(), 0.0 );
+        for( size_t di = 0; di < data.size(); ++di ) {
+            weights[ nearest[ di ]] += 1.0;
+        }
+
+        // If there are not enough candidates (e.g., because many data points are identical),
+        // we fill up the centroids from the remaining data points, using k-means++ sampling.
+        centroids_ = std::vector<Point>();
+        if( candidates.size() <= k ) {
+            for( auto const c : candidates ) {
+                centroids_.push_back( data[c] );
+            }
+            while( centroids_.size() < k ) {
+                auto const idx = sample_by_squared_distance_( min_dists, engine );
+                centroids_.push_back( data[ idx ] );
+                update_min_distances_( data, centroids_.back(), min_dists );
+            }
+            assert( centroids_.size() == k );
+            return;
         }
 
+        // Otherwise, reduce the candidates to k centroids with a weighted k-means++.
+        // The first one is selected proportional to the weights.
+        std::discrete_distribution<size_t> first_cand( weights.begin(), weights.end() );
+        auto selected = std::vector<size_t>{ first_cand( engine ) };
+        auto cand_dists = std::vector<double>( candidates.size(), std::numeric_limits<double>::max() );
+        auto cand_probs = std::vector<double>( candidates.size(), 0.0 );
+        while( selected.size() < k ) {
+            auto const& newest = data[ candidates[ selected.back() ]];
+            #pragma omp parallel for
+            for( size_t c = 0; c < candidates.size(); ++c ) {
+                auto const dist = distance( data[ candidates[c] ], newest );
+                cand_dists[c] = std::min( cand_dists[c], dist );
+                cand_probs[c] = weights[c] * cand_dists[c] * cand_dists[c];
+            }
+
+            // If all remaining candidates coincide with the selected ones, there is nothing left
+            // to choose by distance, so we simply take an unselected one.
+            if( std::all_of( cand_probs.begin(), cand_probs.end(), []( double v ){ return v == 0.0; })) {
+                for( size_t c = 0; c < candidates.size(); ++c ) {
+                    if( std::find( selected.begin(), selected.end(), c ) == selected.end() ) {
+                        cand_probs[c] = 1.0;
+                    }
+                }
+            }
+            std::discrete_distribution<size_t> next_cand( cand_probs.begin(), cand_probs.end() );
+            selected.push_back( next_cand( engine ));
+        }
+        for( auto const c : selected ) {
+            centroids_.push_back( data[ candidates[c] ] );
+        }
         assert( centroids_.size() == k );
     }
 
+    /**
+     * @brief Update the distances from each data point to its closest centroid with a new
+     * @p centroid.
+     */
+    void update_min_distances_(
+        std::vector<Point> const& data,
+        Point const&              centroid,
+        std::vector<double>&      min_dists
+    ) const {
+        assert( min_dists.size() == data.size() );
+
+        // No need for OpenMP locking here, as di is unique to each thread.
+        #pragma omp parallel for
+        for( size_t di = 0; di < data.size(); ++di ) {
+            min_dists[ di ] = std::min( min_dists[ di ], distance( data[ di ], centroid ));
+        }
+    }
+
+    /**
+     * @brief Select a data point, using the squares of the distances to their closest centroid
+     * as probabilities.
+     */
+    template< class Engine >
+    size_t sample_by_squared_distance_(
+        std::vector<double> const& min_dists,
+        Engine&                    engine
+    ) const {
+        auto data_probs = std::vector<double>( min_dists.size() );
+        for( size_t di = 0; di < min_dists.size(); ++di ) {
+            data_probs[ di ] = min_dists[ di ] * min_dists[ di ];
+        }
+        std::discrete_distribution<size_t> distribution(
+            data_probs.begin(), data_probs.end()
+        );
+        return distribution( engine );
+    }
+
+    size_t run_mini_batches_(
+        std::vector<Point> const& data,
+        size_t const              k
+    ) {
+        auto& engine = Options::get().random_engine();
+        std::uniform_int_distribution<size_t> data_dist( 0, data.size() - 1 );
+
+        // Number of data points that each centroid has received so far,
+        // and whether it received any in the current batch.
+        auto counts = std::vector<size_t>( k, 0 );
+        auto moved  = std::vector<char>( k, 0 );
+        auto batch = std::vector<size_t>( mini_batch_size_ );
+        auto batch_assignments = std::vector<size_t>( mini_batch_size_ );
+
+        size_t iteration = 0;
+        for( ; iteration < max_iterations_; ++iteration ) {
+            if( report_iteration ) {
+                report_iteration( iteration + 1 );
+            }
+
+            // Draw the batch, and find the nearest centroids of its points.
+            for( auto& idx : batch ) {
+                idx = data_dist( engine );
+            }
+            #pragma omp parallel for
+            for( size_t b = 0; b < batch.size(); ++b ) {
+                batch_assignments[b] = find_nearest_cluster( centroids_, data[ batch[b] ] ).first;
+            }
+
+            // Move each centroid towards its points, with a decreasing learning rate.
+            std::fill( moved.begin(), moved.end(), 0 );
+            for( size_t b = 0; b < batch.size(); ++b ) {
+                auto const c = batch_assignments[b];
+                assert( c < k );
+                ++counts[c];
+                moved[c] = 1;
+                move_centroid( centroids_[c], data[ batch[b] ], 1.0 / static_cast<double>( counts[c] ));
+            }
+
+            // Finish the centroids that moved, once per batch.
+            #pragma omp parallel for
+            for( size_t c = 0; c < k; ++c ) {
+                if( moved[c] ) {
+                    finish_moved_centroid( centroids_[c] );
+                }
+            }
+        }
+
+        // Finally, assign all data points to the resulting centroids.
+        assign_to_centroids( data, centroids_, assignments_ );
+        runtime_checks_( data, k );
+
+        // Centroids that never received a data point, or lost all of them in the final
+        // assignment, are treated the same way as in the normal mode.
+        auto const empty_centroids = get_empty_centroids_();
+        if( ! empty_centroids.empty() ) {
+            LOG_INFO << "Empty centroid occurred: " << empty_centroids.size();
+            treat_empty_centroids( data, assignments_, centroids_, empty_centroids );
+            runtime_checks_( data, k );
+        }
+        return iteration;
+    }
+
+    void clear_distance_bounds_()
+    {
+        bound_centroids_.clear();
+        bound_assignments_.clear();
+        upper_bounds_.clear();
+        lower_bounds_.clear();
+    }
+
+    /**
+     * @brief Find the nearest and the second nearest centroid of a datum, and store the nearest
+     * one and the two distances as the assignment and the bounds of the datum.
+     */
+    void find_nearest_clusters_bounded_(
+        std::vector<Point> const& centroids,
+        Point const&              datum,
+        size_t&                   assignment,
+        double&                   upper_bound,
+        double&                   lower_bound
+    ) const {
+        assert( centroids.size() > 0 );
+
+        // Same as in find_nearest_cluster(), so that ties are resolved in the same way.
+        size_t min_i = std::numeric_limits<size_t>::max();
+        double min_d = std::numeric_limits<double>::max();
+        double sec_d = std::numeric_limits<double>::max();
+        for( size_t i = 0; i < centroids.size(); ++i ) {
+            auto const dist = distance( datum, centroids[i] );
+            if( dist < min_d ) {
+                sec_d = min_d;
+                min_i = i;
+                min_d = dist;
+            } else if( dist < sec_d ) {
+                sec_d = dist;
+            }
+        }
+
+        assignment  = min_i;
+        upper_bound = min_d;
+        lower_bound = sec_d;
+    }
+
+    bool assign_to_centroids_with_bounds_(
+        std::vector<Point> const& data,
+        std::vector<Point> const& centroids,
+        std::vector<size_t>&      assignments
+    ) {
+        auto const k = centroids.size();
+        assert( k > 0 );
+        assert( assignments.size() == data.size() );
+
+        // Bounds are compared with a small margin, so that numerical differences in the bounds
+        // cannot lead to a different assignment than calculating all distances would.
+        double const margin = 1e-9;
+
+        // If we have bounds from the previous iteration, move them by how far the centroids moved.
+        // Otherwise, we need to calculate all distances once.
+        bool const have_bounds = (
+            bound_centroids_.size() == k &&
+            bound_assignments_.size() == data.size() &&
+            upper_bounds_.size() == data.size() &&
+            lower_bounds_.size() == data.size()
+        );
+        auto drifts = std::vector<double>( k, 0.0 );
+        auto half_separations = std::vector<double>( k, std::numeric_limits<double>::max() );
+        double max_drift = 0.0;
+        if( have_bounds ) {
+            #pragma omp parallel for
+            for( size_t c = 0; c < k; ++c ) {
+                drifts[c] = distance( bound_centroids_[c], centroids[c] );
+            }
+            max_drift = *std::max_element( drifts.begin(), drifts.end() );
+
+            // Half the distance from each centroid to its closest other centroid. A datum that is
+            // closer than this to its centroid cannot be closer to any other centroid.
+            // Each thread computes the full row of its centroid, so that no synchronization and
+            // no pairwise matrix are needed, at the cost of computing each distance twice.
+            #pragma omp parallel for
+            for( size_t c = 0; c < k; ++c ) {
+                for( size_t o = 0; o < k; ++o ) {
+                    if( o != c ) {
+                        auto const half = distance( centroids[c], centroids[o] ) / 2.0;
+                        half_separations[c] = std::min( half_separations[c], half );
+                    }
+                }
+            }
+        } else {
+            upper_bounds_.assign( data.size(), 0.0 );
+            lower_bounds_.assign( data.size(), 0.0 );
+        }
+
+        // Store whether anything changed.
+        bool changed_assigment = false;
+
+        #pragma omp parallel for schedule( dynamic )
+        for( size_t i = 0; i < data.size(); ++i ) {
+            size_t new_idx = assignments[i];
+
+            // The bounds are only valid for the assignment that they were computed for. If the
+            // assignment was changed in between (e.g., when treating empty centroids), or if there
+            // are no bounds yet, calculate all distances for the datum.
+            bool need_full = ! have_bounds || bound_assignments_[i] != assignments[i];
+            if( ! need_full ) {
+                upper_bounds_[i] += drifts[ new_idx ];
+                lower_bounds_[i] -= max_drift;
+
+                // Check whether the assignment can change. If so, get the exact distance to the
+                // assigned centroid, and check again, before calculating all distances.
+                auto const bound = std::max( half_separations[ new_idx ], lower_bounds_[i] );
+                if( !( upper_bounds_[i] * ( 1.0 + margin ) < bound * ( 1.0 - margin ))) {
+                    upper_bounds_[i] = distance( data[i], centroids[ new_idx ] );
+                    need_full = !( upper_bounds_[i] * ( 1.0 + margin ) < bound * ( 1.0 - margin ));
+                }
+            }
+            if( need_full ) {
+                find_nearest_clusters_bounded_(
+                    centroids, data[i], new_idx, upper_bounds_[i], lower_bounds_[i]
+                );
+            }
+
+            if( new_idx != assignments[i] ) {
+                // Update the assignment. No need for locking, as each thread works on its own i.
+                assignments[i] = new_idx;
+
+                // If we have a new assigment for this datum, we need to do another loop iteration.
+                // Do this atomically, as all threads use this variable.
+                #pragma omp atomic write
+                changed_assigment = true;
+            }
+        }
+
+        // Store the state that the bounds refer to. Centroids that did not move do not need to be
+        // copied again, which saves time for large centroids.
+        if( have_bounds ) {
+            #pragma omp parallel for
+            for( size_t c = 0; c < k; ++c ) {
+                if( drifts[c] > 0.0 ) {
+                    bound_centroids_[c] = centroids[c];
+                }
+            }
+        } else {
+            bound_centroids_ = centroids;
+        }
+        bound_assignments_ = assignments;
+
+        return changed_assigment;
+    }
+
     std::unordered_set<size_t> get_empty_centroids_() {
         auto const k = centroids_.size();
 
@@ -699,6 +1187,17 @@ private:
     size_t max_iterations_ = 100;
     KmeansInitializationStrategy init_strategy_ = KmeansInitializationStrategy::kKmeansPlusPlus;
 
+    size_t mini_batch_size_            = 0;
+    size_t parallel_init_rounds_       = 5;
+    double parallel_init_oversampling_ = 2.0;
+
+    // Distance bounds, see distance_bounds(), and the centroids and assignments they refer to.
+    bool                distance_bounds_ = false;
+    std::vector<Point>  bound_centroids_;
+    std::vector<size_t> bound_assignments_;
+    std::vector<double> upper_bounds_;
+    std::vector<double> lower_bounds_;
+
 };
 
 } // namespace utils
@@ -30,12 +30,21 @@
 
 #include "src/common.hpp"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
+#include "genesis/placement/formats/jplace_input_iterator.hpp"
 #include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/formats/jplace_writer.hpp"
 #include "genesis/placement/function/helper.hpp"
 #include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/function/masses.hpp"
+#include "genesis/placement/function/operators.hpp"
 #include "genesis/placement/sample.hpp"
+#include "genesis/placement/sample_set.hpp"
+#include "genesis/utils/formats/json/document.hpp"
+#include "genesis/utils/formats/json/reader.hpp"
 
 using namespace genesis;
 using namespace genesis::placement;
@@ -103,6 +112,37 @@ TEST( JplaceReader, FromFilesGzip )
     EXPECT_EQ( "test_b", smps.name_at(1) );
 }
 
+TEST( JplaceReader, FromFilesReuseTrees )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Use the same file twice, so that the reference tree is taken from the cache.
+    auto const indir = environment->data_dir + "placement/";
+    auto const infiles = std::vector<std::string>{
+        indir + "test_a.jplace", indir + "test_b.jplace", indir + "test_a.jplace",
+        indir + "version_1.jplace", indir + "version_1.jplace"
+    };
+
+    SampleSet const reused = JplaceReader().read( from_files( infiles ));
+    SampleSet const parsed = JplaceReader().reuse_trees( false ).read( from_files( infiles ));
+    ASSERT_EQ( infiles.size(), reused.size() );
+    ASSERT_EQ( infiles.size(), parsed.size() );
+
+    for( size_t i = 0; i < infiles.size(); ++i ) {
+        EXPECT_TRUE( compatible_trees( reused[i], parsed[i] ));
+        EXPECT_TRUE( validate( reused[i], true, false ));
+        EXPECT_TRUE( has_correct_edge_nums( reused[i].tree() ));
+        EXPECT_EQ( total_placement_count( parsed[i] ), total_placement_count( reused[i] ));
+        EXPECT_EQ( placement_mass_per_edges_with_multiplicities( parsed[i] ),
+                   placement_mass_per_edges_with_multiplicities( reused[i] ));
+    }
+
+    // Each Sample owns its tree.
+    EXPECT_NE( &reused[0].tree().edge_at(0), &reused[2].tree().edge_at(0) );
+    EXPECT_NE( &reused[3].tree().edge_at(0), &reused[4].tree().edge_at(0) );
+}
+
 TEST( JplaceReader, Version1 )
 {
     // Skip test if no data availabe.
@@ -145,6 +185,212 @@ TEST( JplaceReader, Version3 )
     EXPECT_TRUE( has_correct_edge_nums(smp.tree()) );
 }
 
+TEST( JplaceReader, KeyOrder )
+{
+    // Header before the placements, so that the pqueries are processed while reading,
+    // with an extra field that is not used, and names in different formats.
+    std::string const header_first = R"({
+        "version": 3,
+        "metadata": { "invocation": "test" },
+        "fields": [ "classification", "edge_num", "likelihood", "like_weight_ratio",
+                    "distal_length", "pendant_length" ],
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "placements": [
+            { "nm": [[ "a", 2.0 ], [ "b", 1.0 ]], "p": [[ null, 0, -1.0, 0.6, 1.2, 0.1 ], [ "x", 2, -2.0, 0.4, 1.2, 0.1 ]] },
+            { "n": "c", "m": 3.0, "p": [[ "y", 7, -1.0, 1.0, 0.5, 0.2 ]] },
+            { "p": [[ "z", 8, -1.0, 1.0, 1.5, 0.3 ]], "n": [ "d" ] }
+        ]
+    })";
+
+    // Same document, but with the header after the placements, as written by most programs.
+    std::string const header_last = R"({
+        "placements": [
+            { "nm": [[ "a", 2.0 ], [ "b", 1.0 ]], "p": [[ null, 0, -1.0, 0.6, 1.2, 0.1 ], [ "x", 2, -2.0, 0.4, 1.2, 0.1 ]] },
+            { "n": "c", "m": 3.0, "p": [[ "y", 7, -1.0, 1.0, 0.5, 0.2 ]] },
+            { "p": [[ "z", 8, -1.0, 1.0, 1.5, 0.3 ]], "n": [ "d" ] }
+        ],
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "metadata": { "invocation": "test" },
+        "version": 3,
+        "fields": [ "classification", "edge_num", "likelihood", "like_weight_ratio",
+                    "distal_length", "pendant_length" ]
+    })";
+
+    // Tree and fields before the placements, but the version after them, which also needs
+    // the placement values to be kept until the end of the document.
+    std::string const version_last = R"({
+        "fields": [ "classification", "edge_num", "likelihood", "like_weight_ratio",
+                    "distal_length", "pendant_length" ],
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "placements": [
+            { "nm": [[ "a", 2.0 ], [ "b", 1.0 ]], "p": [[ null, 0, -1.0, 0.6, 1.2, 0.1 ], [ "x", 2, -2.0, 0.4, 1.2, 0.1 ]] },
+            { "n": "c", "m": 3.0, "p": [[ "y", 7, -1.0, 1.0, 0.5, 0.2 ]] },
+            { "p": [[ "z", 8, -1.0, 1.0, 1.5, 0.3 ]], "n": [ "d" ] }
+        ],
+        "metadata": { "invocation": "test" },
+        "version": 3
+    })";
+
+    // Read all variants, including the one via a JsonDocument.
+    auto doc = JsonReader().read( from_string( header_first ));
+    auto const smps = std::vector<Sample>{
+        JplaceReader().read( from_string( header_first )),
+        JplaceReader().read( from_string( header_last )),
+        JplaceReader().read( from_string( version_last )),
+        JplaceReader().read( doc )
+    };
+
+    for( auto const& smp : smps ) {
+        EXPECT_EQ( 3, smp.size() );
+        EXPECT_EQ( 4, total_placement_count(smp) );
+        EXPECT_EQ( 4, total_name_count(smp) );
+        EXPECT_DOUBLE_EQ( 7.0, total_multiplicity(smp) );
+        EXPECT_TRUE( validate(smp, true, false) );
+        EXPECT_EQ( "test", smp.metadata.at( "invocation" ));
+
+        EXPECT_EQ( 2, smp.at(0).placement_at(1).edge_num() );
+        EXPECT_DOUBLE_EQ( 0.8, smp.at(0).placement_at(1).proximal_length );
+        EXPECT_DOUBLE_EQ( 0.4, smp.at(0).placement_at(1).like_weight_ratio );
+        EXPECT_EQ( "c", smp.at(1).name_at(0).name );
+        EXPECT_DOUBLE_EQ( 3.0, smp.at(1).name_at(0).multiplicity );
+        EXPECT_EQ( 8, smp.at(2).placement_at(0).edge_num() );
+    }
+
+    // Used fields need to be numbers.
+    std::string const invalid = R"({
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "placements": [ { "p": [[ 0, "a", 0.6, 1.2, 0.1 ]], "n": "a" } ],
+        "version": 3,
+        "fields": [ "edge_num", "likelihood", "like_weight_ratio", "distal_length", "pendant_length" ]
+    })";
+    EXPECT_ANY_THROW( JplaceReader().read( from_string( invalid )));
+}
+
+TEST( JplaceReader, InputIterator )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // The file has the tree and fields after the placements, so we need to provide it twice.
+    std::string infile = environment->data_dir + "placement/version_2.jplace";
+    Sample const smp = JplaceReader().read( from_file( infile ));
+    EXPECT_ANY_THROW( JplaceInputIterator( from_file( infile )));
+
+    auto it = JplaceInputIterator( from_file( infile ), from_file( infile ));
+    EXPECT_EQ( smp.tree().edge_count(), it.tree().edge_count() );
+    EXPECT_EQ( 0, it.sample().size() );
+
+    // Iterate and compare to the Sample.
+    size_t cnt = 0;
+    auto masses = std::vector<double>( it.tree().edge_count(), 0.0 );
+    while( it ) {
+        ASSERT_LT( cnt, smp.size() );
+        EXPECT_EQ( smp.at(cnt).placement_size(), it->placement_size() );
+        EXPECT_EQ( smp.at(cnt).name_at(0).name, it->name_at(0).name );
+        EXPECT_EQ(
+            smp.at(cnt).placement_at(0).edge().index(), it->placement_at(0).edge().index()
+        );
+        placement_mass_per_edges_with_multiplicities( *it, masses );
+        ++it;
+        ++cnt;
+    }
+    EXPECT_EQ( smp.size(), cnt );
+    EXPECT_ITERABLE_DOUBLE_EQ(
+        std::vector<double>, placement_mass_per_edges_with_multiplicities( smp ), masses
+    );
+
+    // With the header first, one source is enough.
+    std::string const header_first = R"({
+        "version": 3,
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "fields": [ "edge_num", "likelihood", "like_weight_ratio", "distal_length", "pendant_length" ],
+        "placements": [
+            { "p": [[ 0, -1.0, 0.6, 1.2, 0.1 ], [ 2, -2.0, 0.4, 1.2, 0.1 ]], "n": "a" },
+            { "p": [[ 7, -1.0, 1.0, 0.5, 0.2 ]], "nm": [[ "b", 2.0 ]] }
+        ],
+        "metadata": { "invocation": "test" }
+    })";
+    auto hit = JplaceInputIterator( from_string( header_first ));
+    cnt = 0;
+    while( hit ) {
+        ++cnt;
+        ++hit;
+    }
+    EXPECT_EQ( 2, cnt );
+    EXPECT_EQ( "test", hit.sample().metadata.at( "invocation" ));
+}
+
+TEST( JplaceReader, InputIteratorWriterRoundTrip )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Our own writer puts the header before the placements, so that its output can be iterated
+    // without a second source.
+    std::string infile = environment->data_dir + "placement/version_3.jplace";
+    Sample const smp = JplaceReader().read( from_file( infile ));
+    auto const jplace = JplaceWriter().to_string( smp );
+
+    auto it = JplaceInputIterator( from_string( jplace ));
+    size_t cnt = 0;
+    auto masses = std::vector<double>( it.tree().edge_count(), 0.0 );
+    while( it ) {
+        ASSERT_LT( cnt, smp.size() );
+        ASSERT_EQ( smp.at(cnt).placement_size(), it->placement_size() );
+        ASSERT_EQ( smp.at(cnt).name_size(), it->name_size() );
+        for( size_t i = 0; i < it->placement_size(); ++i ) {
+            auto const& exp_place = smp.at(cnt).placement_at(i);
+            auto const& act_place = it->placement_at(i);
+            EXPECT_EQ( exp_place.edge().index(), act_place.edge().index() );
+            EXPECT_DOUBLE_EQ( exp_place.like_weight_ratio, act_place.like_weight_ratio );
+            EXPECT_DOUBLE_EQ( exp_place.proximal_length, act_place.proximal_length );
+            EXPECT_DOUBLE_EQ( exp_place.pendant_length, act_place.pendant_length );
+        }
+        for( size_t i = 0; i < it->name_size(); ++i ) {
+            EXPECT_EQ( smp.at(cnt).name_at(i).name, it->name_at(i).name );
+        }
+        placement_mass_per_edges_with_multiplicities( *it, masses );
+        ++it;
+        ++cnt;
+    }
+    EXPECT_EQ( smp.size(), cnt );
+    EXPECT_ITERABLE_DOUBLE_EQ(
+        std::vector<double>, placement_mass_per_edges_with_multiplicities( smp ), masses
+    );
+
+    // A vector that is too small for some of the placements is not touched at all.
+    auto const& pqry = smp.at(0);
+    size_t max_index = 0;
+    for( auto const& place : pqry.placements() ) {
+        max_index = std::max( max_index, place.edge().index() );
+    }
+    auto small = std::vector<double>( max_index, 0.0 );
+    EXPECT_ANY_THROW( placement_mass_per_edges_with_multiplicities( pqry, small ));
+    EXPECT_EQ( std::vector<double>( max_index, 0.0 ), small );
+}
+
+TEST( JplaceReader, InputIteratorTrailingVersion )
+{
+    // Tree and fields before the placements are enough, and the version can come afterwards,
+    // unless it is version 1, which would have needed a different way of reading the tree.
+    std::string const document = R"({
+        "tree": "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};",
+        "fields": [ "edge_num", "likelihood", "like_weight_ratio", "distal_length", "pendant_length" ],
+        "placements": [
+            { "p": [[ 0, -1.0, 0.6, 1.2, 0.1 ], [ 2, -2.0, 0.4, 1.2, 0.1 ]], "n": "a" }
+        ],
+        "version": )";
+
+    auto it = JplaceInputIterator( from_string( document + "3 }" ));
+    EXPECT_TRUE( static_cast<bool>( it ));
+    EXPECT_NO_THROW( ++it );
+    EXPECT_FALSE( static_cast<bool>( it ));
+
+    auto it_v1 = JplaceInputIterator( from_string( document + "1 }" ));
+    EXPECT_TRUE( static_cast<bool>( it_v1 ));
+    EXPECT_ANY_THROW( ++it_v1 );
+}
+
 // TEST( JplaceReader, Speed )
 // {
 //     std::string inputfile = "/home/lucas/Projects/data/for_testing/jplace/sample_0_all_big.jplace";
@@ -39,6 +39,7 @@
 #include "genesis/placement/function/nhd.hpp"
 #include "genesis/placement/sample.hpp"
 #include "genesis/placement/sample_set.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
 #include "genesis/utils/containers/matrix.hpp"
 
 using namespace genesis;
@@ -144,3 +145,58 @@ TEST( SampleMeasures, NodeHistogramDistance )
     EXPECT_FLOAT_EQ( 1.9533334, nhd_mat( 0, 1 ));
     EXPECT_FLOAT_EQ( 0.0,    nhd_mat( 1, 1 ));
 }
+
+TEST( SampleMeasures, TreeDistanceOracle )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Input files.
+    std::string infile_lhs = environment->data_dir + "placement/test_a.jplace";
+    std::string infile_rhs = environment->data_dir + "placement/test_b.jplace";
+
+    // Read files.
+    Sample smp_lhs = JplaceReader().read( from_file( infile_lhs ));
+    Sample smp_rhs = JplaceReader().read( from_file( infile_rhs ));
+    auto const oracle = tree::TreeDistanceOracle( smp_lhs.tree() );
+
+    // All measures give the same results as with the node distance matrices.
+    for( auto const* smp : { &smp_lhs, &smp_rhs } ) {
+        auto const exp_edpl = edpl( *smp );
+        auto const act_edpl = edpl( *smp, oracle );
+        ASSERT_EQ( exp_edpl.size(), act_edpl.size() );
+        for( size_t i = 0; i < exp_edpl.size(); ++i ) {
+            EXPECT_DOUBLE_EQ( exp_edpl[i], act_edpl[i] );
+        }
+
+        for( bool with_pendant_length : { false, true } ) {
+            EXPECT_DOUBLE_EQ(
+                variance( *smp, with_pendant_length ),
+                variance( *smp, oracle, with_pendant_length )
+            );
+        }
+    }
+    for( bool with_pendant_length : { false, true } ) {
+        EXPECT_DOUBLE_EQ(
+            pairwise_distance( smp_lhs, smp_rhs, with_pendant_length ),
+            pairwise_distance( smp_lhs, smp_rhs, oracle, with_pendant_length )
+        );
+        EXPECT_DOUBLE_EQ(
+            center_of_gravity_distance( smp_lhs, smp_rhs, with_pendant_length ),
+            center_of_gravity_distance( smp_lhs, smp_rhs, oracle, with_pendant_length )
+        );
+    }
+    EXPECT_FLOAT_EQ( 1.9533334, node_histogram_distance( smp_lhs, smp_rhs, oracle, 10 ));
+    EXPECT_FLOAT_EQ( 0.0, node_histogram_distance( smp_lhs, smp_lhs, oracle ));
+
+    SampleSet set;
+    set.add( smp_lhs );
+    set.add( smp_rhs );
+    EXPECT_EQ( node_histogram_distance( set, 10 ), node_histogram_distance( set, oracle, 10 ));
+
+    // Oracle of a different tree.
+    Sample smp_other = JplaceReader().read( from_file(
+        environment->data_dir + "placement/rooted.jplace"
+    ));
+    EXPECT_ANY_THROW( edpl( smp_other, tree::TreeDistanceOracle( smp_lhs.tree() )));
+}
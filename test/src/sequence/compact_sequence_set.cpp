@@ -0,0 +1,174 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/sequence/compact_sequence_set.hpp"
+#include "genesis/sequence/counts.hpp"
+#include "genesis/sequence/formats/fasta_reader.hpp"
+#include "genesis/sequence/formats/phylip_reader.hpp"
+#include "genesis/sequence/functions/codes.hpp"
+#include "genesis/sequence/functions/functions.hpp"
+#include "genesis/sequence/functions/stats.hpp"
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/sequence/sequence_view.hpp"
+#include "genesis/sequence/sequence.hpp"
+
+#include <stdexcept>
+
+using namespace genesis;
+using namespace genesis::sequence;
+using namespace genesis::utils;
+
+// =================================================================================================
+//     Helpers
+// =================================================================================================
+
+static void compare_compact_sequence_set_( SequenceSet const& sset, CompactSequenceSet const& cset )
+{
+    ASSERT_EQ( sset.size(), cset.size() );
+    size_t i = 0;
+    for( auto const& view : cset ) {
+        EXPECT_EQ( sset[i].label(),     view.label() );
+        EXPECT_EQ( sset[i].sites(),     view.sites() );
+        EXPECT_EQ( sset[i].abundance(), view.abundance() );
+        ++i;
+    }
+    EXPECT_EQ( sset.size(), i );
+}
+
+// =================================================================================================
+//     Basics
+// =================================================================================================
+
+TEST( Sequence, CompactSequenceSetBasics )
+{
+    CompactSequenceSet cset;
+    EXPECT_TRUE( cset.empty() );
+    EXPECT_EQ( 0, cset.total_sites() );
+    EXPECT_TRUE( is_alignment( cset ));
+
+    cset.add( "a", "ACGT" );
+    cset.add( Sequence( "bb", "AC-T", 3 ));
+    cset.add( "", "" );
+    cset.add( "ccc", "TT" );
+
+    ASSERT_EQ( 4, cset.size() );
+    EXPECT_EQ( 10, cset.total_sites() );
+    EXPECT_EQ( 10, total_length( cset ));
+    EXPECT_EQ( 4, longest_sequence_length( cset ));
+    EXPECT_FALSE( is_alignment( cset ));
+    EXPECT_TRUE( validate_chars( cset, nucleic_acid_codes_all() ));
+    EXPECT_EQ( 1, count_chars( cset, "-" ));
+
+    EXPECT_EQ( "bb",   cset[1].label() );
+    EXPECT_EQ( "AC-T", cset[1].sites() );
+    EXPECT_EQ( 3,      cset[1].abundance() );
+    EXPECT_EQ( '-',    cset[1][2] );
+    EXPECT_EQ( '-',    cset[1].site_at( 2 ));
+    EXPECT_EQ( 0,      cset[2].length() );
+    EXPECT_EQ( "ccc",  cset.at( 3 ).label() );
+
+    EXPECT_THROW( cset.at( 4 ), std::out_of_range );
+    EXPECT_THROW( cset[1].site_at( 4 ), std::out_of_range );
+
+    // Round trip.
+    auto const sset = cset.to_sequence_set();
+    compare_compact_sequence_set_( sset, cset );
+    compare_compact_sequence_set_( sset, CompactSequenceSet( sset ));
+
+    // A view of a Sequence points to its data.
+    auto const view = SequenceView( sset[0] );
+    EXPECT_EQ( sset[0].sites().data(), view.sites_data() );
+    EXPECT_EQ( site_histogram( sset[0] ), site_histogram( view ));
+
+    cset.clear();
+    EXPECT_TRUE( cset.empty() );
+    EXPECT_EQ( 0, cset.total_sites() );
+}
+
+// =================================================================================================
+//     Readers
+// =================================================================================================
+
+TEST( Sequence, CompactSequenceSetFasta )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const sset = FastaReader().read( from_file( infile ));
+
+    for( size_t threads : { 1, 2 } ) {
+        CompactSequenceSet cset;
+        FastaReader().threads( threads ).chunk_size( 500 ).read( from_file( infile ), cset );
+        compare_compact_sequence_set_( sset, cset );
+
+        // Functions give the same results as for the normal set.
+        EXPECT_EQ( site_histogram( sset ), site_histogram( cset ));
+        EXPECT_EQ(
+            base_frequencies( sset, nucleic_acid_codes_plain() ),
+            base_frequencies( cset, nucleic_acid_codes_plain() )
+        );
+        EXPECT_EQ( gapyness( sset, "-" ), gapyness( cset, "-" ));
+        EXPECT_EQ( total_length( sset ), total_length( cset ));
+        EXPECT_EQ( is_alignment( sset ), is_alignment( cset ));
+
+        // Same for the site counts.
+        auto counts_s = SiteCounts( nucleic_acid_codes_plain(), sset[0].length() );
+        auto counts_c = SiteCounts( nucleic_acid_codes_plain(), sset[0].length() );
+        counts_s.add_sequences( sset );
+        counts_c.add_sequences( cset );
+        EXPECT_EQ( counts_s.added_sequences_count(), counts_c.added_sequences_count() );
+        for( size_t s = 0; s < counts_s.length(); ++s ) {
+            for( size_t c = 0; c < counts_s.characters().size(); ++c ) {
+                EXPECT_EQ( counts_s.count_at( c, s ), counts_c.count_at( c, s ));
+            }
+        }
+    }
+}
+
+TEST( Sequence, CompactSequenceSetPhylip )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "sequence/dna_5_42_s.phylip";
+    auto reader = PhylipReader();
+    reader.label_length( 10 );
+
+    SequenceSet sset;
+    reader.read( from_file( infile ), sset );
+
+    CompactSequenceSet cset;
+    reader.read( from_file( infile ), cset );
+    compare_compact_sequence_set_( sset, cset );
+    EXPECT_TRUE( is_alignment( cset ));
+}
@@ -65,6 +65,75 @@ TEST( Sequence, FastaReaderValidating )
     EXPECT_EQ( "TCGAAACCTGC------CTA", sset[0].sites().substr( 0, 20 ) );
 }
 
+TEST( Sequence, FastaReaderParallel )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read sequentially, and then in parallel with different chunk sizes,
+    // including ones that are smaller than a sequence.
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const expected = FastaReader().read( utils::from_file( infile ));
+    ASSERT_EQ( 10, expected.size() );
+
+    for( size_t threads : { 0, 2, 3 } ) {
+        for( size_t chunk_size : { 1, 100, 500, 1000, 1 << 20 } ) {
+            auto const reader = FastaReader()
+                .valid_chars( nucleic_acid_codes_all() )
+                .threads( threads )
+                .chunk_size( chunk_size )
+            ;
+            for( auto const& source : {
+                utils::from_file( infile ), utils::from_mapped_file( infile )
+            }) {
+                auto const sset = reader.read( source );
+                ASSERT_EQ( expected.size(), sset.size() );
+                for( size_t i = 0; i < expected.size(); ++i ) {
+                    EXPECT_EQ( expected[i].label(), sset[i].label() );
+                    EXPECT_EQ( expected[i].sites(), sset[i].sites() );
+                }
+            }
+        }
+    }
+}
+
+TEST( Sequence, FastaReaderParallelSettings )
+{
+    // Windows line breaks, labels with abundances, and a '>' within a label.
+    std::string const input =
+        ">a;size=3;\r\nacgt\r\nac\r\n"
+        ">b>c_5\r\nAC\r\n"
+        ">d\r\n;comment\r\ntt\r\n"
+    ;
+
+    auto const sset = FastaReader()
+        .guess_abundances( true )
+        .threads( 2 )
+        .chunk_size( 4 )
+        .read( utils::from_string( input ))
+    ;
+    ASSERT_EQ( 3, sset.size() );
+    EXPECT_EQ( "a",      sset[0].label() );
+    EXPECT_EQ( 3,        sset[0].abundance() );
+    EXPECT_EQ( "ACGTAC", sset[0].sites() );
+    EXPECT_EQ( "b>c",    sset[1].label() );
+    EXPECT_EQ( 5,        sset[1].abundance() );
+    EXPECT_EQ( "AC",     sset[1].sites() );
+    EXPECT_EQ( "d",      sset[2].label() );
+    EXPECT_EQ( "TT",     sset[2].sites() );
+
+    // Empty input yields no sequences, and invalid input throws, as in sequential reading.
+    EXPECT_EQ( 0, FastaReader().threads( 2 ).read( utils::from_string( "" )).size() );
+    EXPECT_ANY_THROW(
+        FastaReader().threads( 2 ).chunk_size( 4 ).valid_chars( "ACGT" ).read(
+            utils::from_string( ">a\nACGT\n>b\nACXT\n" )
+        )
+    );
+    EXPECT_ANY_THROW(
+        FastaReader().threads( 2 ).read( utils::from_string( "a\nACGT\n" ))
+    );
+}
+
 TEST( FastaInputIterator, ReadingLoop )
 {
     // Skip test if no data availabe.
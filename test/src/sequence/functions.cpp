@@ -75,3 +75,37 @@ TEST( SequenceSet, Characteristics )
     EXPECT_DOUBLE_EQ( 0.2816180235535074,  bf.at('G') );
     EXPECT_DOUBLE_EQ( 0.21633384536610342, bf.at('T') );
 }
+
+TEST( SequenceSet, GapSites )
+{
+    // Use sequences that span more than one word of the Bitvector.
+    size_t const size = 150;
+    SequenceSet sset;
+    for( size_t s = 0; s < 3; ++s ) {
+        std::string sites;
+        for( size_t i = 0; i < size; ++i ) {
+            sites += ( i % ( s + 2 ) == 0 ? '-' : 'A' );
+        }
+        sset.add( Sequence( "s" + std::to_string( s ), sites ));
+    }
+
+    // Single sequence: every second site is a gap.
+    auto const seq_gaps = gap_sites( sset[0] );
+    ASSERT_EQ( size, seq_gaps.size() );
+    EXPECT_EQ( 75, seq_gaps.count() );
+    for( size_t i = 0; i < size; ++i ) {
+        EXPECT_EQ( i % 2 == 0, seq_gaps[i] );
+    }
+
+    // Whole set: sites that are divisible by 2, 3 and 4 are all-gap.
+    auto const set_gaps = gap_sites( sset );
+    ASSERT_EQ( size, set_gaps.size() );
+    EXPECT_EQ( 13, set_gaps.count() );
+    for( size_t i = 0; i < size; ++i ) {
+        EXPECT_EQ( i % 12 == 0, set_gaps[i] );
+    }
+
+    // Not an alignment.
+    sset.add( Sequence( "short", "--" ));
+    EXPECT_ANY_THROW( gap_sites( sset ));
+}
@@ -0,0 +1,209 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/sequence/counts.hpp"
+#include "genesis/sequence/formats/fasta_reader.hpp"
+#include "genesis/sequence/functions/codes.hpp"
+#include "genesis/sequence/functions/signatures.hpp"
+#include "genesis/sequence/functions/signature_specifications.hpp"
+#include "genesis/sequence/packed_sequence.hpp"
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/sequence/sequence.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace genesis;
+using namespace genesis::sequence;
+using namespace genesis::utils;
+
+// =================================================================================================
+//     Helpers
+// =================================================================================================
+
+static std::string packed_sequence_random_sites_( std::string const& chars, size_t length )
+{
+    // Fixed seed, so that the test is reproducible.
+    static std::mt19937 engine( 42 );
+    std::uniform_int_distribution<size_t> distribution( 0, chars.size() - 1 );
+
+    auto result = std::string( length, ' ' );
+    for( auto& c : result ) {
+        c = chars[ distribution( engine ) ];
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Packing
+// =================================================================================================
+
+TEST( Sequence, PackedSequenceBasics )
+{
+    // Two bits.
+    auto const tb = PackedSequence( "a", "ACGTacgtU", PackedSequence::Encoding::kTwobit, 3 );
+    EXPECT_EQ( "a", tb.label() );
+    EXPECT_EQ( 3, tb.abundance() );
+    EXPECT_EQ( 9, tb.size() );
+    EXPECT_EQ( 1, tb.data().size() );
+    EXPECT_EQ( "ACGTACGTT", tb.sites() );
+    EXPECT_EQ( 2, tb.code_at( 2 ));
+    EXPECT_EQ( 'G', tb[ 2 ] );
+    EXPECT_THROW( tb.site_at( 9 ), std::out_of_range );
+    EXPECT_THROW(
+        PackedSequence( "", "ACGN", PackedSequence::Encoding::kTwobit ), std::invalid_argument
+    );
+
+    // Four bits. Undetermined chars except N are unpacked as gaps.
+    auto const fb = PackedSequence( Sequence( "b", "ACGTWSMKRYBDHVN-acgt.?XO" ));
+    EXPECT_EQ( PackedSequence::Encoding::kFourbit, fb.encoding() );
+    EXPECT_EQ( 24, fb.size() );
+    EXPECT_EQ( 2, fb.data().size() );
+    EXPECT_EQ( "ACGTWSMKRYBDHVN-ACGT----", fb.sites() );
+    EXPECT_EQ( 0x5, fb.code_at( 8 ));
+    EXPECT_THROW( PackedSequence( "", "ACGJ" ), std::invalid_argument );
+
+    auto const seq = fb.to_sequence();
+    EXPECT_EQ( "b", seq.label() );
+    EXPECT_EQ( fb.sites(), seq.sites() );
+
+    // All lengths around the word boundaries round trip.
+    for( size_t len = 0; len < 100; ++len ) {
+        auto const plain = packed_sequence_random_sites_( "ACGT", len );
+        auto const amb   = packed_sequence_random_sites_( "ACGTWSMKRYBDHVN-", len );
+        EXPECT_EQ( plain, PackedSequence( "", plain, PackedSequence::Encoding::kTwobit ).sites() );
+        EXPECT_EQ( amb,   PackedSequence( "", amb,   PackedSequence::Encoding::kFourbit ).sites() );
+    }
+}
+
+// =================================================================================================
+//     Kernels
+// =================================================================================================
+
+TEST( Sequence, PackedSequenceReverseComplement )
+{
+    for( size_t len = 0; len < 100; ++len ) {
+        auto const plain = packed_sequence_random_sites_( "ACGT", len );
+        auto const amb   = packed_sequence_random_sites_( "ACGTWSMKRYBDHVN", len );
+
+        auto const tb = PackedSequence( "", plain, PackedSequence::Encoding::kTwobit );
+        auto const tr = reverse_complement( tb );
+        EXPECT_EQ( reverse_complement( plain ), tr.sites() );
+        EXPECT_EQ( tb.data(), reverse_complement( tr ).data() );
+
+        auto const fb = PackedSequence( "", amb, PackedSequence::Encoding::kFourbit );
+        auto const fr = reverse_complement( fb );
+        EXPECT_EQ( reverse_complement( amb ), fr.sites() );
+        EXPECT_EQ( fb.data(), reverse_complement( fr ).data() );
+    }
+
+    // Gaps stay gaps.
+    EXPECT_EQ( "T-CA", reverse_complement( PackedSequence( "", "TG-A" )).sites() );
+}
+
+TEST( Sequence, PackedSequenceSignatureCounts )
+{
+    auto const plain = packed_sequence_random_sites_( "ACGT", 500 );
+    auto const amb   = packed_sequence_random_sites_( "ACGTTTTTTTTN-", 500 );
+
+    for( size_t k = 1; k < 6; ++k ) {
+        auto const settings = SignatureSpecifications( "ACGT", k );
+
+        EXPECT_EQ(
+            signature_counts( Sequence( "", plain ), settings ),
+            signature_counts( PackedSequence( "", plain, PackedSequence::Encoding::kTwobit ), settings )
+        );
+        EXPECT_EQ(
+            signature_counts( Sequence( "", plain ), settings ),
+            signature_counts( PackedSequence( "", plain, PackedSequence::Encoding::kFourbit ), settings )
+        );
+        EXPECT_EQ(
+            signature_counts( Sequence( "", amb ), settings ),
+            signature_counts( PackedSequence( "", amb, PackedSequence::Encoding::kFourbit ), settings )
+        );
+    }
+
+    auto settings = SignatureSpecifications( "ACGT", 2 );
+    settings.unknown_char_behavior( SignatureSpecifications::UnknownCharBehavior::kThrow );
+    EXPECT_THROW( signature_counts( PackedSequence( "", "ACNT" ), settings ), std::runtime_error );
+}
+
+TEST( Sequence, PackedSequenceSiteCounts )
+{
+    auto counts_s = SiteCounts( "ACGT-", 70 );
+    auto counts_p = SiteCounts( "ACGT-", 70 );
+    for( size_t i = 0; i < 10; ++i ) {
+        auto const sites = packed_sequence_random_sites_( "ACGTRN-", 70 );
+        counts_s.add_sequence( Sequence( "", sites, i + 1 ));
+        counts_p.add_sequence( PackedSequence( "", sites, PackedSequence::Encoding::kFourbit, i + 1 ));
+    }
+    EXPECT_EQ( counts_s.added_sequences_count(), counts_p.added_sequences_count() );
+    for( size_t s = 0; s < counts_s.length(); ++s ) {
+        for( size_t c = 0; c < counts_s.characters().size(); ++c ) {
+            EXPECT_EQ( counts_s.count_at( c, s ), counts_p.count_at( c, s ));
+        }
+    }
+
+    EXPECT_THROW( counts_p.add_sequence( PackedSequence( "", "ACGT" )), std::runtime_error );
+}
+
+// =================================================================================================
+//     Reading
+// =================================================================================================
+
+TEST( Sequence, PackedSequenceFastaReader )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const sset = FastaReader().read( from_file( infile ));
+
+    for( size_t threads : { 1, 2 } ) {
+        std::vector<PackedSequence> packed;
+        FastaReader().threads( threads ).read( from_file( infile ), packed );
+
+        ASSERT_EQ( sset.size(), packed.size() );
+        for( size_t i = 0; i < sset.size(); ++i ) {
+            EXPECT_EQ( sset[i].label(), packed[i].label() );
+            EXPECT_EQ( sset[i].sites(), packed[i].sites() );
+        }
+    }
+
+    // The file contains gaps, which do not fit into two bits.
+    std::vector<PackedSequence> packed;
+    EXPECT_THROW(
+        FastaReader().read( from_file( infile ), packed, PackedSequence::Encoding::kTwobit ),
+        std::invalid_argument
+    );
+}
@@ -0,0 +1,192 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief Testing Tree distance methods.
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/tree/bipartition/consensus.hpp"
+#include "genesis/tree/bipartition/rf.hpp"
+#include "genesis/tree/bipartition/split_table.hpp"
+#include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/common_tree/newick_writer.hpp"
+#include "genesis/tree/common_tree/tree.hpp"
+#include "genesis/tree/formats/newick/input_iterator.hpp"
+#include "genesis/tree/function/functions.hpp"
+#include "genesis/tree/tree_set.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace genesis;
+using namespace tree;
+
+TEST( Consensus, Majority )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    TreeSet trees;
+    std::string const infile = environment->data_dir + "tree/random-trees.newick";
+    CommonTreeNewickReader().read( utils::from_file( infile ), trees );
+    ASSERT_EQ( 10, trees.size() );
+
+    // The consensus of copies of the same tree is that tree.
+    TreeSet same;
+    same.add( trees[0] );
+    same.add( trees[0] );
+    same.add( trees[0] );
+    for( auto method : {
+        ConsensusMethod::kStrict,
+        ConsensusMethod::kMajorityRule,
+        ConsensusMethod::kExtendedMajorityRule
+    }) {
+        auto const cons = consensus_tree( same, method );
+        EXPECT_EQ( 0, rf_distance_absolute( trees[0], cons ));
+        EXPECT_TRUE( is_bifurcating( cons ));
+        for( auto const& node : cons.nodes() ) {
+            if( is_inner( node ) && ! is_root( node )) {
+                EXPECT_EQ( "1", node.data<CommonNodeData>().name );
+            }
+        }
+    }
+
+    // Trees 0 and 7 share two of their seven splits. Two copies of tree 0 win the majority.
+    TreeSet mixed;
+    mixed.add( trees[0] );
+    mixed.add( trees[7] );
+    mixed.add( trees[0] );
+    auto const majority = consensus_tree( mixed, ConsensusMethod::kMajorityRule );
+    EXPECT_EQ( 0, rf_distance_absolute( trees[0], majority ));
+    size_t full_support = 0;
+    for( auto const& node : majority.nodes() ) {
+        if( is_inner( node ) && ! is_root( node )) {
+            auto const& name = node.data<CommonNodeData>().name;
+            EXPECT_TRUE( name == "1" || name == "0.666667" );
+            full_support += ( name == "1" );
+        }
+    }
+    EXPECT_EQ( 2, full_support );
+
+    // The strict consensus only has the shared splits.
+    TreeSet pair;
+    pair.add( trees[0] );
+    pair.add( trees[7] );
+    auto const strict = consensus_tree( pair, ConsensusMethod::kStrict );
+    EXPECT_EQ( 2, inner_edge_count( strict ));
+    EXPECT_EQ( 10, leaf_node_count( strict ));
+    EXPECT_EQ( 5, rf_distance_absolute( trees[0], strict ));
+}
+
+TEST( Consensus, Stream )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    TreeSet trees;
+    std::string const infile = environment->data_dir + "tree/random-trees.newick";
+    CommonTreeNewickReader().read( utils::from_file( infile ), trees );
+
+    for( auto method : {
+        ConsensusMethod::kStrict,
+        ConsensusMethod::kMajorityRule,
+        ConsensusMethod::kExtendedMajorityRule
+    }) {
+        auto const exp = CommonTreeNewickWriter().to_string( consensus_tree( trees, method ));
+
+        // Small blocks, with and without a limit that does not need pruning.
+        for( size_t max_splits : { 0, 1000 } ) {
+            auto it = NewickInputIterator( utils::from_file( infile ), CommonTreeNewickReader() );
+            auto const cons = consensus_tree( it, method, max_splits, 3 );
+            EXPECT_EQ( exp, CommonTreeNewickWriter().to_string( cons ));
+            EXPECT_EQ( 10, leaf_node_count( cons ));
+        }
+    }
+
+    // The extended majority rule resolves at least as much as the majority rule.
+    auto const majority = consensus_tree( trees, ConsensusMethod::kMajorityRule );
+    auto const extended = consensus_tree( trees, ConsensusMethod::kExtendedMajorityRule );
+    EXPECT_LE( inner_edge_count( majority ), inner_edge_count( extended ));
+    EXPECT_LE( inner_edge_count( extended ), 7 );
+
+    // Pruning keeps the most frequent splits.
+    auto pruned = SplitTable( rf_taxon_name_map( trees[0] ), SplitHashWidth::k128, true );
+    pruned.add_trees( trees );
+    auto freqs = std::vector<size_t>();
+    for( size_t i = 0; i < pruned.split_count(); ++i ) {
+        freqs.push_back( pruned.split_frequency( i ));
+    }
+    std::sort( freqs.rbegin(), freqs.rend() );
+    pruned.retain_most_frequent( 5 );
+    ASSERT_EQ( 5, pruned.split_count() );
+    for( size_t i = 0; i < 5; ++i ) {
+        EXPECT_LE( freqs[4], pruned.split_frequency( i ));
+    }
+    auto const after = pruned.add_tree( trees[0] );
+    EXPECT_EQ( 7, after.size() );
+    auto const added = std::count_if( after.begin(), after.end(), []( SplitTable::SplitId id ){
+        return id >= 5;
+    });
+    EXPECT_EQ( 5 + static_cast<size_t>( added ), pruned.split_count() );
+
+    // Reducing keeps the frequencies within the documented error of their true values.
+    auto exact = SplitTable( rf_taxon_name_map( trees[0] ));
+    exact.add_trees( trees );
+    auto reduced = SplitTable( rf_taxon_name_map( trees[0] ));
+    reduced.add_trees( trees );
+    reduced.reduce_to_frequent( 5 );
+    EXPECT_LE( reduced.split_count(), 5 );
+    EXPECT_LE( reduced.frequency_error(), trees.size() * 7 / 6 );
+    for( size_t i = 0; i < exact.split_count(); ++i ) {
+        size_t found = 0;
+        for( size_t j = 0; j < reduced.split_count(); ++j ) {
+            if( reduced.split_hash( j ) == exact.split_hash( i )) {
+                EXPECT_LE( reduced.split_frequency( j ), exact.split_frequency( i ));
+                EXPECT_LE(
+                    exact.split_frequency( i ), reduced.split_frequency( j ) + reduced.frequency_error()
+                );
+                ++found;
+            }
+        }
+        EXPECT_LE( found, 1 );
+        if( exact.split_frequency( i ) > reduced.frequency_error() ) {
+            EXPECT_EQ( 1, found );
+        }
+    }
+
+    // Too few splits to hold a full tree are rejected.
+    auto small = NewickInputIterator( utils::from_file( infile ), CommonTreeNewickReader() );
+    EXPECT_ANY_THROW( consensus_tree( small, ConsensusMethod::kMajorityRule, 6 ));
+
+    // Bitvectors are needed for building the tree.
+    auto table = SplitTable( rf_taxon_name_map( trees[0] ));
+    table.add_trees( trees );
+    EXPECT_ANY_THROW( consensus_tree( table, ConsensusMethod::kMajorityRule ));
+}
@@ -34,6 +34,7 @@
 
 #include "genesis/tree/common_tree/distances.hpp"
 #include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/common_tree/tree_distance_oracle.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/functions.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
@@ -109,3 +110,42 @@ TEST( CommonTree, PatristicDistances )
 
     EXPECT_EQ( exp, mat );
 }
+
+TEST( CommonTree, TreeDistanceOracle )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read and process tree.
+    std::string const infile = environment->data_dir + "tree/distances.newick";
+    Tree const tree =  CommonTreeNewickReader().read( utils::from_file( infile ));
+
+    auto const oracle = TreeDistanceOracle( tree );
+    auto const distances = node_branch_length_distance_matrix( tree );
+    auto const sides = node_root_direction_matrix( tree );
+    ASSERT_EQ( tree.node_count(), oracle.node_count() );
+
+    for( size_t i = 0; i < tree.node_count(); ++i ) {
+        EXPECT_EQ( distances( tree.root_node().index(), i ), oracle.root_distance( i ));
+        for( size_t j = 0; j < tree.node_count(); ++j ) {
+            EXPECT_EQ( distances( i, j ), oracle.distance( i, j ));
+            EXPECT_EQ( distances( i, j ), oracle( i, j ));
+            EXPECT_EQ( sides( i, j ), oracle.root_direction( i, j ));
+        }
+    }
+
+    // Batch lookup.
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for( size_t i = 0; i < tree.node_count(); ++i ) {
+        for( size_t j = i; j < tree.node_count(); ++j ) {
+            pairs.emplace_back( j, i );
+        }
+    }
+    for( auto method : { LcaBatchMethod::kOnline, LcaBatchMethod::kOffline } ) {
+        auto const batch = oracle.distances( pairs, method );
+        ASSERT_EQ( pairs.size(), batch.size() );
+        for( size_t k = 0; k < pairs.size(); ++k ) {
+            EXPECT_EQ( distances( pairs[k].first, pairs[k].second ), batch[k] );
+        }
+    }
+}
@@ -30,11 +30,14 @@
 
 #include "src/common.hpp"
 
+#include <algorithm>
 #include <string>
 
 #include "genesis/tree/bipartition/rf.hpp"
+#include "genesis/tree/bipartition/split_table.hpp"
 #include "genesis/tree/common_tree/distances.hpp"
 #include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/formats/newick/input_iterator.hpp"
 #include "genesis/tree/function/functions.hpp"
 #include "genesis/tree/tree_set.hpp"
 #include "genesis/tree/tree.hpp"
@@ -99,3 +102,66 @@ TEST(CommonTree, RFDistance)
     };
     EXPECT_EQ( rf_vec_exp, rf_vec );
 }
+
+TEST(CommonTree, RFDistanceSplitTable)
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    TreeSet trees;
+    std::string const infile = environment->data_dir + "tree/random-trees.newick";
+    CommonTreeNewickReader().read( utils::from_file( infile ), trees );
+    ASSERT_EQ( 10, trees.size() );
+    auto const rf_mat = rf_distance_absolute( trees );
+
+    // Streaming, with all hash variants, and small blocks so that we get several of them.
+    for( auto width : { SplitHashWidth::k64, SplitHashWidth::k128 } ) {
+        for( auto verify : { false, true } ) {
+            auto it = NewickInputIterator( utils::from_file( infile ), CommonTreeNewickReader() );
+            EXPECT_EQ( rf_mat, rf_distance_absolute( it, width, verify ));
+
+            auto table = SplitTable( rf_taxon_name_map( trees[0] ), width, verify );
+            auto it2 = NewickInputIterator( utils::from_file( infile ), CommonTreeNewickReader() );
+            auto const ids = rf_get_split_ids( it2, table, 3 );
+            ASSERT_EQ( trees.size(), ids.size() );
+            EXPECT_EQ( rf_mat, rf_distance_absolute( ids ));
+            EXPECT_EQ( trees.size(), table.tree_count() );
+
+            // Adding the trees in small blocks yields the same ids as adding them all at once.
+            auto blocked = SplitTable( rf_taxon_name_map( trees[0] ), width, verify );
+            EXPECT_EQ( ids, blocked.add_trees( trees, 3 ));
+        }
+    }
+
+    // The table yields the same splits as the bitvectors.
+    auto const names = rf_taxon_name_map( trees[0] );
+    auto table = SplitTable( names, SplitHashWidth::k128, true );
+    auto const ids = table.add_trees( trees );
+    size_t total = 0;
+    for( size_t i = 0; i < trees.size(); ++i ) {
+        auto const bitvecs = rf_get_bitvectors( trees[i], names );
+        ASSERT_EQ( bitvecs.size(), ids[i].size() );
+        EXPECT_EQ( bitvecs.size(), table.split_hashes( trees[i] ).size() );
+        for( auto const id : ids[i] ) {
+            EXPECT_NE( bitvecs.end(), std::find(
+                bitvecs.begin(), bitvecs.end(), table.split_bitvector( id )
+            ));
+        }
+        total += ids[i].size();
+    }
+    size_t freq_sum = 0;
+    for( size_t id = 0; id < table.split_count(); ++id ) {
+        freq_sum += table.split_frequency( id );
+    }
+    EXPECT_EQ( total, freq_sum );
+    EXPECT_EQ( rf_get_occurrences( trees ).size(), table.split_count() );
+
+    // Bitvectors are only available when verifying.
+    auto plain = SplitTable( names );
+    plain.add_tree( trees[0] );
+    EXPECT_ANY_THROW( plain.split_bitvector( 0 ));
+
+    // Wrong taxa.
+    auto other = CommonTreeNewickReader().read( utils::from_string( "((a,b),(c,d),e);" ));
+    EXPECT_ANY_THROW( table.add_tree( other ));
+}
@@ -0,0 +1,120 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/function/measures.hpp"
+#include "genesis/placement/function/operators.hpp"
+#include "genesis/placement/sample.hpp"
+
+#include "genesis/tree/common_tree/distances.hpp"
+#include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/flat_tree.hpp"
+#include "genesis/tree/function/distances.hpp"
+#include "genesis/tree/function/functions.hpp"
+#include "genesis/tree/mass_tree/emd.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include "genesis/utils/containers/matrix.hpp"
+#include "genesis/utils/containers/matrix/operators.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::tree;
+
+TEST( FlatTree, Topology )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string const infile = environment->data_dir + "tree/distances.newick";
+    Tree const tree = CommonTreeNewickReader().read( utils::from_file( infile ));
+    FlatTree const flat( tree );
+
+    EXPECT_EQ( tree.node_count(), flat.node_count() );
+    EXPECT_EQ( tree.edge_count(), flat.edge_count() );
+    EXPECT_EQ( tree.root_node().index(), flat.root_node() );
+    EXPECT_TRUE( flat.has_branch_lengths() );
+
+    for( auto const& node : tree.nodes() ) {
+        auto const ni = node.index();
+        EXPECT_EQ( degree( node ), flat.degree( ni ));
+        EXPECT_EQ( is_leaf( node ), flat.is_leaf( ni ));
+        for( auto const child : flat.children( ni )) {
+            EXPECT_EQ( ni, flat.parent_node( child ));
+        }
+    }
+    for( auto const& edge : tree.edges() ) {
+        auto const ei = edge.index();
+        EXPECT_EQ( edge.primary_node().index(), flat.primary_node( ei ));
+        EXPECT_EQ( edge.secondary_node().index(), flat.secondary_node( ei ));
+        EXPECT_EQ( ei, flat.parent_edge( flat.secondary_node( ei )));
+    }
+    EXPECT_EQ( FlatTree::InvalidIndex, flat.parent_node( flat.root_node() ));
+    EXPECT_EQ( flat.root_node(), flat.preorder().front() );
+    EXPECT_EQ( flat.root_node(), flat.postorder().back() );
+
+    // Functions give the same results as on the Tree.
+    EXPECT_EQ( subtree_sizes( tree ), subtree_sizes( flat ));
+    EXPECT_EQ( node_path_length_matrix( tree ), node_path_length_matrix( flat ));
+    EXPECT_EQ(
+        node_branch_length_distance_matrix( tree ),
+        node_branch_length_distance_matrix( flat )
+    );
+}
+
+TEST( FlatTree, Measures )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string const infile_lhs = environment->data_dir + "placement/test_a.jplace";
+    std::string const infile_rhs = environment->data_dir + "placement/test_b.jplace";
+    auto const smp_lhs = placement::JplaceReader().read( utils::from_file( infile_lhs ));
+    auto const smp_rhs = placement::JplaceReader().read( utils::from_file( infile_rhs ));
+    FlatTree const flat( smp_lhs.tree() );
+
+    // Edpl.
+    EXPECT_EQ( placement::edpl( smp_lhs ), placement::edpl( smp_lhs, flat ));
+
+    // Earth mover's distance.
+    auto const mt_lhs = placement::convert_sample_to_mass_tree( smp_lhs, true ).first;
+    auto const mt_rhs = placement::convert_sample_to_mass_tree( smp_rhs, true ).first;
+    for( double p : { 1.0, 2.0 } ) {
+        EXPECT_DOUBLE_EQ(
+            earth_movers_distance( mt_lhs, mt_rhs, p ),
+            earth_movers_distance( flat, mt_lhs, mt_rhs, p )
+        );
+    }
+    EXPECT_DOUBLE_EQ( 0.0, earth_movers_distance( flat, mt_lhs, mt_lhs ));
+}
@@ -38,6 +38,7 @@
 #include "genesis/tree/common_tree/tree.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
 #include "genesis/tree/function/functions.hpp"
+#include "genesis/tree/function/lca_lookup.hpp"
 #include "genesis/tree/tree.hpp"
 #include "genesis/utils/text/string.hpp"
 #include "genesis/utils/containers/matrix/operators.hpp"
@@ -286,6 +287,39 @@ TEST( TreeFunctions, LCAs )
     EXPECT_EQ( exp, lcas );
 }
 
+TEST( TreeFunctions, LcaLookupBatch )
+{
+    auto test_tree = []( Tree const& tree ){
+        auto const lcas = lowest_common_ancestors( tree );
+        auto const lookup = LcaLookup( tree );
+
+        // All pairs of nodes, in both orders.
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for( size_t i = 0; i < tree.node_count(); ++i ) {
+            for( size_t j = 0; j < tree.node_count(); ++j ) {
+                pairs.emplace_back( i, j );
+            }
+        }
+
+        for( auto method : {
+            LcaBatchMethod::kAutomatic, LcaBatchMethod::kOnline, LcaBatchMethod::kOffline
+        }) {
+            auto const result = lookup( pairs, method );
+            ASSERT_EQ( pairs.size(), result.size() );
+            for( size_t k = 0; k < pairs.size(); ++k ) {
+                EXPECT_EQ( lcas( pairs[k].first, pairs[k].second ), result[k] );
+            }
+            EXPECT_TRUE( lookup( {}, method ).empty() );
+        }
+
+        EXPECT_ANY_THROW( lookup({ std::make_pair( tree.node_count(), size_t( 0 )) }));
+    };
+
+    test_tree( CommonTreeNewickReader().read( utils::from_string( "((B,(D,E)C)A,F,(H,I)G)R;" )));
+    test_tree( CommonTreeNewickReader().read( utils::from_string( "((A,B)C,(D,E)F)R;" )));
+    test_tree( CommonTreeNewickReader().read( utils::from_string( "(A)R;" )));
+}
+
 TEST( TreeFunctions, SignMatrix )
 {
     // Skip test if no data availabe.
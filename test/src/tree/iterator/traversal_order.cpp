@@ -0,0 +1,106 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief Testing Tree Iterators.
+ *
+ * @file
+ * @ingroup test
+ */
+#include "src/common.hpp"
+
+#include <string>
+
+#include "genesis/tree/common_tree/tree.hpp"
+#include "genesis/tree/common_tree/functions.hpp"
+#include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/formats/newick/reader.hpp"
+#include "genesis/tree/function/manipulation.hpp"
+#include "genesis/tree/iterator/levelorder.hpp"
+#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/iterator/preorder.hpp"
+#include "genesis/tree/iterator/traversal_order.hpp"
+#include "genesis/tree/tree.hpp"
+
+using namespace genesis;
+using namespace tree;
+
+// =================================================================================================
+//     Traversal Order
+// =================================================================================================
+
+template< class Range >
+std::string TestTraversalOrderNames( Range range )
+{
+    std::string nodes;
+    for( auto it : range ) {
+        nodes += it.node().template data<CommonNodeData>().name;
+    }
+    return nodes;
+}
+
+TEST( TreeIterator, TraversalOrder )
+{
+    std::string const input = "((B,(D,E)C)A,F,(H,I)G)R;";
+    Tree tree = CommonTreeNewickReader().read( utils::from_string( input ));
+    Tree const& ctree = tree;
+
+    // Same nodes as the iterators.
+    EXPECT_EQ( "BDECAFHIGR", TestTraversalOrderNames( cached_postorder( ctree )));
+    EXPECT_EQ( "RABCDEFGHI", TestTraversalOrderNames( cached_preorder( ctree )));
+    EXPECT_EQ( TestTraversalOrderNames( levelorder( ctree )), TestTraversalOrderNames( cached_levelorder( ctree )));
+    EXPECT_EQ( TestTraversalOrderNames( postorder( tree )), TestTraversalOrderNames( cached_postorder( tree )));
+
+    // Same links and flags as the iterators.
+    auto cached = cached_postorder( ctree ).begin();
+    for( auto it : postorder( ctree )) {
+        EXPECT_EQ( &it.link(), &cached.link() );
+        EXPECT_EQ( &it.edge(), &cached.edge() );
+        EXPECT_EQ( it.is_last_iteration(), cached.is_last_iteration() );
+        ++cached;
+    }
+    EXPECT_TRUE( cached == cached_postorder( ctree ).end() );
+    EXPECT_TRUE( cached_preorder( ctree ).begin().is_first_iteration() );
+
+    // The cache is reused as long as the topology does not change.
+    auto const* const cache = &tree.traversal_link_indices( TreeTraversalOrder::kPostorder );
+    EXPECT_EQ( cache, &tree.traversal_link_indices( TreeTraversalOrder::kPostorder ));
+    EXPECT_EQ( tree.node_count(), cache->size() );
+
+    // Copies compute their own order.
+    Tree const copy = tree;
+    EXPECT_NE( cache, &copy.traversal_link_indices( TreeTraversalOrder::kPostorder ));
+    EXPECT_EQ( *cache, copy.traversal_link_indices( TreeTraversalOrder::kPostorder ));
+
+    // Changes of the topology invalidate the cache.
+    ladderize( tree );
+    EXPECT_EQ( TestTraversalOrderNames( postorder( ctree )), TestTraversalOrderNames( cached_postorder( ctree )));
+    EXPECT_EQ( TestTraversalOrderNames( genesis::tree::preorder( ctree )), TestTraversalOrderNames( cached_preorder( ctree )));
+
+    change_rooting( tree, *find_node( tree, "C" ));
+    EXPECT_EQ( TestTraversalOrderNames( postorder( ctree )), TestTraversalOrderNames( cached_postorder( ctree )));
+    EXPECT_EQ( TestTraversalOrderNames( levelorder( ctree )), TestTraversalOrderNames( cached_levelorder( ctree )));
+
+    tree.clear();
+    EXPECT_TRUE( tree.traversal_link_indices( TreeTraversalOrder::kPreorder ).empty() );
+}
@@ -35,15 +35,22 @@
 #include "genesis/placement/sample.hpp"
 
 #include "genesis/tree/common_tree/newick_reader.hpp"
+#include "genesis/tree/flat_tree.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/mass_tree/balances.hpp"
+#include "genesis/tree/mass_tree/binned_mass_tree.hpp"
+#include "genesis/tree/mass_tree/emd.hpp"
+#include "genesis/tree/mass_tree/flat_mass_tree.hpp"
 #include "genesis/tree/mass_tree/functions.hpp"
 #include "genesis/tree/mass_tree/phylo_ilr.hpp"
+#include "genesis/tree/mass_tree/squash_clustering.hpp"
+#include "genesis/tree/mass_tree/tree.hpp"
 
 #include "genesis/utils/containers/matrix/operators.hpp"
 #include "genesis/utils/math/common.hpp"
 #include "genesis/utils/text/string.hpp"
 
+#include <limits>
 #include <vector>
 
 using namespace genesis;
@@ -84,6 +91,314 @@ TEST( MassTree, Binify )
     }
 }
 
+TEST( MassTree, FlatMassTreeEmd )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::vector<MassTree> trees;
+    for( auto const& name : { "test_a", "test_b", "test_c" } ) {
+        auto const infile = environment->data_dir + "placement/" + name + ".jplace";
+        auto const smp = JplaceReader().read( utils::from_file( infile ));
+        trees.push_back( convert_sample_to_mass_tree( smp, true ).first );
+    }
+
+    // Flat masses are sorted per edge, in the same order as the maps.
+    auto const flat = FlatMassTree( trees[0] );
+    ASSERT_EQ( trees[0].edge_count(), flat.edge_count() );
+    for( size_t e = 0; e < flat.edge_count(); ++e ) {
+        auto const& data = trees[0].edge_at( e ).data<MassTreeEdgeData>();
+        EXPECT_EQ( data.branch_length, flat.branch_length( e ));
+        ASSERT_EQ( data.masses.size(), flat.mass_end( e ) - flat.mass_begin( e ));
+        size_t i = flat.mass_begin( e );
+        for( auto const& mass : data.masses ) {
+            EXPECT_EQ( mass.first,  flat.masses()[i].first );
+            EXPECT_EQ( mass.second, flat.masses()[i].second );
+            ++i;
+        }
+    }
+
+    // All versions of the distance yield the same values.
+    auto const topology = FlatTree( trees[0] );
+    for( double p : { 1.0, 2.0 } ) {
+        auto const matrix = earth_movers_distance( trees, p );
+        for( size_t i = 0; i < trees.size(); ++i ) {
+            EXPECT_EQ( 0.0, matrix( i, i ));
+            for( size_t j = 0; j < trees.size(); ++j ) {
+                auto const emd = earth_movers_distance( trees[i], trees[j], p );
+                EXPECT_DOUBLE_EQ( emd, matrix( i, j ));
+                EXPECT_DOUBLE_EQ( emd, earth_movers_distance( topology, trees[i], trees[j], p ));
+                EXPECT_DOUBLE_EQ( emd, earth_movers_distance(
+                    topology, FlatMassTree( trees[i] ), FlatMassTree( trees[j] ), p
+                ));
+                if( i != j ) {
+                    EXPECT_LT( 0.0, emd );
+                }
+
+                // Single tree version with merged masses.
+                auto merged = trees[j];
+                mass_tree_reverse_signs( merged );
+                mass_tree_merge_trees_inplace( merged, trees[i] );
+                auto const single = earth_movers_distance( merged, p ).first;
+                EXPECT_NEAR( emd, single, 1e-10 );
+            }
+        }
+    }
+}
+
+TEST( MassTree, EmdBatch )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::vector<MassTree> samples;
+    for( auto const& name : { "test_a", "test_b", "test_c" } ) {
+        auto const infile = environment->data_dir + "placement/" + name + ".jplace";
+        auto const smp = JplaceReader().read( utils::from_file( infile ));
+        samples.push_back( convert_sample_to_mass_tree( smp, true ).first );
+    }
+
+    // Use some more trees, so that there are several tiles.
+    std::vector<MassTree> trees;
+    for( size_t i = 0; i < 7; ++i ) {
+        trees.push_back( samples[ i % samples.size() ] );
+    }
+    auto batch = EarthMoversDistanceBatch( trees );
+    EXPECT_EQ( trees.size(), batch.size() );
+    EXPECT_EQ( trees[0].edge_count(), batch.edge_count() );
+
+    auto const topology = FlatTree( trees[0] );
+    for( double p : { 1.0, 2.0 } ) {
+        for( size_t tile_size : { 1, 2, 3, 16 } ) {
+            batch.tile_size( tile_size );
+            auto const matrix = batch.distance_matrix( p );
+            for( size_t i = 0; i < trees.size(); ++i ) {
+                EXPECT_EQ( 0.0, matrix( i, i ));
+                for( size_t j = 0; j < trees.size(); ++j ) {
+                    auto const emd = earth_movers_distance(
+                        topology, FlatMassTree( trees[i] ), FlatMassTree( trees[j] ), p
+                    );
+                    if( i != j ) {
+                        EXPECT_EQ( emd, matrix( i, j ));
+                    }
+                    EXPECT_EQ( emd, batch.distance( i, j, p ));
+                    EXPECT_DOUBLE_EQ( earth_movers_distance( trees[i], trees[j], p ), emd );
+                }
+            }
+        }
+    }
+
+    EXPECT_ANY_THROW( batch.distance( 0, trees.size() ));
+    EXPECT_EQ( 0, EarthMoversDistanceBatch( std::vector<MassTree>() ).distance_matrix().rows() );
+}
+
+TEST( MassTree, IncrementalEmd )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::vector<MassTree> samples;
+    for( auto const& name : { "test_a", "test_b", "test_c" } ) {
+        auto const infile = environment->data_dir + "placement/" + name + ".jplace";
+        auto const smp = JplaceReader().read( utils::from_file( infile ));
+        samples.push_back( convert_sample_to_mass_tree( smp, true ).first );
+    }
+
+    // Move the first mass point of the edge with index `from` to the start of edge `to`.
+    auto move_mass = []( MassTree& tree, size_t from, size_t to ){
+        auto& from_masses = tree.edge_at( from ).data<MassTreeEdgeData>().masses;
+        ASSERT_FALSE( from_masses.empty() );
+        tree.edge_at( to ).data<MassTreeEdgeData>().masses[ 0.0 ] += from_masses.begin()->second;
+        from_masses.erase( from_masses.begin() );
+    };
+
+    // Find some edges with masses.
+    auto sample = samples[0];
+    std::vector<size_t> mass_edges;
+    for( auto const& edge : sample.edges() ) {
+        if( ! edge.data<MassTreeEdgeData>().masses.empty() ) {
+            mass_edges.push_back( edge.index() );
+        }
+    }
+    ASSERT_LE( 3, mass_edges.size() );
+    auto const edge_count = sample.edge_count();
+
+    for( double p : { 1.0, 2.0 } ) {
+        sample = samples[0];
+        auto incremental = IncrementalEarthMoversDistance( sample, samples, p );
+        EXPECT_EQ( samples.size(), incremental.size() );
+        EXPECT_EQ( edge_count, incremental.edge_count() );
+
+        auto check = [&](){
+            auto const distances = incremental.distances();
+            ASSERT_EQ( samples.size(), distances.size() );
+            for( size_t i = 0; i < samples.size(); ++i ) {
+                EXPECT_NEAR( earth_movers_distance( sample, samples[i], p ), distances[i], 1e-10 );
+                EXPECT_EQ( distances[i], incremental.distance( i ));
+            }
+        };
+        check();
+        EXPECT_NEAR( 0.0, incremental.distance( 0 ), 1e-10 );
+
+        // Update with given edges.
+        move_mass( sample, mass_edges[0], mass_edges[1] );
+        move_mass( sample, mass_edges[2], ( mass_edges[2] + edge_count / 2 ) % edge_count );
+        incremental.update( sample, {
+            mass_edges[0], mass_edges[1], mass_edges[2], ( mass_edges[2] + edge_count / 2 ) % edge_count
+        });
+        check();
+
+        // Update with detection of the changed edges.
+        move_mass( sample, mass_edges[1], edge_count - 1 );
+        incremental.update( sample );
+        check();
+
+        // Nothing changed.
+        incremental.update( sample, {} );
+        check();
+    }
+
+    auto incremental = IncrementalEarthMoversDistance( samples[0], samples );
+    EXPECT_ANY_THROW( incremental.update( samples[1], { edge_count } ));
+
+    // Invalid edge data is detected before anything is changed, even on later edges.
+    auto invalid = samples[1];
+    invalid.edge_at( edge_count - 1 ).reset_data( CommonEdgeData::create() );
+    auto const before = incremental.distances();
+    EXPECT_ANY_THROW( incremental.update( invalid, { mass_edges[0], edge_count - 1 } ));
+    EXPECT_EQ( before, incremental.distances() );
+
+    EXPECT_ANY_THROW( incremental.distance( samples.size() ));
+    EXPECT_ANY_THROW( IncrementalEarthMoversDistance( samples[0], samples, 0.0 ));
+}
+
+TEST( MassTree, BinnedEmd )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::vector<MassTree> trees;
+    for( auto const& name : { "test_a", "test_b", "test_c" } ) {
+        auto const infile = environment->data_dir + "placement/" + name + ".jplace";
+        auto const smp = JplaceReader().read( utils::from_file( infile ));
+        trees.push_back( convert_sample_to_mass_tree( smp, true ).first );
+    }
+    auto const topology = FlatTree( trees[0] );
+
+    for( double p : { 0.5, 1.0, 2.0 } ) {
+        for( size_t bin_count : { 1, 4, 32 } ) {
+            auto const matrices = binned_earth_movers_distance( trees, bin_count, p );
+            for( size_t i = 0; i < trees.size(); ++i ) {
+                EXPECT_EQ( 0.0, matrices.first( i, i ));
+                for( size_t j = 0; j < trees.size(); ++j ) {
+                    auto const lhs = BinnedMassTree( trees[i], bin_count );
+                    auto const rhs = BinnedMassTree( trees[j], bin_count );
+                    auto const binned = binned_earth_movers_distance( topology, lhs, rhs, p );
+                    if( i != j ) {
+                        EXPECT_DOUBLE_EQ( binned.first,  matrices.first( i, j ));
+                        EXPECT_DOUBLE_EQ( binned.second, matrices.second( i, j ));
+                    }
+
+                    // The exact distance is within the bound.
+                    auto const exact = earth_movers_distance( trees[i], trees[j], p );
+                    EXPECT_LE( std::abs( exact - binned.first ), binned.second );
+
+                    // Same as the exact distance on binned masses.
+                    auto lhs_tree = trees[i];
+                    auto rhs_tree = trees[j];
+                    mass_tree_binify_masses( lhs_tree, bin_count );
+                    mass_tree_binify_masses( rhs_tree, bin_count );
+                    EXPECT_NEAR(
+                        earth_movers_distance( lhs_tree, rhs_tree, p ), binned.first, 1e-10
+                    );
+                }
+            }
+        }
+
+        // More bins, smaller error.
+        EXPECT_LT(
+            BinnedMassTree( trees[0], 32 ).binning_error( p ),
+            BinnedMassTree( trees[0], 4 ).binning_error( p )
+        );
+    }
+}
+
+TEST( MassTree, SquashClustering )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::vector<MassTree> samples;
+    for( auto const& name : { "test_a", "test_b", "test_c" } ) {
+        auto const infile = environment->data_dir + "placement/" + name + ".jplace";
+        auto const smp = JplaceReader().read( utils::from_file( infile ));
+        samples.push_back( convert_sample_to_mass_tree( smp, true ).first );
+    }
+
+    // Use some copies of the trees, so that there are pairs with equal distances.
+    std::vector<MassTree> trees = {
+        samples[0], samples[1], samples[2], samples[0], samples[1],
+        mass_tree_merge_trees( samples[0], samples[2], 1.0, 3.0 ), samples[2]
+    };
+
+    // Reference: Scan all pairs of active clusters in each step.
+    auto clusters = trees;
+    auto counts   = std::vector<size_t>( trees.size(), 1 );
+    auto active   = std::vector<bool>( trees.size(), true );
+    auto expected = std::vector<SquashClustering::Merger>();
+    for( size_t step = 0; step + 1 < trees.size(); ++step ) {
+        size_t min_i = 0;
+        size_t min_j = 0;
+        double min_d = std::numeric_limits<double>::max();
+        for( size_t i = 0; i < clusters.size(); ++i ) {
+            for( size_t j = 0; j < i; ++j ) {
+                if( ! active[i] || ! active[j] ) {
+                    continue;
+                }
+                auto const dist = earth_movers_distance( clusters[i], clusters[j] );
+                if( dist < min_d ) {
+                    min_i = j;
+                    min_j = i;
+                    min_d = dist;
+                }
+            }
+        }
+
+        auto merged = mass_tree_merge_trees(
+            clusters[ min_i ], clusters[ min_j ],
+            static_cast<double>( counts[ min_i ] ), static_cast<double>( counts[ min_j ] )
+        );
+        mass_tree_normalize_masses( merged );
+        expected.push_back({
+            min_i, earth_movers_distance( merged, clusters[ min_i ] ),
+            min_j, earth_movers_distance( merged, clusters[ min_j ] )
+        });
+        clusters.push_back( std::move( merged ));
+        counts.push_back( counts[ min_i ] + counts[ min_j ] );
+        active.push_back( true );
+        active[ min_i ] = false;
+        active[ min_j ] = false;
+    }
+
+    auto sc = SquashClustering();
+    auto copy = trees;
+    sc.run( std::move( copy ));
+    ASSERT_EQ( expected.size(), sc.mergers().size() );
+    ASSERT_EQ( 2 * trees.size() - 1, sc.clusters().size() );
+    for( size_t i = 0; i < expected.size(); ++i ) {
+        EXPECT_EQ( expected[i].index_a,    sc.mergers()[i].index_a );
+        EXPECT_EQ( expected[i].index_b,    sc.mergers()[i].index_b );
+        EXPECT_EQ( expected[i].distance_a, sc.mergers()[i].distance_a );
+        EXPECT_EQ( expected[i].distance_b, sc.mergers()[i].distance_b );
+    }
+
+    // Copies are merged first, in the order of their indices.
+    EXPECT_EQ( 0, sc.mergers()[0].index_a );
+    EXPECT_EQ( 3, sc.mergers()[0].index_b );
+    EXPECT_EQ( 1, sc.mergers()[1].index_a );
+    EXPECT_EQ( 4, sc.mergers()[1].index_b );
+}
+
 TEST( MassTree, PhylogeneticILR )
 {
     // Skip test if no data availabe.
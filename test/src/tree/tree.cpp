@@ -34,9 +34,12 @@
 
 #include "genesis/tree/common_tree/newick_reader.hpp"
 #include "genesis/tree/function/functions.hpp"
+#include "genesis/tree/function/manipulation.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
 #include "genesis/tree/tree.hpp"
 
+#include <cstdint>
+
 using namespace genesis;
 using namespace tree;
 
@@ -63,3 +66,41 @@ TEST(Tree, Basics)
     auto const copy_b = tree;
     EXPECT_TRUE( validate_topology( copy_b ));
 }
+
+TEST(Tree, ElementPool)
+{
+    std::string input = "((A,(B,C)D)E,((F,(G,H)I)J,K)L)R;";
+
+    // Reading and copying a tree creates its elements in contiguous memory.
+    Tree tree = CommonTreeNewickReader().read( utils::from_string(input));
+    auto copy = std::unique_ptr<Tree>( new Tree( tree ));
+    for( auto const* t : { &tree, copy.get() } ) {
+        for( size_t i = 1; i < t->node_count(); ++i ) {
+            auto const prev = reinterpret_cast<std::uintptr_t>( &t->node_at( i - 1 ));
+            auto const cur  = reinterpret_cast<std::uintptr_t>( &t->node_at( i ));
+            EXPECT_EQ( prev + sizeof( TreeNode ), cur );
+        }
+        EXPECT_EQ( 2 * t->edge_count(), t->link_count() );
+    }
+
+    // Elements can still be added and deleted individually.
+    add_new_node( *copy, copy->root_node() );
+    for( auto& node : tree.nodes() ) {
+        if( is_leaf( node )) {
+            delete_leaf_node( tree, node );
+            break;
+        }
+    }
+    EXPECT_EQ( 12, tree.node_count() );
+    EXPECT_TRUE( validate_topology( tree ));
+    EXPECT_TRUE( validate_topology( *copy ));
+
+    // Moving elements between trees keeps them alive as long as they are used.
+    Tree other;
+    other.swap( *copy );
+    copy.reset();
+    auto copy_b = other;
+    other = Tree();
+    EXPECT_EQ( 14, copy_b.node_count() );
+    EXPECT_TRUE( validate_topology( copy_b ));
+}
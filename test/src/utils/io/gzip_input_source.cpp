@@ -0,0 +1,193 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/io/gzip_input_source.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/parallel_gzip_input_source.hpp"
+
+#include <memory>
+#include <string>
+
+using namespace genesis;
+using namespace genesis::utils;
+
+static std::string read_input_source( std::shared_ptr<BaseInputSource> source )
+{
+    // Read in small pieces, so that reading crosses the boundaries of the decompressed blocks.
+    std::string result;
+    char buffer[ 100 ];
+    size_t count = 0;
+    while(( count = source->read( buffer, sizeof( buffer ))) > 0 ) {
+        result.append( buffer, count );
+    }
+    return result;
+}
+
+TEST( GzipInputSource, Members )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Files that consist of multiple gzip members need to be read completely.
+    auto const expected = file_read( environment->data_dir + "sequence/dna_10.fasta" );
+    auto const infile = environment->data_dir + "sequence/dna_10_members.fasta.gz";
+    EXPECT_EQ( expected, read_input_source( std::make_shared<GzipInputSource>(
+        std::make_shared<FileInputSource>( infile )
+    )));
+}
+
+TEST( GzipInputSource, Truncated )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Cut the file in the middle of the deflate stream, and right before its trailer.
+    auto const content = file_read( environment->data_dir + "sequence/dna_10.fasta.gz" );
+    for( auto const size : { content.size() / 2, content.size() - 8 } ) {
+        EXPECT_ANY_THROW( read_input_source( std::make_shared<GzipInputSource>(
+            from_string( content.substr( 0, size ))
+        )));
+    }
+}
+
+TEST( ParallelGzipInputSource, Bgzf )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    auto const expected = file_read( environment->data_dir + "sequence/dna_10.fasta" );
+    auto const infile = environment->data_dir + "sequence/dna_10_bgzf.fasta.gz";
+
+    // Use different task sizes and numbers of threads, including tasks of a single block.
+    for( size_t blocks = 1; blocks < 4; ++blocks ) {
+        for( size_t threads = 1; threads < 4; ++threads ) {
+            EXPECT_EQ( expected, read_input_source( std::make_shared<ParallelGzipInputSource>(
+                std::make_shared<FileInputSource>( infile ), blocks, threads
+            )));
+        }
+    }
+
+    // Default settings, and via the mapped file.
+    EXPECT_EQ( expected, read_input_source( from_file( infile )));
+    EXPECT_EQ( expected, read_input_source( from_mapped_file( infile )));
+    EXPECT_EQ(
+        environment->data_dir + "sequence/dna_10_bgzf.fasta",
+        from_file( infile )->source_string()
+    );
+}
+
+TEST( ParallelGzipInputSource, Fallback )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Files that are not in BGZF format are read with a normal GzipInputSource.
+    auto const expected = file_read( environment->data_dir + "sequence/dna_10.fasta" );
+    for( auto const& name : { "dna_10.fasta.gz", "dna_10_members.fasta.gz" } ) {
+        auto const infile = environment->data_dir + "sequence/" + name;
+        EXPECT_EQ( expected, read_input_source( std::make_shared<ParallelGzipInputSource>(
+            std::make_shared<FileInputSource>( infile ), 1, 2
+        )));
+    }
+}
+
+TEST( ParallelGzipInputSource, Mixed )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Concatenated BGZF and normal gzip files: Once the first normal gzip member is found,
+    // the rest of the input is read with a normal GzipInputSource, including further BGZF blocks.
+    auto const expected = file_read( environment->data_dir + "sequence/dna_10.fasta" );
+    auto const bgzf  = file_read( environment->data_dir + "sequence/dna_10_bgzf.fasta.gz" );
+    auto const plain = file_read( environment->data_dir + "sequence/dna_10.fasta.gz" );
+    for( size_t blocks = 1; blocks < 4; ++blocks ) {
+        for( size_t threads = 1; threads < 4; ++threads ) {
+            EXPECT_EQ( expected + expected, read_input_source(
+                std::make_shared<ParallelGzipInputSource>(
+                    from_string( bgzf + plain ), blocks, threads
+                )
+            ));
+            EXPECT_EQ( expected + expected + expected, read_input_source(
+                std::make_shared<ParallelGzipInputSource>(
+                    from_string( bgzf + plain + bgzf ), blocks, threads
+                )
+            ));
+        }
+    }
+}
+
+TEST( ParallelGzipInputSource, Truncated )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Cut the file in the middle of a block.
+    auto const infile = environment->data_dir + "sequence/dna_10_bgzf.fasta.gz";
+    auto const content = file_read( infile );
+    auto const truncated = content.substr( 0, content.size() / 2 );
+    EXPECT_ANY_THROW( read_input_source( std::make_shared<ParallelGzipInputSource>(
+        from_string( truncated ), 1, 2
+    )));
+}
+
+TEST( ParallelGzipInputSource, InvalidSize )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Get the size of the first block, and its stated uncompressed size at the end of the block.
+    auto const infile = environment->data_dir + "sequence/dna_10_bgzf.fasta.gz";
+    auto const content = file_read( infile );
+    auto const byte = [&]( size_t pos ){
+        return static_cast<size_t>( static_cast<unsigned char>( content[pos] ));
+    };
+    size_t const block_size = ( byte( 16 ) | ( byte( 17 ) << 8 )) + 1;
+    size_t const isize_pos = block_size - 4;
+    size_t isize = 0;
+    for( size_t i = 0; i < 4; ++i ) {
+        isize |= byte( isize_pos + i ) << ( 8 * i );
+    }
+
+    // Both a size that is too large for a BGZF block and a size that does not match
+    // the compressed data have to be rejected.
+    for( auto const wrong : { isize - 1, isize + 1, static_cast<size_t>( 1 ) << 30 } ) {
+        auto corrupt = content;
+        for( size_t i = 0; i < 4; ++i ) {
+            corrupt[ isize_pos + i ] = static_cast<char>(( wrong >> ( 8 * i )) & 0xFF );
+        }
+        EXPECT_ANY_THROW( read_input_source( std::make_shared<ParallelGzipInputSource>(
+            from_string( corrupt ), 1, 2
+        )));
+    }
+}
@@ -0,0 +1,159 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2019 Lucas Czech and HITS gGmbH
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/sequence/formats/fasta_reader.hpp"
+#include "genesis/sequence/formats/fasta_writer.hpp"
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/options.hpp"
+#include "genesis/utils/io/gzip_input_source.hpp"
+#include "genesis/utils/io/gzip_stream.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/output_stream.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace genesis;
+using namespace genesis::utils;
+
+static std::string gunzip_string( std::string const& compressed )
+{
+    auto source = std::make_shared<GzipInputSource>( from_string( compressed ));
+    std::string result;
+    char buffer[ 4096 ];
+    size_t count = 0;
+    while(( count = source->read( buffer, sizeof( buffer ))) > 0 ) {
+        result.append( buffer, count );
+    }
+    return result;
+}
+
+TEST( GzipStream, OStream )
+{
+    // Make some data that spans multiple blocks of the stream buffer.
+    std::string expected;
+    for( size_t i = 0; i < 100000; ++i ) {
+        expected += "line " + std::to_string( i ) + "\n";
+    }
+
+    for( auto const level : {
+        GzipCompressionLevel::kDefaultCompression, GzipCompressionLevel::kNoCompression,
+        GzipCompressionLevel::kBestSpeed, GzipCompressionLevel::kBestCompression
+    }) {
+        std::ostringstream sink;
+        {
+            GzipOStream gzip( sink, level );
+            gzip << expected.substr( 0, 1000 );
+
+            // After flushing, the data so far needs to be written, but the gzip file is not
+            // yet complete, so reading it has to fail instead of running forever.
+            gzip.flush();
+            EXPECT_LT( 0, sink.str().size() );
+            EXPECT_ANY_THROW( gunzip_string( sink.str() ));
+
+            gzip << expected.substr( 1000 );
+        }
+        EXPECT_EQ( expected, gunzip_string( sink.str() ));
+    }
+
+    // Empty output is a valid gzip file as well.
+    std::ostringstream sink;
+    {
+        GzipOStream gzip( sink );
+    }
+    EXPECT_EQ( "", gunzip_string( sink.str() ));
+}
+
+TEST( GzipStream, SmallBlocks )
+{
+    // Use a tiny block size, so that many blocks are handed over to the compression thread.
+    std::string expected;
+    for( size_t i = 0; i < 10000; ++i ) {
+        expected += "line " + std::to_string( i ) + "\n";
+    }
+
+    std::ostringstream sink;
+    {
+        GzipStreamBuf buffer( sink, GzipCompressionLevel::kDefaultCompression, 100 );
+        std::ostream out( &buffer );
+        out << expected;
+        buffer.finish();
+
+        // Finishing again does nothing, and no more data can be written afterwards.
+        buffer.finish();
+        out << "more";
+        EXPECT_FALSE( out.good() );
+    }
+    EXPECT_EQ( expected, gunzip_string( sink.str() ));
+}
+
+TEST( GzipStream, FailingSink )
+{
+    // Errors of the underlying stream cannot be reported from the destructor,
+    // but finish() throws them.
+    std::ostringstream sink;
+    sink.setstate( std::ios::badbit );
+    GzipOStream gzip( sink );
+    gzip << "some data";
+    EXPECT_ANY_THROW( gzip.finish() );
+}
+
+TEST( GzipStream, WriterToFile )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    auto const infile  = environment->data_dir + "sequence/dna_10.fasta";
+    auto const outfile = environment->data_dir + "sequence/dna_10_out.fasta.gz";
+    auto const sset = sequence::FastaReader().read( from_file( infile ));
+
+    // Writing to a file ending in .gz compresses the output, which we can read again.
+    Options::get().allow_file_overwriting( true );
+    sequence::FastaWriter().to_file( sset, outfile );
+    Options::get().allow_file_overwriting( false );
+
+    EXPECT_TRUE( is_gzip_compressed_file( outfile ));
+    auto const reread = sequence::FastaReader().read( from_file( outfile ));
+    ASSERT_EQ( sset.size(), reread.size() );
+    for( size_t i = 0; i < sset.size(); ++i ) {
+        EXPECT_EQ( sset[i].label(), reread[i].label() );
+        EXPECT_EQ( sset[i].sites(), reread[i].sites() );
+    }
+
+    // Existing files are not overwritten by default.
+    EXPECT_ANY_THROW( sequence::FastaWriter().to_file( sset, outfile ));
+
+    ASSERT_EQ( 0, std::remove( outfile.c_str() ));
+}
@@ -30,12 +30,15 @@
 
 #include "src/common.hpp"
 
+#include "genesis/utils/io/char_search.hpp"
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/core/std.hpp"
 
 #include <algorithm>
 #include <cstdio>
 #include <fstream>
+#include <functional>
 #include <iterator>
 #include <sstream>
 #include <string>
@@ -159,3 +162,220 @@ TEST( InputStream, LargeFile )
     // Make sure the file is deleted.
     ASSERT_EQ( 0, std::remove(tmpfile.c_str()) );
 }
+
+static void test_mapped_file( std::string const& content )
+{
+    std::string tmpfile = environment->data_dir + "utils/mapped_file.txt";
+    {
+        std::ofstream out{ tmpfile, std::ios::binary };
+        ASSERT_TRUE( out );
+        out << content;
+    }
+
+    // Read the file via the normal buffer and via the mapping, and compare all chars and counters.
+    // We read the mapped source twice, to make sure that reading does not change the mapping.
+    auto const mapped_source = from_mapped_file( tmpfile );
+    for( size_t r = 0; r < 2; ++r ) {
+        InputStream buffered( from_file( tmpfile ));
+        InputStream mapped( mapped_source );
+        while( buffered && mapped ) {
+            EXPECT_EQ( *buffered, *mapped );
+            EXPECT_EQ( buffered.line(),   mapped.line() );
+            EXPECT_EQ( buffered.column(), mapped.column() );
+            ++buffered;
+            ++mapped;
+        }
+        EXPECT_FALSE( buffered );
+        EXPECT_FALSE( mapped );
+    }
+
+    // Same for reading lines.
+    InputStream buffered( from_file( tmpfile ));
+    InputStream mapped( mapped_source );
+    while( buffered && mapped ) {
+        EXPECT_EQ( buffered.get_line(), mapped.get_line() );
+        EXPECT_EQ( buffered.line(), mapped.line() );
+    }
+    EXPECT_FALSE( buffered );
+    EXPECT_FALSE( mapped );
+
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+}
+
+TEST( InputStream, MappedFile )
+{
+    // Skip test if no data directory availabe.
+    NEEDS_TEST_DATA;
+
+    test_mapped_file( "" );
+    test_mapped_file( "x" );
+    test_mapped_file( "xyz\nxy\nx\nx" );
+    test_mapped_file( "a\rb\r" );
+    test_mapped_file( "a\r\nb\r\n" );
+    test_mapped_file( "\r\r\n\r\n\n" );
+    test_mapped_file( "\xEF\xBB\xBFxyz\n" );
+
+    // Exactly one page, so that the closing new line char has to go into the next one.
+    test_mapped_file( std::string( 4096, 'x' ));
+
+    // Lines longer than the buffer of the stream can be read in one piece from a mapped file.
+    auto const line = std::string( InputStream::BlockLength * 5 / 2, 'x' );
+    test_mapped_file( line + "\n" + line );
+
+    // Read a file with known counters.
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    InputStream instr( from_mapped_file( infile ));
+    test_input_specs( instr, 110, 51 );
+}
+
+TEST( InputStream, MappedLargeFile )
+{
+    // Skip test if no data directory availabe.
+    NEEDS_TEST_DATA;
+
+    // Create a file with many short lines that is larger than the two blocks that the stream
+    // buffers for normal sources, so that the whole mapping is walked by advance() and get_line().
+    std::string tmpfile = environment->data_dir + "utils/mapped_large_file.txt";
+    auto const line = std::string( 99, 'x' );
+    size_t const line_count = 3 * InputStream::BlockLength / ( line.size() + 1 );
+    {
+        std::ofstream out{ tmpfile, std::ios::binary };
+        ASSERT_TRUE( out );
+        for( size_t i = 0; i < line_count; ++i ) {
+            out << line << "\n";
+        }
+    }
+    ASSERT_LT( 2 * InputStream::BlockLength, line_count * ( line.size() + 1 ));
+    auto const source = from_mapped_file( tmpfile );
+
+    // Read char by char.
+    size_t char_count = 0;
+    auto chars = InputStream( source );
+    while( chars ) {
+        ++char_count;
+        ++chars;
+    }
+    EXPECT_EQ( line_count * ( line.size() + 1 ), char_count );
+    EXPECT_EQ( line_count + 1, chars.line() );
+
+    // Read line by line.
+    size_t cnt = 0;
+    auto lines = InputStream( source );
+    while( lines ) {
+        EXPECT_EQ( line, lines.get_line() );
+        ++cnt;
+        EXPECT_EQ( cnt + 1, lines.line() );
+    }
+    EXPECT_EQ( line_count, cnt );
+
+    // Make sure the file is deleted.
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+}
+
+TEST( InputStream, CharSearch )
+{
+    // Test the search functions with all offsets of the found char,
+    // so that we get all combinations of the vectorized and the scalar part.
+    for( size_t len = 0; len < 100; ++len ) {
+        for( size_t pos = 0; pos <= len; ++pos ) {
+            auto str = std::string( len, 'x' );
+            if( pos < len ) {
+                str[pos] = 'y';
+            }
+            auto const first = str.data();
+            auto const last  = str.data() + str.size();
+            EXPECT_EQ( first + pos, find_char( first, last, 'y' ));
+            EXPECT_EQ( first + pos, find_either_char( first, last, 'y', 'z' ));
+            EXPECT_EQ( first + pos, find_either_char( first, last, 'z', 'y' ));
+            EXPECT_EQ( first + pos, find_any_of( first, last, "abcy" ));
+            EXPECT_EQ( first + pos, find_not_char( first, last, 'x' ));
+            size_t const found = pos < len ? 1 : 0;
+            EXPECT_EQ( found, count_char( first, last, 'y' ));
+            EXPECT_EQ( len - found, count_char( first, last, 'x' ));
+        }
+    }
+}
+
+static void test_bulk_scanning( std::string const& content )
+{
+    // Compare the bulk functions to reading the same stream char by char,
+    // using the std::function overloads of the scanner functions.
+    auto compare = [&](
+        std::function<void( InputStream&, std::string& )> bulk,
+        std::function<void( InputStream&, std::string& )> single
+    ) {
+        InputStream bulk_it( from_string( content ));
+        InputStream single_it( from_string( content ));
+        while( bulk_it && single_it ) {
+            std::string bulk_str;
+            std::string single_str;
+            bulk( bulk_it, bulk_str );
+            single( single_it, single_str );
+            EXPECT_EQ( single_str, bulk_str );
+            EXPECT_EQ( single_it.line(),   bulk_it.line() );
+            EXPECT_EQ( single_it.column(), bulk_it.column() );
+            EXPECT_EQ( *single_it, *bulk_it );
+
+            // Move on, so that we find the next one.
+            ++bulk_it;
+            ++single_it;
+        }
+        EXPECT_FALSE( bulk_it );
+        EXPECT_FALSE( single_it );
+    };
+
+    for( char const c : std::string( "\nabx\r" )) {
+        compare(
+            [&]( InputStream& it, std::string& ){ skip_until( it, c ); },
+            [&]( InputStream& it, std::string& ){ skip_until( it, [&]( char d ){ return d == c; }); }
+        );
+        compare(
+            [&]( InputStream& it, std::string& s ){ s = read_until( it, c ); },
+            [&]( InputStream& it, std::string& s ){
+                s = read_until( it, [&]( char d ){ return d == c; });
+            }
+        );
+        compare(
+            [&]( InputStream& it, std::string& ){ skip_while( it, c ); },
+            [&]( InputStream& it, std::string& ){ skip_while( it, [&]( char d ){ return d == c; }); }
+        );
+    }
+    compare(
+        [&]( InputStream& it, std::string& s ){ it.read_until_any_of( s, "b\n" ); },
+        [&]( InputStream& it, std::string& s ){
+            s = read_until( it, []( char d ){ return d == 'b' || d == '\n'; });
+        }
+    );
+    compare(
+        [&]( InputStream& it, std::string& s ){ it.read_until_any_of( s, "abc" ); },
+        [&]( InputStream& it, std::string& s ){
+            s = read_until( it, []( char d ){ return d == 'a' || d == 'b' || d == 'c'; });
+        }
+    );
+    compare(
+        [&]( InputStream& it, std::string& s ){ s = read_to_end_of_line( it ); },
+        [&]( InputStream& it, std::string& s ){
+            s = read_until( it, []( char d ){ return d == '\n'; });
+        }
+    );
+}
+
+TEST( InputStream, BulkScanning )
+{
+    test_bulk_scanning( "" );
+    test_bulk_scanning( "x" );
+    test_bulk_scanning( "xyz\nxy\nx\nx" );
+    test_bulk_scanning( "a\rb\r" );
+    test_bulk_scanning( "a\r\nb\r\n" );
+    test_bulk_scanning( "\r\r\n\r\n\n" );
+    test_bulk_scanning( "\xEF\xBB\xBFxyz\n" );
+
+    // Longer content, with all kinds of line breaks, and some runs of the same char.
+    std::string content;
+    for( size_t i = 0; i < 500; ++i ) {
+        content += std::string( i % 37, 'x' ) + "ab" + std::string( i % 13, 'a' );
+        content += ( i % 3 == 0 ? "\n" : ( i % 3 == 1 ? "\r\n" : "\r" ));
+    }
+    test_bulk_scanning( content );
+    test_bulk_scanning( content.substr( 0, content.size() - 1 ));
+}
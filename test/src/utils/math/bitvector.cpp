@@ -36,6 +36,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <random>
 
 using namespace genesis::utils;
 
@@ -76,3 +77,101 @@ TEST( Bitvector, Streams )
     istr >> cp;
     EXPECT_EQ( bv, cp );
 }
+
+/**
+ * @brief Local helper function that creates a random Bitvector of the given size.
+ */
+static Bitvector make_random_bitvector_( size_t size, std::mt19937& engine )
+{
+    auto result = Bitvector( size );
+    for( size_t i = 0; i < size; ++i ) {
+        if( engine() % 2 ) {
+            result.set( i );
+        }
+    }
+    return result;
+}
+
+TEST( Bitvector, Words )
+{
+    // Set the words, including the padding bits of the last one, which need to be ignored.
+    auto bv = Bitvector( 70 );
+    ASSERT_EQ( 2, bv.word_count() );
+    bv.set_word( 0, 0x8000000000000001 );
+    bv.set_word( 1, ~Bitvector::IntType( 0 ));
+    EXPECT_EQ( 8, bv.count() );
+    EXPECT_EQ( 0x3F, bv.get_word( 1 ));
+    EXPECT_TRUE( bv[0] );
+    EXPECT_FALSE( bv[1] );
+    EXPECT_TRUE( bv[63] );
+    EXPECT_TRUE( bv[64] );
+    EXPECT_TRUE( bv[69] );
+    EXPECT_EQ( bv, ~Bitvector( 70, false ) & bv );
+}
+
+TEST( Bitvector, Counts )
+{
+    std::mt19937 engine( 42 );
+
+    // Test sizes around the word and vector boundaries.
+    for( size_t size : { 0, 1, 63, 64, 65, 255, 256, 300, 1000 } ) {
+        auto const lhs = make_random_bitvector_( size, engine );
+        auto const rhs = make_random_bitvector_( size, engine );
+
+        // Compare to a simple count of the bits.
+        size_t exp_lhs = 0;
+        size_t exp_and = 0;
+        size_t exp_or  = 0;
+        size_t exp_xor = 0;
+        for( size_t i = 0; i < size; ++i ) {
+            exp_lhs += lhs[i];
+            exp_and += lhs[i] && rhs[i];
+            exp_or  += lhs[i] || rhs[i];
+            exp_xor += lhs[i] != rhs[i];
+        }
+        EXPECT_EQ( exp_lhs, lhs.count() );
+        EXPECT_EQ( exp_and, count_and( lhs, rhs ));
+        EXPECT_EQ( exp_or,  count_or( lhs, rhs ));
+        EXPECT_EQ( exp_xor, count_xor( lhs, rhs ));
+
+        // Compare to the materialized operations.
+        EXPECT_EQ( ( lhs & rhs ).count(), count_and( lhs, rhs ));
+        EXPECT_EQ( ( lhs | rhs ).count(), count_or( lhs, rhs ));
+        EXPECT_EQ( ( lhs ^ rhs ).count(), count_xor( lhs, rhs ));
+        EXPECT_EQ( ( lhs | rhs ) & ~( lhs & rhs ), symmetric_difference( lhs, rhs ));
+        EXPECT_EQ( lhs & ~rhs, set_minus( lhs, rhs ));
+        EXPECT_EQ( size - exp_or, ( ~( lhs | rhs )).count() );
+    }
+
+    EXPECT_ANY_THROW( count_and( Bitvector( 5 ), Bitvector( 6 )));
+    EXPECT_ANY_THROW( count_xor( Bitvector( 5 ), Bitvector( 6 )));
+}
+
+TEST( Bitvector, Subsets )
+{
+    std::mt19937 engine( 42 );
+
+    for( size_t size : { 1, 64, 65, 300 } ) {
+        auto const super = make_random_bitvector_( size, engine ) | Bitvector( size, { 0 } );
+        auto sub = super;
+        sub.unset( 0 );
+
+        EXPECT_TRUE(  is_subset( sub, super ));
+        EXPECT_TRUE(  is_subset( super, super ));
+        EXPECT_TRUE(  is_strict_subset( sub, super ));
+        EXPECT_FALSE( is_strict_subset( super, super ));
+        EXPECT_FALSE( is_subset( super, sub ));
+        EXPECT_TRUE(  is_superset( super, sub ));
+        EXPECT_TRUE(  is_strict_superset( super, sub ));
+        EXPECT_FALSE( is_strict_superset( sub, super ));
+
+        // A bit in the last word that is not in the superset.
+        auto other = sub;
+        other.set( size - 1 );
+        auto extended = super;
+        extended.unset( size - 1 );
+        EXPECT_FALSE( is_subset( other, extended ));
+    }
+
+    EXPECT_ANY_THROW( is_subset( Bitvector( 5 ), Bitvector( 6 )));
+}
@@ -35,12 +35,64 @@
 #include "genesis/utils/math/euclidean_kmeans.hpp"
 #include "genesis/utils/math/kmeans.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
+#include <random>
 #include <utility>
+#include <vector>
 
 using namespace genesis;
 using namespace utils;
 
+// =================================================================================================
+//     Helper
+// =================================================================================================
+
+/**
+ * @brief Simple euclidean Kmeans that counts its distance calculations.
+ */
+class CountingKmeans
+    : public Kmeans< std::vector<double> >
+{
+public:
+
+    using Point = std::vector<double>;
+
+    mutable std::atomic<size_t> distance_count{ 0 };
+
+private:
+
+    virtual void update_centroids(
+        std::vector<Point>  const& data,
+        std::vector<size_t> const& assignments,
+        std::vector<Point>&        centroids
+    ) override {
+        auto counts = std::vector<size_t>( centroids.size(), 0 );
+        centroids = std::vector<Point>( centroids.size(), Point( 2, 0.0 ));
+        for( size_t i = 0; i < data.size(); ++i ) {
+            centroids[ assignments[i] ][0] += data[i][0];
+            centroids[ assignments[i] ][1] += data[i][1];
+            ++counts[ assignments[i] ];
+        }
+        for( size_t c = 0; c < centroids.size(); ++c ) {
+            if( counts[c] > 0 ) {
+                centroids[c][0] /= static_cast<double>( counts[c] );
+                centroids[c][1] /= static_cast<double>( counts[c] );
+            }
+        }
+    }
+
+    virtual double distance( Point const& lhs, Point const& rhs ) const override
+    {
+        ++distance_count;
+        auto const d0 = lhs[0] - rhs[0];
+        auto const d1 = lhs[1] - rhs[1];
+        return std::sqrt( d0 * d0 + d1 * d1 );
+    }
+};
+
 // =================================================================================================
 //     Test Cases
 // =================================================================================================
@@ -141,3 +193,109 @@ TEST( Math, Kmeans )
     doc.write( out );
     file_write( out.str(), "/home/lucas/test.svg" );
 }
+
+TEST( Math, KmeansDistanceBounds )
+{
+    using Point = std::vector<double>;
+
+    // Overlapping clusters, so that there are some points that change their assignment
+    // over several iterations.
+    auto& e = Options::get().random_engine();
+    std::normal_distribution<double> norm( 0.0, 1.5 );
+    auto data = std::vector<Point>();
+    for( size_t c = 0; c < 5; ++c ) {
+        for( size_t i = 0; i < 200; ++i ) {
+            data.push_back({ 3.0 * c + norm( e ), 2.0 * ( c % 2 ) + norm( e ) });
+        }
+    }
+    auto const initial = std::vector<Point>( data.begin(), data.begin() + 5 );
+
+    CountingKmeans plain;
+    plain.distance_bounds( false );
+    plain.initialization_strategy( KmeansInitializationStrategy::kNone );
+    plain.centroids( initial );
+    auto const plain_iterations = plain.run( data, 5 );
+
+    CountingKmeans bounded;
+    bounded.distance_bounds( true );
+    bounded.initialization_strategy( KmeansInitializationStrategy::kNone );
+    bounded.centroids( initial );
+    auto const bounded_iterations = bounded.run( data, 5 );
+
+    // Same result, with fewer distance calculations.
+    EXPECT_LT( 2, plain_iterations );
+    EXPECT_EQ( plain_iterations, bounded_iterations );
+    EXPECT_EQ( plain.assignments(), bounded.assignments() );
+    EXPECT_EQ( plain.centroids(), bounded.centroids() );
+    EXPECT_LT( bounded.distance_count.load(), plain.distance_count.load() );
+}
+
+TEST( Math, KmeansInitializationAndMiniBatch )
+{
+    using Point = std::vector<double>;
+
+    // Well separated clusters of different size. Use a fixed seed, so that the test does not
+    // depend on the (unlikely) case of two initial centroids in the same cluster.
+    Options::get().random_seed( 42 );
+    auto& e = Options::get().random_engine();
+    std::normal_distribution<double> norm( 0.0, 0.5 );
+    auto const centers = std::vector<Point>{{ 0.0, 0.0 }, { 20.0, 0.0 }, { 0.0, 20.0 }, { 20.0, 20.0 }};
+    auto const sizes   = std::vector<size_t>{ 300, 100, 200, 50 };
+    auto data  = std::vector<Point>();
+    auto truth = std::vector<size_t>();
+    for( size_t c = 0; c < centers.size(); ++c ) {
+        for( size_t i = 0; i < sizes[c]; ++i ) {
+            data.push_back({ centers[c][0] + norm( e ), centers[c][1] + norm( e ) });
+            truth.push_back( c );
+        }
+    }
+
+    // Each true cluster needs to end up in its own cluster.
+    auto check_clustering = [&]( std::vector<size_t> const& assignments ){
+        ASSERT_EQ( data.size(), assignments.size() );
+        auto mapping = std::vector<size_t>( centers.size(), centers.size() );
+        for( size_t i = 0; i < data.size(); ++i ) {
+            if( mapping[ truth[i] ] == centers.size() ) {
+                mapping[ truth[i] ] = assignments[i];
+            }
+            EXPECT_EQ( mapping[ truth[i] ], assignments[i] );
+        }
+        std::sort( mapping.begin(), mapping.end() );
+        EXPECT_EQ( std::vector<size_t>({ 0, 1, 2, 3 }), mapping );
+    };
+
+    for( auto strategy : {
+        KmeansInitializationStrategy::kKmeansPlusPlus, KmeansInitializationStrategy::kKmeansParallel
+    }) {
+        // Full batch.
+        auto kmeans = EuclideanKmeans( 2 );
+        kmeans.initialization_strategy( strategy );
+        kmeans.run( data, 4 );
+        check_clustering( kmeans.assignments() );
+
+        // Mini-batch, using fewer points per iteration than there are data points.
+        auto mini = EuclideanKmeans( 2 );
+        mini.initialization_strategy( strategy );
+        mini.mini_batch_size( 64 );
+        mini.max_iterations( 20 );
+        EXPECT_EQ( 20, mini.run( data, 4 ));
+        check_clustering( mini.assignments() );
+    }
+
+    // A centroid that is far away from all data never receives points in the mini-batches,
+    // and needs to be treated as an empty cluster at the end.
+    auto far = EuclideanKmeans( 2 );
+    far.initialization_strategy( KmeansInitializationStrategy::kNone );
+    far.centroids({ data[0], data[300], data[400], Point{ 1000.0, 1000.0 } });
+    far.mini_batch_size( 64 );
+    far.max_iterations( 20 );
+    far.run( data, 4 );
+    for( auto const size : far.cluster_sizes() ) {
+        EXPECT_LT( 0, size );
+    }
+
+    // Without support for mini-batches, the base class throws.
+    CountingKmeans counting;
+    counting.mini_batch_size( 10 );
+    EXPECT_ANY_THROW( counting.run( data, 4 ));
+}